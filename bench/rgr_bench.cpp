@@ -0,0 +1,657 @@
+//
+//  rgr_bench.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  Throughput and latency benchmarks for the C++ core. Typical run:
+//
+//      rgr_bench --benchmark_format=json --benchmark_out=bench.json
+//
+//  Payloads larger than RGR_BENCH_MAX_BYTES (default 16 MiB) are not
+//  registered; export RGR_BENCH_MAX_BYTES=1073741824 for the full
+//  64 B - 1 GB sweep. RGR_BENCH_INSTRUMENTATION=1 enables the core's stage
+//  counters and prints their JSON snapshot to stderr after the run.
+//
+
+#include "container/cipher_container.hpp"
+#include "engine/cipher_engine.hpp"
+#include "engine/cipher_file_pipeline.hpp"
+#include "gost/gost.hpp"
+#include "permutationCipher/permutation_cipher.hpp"
+#include "rsa/rsa.hpp"
+#include "staticShift/static_shift.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const std::string kGostKey =
+    "00112233445566778899aabbccddeeff0123456789abcdeffedcba9876543210";
+const std::string kPermutationKey = "4203156";
+const std::string kStaticShiftKey = "3";
+const unsigned int kRsaBits = 1024;
+// RSA is several orders of magnitude slower; keep its sweep short.
+const size_t kRsaMaxBytes = 64 * 1024;
+
+size_t max_payload_bytes() {
+    static const size_t max_bytes = [] {
+        const char *env = std::getenv("RGR_BENCH_MAX_BYTES");
+        return env ? static_cast<size_t>(std::strtoull(env, nullptr, 10))
+                   : static_cast<size_t>(16) << 20;
+    }();
+    return max_bytes;
+}
+
+std::vector<int64_t> payload_sizes(size_t limit) {
+    std::vector<int64_t> sizes;
+    for (size_t size = 64; size <= (static_cast<size_t>(1) << 30); size *= 16) {
+        if (size <= std::min(limit, max_payload_bytes())) {
+            sizes.push_back(static_cast<int64_t>(size));
+        }
+    }
+    return sizes;
+}
+
+std::vector<unsigned int> thread_counts() {
+    unsigned int hw = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> counts = {1};
+    for (unsigned int t = 2; t <= hw && t <= 16; t *= 2) {
+        counts.push_back(t);
+    }
+    return counts;
+}
+
+const std::vector<unsigned char> &payload(size_t size) {
+    static std::map<size_t, std::vector<unsigned char>> cache;
+    auto it = cache.find(size);
+    if (it == cache.end()) {
+        std::mt19937 gen(static_cast<unsigned int>(size));
+        std::vector<unsigned char> data(size);
+        for (unsigned char &byte : data) {
+            byte = static_cast<unsigned char>(gen());
+        }
+        it = cache.emplace(size, std::move(data)).first;
+    }
+    return it->second;
+}
+
+const KeyPair &rsa_keys() {
+    static const KeyPair keys = [] {
+        boost::random::mt19937 rng(42);
+        return generateKeys(kRsaBits, rng);
+    }();
+    return keys;
+}
+
+// 3072-bit keys with 2, 3 and 4 primes for the CRT comparison.
+const unsigned int kRsaCrtBits = 3072;
+
+const KeyPair &rsa_crt_keys(unsigned int prime_count) {
+    static std::map<unsigned int, KeyPair> cache;
+    auto it = cache.find(prime_count);
+    if (it == cache.end()) {
+        boost::random::mt19937 rng(42 + prime_count);
+        it = cache
+                 .emplace(prime_count,
+                          generateKeys(kRsaCrtBits, rng, prime_count))
+                 .first;
+    }
+    return it->second;
+}
+
+std::string rsa_engine_key() {
+    const KeyPair &keys = rsa_keys();
+    std::ostringstream oss;
+    oss << std::hex << keys.pubKey.n << ";" << keys.pubKey.e << ";"
+        << keys.privKey.d;
+    return oss.str();
+}
+
+struct EngineCase {
+    std::string name;
+    std::string key;
+    size_t max_bytes;
+};
+
+std::vector<EngineCase> engine_cases() {
+    return {
+        {"gost", kGostKey, ~static_cast<size_t>(0)},
+        {"permutation", kPermutationKey, ~static_cast<size_t>(0)},
+        {"static_shift", kStaticShiftKey, ~static_cast<size_t>(0)},
+        {"rsa", rsa_engine_key(), kRsaMaxBytes},
+    };
+}
+
+std::vector<unsigned char> engine_input(const EngineCase &c,
+                                        CipherDirection direction,
+                                        size_t size) {
+    const std::vector<unsigned char> &plaintext = payload(size);
+    if (direction == CipherDirection::Encrypt) {
+        return plaintext;
+    }
+    auto engine = CipherEngineRegistry::instance().create(
+        c.name, c.key, CipherDirection::Encrypt);
+    return run_cipher_buffer(*engine, plaintext.data(), plaintext.size());
+}
+
+void set_throughput(benchmark::State &state, size_t bytes_per_iteration) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(bytes_per_iteration));
+}
+
+// --- In-memory engine path ---
+void BM_EngineBuffer(benchmark::State &state, EngineCase c,
+                     CipherDirection direction, unsigned int threads) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::vector<unsigned char> input = engine_input(c, direction, size);
+    CipherDriverOptions options;
+    options.threads = threads;
+    for (auto _ : state) {
+        auto engine =
+            CipherEngineRegistry::instance().create(c.name, c.key, direction);
+        std::vector<unsigned char> output =
+            run_cipher_buffer(*engine, input.data(), input.size(), options);
+        benchmark::DoNotOptimize(output.data());
+    }
+    set_throughput(state, size);
+}
+
+// --- File path ---
+std::string temp_file(const std::string &tag) {
+    return (std::filesystem::temp_directory_path() /
+            ("rgr_bench_" + tag + ".bin"))
+        .string();
+}
+
+void BM_EngineFile(benchmark::State &state, EngineCase c,
+                   CipherDirection direction, unsigned int threads,
+                   CipherIoBackend backend) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string input_path = temp_file(c.name + "_in");
+    std::string output_path = temp_file(c.name + "_out");
+    {
+        std::vector<unsigned char> input = engine_input(c, direction, size);
+        std::ofstream file(input_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(input.data()),
+                   static_cast<std::streamsize>(input.size()));
+    }
+    CipherDriverOptions options;
+    options.threads = threads;
+    options.io_backend = backend;
+    for (auto _ : state) {
+        auto engine =
+            CipherEngineRegistry::instance().create(c.name, c.key, direction);
+        CipherDriverResult result =
+            run_cipher_file(*engine, input_path, output_path, options);
+        if (!result.success) {
+            state.SkipWithError(result.message.c_str());
+            break;
+        }
+    }
+    set_throughput(state, size);
+    std::filesystem::remove(input_path);
+    std::filesystem::remove(output_path);
+}
+
+// --- Chunked container: 4 KiB reads at random offsets ---
+void BM_ContainerReadAt(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string input_path = temp_file("container_in");
+    std::string container_path = temp_file("container");
+    {
+        const std::vector<unsigned char> &data = payload(size);
+        std::ofstream file(input_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+    }
+    CipherContainerOptions options;
+    options.chunk_size = 64 * 1024;
+    options.mac_key.assign(16, 0x5a);
+    auto encryptor = CipherEngineRegistry::instance().create(
+        "gost", kGostKey, CipherDirection::Encrypt);
+    write_cipher_container(*encryptor, input_path, container_path, options);
+    auto decryptor = CipherEngineRegistry::instance().create(
+        "gost", kGostKey, CipherDirection::Decrypt);
+    CipherContainerReader reader(container_path, *decryptor, options.mac_key);
+    const size_t read_size = 4096;
+    std::mt19937_64 gen(7);
+    for (auto _ : state) {
+        uint64_t offset = gen() % (size > read_size ? size - read_size : 1);
+        std::vector<unsigned char> bytes = reader.read_at(offset, read_size);
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    set_throughput(state, std::min(size, read_size));
+    std::filesystem::remove(input_path);
+    std::filesystem::remove(container_path);
+}
+
+// Text resembling service logs, which LZ4 shrinks several times over.
+const std::vector<unsigned char> &log_payload(size_t size) {
+    static std::map<size_t, std::vector<unsigned char>> cache;
+    auto it = cache.find(size);
+    if (it == cache.end()) {
+        static const char *const levels[] = {"INFO", "DEBUG", "WARN"};
+        std::mt19937 gen(static_cast<unsigned int>(size));
+        std::string text;
+        while (text.size() < size) {
+            text += "2026-10-18T12:" + std::to_string(gen() % 60) + ":" +
+                    std::to_string(gen() % 60) + " " + levels[gen() % 3] +
+                    " worker-" + std::to_string(gen() % 8) +
+                    " request id=" + std::to_string(gen() % 100000) +
+                    " status=200 latency_ms=" + std::to_string(gen() % 500) +
+                    "\n";
+        }
+        it = cache.emplace(size, std::vector<unsigned char>(
+                                     text.begin(), text.begin() + size))
+                 .first;
+    }
+    return it->second;
+}
+
+// --- Chunked container: whole-file write of log text, optionally LZ4 ---
+void BM_ContainerWrite(benchmark::State &state,
+                       CipherContainerCompression compression) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string input_path = temp_file("container_log");
+    std::string container_path = temp_file("container_out");
+    {
+        const std::vector<unsigned char> &data = log_payload(size);
+        std::ofstream file(input_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+    }
+    CipherContainerOptions options;
+    options.compression = compression;
+    auto encryptor = CipherEngineRegistry::instance().create(
+        "gost", kGostKey, CipherDirection::Encrypt);
+    uint64_t container_bytes = 0;
+    for (auto _ : state) {
+        CipherContainerResult result = write_cipher_container(
+            *encryptor, input_path, container_path, options);
+        if (!result.success) {
+            state.SkipWithError(result.message.c_str());
+            break;
+        }
+        container_bytes = result.container_bytes;
+    }
+    set_throughput(state, size);
+    state.counters["output_ratio"] =
+        static_cast<double>(container_bytes) / static_cast<double>(size);
+    std::filesystem::remove(input_path);
+    std::filesystem::remove(container_path);
+}
+
+// --- Legacy string/hex text APIs ---
+void BM_TextGOST(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string text(payload(size).begin(), payload(size).end());
+    for (auto _ : state) {
+        GostEncryptedTextResult result = encryptTextGOST(text, kGostKey);
+        benchmark::DoNotOptimize(result.ciphertext_hex.data());
+    }
+    set_throughput(state, size);
+}
+
+void BM_TextPermutation(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string text(payload(size).begin(), payload(size).end());
+    for (auto _ : state) {
+        PermutationTextResultCpp result =
+            encryptTextPermutationCpp(text, kPermutationKey);
+        benchmark::DoNotOptimize(result.data_hex.data());
+    }
+    set_throughput(state, size);
+}
+
+void BM_TextRSA(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string text(payload(size).begin(), payload(size).end());
+    const PublicKey &key = rsa_keys().pubKey;
+    size_t key_n_byte_length = getApproximateByteLength(key.n);
+    for (auto _ : state) {
+        std::vector<BigInt> blocks = encryptText(text, key, key_n_byte_length);
+        benchmark::DoNotOptimize(blocks.data());
+    }
+    set_throughput(state, size);
+}
+
+// One private-key operation; prime_count 0 is the same two-prime key
+// without its CRT factors, i.e. a full-size c^d mod n.
+void BM_RsaPrivateOp(benchmark::State &state, unsigned int prime_count) {
+    PrivateKey key = rsa_crt_keys(prime_count == 0 ? 2 : prime_count).privKey;
+    if (prime_count == 0) {
+        key.primes.clear();
+    }
+    BigInt c = key.n / 3;
+    for (auto _ : state) {
+        BigInt m = applyPrivateKey(c, key);
+        benchmark::DoNotOptimize(m);
+    }
+}
+
+// --- Binary text APIs: the same work without the hex step ---
+void BM_BytesGOST(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    const std::vector<unsigned char> &data = payload(size);
+    std::vector<unsigned char> key = hexStringToBytes(kGostKey);
+    for (auto _ : state) {
+        CipherBytesResult result = encryptBytesGOST(data.data(), size, key);
+        benchmark::DoNotOptimize(result.data.data());
+    }
+    set_throughput(state, size);
+}
+
+// The GOST 28147-89 block function alone, per S-box set.
+void BM_GostBlocks(benchmark::State &state, GostSBoxSet set) {
+    size_t size = static_cast<size_t>(state.range(0)) /
+                  GOST_BLOCK_SIZE_BYTES * GOST_BLOCK_SIZE_BYTES;
+    const std::vector<unsigned char> &data = payload(size);
+    std::vector<unsigned char> key = hexStringToBytes(kGostKey);
+    std::vector<unsigned char> out(size);
+    for (auto _ : state) {
+        gost_ecb_encrypt_blocks(set, key.data(), data.data(), out.data(),
+                                size / GOST_BLOCK_SIZE_BYTES);
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_throughput(state, size);
+}
+
+void BM_BytesPermutation(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    const std::vector<unsigned char> &data = payload(size);
+    for (auto _ : state) {
+        CipherBytesResult result =
+            encryptBytesPermutationCpp(data.data(), size, kPermutationKey);
+        benchmark::DoNotOptimize(result.data.data());
+    }
+    set_throughput(state, size);
+}
+
+// --- Batch APIs: many 64-byte messages per call ---
+void BM_BatchGOST(benchmark::State &state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    const size_t message_size = 64;
+    const std::vector<unsigned char> &input = payload(count * message_size);
+    std::vector<CipherBatchRecord> records(count);
+    for (size_t i = 0; i < count; ++i) {
+        records[i] = {i * message_size, message_size};
+    }
+    for (auto _ : state) {
+        CipherBatchResult result =
+            encryptBatchGOST(input.data(), input.size(), records, kGostKey);
+        benchmark::DoNotOptimize(result.arena.data());
+    }
+    set_throughput(state, input.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(count));
+}
+
+// Same, with message lengths spread over 1..256 bytes so the multi-buffer
+// scheduler has to group them.
+void BM_BatchGOSTMixed(benchmark::State &state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    std::vector<CipherBatchRecord> records(count);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t length = 1 + (i * 37) % 256;
+        records[i] = {offset, length};
+        offset += length;
+    }
+    const std::vector<unsigned char> &input = payload(offset);
+    for (auto _ : state) {
+        CipherBatchResult result =
+            encryptBatchGOST(input.data(), input.size(), records, kGostKey);
+        benchmark::DoNotOptimize(result.arena.data());
+    }
+    set_throughput(state, offset);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(count));
+}
+
+// RSA records are spread over the shared thread pool; each 64-byte message
+// is one private-key-sized block.
+void BM_BatchRSA(benchmark::State &state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    const size_t message_size = 64;
+    const std::vector<unsigned char> &input = payload(count * message_size);
+    std::vector<CipherBatchRecord> records(count);
+    for (size_t i = 0; i < count; ++i) {
+        records[i] = {i * message_size, message_size};
+    }
+    const PublicKey &key = rsa_keys().pubKey;
+    for (auto _ : state) {
+        CipherBatchResult result =
+            encryptBatchRSA(input.data(), input.size(), records, key);
+        benchmark::DoNotOptimize(result.arena.data());
+    }
+    set_throughput(state, input.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(count));
+}
+
+// --- Codecs ---
+void BM_HexEncode(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    const std::vector<unsigned char> &data = payload(size);
+    for (auto _ : state) {
+        std::string hex = bytesToHexString(data);
+        benchmark::DoNotOptimize(hex.data());
+    }
+    set_throughput(state, size);
+    state.counters["encoded_ratio"] = 2.0;
+}
+
+void BM_HexDecode(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string hex = bytesToHexString(payload(size));
+    for (auto _ : state) {
+        std::vector<unsigned char> bytes = hexStringToBytes(hex);
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    set_throughput(state, size);
+    state.counters["encoded_ratio"] = 2.0;
+}
+
+// Base64 counterparts of codec/hex; encoded_ratio is output over input size.
+void BM_TextEncode(benchmark::State &state, CipherTextEncoding encoding) {
+    size_t size = static_cast<size_t>(state.range(0));
+    const std::vector<unsigned char> &data = payload(size);
+    size_t encoded = 0;
+    for (auto _ : state) {
+        std::string text = cipher_text_encode(data, encoding);
+        encoded = text.size();
+        benchmark::DoNotOptimize(text.data());
+    }
+    set_throughput(state, size);
+    state.counters["encoded_ratio"] =
+        static_cast<double>(encoded) / static_cast<double>(size);
+}
+
+void BM_TextDecode(benchmark::State &state, CipherTextEncoding encoding) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string text = cipher_text_encode(payload(size), encoding);
+    for (auto _ : state) {
+        std::vector<unsigned char> bytes = cipher_text_decode(text, encoding);
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    set_throughput(state, size);
+    state.counters["encoded_ratio"] =
+        static_cast<double>(text.size()) / static_cast<double>(size);
+}
+
+void BM_TextGOSTBase64(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string text(payload(size).begin(), payload(size).end());
+    for (auto _ : state) {
+        GostEncryptedTextResult result =
+            encryptTextGOST(text, kGostKey, "", CipherTextEncoding::Base64);
+        benchmark::DoNotOptimize(result.ciphertext_hex.data());
+    }
+    set_throughput(state, size);
+}
+
+const char *direction_name(CipherDirection direction) {
+    return direction == CipherDirection::Encrypt ? "encrypt" : "decrypt";
+}
+
+void apply_sizes(benchmark::internal::Benchmark *bench,
+                 const std::vector<int64_t> &sizes) {
+    for (int64_t size : sizes) {
+        bench->Arg(size);
+    }
+    bench->UseRealTime()->Unit(benchmark::kMicrosecond);
+}
+
+void register_benchmarks() {
+    for (const EngineCase &c : engine_cases()) {
+        std::vector<int64_t> sizes = payload_sizes(c.max_bytes);
+        for (CipherDirection direction :
+             {CipherDirection::Encrypt, CipherDirection::Decrypt}) {
+            for (unsigned int threads : thread_counts()) {
+                std::string suffix = c.name + "/" + direction_name(direction) +
+                                     "/threads:" + std::to_string(threads);
+                apply_sizes(benchmark::RegisterBenchmark(
+                                ("engine_buffer/" + suffix).c_str(),
+                                BM_EngineBuffer, c, direction, threads),
+                            sizes);
+                apply_sizes(benchmark::RegisterBenchmark(
+                                ("file/stdio/" + suffix).c_str(),
+                                BM_EngineFile, c, direction, threads,
+                                CipherIoBackend::Stream),
+                            sizes);
+            }
+            // The overlapped pipeline only serves the single-threaded path.
+            std::string suffix =
+                c.name + "/" + direction_name(direction) + "/threads:1";
+            apply_sizes(benchmark::RegisterBenchmark(
+                            ("file/threaded_io/" + suffix).c_str(),
+                            BM_EngineFile, c, direction, 1u,
+                            CipherIoBackend::Threaded),
+                        sizes);
+            if (cipher_io_uring_available()) {
+                apply_sizes(benchmark::RegisterBenchmark(
+                                ("file/io_uring/" + suffix).c_str(),
+                                BM_EngineFile, c, direction, 1u,
+                                CipherIoBackend::IoUring),
+                            sizes);
+            }
+        }
+    }
+
+    apply_sizes(benchmark::RegisterBenchmark("container/gost/read_at_4k",
+                                             BM_ContainerReadAt),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("container/gost/write_logs",
+                                             BM_ContainerWrite,
+                                             CipherContainerCompression::None),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("container/gost_lz4/write_logs",
+                                             BM_ContainerWrite,
+                                             CipherContainerCompression::Lz4),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("text_hex/gost/encrypt",
+                                             BM_TextGOST),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("text_hex/permutation/encrypt",
+                                             BM_TextPermutation),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("text_hex/rsa/encrypt",
+                                             BM_TextRSA),
+                payload_sizes(kRsaMaxBytes));
+    apply_sizes(benchmark::RegisterBenchmark("text_base64/gost/encrypt",
+                                             BM_TextGOSTBase64),
+                payload_sizes(~static_cast<size_t>(0)));
+    const std::pair<const char *, unsigned int> rsa_private_ops[] = {
+        {"rsa/private_op/3072/no_crt", 0},
+        {"rsa/private_op/3072/crt_2_primes", 2},
+        {"rsa/private_op/3072/crt_3_primes", 3},
+        {"rsa/private_op/3072/crt_4_primes", 4},
+    };
+    for (const auto &[name, prime_count] : rsa_private_ops) {
+        benchmark::RegisterBenchmark(name, BM_RsaPrivateOp, prime_count)
+            ->Unit(benchmark::kMillisecond);
+    }
+    apply_sizes(benchmark::RegisterBenchmark("text_bytes/gost/encrypt",
+                                             BM_BytesGOST),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("text_bytes/permutation/encrypt",
+                                             BM_BytesPermutation),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("gost_block/cryptopro_a/ecb",
+                                             BM_GostBlocks,
+                                             GostSBoxSet::CryptoProA),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("gost_block/tc26_z/ecb",
+                                             BM_GostBlocks, GostSBoxSet::Tc26Z),
+                payload_sizes(~static_cast<size_t>(0)));
+    benchmark::RegisterBenchmark("batch/gost/encrypt/messages", BM_BatchGOST)
+        ->Arg(16)
+        ->Arg(1024)
+        ->Arg(16384)
+        ->UseRealTime()
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("batch/gost/encrypt/mixed_lengths",
+                                 BM_BatchGOSTMixed)
+        ->Arg(1024)
+        ->Arg(16384)
+        ->UseRealTime()
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("batch/rsa/encrypt/messages", BM_BatchRSA)
+        ->Arg(16)
+        ->Arg(256)
+        ->UseRealTime()
+        ->Unit(benchmark::kMicrosecond);
+    apply_sizes(benchmark::RegisterBenchmark("codec/hex/encode", BM_HexEncode),
+                payload_sizes(~static_cast<size_t>(0)));
+    apply_sizes(benchmark::RegisterBenchmark("codec/hex/decode", BM_HexDecode),
+                payload_sizes(~static_cast<size_t>(0)));
+    const std::pair<const char *, CipherTextEncoding> base64_codecs[] = {
+        {"base64", CipherTextEncoding::Base64},
+        {"base64url", CipherTextEncoding::Base64Url},
+    };
+    for (const auto &[name, encoding] : base64_codecs) {
+        apply_sizes(benchmark::RegisterBenchmark(
+                        (std::string("codec/") + name + "/encode").c_str(),
+                        BM_TextEncode, encoding),
+                    payload_sizes(~static_cast<size_t>(0)));
+        apply_sizes(benchmark::RegisterBenchmark(
+                        (std::string("codec/") + name + "/decode").c_str(),
+                        BM_TextDecode, encoding),
+                    payload_sizes(~static_cast<size_t>(0)));
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    register_benchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    const char *instrumentation = std::getenv("RGR_BENCH_INSTRUMENTATION");
+    bool instrument = instrumentation && std::string(instrumentation) == "1";
+    cipher_instrumentation_set_enabled(instrument);
+    benchmark::RunSpecifiedBenchmarks();
+    if (instrument) {
+        std::cerr << cipher_instrumentation_to_json(
+                         cipher_instrumentation_snapshot())
+                  << std::endl;
+    }
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,355 @@
+//
+//  cipher_async.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_async.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../container/cipher_container.hpp"
+
+namespace {
+
+class FileDescriptor {
+  public:
+    explicit FileDescriptor(int fd) : fd_(fd) {}
+    ~FileDescriptor() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+    FileDescriptor(const FileDescriptor &) = delete;
+    FileDescriptor &operator=(const FileDescriptor &) = delete;
+    int get() const { return fd_; }
+
+  private:
+    int fd_;
+};
+
+// Reads until length bytes are in or the file ends; returns bytes read.
+CipherTask<size_t> read_up_to(CipherExecutor &executor, int fd,
+                              unsigned char *buffer, size_t length,
+                              uint64_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        size_t n = co_await executor.read_at(fd, buffer + done, length - done,
+                                             offset + done);
+        if (n == 0) {
+            break;
+        }
+        done += n;
+    }
+    co_return done;
+}
+
+CipherTask<void> write_all(CipherExecutor &executor, int fd,
+                           const unsigned char *buffer, size_t length,
+                           uint64_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        size_t n = co_await executor.write_at(fd, buffer + done, length - done,
+                                              offset + done);
+        if (n == 0) {
+            throw std::runtime_error("Error writing to output file.");
+        }
+        done += n;
+    }
+}
+
+} // namespace
+
+CipherTask<CipherDriverResult>
+run_cipher_file_async(CipherExecutor &executor, CipherEngine &engine,
+                      std::string inputFilePath, std::string outputFilePath,
+                      size_t chunk_size, CipherProgressToken *progress) {
+    co_await executor.schedule();
+    CipherDriverResult result;
+    bool output_created = false;
+    CIPHER_INSTR_CALL(engine.instrumentation_algorithm());
+    try {
+        FileDescriptor input(
+            ::open(inputFilePath.c_str(), O_RDONLY | O_CLOEXEC));
+        if (input.get() < 0) {
+            result.message = "Error opening input file: " + inputFilePath;
+            co_return result;
+        }
+        struct stat info;
+        if (::fstat(input.get(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            result.message = "Input is not a regular file: " + inputFilePath;
+            co_return result;
+        }
+        FileDescriptor output(::open(outputFilePath.c_str(),
+                                     O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                     0644));
+        if (output.get() < 0) {
+            result.message = "Error opening output file: " + outputFilePath;
+            co_return result;
+        }
+        output_created = true;
+        if (progress) {
+            progress->set_total(static_cast<uint64_t>(info.st_size));
+        }
+
+        CipherDriverOptions options;
+        options.chunk_size = chunk_size;
+        options.progress = progress;
+        CipherStreamChunker chunker(engine, options);
+        std::vector<unsigned char> &header = chunker.header();
+        if (!header.empty()) {
+            if (engine.direction() == CipherDirection::Encrypt) {
+                co_await write_all(executor, output.get(), header.data(),
+                                   header.size(), 0);
+                result.bytes_out += header.size();
+            } else {
+                size_t got = co_await read_up_to(executor, input.get(),
+                                                 header.data(), header.size(), 0);
+                if (got != header.size()) {
+                    result.message = "Error reading header from input file "
+                                     "(file too short or read error).";
+                    co_return result;
+                }
+                result.bytes_in += header.size();
+                chunker.read_header();
+            }
+        }
+
+        do {
+            size_t bytes_read = co_await read_up_to(
+                executor, input.get(), chunker.input(), chunker.chunk_size(),
+                result.bytes_in);
+            result.bytes_in += bytes_read;
+            size_t written = chunker.process(bytes_read);
+            co_await write_all(executor, output.get(), chunker.output(),
+                               written, result.bytes_out);
+            result.bytes_out += written;
+        } while (chunker.next());
+        result.success = true;
+    } catch (const CipherCancelledError &e) {
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.message =
+            std::string("C++ Exception in async cipher driver: ") + e.what();
+    }
+
+    if (!result.success && output_created) {
+        cipher_remove_failed_output(outputFilePath);
+    } else if (result.success && progress) {
+        progress->report();
+    }
+    co_return result;
+}
+
+CipherTask<GostEncryptedTextResult>
+encryptTextGOSTAsync(CipherExecutor &executor, std::string plaintext,
+                     std::string key_hex, std::string iv_hex,
+                     CipherTextEncoding encoding) {
+    co_await executor.schedule();
+    co_return encryptTextGOST(plaintext, key_hex, iv_hex, encoding);
+}
+
+CipherTask<GostDecryptedTextResult>
+decryptTextGOSTAsync(CipherExecutor &executor, std::string iv_hex,
+                     std::string ciphertext_hex, std::string key_hex,
+                     CipherTextEncoding encoding) {
+    co_await executor.schedule();
+    co_return decryptTextGOST(iv_hex, ciphertext_hex, key_hex, encoding);
+}
+
+CipherTask<GostFileOperationResult>
+encryptFileGOSTAsync(CipherExecutor &executor, std::string inputFilePath,
+                     std::string outputFilePath, std::string key_hex,
+                     std::string initial_iv_hex,
+                     CipherProgressToken *progress) {
+    co_await executor.schedule();
+    GostFileOperationResult fres;
+    GostCipherEngine engine;
+    try {
+        if (hexStringToBytes(key_hex).size() != GOST_KEY_SIZE_BYTES) {
+            fres.message = "Invalid key length for file encryption.";
+            co_return fres;
+        }
+        engine.init(key_hex, CipherDirection::Encrypt);
+        if (!initial_iv_hex.empty()) {
+            std::vector<unsigned char> iv = hexStringToBytes(initial_iv_hex);
+            if (iv.size() != GOST_IV_SIZE_BYTES) {
+                fres.message = "Invalid IV length for file encryption.";
+                co_return fres;
+            }
+            engine.set_iv(iv);
+        }
+    } catch (const std::exception &e) {
+        fres.message =
+            std::string("C++ Exception during file encryption: ") + e.what();
+        co_return fres;
+    }
+
+    CipherDriverResult dres = co_await run_cipher_file_async(
+        executor, engine, std::move(inputFilePath), std::move(outputFilePath),
+        CIPHER_STREAM_CHUNK_BYTES, progress);
+    fres.used_iv_hex = bytesToHexString(engine.iv());
+    if (!dres.success) {
+        fres.cancelled = dres.cancelled;
+        fres.message = dres.message;
+        co_return fres;
+    }
+    fres.success = true;
+    fres.message = "File encrypted successfully.";
+    co_return fres;
+}
+
+CipherTask<GostFileOperationResult>
+decryptFileGOSTAsync(CipherExecutor &executor, std::string inputFilePath,
+                     std::string outputFilePath, std::string key_hex,
+                     CipherProgressToken *progress) {
+    co_await executor.schedule();
+    if (is_cipher_container(inputFilePath)) {
+        co_return decryptFileGOST(inputFilePath, outputFilePath, key_hex,
+                                  progress);
+    }
+    GostFileOperationResult fres;
+    GostCipherEngine engine;
+    try {
+        if (hexStringToBytes(key_hex).size() != GOST_KEY_SIZE_BYTES) {
+            fres.message = "Invalid key length for file decryption.";
+            co_return fres;
+        }
+        engine.init(key_hex, CipherDirection::Decrypt);
+    } catch (const std::exception &e) {
+        fres.message =
+            std::string("C++ Exception during file decryption: ") + e.what();
+        co_return fres;
+    }
+
+    CipherDriverResult dres = co_await run_cipher_file_async(
+        executor, engine, std::move(inputFilePath), std::move(outputFilePath),
+        CIPHER_STREAM_CHUNK_BYTES, progress);
+    fres.used_iv_hex = bytesToHexString(engine.iv());
+    if (!dres.success) {
+        fres.cancelled = dres.cancelled;
+        fres.message = dres.message;
+        co_return fres;
+    }
+    fres.success = true;
+    fres.message = "File decrypted successfully.";
+    co_return fres;
+}
+
+CipherTask<PermutationTextResultCpp>
+encryptTextPermutationAsync(CipherExecutor &executor, std::string plaintext,
+                            std::string key_str, CipherTextEncoding encoding) {
+    co_await executor.schedule();
+    co_return encryptTextPermutationCpp(plaintext, key_str, encoding);
+}
+
+CipherTask<PermutationTextResultCpp>
+decryptTextPermutationAsync(CipherExecutor &executor,
+                            std::string ciphertext_hex, std::string key_str,
+                            CipherTextEncoding encoding) {
+    co_await executor.schedule();
+    co_return decryptTextPermutationCpp(ciphertext_hex, key_str, encoding);
+}
+
+namespace {
+
+CipherTask<PermutationFileResultCpp>
+run_permutation_file_async(CipherExecutor &executor, std::string inputFilePath,
+                           std::string outputFilePath, std::string key_str,
+                           CipherProgressToken *progress,
+                           CipherDirection direction) {
+    co_await executor.schedule();
+    PermutationFileResultCpp fres;
+    const bool encrypt = direction == CipherDirection::Encrypt;
+    PermutationCipherEngine engine;
+    try {
+        engine.init(key_str, direction);
+    } catch (const std::exception &e) {
+        fres.message = std::string(encrypt ? "C++ Permutation Encrypt File: "
+                                           : "C++ Permutation Decrypt File: ") +
+                       e.what();
+        co_return fres;
+    }
+    CipherDriverResult dres = co_await run_cipher_file_async(
+        executor, engine, std::move(inputFilePath), std::move(outputFilePath),
+        CIPHER_STREAM_CHUNK_BYTES, progress);
+    if (!dres.success) {
+        fres.cancelled = dres.cancelled;
+        fres.message = dres.message;
+        co_return fres;
+    }
+    fres.success = true;
+    fres.message = encrypt
+                       ? "File successfully encrypted with permutation cipher."
+                       : "File successfully decrypted with permutation cipher.";
+    co_return fres;
+}
+
+} // namespace
+
+CipherTask<PermutationFileResultCpp>
+encryptFilePermutationAsync(CipherExecutor &executor, std::string inputFilePath,
+                            std::string outputFilePath, std::string key_str,
+                            CipherProgressToken *progress) {
+    return run_permutation_file_async(executor, std::move(inputFilePath),
+                                      std::move(outputFilePath),
+                                      std::move(key_str), progress,
+                                      CipherDirection::Encrypt);
+}
+
+CipherTask<PermutationFileResultCpp>
+decryptFilePermutationAsync(CipherExecutor &executor, std::string inputFilePath,
+                            std::string outputFilePath, std::string key_str,
+                            CipherProgressToken *progress) {
+    co_await executor.schedule();
+    if (is_cipher_container(inputFilePath)) {
+        co_return decryptFilePermutationCpp(inputFilePath, outputFilePath,
+                                            key_str, progress);
+    }
+    co_return co_await run_permutation_file_async(
+        executor, std::move(inputFilePath), std::move(outputFilePath),
+        std::move(key_str), progress, CipherDirection::Decrypt);
+}
+
+CipherTask<std::vector<BigInt>> encryptTextRSAAsync(CipherExecutor &executor,
+                                                    std::string text,
+                                                    PublicKey key,
+                                                    size_t key_byte_length) {
+    co_await executor.schedule();
+    co_return encryptText(text, key, key_byte_length);
+}
+
+CipherTask<std::string> decryptTextRSAAsync(CipherExecutor &executor,
+                                            std::vector<BigInt> encrypted_data,
+                                            PrivateKey key,
+                                            size_t key_byte_length) {
+    co_await executor.schedule();
+    co_return decryptText(encrypted_data, key, key_byte_length);
+}
+
+CipherTask<bool> encryptFileRSAAsync(CipherExecutor &executor,
+                                     std::string inputFilePath,
+                                     std::string outputFilePath, PublicKey key,
+                                     size_t key_byte_length,
+                                     CipherProgressToken *progress) {
+    co_await executor.schedule();
+    co_return encryptFile(inputFilePath, outputFilePath, key, key_byte_length,
+                          progress);
+}
+
+CipherTask<bool> decryptFileRSAAsync(CipherExecutor &executor,
+                                     std::string inputFilePath,
+                                     std::string outputFilePath, PrivateKey key,
+                                     size_t key_byte_length,
+                                     CipherProgressToken *progress) {
+    co_await executor.schedule();
+    co_return decryptFile(inputFilePath, outputFilePath, key, key_byte_length,
+                          progress);
+}
@@ -0,0 +1,97 @@
+//
+//  cipher_async.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_ASYNC_HPP
+#define CIPHER_ASYNC_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../engine/cipher_engine.hpp"
+#include "../gost/gost.hpp"
+#include "../permutationCipher/permutation_cipher.hpp"
+#include "../rsa/rsa.hpp"
+#include "cipher_executor.hpp"
+#include "cipher_task.hpp"
+
+// Awaitable counterparts of the GOST, permutation and RSA text and file
+// APIs. Results and error messages match the blocking functions; the tasks
+// run on executor, and arguments are taken by value so a task may outlive
+// the caller's variables. progress, when given, must outlive the task.
+
+// Engine file driver whose reads and writes are awaited on the executor's
+// I/O backend instead of blocking a thread; the payload is processed in
+// chunk_size pieces in order, through the same CipherStreamChunker as
+// run_cipher_stream. Regular files only (positional I/O). engine must
+// outlive the task. A failed or cancelled operation removes its output
+// file.
+CipherTask<CipherDriverResult>
+run_cipher_file_async(CipherExecutor &executor, CipherEngine &engine,
+                      std::string inputFilePath, std::string outputFilePath,
+                      size_t chunk_size = CIPHER_STREAM_CHUNK_BYTES,
+                      CipherProgressToken *progress = nullptr);
+
+CipherTask<GostEncryptedTextResult>
+encryptTextGOSTAsync(CipherExecutor &executor, std::string plaintext,
+                     std::string key_hex, std::string iv_hex = "",
+                     CipherTextEncoding encoding = CipherTextEncoding::Hex);
+CipherTask<GostDecryptedTextResult>
+decryptTextGOSTAsync(CipherExecutor &executor, std::string iv_hex,
+                     std::string ciphertext_hex, std::string key_hex,
+                     CipherTextEncoding encoding = CipherTextEncoding::Hex);
+// Compressed containers are not written here; decryption of one falls back
+// to the blocking container reader on a worker.
+CipherTask<GostFileOperationResult>
+encryptFileGOSTAsync(CipherExecutor &executor, std::string inputFilePath,
+                     std::string outputFilePath, std::string key_hex,
+                     std::string initial_iv_hex = "",
+                     CipherProgressToken *progress = nullptr);
+CipherTask<GostFileOperationResult>
+decryptFileGOSTAsync(CipherExecutor &executor, std::string inputFilePath,
+                     std::string outputFilePath, std::string key_hex,
+                     CipherProgressToken *progress = nullptr);
+
+CipherTask<PermutationTextResultCpp> encryptTextPermutationAsync(
+    CipherExecutor &executor, std::string plaintext, std::string key_str,
+    CipherTextEncoding encoding = CipherTextEncoding::Hex);
+CipherTask<PermutationTextResultCpp> decryptTextPermutationAsync(
+    CipherExecutor &executor, std::string ciphertext_hex, std::string key_str,
+    CipherTextEncoding encoding = CipherTextEncoding::Hex);
+CipherTask<PermutationFileResultCpp>
+encryptFilePermutationAsync(CipherExecutor &executor, std::string inputFilePath,
+                            std::string outputFilePath, std::string key_str,
+                            CipherProgressToken *progress = nullptr);
+CipherTask<PermutationFileResultCpp>
+decryptFilePermutationAsync(CipherExecutor &executor, std::string inputFilePath,
+                            std::string outputFilePath, std::string key_str,
+                            CipherProgressToken *progress = nullptr);
+
+// RSA is dominated by modular exponentiation and its file format is the
+// line-oriented hex layout, so these run the blocking functions on a worker;
+// they still keep the work off the caller's thread. decryptTextRSAAsync
+// rethrows what decryptText throws.
+CipherTask<std::vector<BigInt>> encryptTextRSAAsync(CipherExecutor &executor,
+                                                    std::string text,
+                                                    PublicKey key,
+                                                    size_t key_byte_length);
+CipherTask<std::string> decryptTextRSAAsync(CipherExecutor &executor,
+                                            std::vector<BigInt> encrypted_data,
+                                            PrivateKey key,
+                                            size_t key_byte_length);
+CipherTask<bool> encryptFileRSAAsync(CipherExecutor &executor,
+                                     std::string inputFilePath,
+                                     std::string outputFilePath, PublicKey key,
+                                     size_t key_byte_length,
+                                     CipherProgressToken *progress = nullptr);
+CipherTask<bool> decryptFileRSAAsync(CipherExecutor &executor,
+                                     std::string inputFilePath,
+                                     std::string outputFilePath, PrivateKey key,
+                                     size_t key_byte_length,
+                                     CipherProgressToken *progress = nullptr);
+
+#endif // CIPHER_ASYNC_HPP
@@ -0,0 +1,417 @@
+//
+//  cipher_executor.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_executor.hpp"
+#include "../engine/cipher_file_pipeline.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// Backend completing IoRequests; implementations call complete() from any
+// thread once the transfer is done.
+class CipherExecutor::IoService {
+  public:
+    explicit IoService(CipherExecutor *executor) : executor_(executor) {}
+    virtual ~IoService() = default;
+    virtual bool io_uring() const = 0;
+    virtual void submit(IoRequest *request) = 0;
+
+  protected:
+    void complete(IoRequest *request, long result) {
+        executor_->complete_io(request, result);
+    }
+
+  private:
+    CipherExecutor *executor_;
+};
+
+namespace {
+
+long transfer(const CipherExecutor::IoRequest &request) {
+    while (true) {
+        ssize_t n = request.write
+                        ? ::pwrite(request.fd, request.buffer, request.length,
+                                   static_cast<off_t>(request.offset))
+                        : ::pread(request.fd, request.buffer, request.length,
+                                  static_cast<off_t>(request.offset));
+        if (n >= 0) {
+            return static_cast<long>(n);
+        }
+        if (errno != EINTR) {
+            return -errno;
+        }
+    }
+}
+
+// Fallback backend: a few threads doing blocking pread/pwrite.
+class ThreadIoService : public CipherExecutor::IoService {
+  public:
+    ThreadIoService(CipherExecutor *executor, unsigned int threads)
+        : IoService(executor) {
+        for (unsigned int i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~ThreadIoService() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    bool io_uring() const override { return false; }
+
+    void submit(CipherExecutor::IoRequest *request) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(request);
+        }
+        cv_.notify_one();
+    }
+
+  private:
+    // Queued requests are finished even when stopping, so no coroutine is
+    // left suspended on a transfer that never completes.
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            CipherExecutor::IoRequest *request = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            complete(request, transfer(*request));
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<CipherExecutor::IoRequest *> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+#ifdef __linux__
+// io_uring reactor over raw syscalls (no liburing). Submitting threads
+// share the SQ under a mutex; a reaper thread owns the CQ and hands each
+// completion back to the executor. At most cq_entries operations are in
+// flight so the CQ never overflows; the rest wait in a backlog. Short
+// transfers are reported as such; the callers loop.
+class UringIoService : public CipherExecutor::IoService {
+  public:
+    static std::unique_ptr<UringIoService> create(CipherExecutor *executor,
+                                                  unsigned int entries) {
+        // Requests use IORING_OP_READ/WRITE on caller buffers; older rings
+        // would fail every one of them with -EINVAL.
+        if (!cipher_io_uring_read_write_available()) {
+            return nullptr;
+        }
+        std::unique_ptr<UringIoService> io(new UringIoService(executor));
+        if (!io->setup(std::max(entries, 2u))) {
+            return nullptr;
+        }
+        io->reaper_ = std::thread([raw = io.get()] { raw->reap(); });
+        return io;
+    }
+
+    ~UringIoService() override {
+        if (reaper_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                push(IORING_OP_NOP, nullptr);
+            }
+            reaper_.join();
+        }
+        if (sqes_ != MAP_FAILED) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != MAP_FAILED) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+        }
+    }
+
+    bool io_uring() const override { return true; }
+
+    void submit(CipherExecutor::IoRequest *request) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (in_flight_ >= cq_entries_) {
+            backlog_.push_back(request);
+            return;
+        }
+        push(request->write ? IORING_OP_WRITE : IORING_OP_READ, request);
+    }
+
+  private:
+    explicit UringIoService(CipherExecutor *executor) : IoService(executor) {}
+
+    bool setup(unsigned int entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(
+            ::syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd_ < 0) {
+            return false;
+        }
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd_,
+                          IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            return false;
+        }
+        cq_ring_ = single_mmap
+                       ? sq_ring_
+                       : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            return false;
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) {
+            return false;
+        }
+
+        unsigned char *sq = static_cast<unsigned char *>(sq_ring_);
+        unsigned char *cq = static_cast<unsigned char *>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        cq_entries_ = params.cq_entries;
+        return true;
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        while (true) {
+            long ret = ::syscall(__NR_io_uring_enter, ring_fd_, to_submit,
+                                 min_complete, flags, nullptr, 0);
+            if (ret >= 0) {
+                return static_cast<int>(ret);
+            }
+            if (errno == EAGAIN || errno == EBUSY) {
+                std::this_thread::yield();
+            } else if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(),
+                                        "io_uring_enter");
+            }
+        }
+    }
+
+    // Pushes one SQE and submits it; mutex_ held. The kernel consumes the
+    // SQE inside enter(), so the SQ never holds more than one entry.
+    void push(uint8_t opcode, CipherExecutor::IoRequest *request) {
+        io_uring_sqe *sqes = static_cast<io_uring_sqe *>(sqes_);
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & sq_mask_;
+        io_uring_sqe &sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        if (request != nullptr) {
+            sqe.fd = request->fd;
+            sqe.off = request->offset;
+            sqe.addr = reinterpret_cast<uint64_t>(request->buffer);
+            sqe.len = static_cast<uint32_t>(
+                std::min<size_t>(request->length, UINT32_MAX));
+        }
+        sqe.user_data = reinterpret_cast<uint64_t>(request);
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++in_flight_;
+        enter(1, 0, 0);
+    }
+
+    void reap() {
+        bool stop_seen = false;
+        while (true) {
+            unsigned head = *cq_head_;
+            if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+                try {
+                    enter(0, 1, IORING_ENTER_GETEVENTS);
+                } catch (const std::system_error &) {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            unsigned reaped = tail - head;
+            for (; head != tail; ++head) {
+                const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+                auto *request =
+                    reinterpret_cast<CipherExecutor::IoRequest *>(cqe.user_data);
+                if (request == nullptr) {
+                    stop_seen = true;
+                } else {
+                    complete(request, cqe.res);
+                }
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_ -= reaped;
+            while (!backlog_.empty() && in_flight_ < cq_entries_) {
+                CipherExecutor::IoRequest *request = backlog_.front();
+                backlog_.pop_front();
+                push(request->write ? IORING_OP_WRITE : IORING_OP_READ,
+                     request);
+            }
+            // Requests submitted before the stop NOP may still be in flight;
+            // keep reaping until those are done too.
+            if (stop_seen && in_flight_ == 0 && backlog_.empty()) {
+                return;
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::deque<CipherExecutor::IoRequest *> backlog_;
+    unsigned int in_flight_ = 0;
+    unsigned int cq_entries_ = 0;
+    std::thread reaper_;
+
+    int ring_fd_ = -1;
+    void *sq_ring_ = MAP_FAILED;
+    void *cq_ring_ = MAP_FAILED;
+    void *sqes_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+};
+#endif // __linux__
+
+} // namespace
+
+CipherExecutor::CipherExecutor(const CipherExecutorOptions &options) {
+    if (options.threads == 0) {
+        pool_ = &cipher_thread_pool();
+    } else {
+        CipherThreadPoolOptions pool_options;
+        pool_options.threads = options.threads;
+        own_pool_ = std::make_unique<CipherThreadPool>(pool_options);
+        pool_ = own_pool_.get();
+    }
+#ifdef __linux__
+    if (options.use_io_uring) {
+        io_ = UringIoService::create(this, options.io_queue_depth);
+    }
+#endif
+    if (!io_) {
+        io_ = std::make_unique<ThreadIoService>(
+            this, std::max(options.io_threads, 1u));
+    }
+}
+
+CipherExecutor::~CipherExecutor() {
+    wait_idle();
+    io_.reset();
+    own_pool_.reset();
+}
+
+// The counter is bumped first: once the coroutine runs, the executor may
+// already be gone.
+void CipherExecutor::post(std::coroutine_handle<> handle) {
+    pool_->submit([this, handle] {
+        resumed_.fetch_add(1, std::memory_order_relaxed);
+        handle.resume();
+    });
+}
+
+void CipherExecutor::IoAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    request_.handle = handle;
+    executor_->io_submitted_.fetch_add(1, std::memory_order_relaxed);
+    // The coroutine may resume on a worker before submit() returns; nothing
+    // in its frame is touched afterwards.
+    executor_->io_->submit(&request_);
+}
+
+size_t CipherExecutor::IoAwaiter::await_resume() const {
+    if (request_.result < 0) {
+        throw std::system_error(static_cast<int>(-request_.result),
+                                std::generic_category(),
+                                request_.write ? "write" : "read");
+    }
+    return static_cast<size_t>(request_.result);
+}
+
+void CipherExecutor::complete_io(IoRequest *request, long result) {
+    request->result = result;
+    io_completed_.fetch_add(1, std::memory_order_relaxed);
+    post(request->handle);
+}
+
+void CipherExecutor::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [&] { return spawned_running_ == 0; });
+}
+
+void CipherExecutor::spawn_finished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--spawned_running_ == 0) {
+        idle_cv_.notify_all();
+    }
+}
+
+bool CipherExecutor::uses_io_uring() const { return io_->io_uring(); }
+
+CipherExecutorStats CipherExecutor::stats() const {
+    CipherExecutorStats stats;
+    stats.threads = thread_count();
+    stats.io_uring = uses_io_uring();
+    stats.resumed = resumed_.load(std::memory_order_relaxed);
+    stats.io_submitted = io_submitted_.load(std::memory_order_relaxed);
+    stats.io_completed = io_completed_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.spawned_running = spawned_running_;
+    return stats;
+}
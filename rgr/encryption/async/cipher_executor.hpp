@@ -0,0 +1,206 @@
+//
+//  cipher_executor.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_EXECUTOR_HPP
+#define CIPHER_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "../common/cipher_thread_pool.hpp"
+#include "cipher_task.hpp"
+
+struct CipherExecutorOptions {
+    // CPU workers resuming coroutines; 0 runs them on the shared
+    // cipher_thread_pool(), any other count on a private pool of that size.
+    unsigned int threads = 0;
+    // Submission queue size of the io_uring reactor; more operations than
+    // its completion queue holds wait in a backlog.
+    unsigned int io_queue_depth = 256;
+    // Blocking pread/pwrite threads used when io_uring is unavailable or
+    // disabled.
+    unsigned int io_threads = 2;
+    bool use_io_uring = true;
+};
+
+struct CipherExecutorStats {
+    unsigned int threads = 0;
+    bool io_uring = false;
+    uint64_t resumed = 0;      // coroutine resumptions on CPU workers
+    uint64_t io_submitted = 0; // positional reads and writes
+    uint64_t io_completed = 0;
+    uint64_t spawned_running = 0;
+};
+
+// Runs coroutines on a pool of CPU workers and completes their file
+// I/O without blocking those workers: reads and writes go to an io_uring
+// reactor on Linux (one reaper thread hands completions back to the pool)
+// or to a few blocking I/O threads elsewhere. A coroutine suspended on
+// I/O holds no thread, so thousands of file operations can be in flight on
+// a handful of threads.
+class CipherExecutor {
+  public:
+    explicit CipherExecutor(const CipherExecutorOptions &options = {});
+    // Waits for spawned tasks, then stops the reactor and a private pool.
+    ~CipherExecutor();
+    CipherExecutor(const CipherExecutor &) = delete;
+    CipherExecutor &operator=(const CipherExecutor &) = delete;
+
+    // co_await executor.schedule() continues the coroutine on a worker.
+    struct ScheduleAwaiter {
+        CipherExecutor *executor;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            executor->post(handle);
+        }
+        void await_resume() const noexcept {}
+    };
+    ScheduleAwaiter schedule() { return ScheduleAwaiter{this}; }
+    void post(std::coroutine_handle<> handle);
+
+    // One positional pread or pwrite as handed to the I/O backend; result
+    // is the byte count or -errno.
+    struct IoRequest {
+        int fd = -1;
+        bool write = false;
+        unsigned char *buffer = nullptr;
+        size_t length = 0;
+        uint64_t offset = 0;
+        long result = 0;
+        std::coroutine_handle<> handle;
+    };
+
+    // co_await yields the bytes transferred (0 at end of file; may be short)
+    // and throws std::system_error on failure. The coroutine resumes on a
+    // worker.
+    class IoAwaiter {
+      public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        size_t await_resume() const;
+
+      private:
+        friend class CipherExecutor;
+        IoAwaiter(CipherExecutor *executor, const IoRequest &request)
+            : executor_(executor), request_(request) {}
+
+        CipherExecutor *executor_;
+        IoRequest request_;
+    };
+    IoAwaiter read_at(int fd, void *buffer, size_t length, uint64_t offset) {
+        return IoAwaiter(this, {fd, false, static_cast<unsigned char *>(buffer),
+                                length, offset, 0, {}});
+    }
+    IoAwaiter write_at(int fd, const void *buffer, size_t length,
+                       uint64_t offset) {
+        return IoAwaiter(
+            this, {fd, true,
+                   const_cast<unsigned char *>(
+                       static_cast<const unsigned char *>(buffer)),
+                   length, offset, 0, {}});
+    }
+
+    // Starts task on a worker and forgets it; exceptions it lets escape are
+    // dropped. wait_idle() and the destructor wait for spawned tasks.
+    template <typename T> void spawn(CipherTask<T> task);
+    void wait_idle();
+
+    unsigned int thread_count() const { return pool_->thread_count(); }
+    bool uses_io_uring() const;
+    CipherExecutorStats stats() const;
+
+    class IoService;
+
+  private:
+    void complete_io(IoRequest *request, long result);
+    void spawn_finished();
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_cv_;
+    uint64_t spawned_running_ = 0;
+    std::atomic<uint64_t> resumed_{0};
+    std::atomic<uint64_t> io_submitted_{0};
+    std::atomic<uint64_t> io_completed_{0};
+    std::unique_ptr<IoService> io_;
+    std::unique_ptr<CipherThreadPool> own_pool_;
+    CipherThreadPool *pool_ = nullptr;
+};
+
+template <typename T> void CipherExecutor::spawn(CipherTask<T> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++spawned_running_;
+    }
+    [](CipherExecutor &executor,
+       CipherTask<T> body) -> cipher_task_detail::Detached {
+        co_await executor.schedule();
+        try {
+            co_await body;
+        } catch (...) {
+        }
+        executor.spawn_finished();
+    }(*this, std::move(task));
+}
+
+namespace cipher_task_detail {
+
+template <typename T> struct SyncWaitState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::exception_ptr error;
+    std::conditional_t<std::is_void_v<T>, bool, std::optional<T>> value{};
+};
+
+// Captureless on purpose: a lambda's captures die with the closure, before
+// the coroutine finishes on another thread.
+template <typename T>
+Detached run_sync_wait(CipherExecutor &executor, CipherTask<T> body,
+                       SyncWaitState<T> *state) {
+    co_await executor.schedule();
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await body;
+        } else {
+            state->value.emplace(co_await body);
+        }
+    } catch (...) {
+        state->error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->done = true;
+    state->cv.notify_all();
+}
+
+} // namespace cipher_task_detail
+
+// Runs task on executor and blocks the calling thread (which must not be a
+// worker of the executor's pool) until it finishes; rethrows its exception.
+template <typename T>
+T cipher_sync_wait(CipherExecutor &executor, CipherTask<T> task) {
+    cipher_task_detail::SyncWaitState<T> state;
+    cipher_task_detail::run_sync_wait(executor, std::move(task), &state);
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&] { return state.done; });
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*state.value);
+    }
+}
+
+#endif // CIPHER_EXECUTOR_HPP
@@ -0,0 +1,141 @@
+//
+//  cipher_task.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_TASK_HPP
+#define CIPHER_TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+template <typename T = void> class CipherTask;
+
+namespace cipher_task_detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T> struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    CipherTask<T> get_return_object();
+    void return_value(T result) { value.emplace(std::move(result)); }
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <> struct Promise<void> : PromiseBase {
+    CipherTask<void> get_return_object();
+    void return_void() {}
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace cipher_task_detail
+
+// Lazily started coroutine returning T. Awaiting a task runs it until its
+// first suspension point and resumes the awaiting coroutine, through
+// symmetric transfer, on whichever thread the task finishes; exceptions
+// thrown by the task are rethrown from co_await. Start a top-level task with
+// CipherExecutor::spawn or cipher_sync_wait.
+template <typename T> class [[nodiscard]] CipherTask {
+  public:
+    using promise_type = cipher_task_detail::Promise<T>;
+
+    CipherTask(CipherTask &&other) noexcept
+        : handle_(std::exchange(other.handle_, {})) {}
+    CipherTask &operator=(CipherTask &&other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    CipherTask(const CipherTask &) = delete;
+    CipherTask &operator=(const CipherTask &) = delete;
+    ~CipherTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() noexcept { return handle.done(); }
+            std::coroutine_handle<>
+            await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{handle_};
+    }
+
+  private:
+    friend promise_type;
+    explicit CipherTask(std::coroutine_handle<promise_type> handle)
+        : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace cipher_task_detail {
+
+template <typename T> CipherTask<T> Promise<T>::get_return_object() {
+    return CipherTask<T>(
+        std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline CipherTask<void> Promise<void>::get_return_object() {
+    return CipherTask<void>(
+        std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+// Eagerly started, self-destroying coroutine used to run a task from
+// non-coroutine code; its body must not let exceptions escape.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+} // namespace cipher_task_detail
+
+#endif // CIPHER_TASK_HPP
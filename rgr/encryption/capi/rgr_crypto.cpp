@@ -0,0 +1,828 @@
+//
+//  rgr_crypto.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "rgr_crypto.h"
+
+#include "../common/cipher_base64.hpp"
+#include "../common/cipher_random.hpp"
+#include "../common/cipher_thread_pool.hpp"
+#include "../gost/gost.hpp"
+#include "../permutationCipher/permutation_cipher.hpp"
+#include "../rsa/rsa.hpp"
+#include "../rsa/rsa_key_pool.hpp"
+
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+thread_local std::string last_error;
+
+int fail(int status, const std::string &message) {
+    last_error = message;
+    return status;
+}
+
+// Runs body with last_error cleared, turning any escaping exception into a
+// status code.
+template <typename Body> int guarded(Body &&body) {
+    last_error.clear();
+    try {
+        return body();
+    } catch (const std::bad_alloc &) {
+        return fail(RGR_ERR_INTERNAL, "Out of memory.");
+    } catch (const std::exception &e) {
+        return fail(RGR_ERR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(RGR_ERR_INTERNAL, "Unknown C++ exception.");
+    }
+}
+
+// Applies the buffer convention: reports required in *out_length and
+// returns false when out_capacity cannot hold it.
+bool reserve_output(size_t required, size_t out_capacity, size_t *out_length) {
+    if (out_length) {
+        *out_length = required;
+    }
+    return required <= out_capacity;
+}
+
+int buffer_too_small(size_t required) {
+    return fail(RGR_ERR_BUFFER_TOO_SMALL,
+                "Output buffer too small; " + std::to_string(required) +
+                    " bytes required.");
+}
+
+bool valid_span(const void *data, size_t length) {
+    return data != nullptr || length == 0;
+}
+
+// memcpy and friends want a valid pointer even for zero bytes.
+const unsigned char *span_data(const uint8_t *data) {
+    static const unsigned char empty = 0;
+    return data ? data : &empty;
+}
+
+int check_flags(unsigned flags, unsigned allowed) {
+    if ((flags & ~allowed) != 0) {
+        return fail(RGR_ERR_INVALID_ARGUMENT, "Unknown flags.");
+    }
+    return RGR_OK;
+}
+
+bool text_encoding(int encoding, CipherTextEncoding &out) {
+    switch (encoding) {
+    case RGR_TEXT_HEX:
+        out = CipherTextEncoding::Hex;
+        return true;
+    case RGR_TEXT_BASE64:
+        out = CipherTextEncoding::Base64;
+        return true;
+    case RGR_TEXT_BASE64URL:
+        out = CipherTextEncoding::Base64Url;
+        return true;
+    }
+    return false;
+}
+
+// --- GOST ---
+int check_gost_key(const uint8_t *key, size_t key_length) {
+    if (key == nullptr || key_length != GOST_KEY_SIZE_BYTES) {
+        return fail(RGR_ERR_INVALID_KEY,
+                    "Invalid key length. Must be " +
+                        std::to_string(GOST_KEY_SIZE_BYTES) + " bytes.");
+    }
+    return RGR_OK;
+}
+
+int check_gost_iv(const uint8_t *iv, size_t iv_length) {
+    if (iv_length != 0 && (iv == nullptr || iv_length != GOST_IV_SIZE_BYTES)) {
+        return fail(RGR_ERR_INVALID_ARGUMENT,
+                    "Invalid IV length. Must be " +
+                        std::to_string(GOST_IV_SIZE_BYTES) +
+                        " bytes if provided.");
+    }
+    return RGR_OK;
+}
+
+std::string gost_key_hex(const uint8_t *key) {
+    return bytesToHexString(
+        std::vector<unsigned char>(key, key + GOST_KEY_SIZE_BYTES));
+}
+
+void gost_store_iv(const std::string &iv_hex, uint8_t *iv_out) {
+    if (!iv_out) {
+        return;
+    }
+    std::vector<unsigned char> iv =
+        iv_hex.empty() ? std::vector<unsigned char>() : hexStringToBytes(iv_hex);
+    if (iv.size() == GOST_IV_SIZE_BYTES) {
+        std::memcpy(iv_out, iv.data(), GOST_IV_SIZE_BYTES);
+    } else {
+        std::memset(iv_out, 0, GOST_IV_SIZE_BYTES);
+    }
+}
+
+// --- Permutation ---
+std::shared_ptr<const CompiledPermutationKey>
+permutation_key(const char *key, size_t key_length) {
+    if (key == nullptr || key_length == 0) {
+        return nullptr;
+    }
+    return get_compiled_permutation_key_cpp(std::string(key, key_length));
+}
+
+int invalid_permutation_key() {
+    return fail(RGR_ERR_INVALID_KEY, "Invalid permutation key string.");
+}
+
+// --- RSA ---
+BigInt big_endian_to_bigint(const uint8_t *data, size_t length) {
+    BigInt value = 0;
+    if (length > 0) {
+        boost::multiprecision::import_bits(value, data, data + length);
+    }
+    return value;
+}
+
+int rsa_key(const uint8_t *n, size_t n_length, const uint8_t *exponent,
+            size_t exponent_length, BigInt &n_out, BigInt &exponent_out,
+            size_t &key_byte_length) {
+    if (n == nullptr || n_length == 0 || exponent == nullptr ||
+        exponent_length == 0) {
+        return fail(RGR_ERR_INVALID_ARGUMENT,
+                    "RSA key components cannot be empty.");
+    }
+    n_out = big_endian_to_bigint(n, n_length);
+    exponent_out = big_endian_to_bigint(exponent, exponent_length);
+    key_byte_length = getApproximateByteLength(n_out);
+    if (key_byte_length < 3) {
+        return fail(RGR_ERR_INVALID_KEY,
+                    "Key modulus n is too small (<3 bytes).");
+    }
+    return RGR_OK;
+}
+
+void store_big_endian(const BigInt &value, uint8_t *out, size_t width) {
+    std::vector<unsigned char> bytes = bigIntToBytes(value, width);
+    std::memcpy(out, bytes.data(), width);
+}
+
+// Body of the RSA decrypt calls once the key is known; k is the byte length
+// of n.
+int rsa_decrypt_blocks(const PrivateKey &key, size_t k, const uint8_t *in,
+                       size_t in_length, uint8_t *out, size_t out_capacity,
+                       size_t *out_length) {
+    if (!valid_span(in, in_length)) {
+        return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+    }
+    if (in_length % k != 0) {
+        return fail(RGR_ERR_BAD_INPUT, "Ciphertext size is not a multiple "
+                                       "of the RSA block size.");
+    }
+    size_t required = in_length / k * getBlockPayloadLength(k);
+    if (!reserve_output(required, out_capacity, out_length) ||
+        (!out && required > 0)) {
+        return buffer_too_small(required);
+    }
+    CipherBytesResult result = decryptBytesRSA(span_data(in), in_length, key);
+    if (!result.success) {
+        return fail(RGR_ERR_BAD_INPUT, result.error_message);
+    }
+    if (!result.data.empty()) {
+        std::memcpy(out, result.data.data(), result.data.size());
+    }
+    if (out_length) {
+        *out_length = result.data.size();
+    }
+    return static_cast<int>(RGR_OK);
+}
+
+} // namespace
+
+extern "C" {
+
+const char *rgr_status_string(int status) {
+    switch (status) {
+    case RGR_OK:
+        return "Success.";
+    case RGR_ERR_INVALID_ARGUMENT:
+        return "Invalid argument.";
+    case RGR_ERR_INVALID_KEY:
+        return "Invalid key.";
+    case RGR_ERR_BUFFER_TOO_SMALL:
+        return "Output buffer too small.";
+    case RGR_ERR_BAD_INPUT:
+        return "Malformed input.";
+    case RGR_ERR_FILE:
+        return "File operation failed.";
+    case RGR_ERR_INTERNAL:
+        return "Internal error.";
+    }
+    return "Unknown status.";
+}
+
+const char *rgr_last_error(void) { return last_error.c_str(); }
+
+int rgr_random_bytes(uint8_t *out, size_t length) {
+    return guarded([&] {
+        if (!valid_span(out, length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Output buffer is NULL.");
+        }
+        cipher_random_fill(out, length);
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+// --- Thread pool ---
+int rgr_thread_pool_configure(unsigned threads, int affinity) {
+    return guarded([&] {
+        CipherThreadPoolOptions options;
+        options.threads = threads;
+        switch (affinity) {
+        case RGR_AFFINITY_NONE:
+            options.affinity = CipherThreadAffinity::None;
+            break;
+        case RGR_AFFINITY_NODE:
+            options.affinity = CipherThreadAffinity::Node;
+            break;
+        case RGR_AFFINITY_CPU:
+            options.affinity = CipherThreadAffinity::Cpu;
+            break;
+        default:
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Unknown thread affinity.");
+        }
+        if (!cipher_thread_pool_configure(options)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT,
+                        "The thread pool is already running.");
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_thread_pool_get_stats(rgr_thread_pool_stats *stats) {
+    return guarded([&] {
+        if (!stats) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Stats pointer is NULL.");
+        }
+        CipherThreadPoolStats pool = cipher_thread_pool().stats();
+        stats->threads = pool.threads;
+        stats->numa_nodes = pool.numa_nodes;
+        stats->executed = pool.executed;
+        stats->steals = pool.steals;
+        stats->remote_steals = pool.remote_steals;
+        stats->queued = pool.queued;
+        stats->occupancy = pool.occupancy;
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+// --- GOST ---
+int rgr_gost_encrypt(const uint8_t *key, size_t key_length, const uint8_t *iv,
+                     size_t iv_length, const uint8_t *in, size_t in_length,
+                     uint8_t *out, size_t out_capacity, size_t *out_length) {
+    return guarded([&] {
+        if (int status = check_gost_key(key, key_length)) {
+            return status;
+        }
+        if (int status = check_gost_iv(iv, iv_length)) {
+            return status;
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        size_t required = GOST_IV_SIZE_BYTES + gost_padded_length(in_length);
+        if (!reserve_output(required, out_capacity, out_length) || !out) {
+            return buffer_too_small(required);
+        }
+        if (iv_length == 0) {
+            std::vector<unsigned char> random_iv;
+            generateRandomBytes(random_iv, GOST_IV_SIZE_BYTES);
+            std::memcpy(out, random_iv.data(), GOST_IV_SIZE_BYTES);
+        } else {
+            std::memcpy(out, iv, GOST_IV_SIZE_BYTES);
+        }
+        gost_encrypt_to(key, out, span_data(in), in_length,
+                        out + GOST_IV_SIZE_BYTES);
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_gost_decrypt(const uint8_t *key, size_t key_length, const uint8_t *in,
+                     size_t in_length, uint8_t *out, size_t out_capacity,
+                     size_t *out_length) {
+    return guarded([&] {
+        if (int status = check_gost_key(key, key_length)) {
+            return status;
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        if (in_length < GOST_IV_SIZE_BYTES) {
+            return fail(RGR_ERR_BAD_INPUT, "Input is shorter than the GOST IV.");
+        }
+        size_t required = in_length - GOST_IV_SIZE_BYTES;
+        if (!reserve_output(required, out_capacity, out_length) ||
+            (!out && required > 0)) {
+            return buffer_too_small(required);
+        }
+        try {
+            size_t written = gost_decrypt_to(key, in, in + GOST_IV_SIZE_BYTES,
+                                             required, out);
+            if (out_length) {
+                *out_length = written;
+            }
+        } catch (const std::exception &e) {
+            return fail(RGR_ERR_BAD_INPUT, e.what());
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_gost_encrypt_file(const char *input_path, const char *output_path,
+                          const uint8_t *key, size_t key_length,
+                          const uint8_t *iv, size_t iv_length, unsigned flags,
+                          uint8_t *iv_out) {
+    return guarded([&] {
+        if (!input_path || !output_path) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "File paths cannot be NULL.");
+        }
+        if (int status = check_gost_key(key, key_length)) {
+            return status;
+        }
+        if (int status = check_gost_iv(iv, iv_length)) {
+            return status;
+        }
+        if (int status = check_flags(flags, RGR_FILE_COMPRESS)) {
+            return status;
+        }
+        std::string iv_hex;
+        if (iv_length > 0) {
+            iv_hex = bytesToHexString(
+                std::vector<unsigned char>(iv, iv + GOST_IV_SIZE_BYTES));
+        }
+        GostFileOperationResult fres =
+            encryptFileGOST(input_path, output_path, gost_key_hex(key), iv_hex,
+                            nullptr, (flags & RGR_FILE_COMPRESS) != 0);
+        if (!fres.success) {
+            return fail(RGR_ERR_FILE, fres.message);
+        }
+        gost_store_iv(fres.used_iv_hex, iv_out);
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_gost_decrypt_file(const char *input_path, const char *output_path,
+                          const uint8_t *key, size_t key_length,
+                          uint8_t *iv_out) {
+    return guarded([&] {
+        if (!input_path || !output_path) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "File paths cannot be NULL.");
+        }
+        if (int status = check_gost_key(key, key_length)) {
+            return status;
+        }
+        GostFileOperationResult fres = decryptFileGOST(
+            input_path, output_path, gost_key_hex(key), nullptr);
+        if (!fres.success) {
+            return fail(RGR_ERR_FILE, fres.message);
+        }
+        gost_store_iv(fres.used_iv_hex, iv_out);
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+// --- Permutation ---
+int rgr_permutation_encrypt(const char *key, size_t key_length,
+                            const uint8_t *in, size_t in_length, uint8_t *out,
+                            size_t out_capacity, size_t *out_length) {
+    return guarded([&] {
+        std::shared_ptr<const CompiledPermutationKey> compiled =
+            permutation_key(key, key_length);
+        if (!compiled) {
+            return invalid_permutation_key();
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        size_t required =
+            (in_length / compiled->block_size + 1) * compiled->block_size;
+        if (!reserve_output(required, out_capacity, out_length) || !out) {
+            return buffer_too_small(required);
+        }
+        permutation_encrypt_to(*compiled, span_data(in), in_length, out);
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_permutation_decrypt(const char *key, size_t key_length,
+                            const uint8_t *in, size_t in_length, uint8_t *out,
+                            size_t out_capacity, size_t *out_length) {
+    return guarded([&] {
+        std::shared_ptr<const CompiledPermutationKey> compiled =
+            permutation_key(key, key_length);
+        if (!compiled) {
+            return invalid_permutation_key();
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        if (!reserve_output(in_length, out_capacity, out_length) ||
+            (!out && in_length > 0)) {
+            return buffer_too_small(in_length);
+        }
+        try {
+            size_t written = permutation_decrypt_to(*compiled, span_data(in),
+                                                    in_length, out);
+            if (out_length) {
+                *out_length = written;
+            }
+        } catch (const std::exception &e) {
+            return fail(RGR_ERR_BAD_INPUT, e.what());
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_permutation_encrypt_file(const char *input_path,
+                                 const char *output_path, const char *key,
+                                 size_t key_length, unsigned flags) {
+    return guarded([&] {
+        if (!input_path || !output_path) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "File paths cannot be NULL.");
+        }
+        if (!permutation_key(key, key_length)) {
+            return invalid_permutation_key();
+        }
+        if (int status = check_flags(flags, RGR_FILE_COMPRESS)) {
+            return status;
+        }
+        PermutationFileResultCpp fres = encryptFilePermutationCpp(
+            input_path, output_path, std::string(key, key_length), nullptr,
+            (flags & RGR_FILE_COMPRESS) != 0);
+        if (!fres.success) {
+            return fail(RGR_ERR_FILE, fres.message);
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_permutation_decrypt_file(const char *input_path,
+                                 const char *output_path, const char *key,
+                                 size_t key_length) {
+    return guarded([&] {
+        if (!input_path || !output_path) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "File paths cannot be NULL.");
+        }
+        if (!permutation_key(key, key_length)) {
+            return invalid_permutation_key();
+        }
+        PermutationFileResultCpp fres = decryptFilePermutationCpp(
+            input_path, output_path, std::string(key, key_length), nullptr);
+        if (!fres.success) {
+            return fail(RGR_ERR_FILE, fres.message);
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+// --- RSA ---
+int rgr_rsa_generate_key(unsigned bits, uint8_t *n, uint8_t *e, uint8_t *d,
+                         size_t capacity, size_t *key_length) {
+    return guarded([&] {
+        if (!n || !e || !d) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Key buffers cannot be NULL.");
+        }
+        // Checked before taking a key, so a size query does not use up a
+        // pooled one.
+        size_t max_width = (static_cast<size_t>(bits) + 7) / 8;
+        if (max_width > capacity) {
+            if (key_length) {
+                *key_length = max_width;
+            }
+            return buffer_too_small(max_width);
+        }
+        KeyPair keys;
+        try {
+            keys = rsa_key_pool().acquire(bits);
+        } catch (const std::invalid_argument &e) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, e.what());
+        }
+        size_t width = getApproximateByteLength(keys.pubKey.n);
+        if (key_length) {
+            *key_length = width;
+        }
+        store_big_endian(keys.pubKey.n, n, width);
+        store_big_endian(keys.pubKey.e, e, width);
+        store_big_endian(keys.privKey.d, d, width);
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_rsa_generate_key_crt(unsigned bits, unsigned prime_count,
+                             uint8_t *out, size_t capacity,
+                             size_t *key_length) {
+    return guarded([&] {
+        if (prime_count < 2 || prime_count > 4) {
+            return fail(RGR_ERR_INVALID_ARGUMENT,
+                        "RSA prime count must be 2, 3 or 4.");
+        }
+        size_t fields = 3 + 3 * static_cast<size_t>(prime_count);
+        size_t max_width = (static_cast<size_t>(bits) + 7) / 8;
+        if (max_width * fields > capacity) {
+            if (key_length) {
+                *key_length = max_width;
+            }
+            return buffer_too_small(max_width * fields);
+        }
+        if (!out) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Key buffer cannot be NULL.");
+        }
+        KeyPair keys;
+        try {
+            keys = rsa_key_pool().acquire(bits, prime_count);
+        } catch (const std::invalid_argument &e) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, e.what());
+        }
+        size_t width = getApproximateByteLength(keys.pubKey.n);
+        if (key_length) {
+            *key_length = width;
+        }
+        store_big_endian(keys.pubKey.n, out, width);
+        store_big_endian(keys.pubKey.e, out + width, width);
+        store_big_endian(keys.privKey.d, out + 2 * width, width);
+        uint8_t *field = out + 3 * width;
+        for (const RsaPrimeFactor &factor : keys.privKey.primes) {
+            store_big_endian(factor.prime, field, width);
+            store_big_endian(factor.exponent, field + width, width);
+            store_big_endian(factor.coefficient, field + 2 * width, width);
+            field += 3 * width;
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_rsa_key_pool_reserve(unsigned bits, size_t depth) {
+    return guarded([&] {
+        try {
+            rsa_key_pool().reserve(bits, depth);
+        } catch (const std::invalid_argument &e) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, e.what());
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_rsa_key_pool_get_stats(unsigned bits, rgr_rsa_key_pool_stats *stats) {
+    return guarded([&] {
+        if (!stats) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Stats pointer is NULL.");
+        }
+        RsaKeyPoolStats pool = rsa_key_pool().stats(bits);
+        stats->target_depth = pool.target_depth;
+        stats->ready = pool.ready;
+        stats->generating = pool.generating;
+        stats->served_from_pool = pool.served_from_pool;
+        stats->served_synchronously = pool.served_synchronously;
+        stats->generated = pool.generated;
+        stats->average_generation_ms = pool.average_generation_ms;
+        stats->refill_keys_per_second = pool.refill_keys_per_second;
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_rsa_encrypt(const uint8_t *n, size_t n_length, const uint8_t *e,
+                    size_t e_length, const uint8_t *in, size_t in_length,
+                    uint8_t *out, size_t out_capacity, size_t *out_length) {
+    return guarded([&] {
+        PublicKey key;
+        size_t k = 0;
+        if (int status = rsa_key(n, n_length, e, e_length, key.n, key.e, k)) {
+            return status;
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        size_t payload = getBlockPayloadLength(k);
+        size_t required = (in_length + payload - 1) / payload * k;
+        if (!reserve_output(required, out_capacity, out_length) ||
+            (!out && required > 0)) {
+            return buffer_too_small(required);
+        }
+        // Modular exponentiation dominates here, so the bytes API's one
+        // extra copy is not worth a second code path.
+        CipherBytesResult result = encryptBytesRSA(span_data(in), in_length, key);
+        if (!result.success) {
+            return fail(RGR_ERR_INTERNAL, result.error_message);
+        }
+        if (!result.data.empty()) {
+            std::memcpy(out, result.data.data(), result.data.size());
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_rsa_decrypt(const uint8_t *n, size_t n_length, const uint8_t *d,
+                    size_t d_length, const uint8_t *in, size_t in_length,
+                    uint8_t *out, size_t out_capacity, size_t *out_length) {
+    return guarded([&] {
+        PrivateKey key;
+        size_t k = 0;
+        if (int status = rsa_key(n, n_length, d, d_length, key.n, key.d, k)) {
+            return status;
+        }
+        return rsa_decrypt_blocks(key, k, in, in_length, out, out_capacity,
+                                  out_length);
+    });
+}
+
+int rgr_rsa_decrypt_legacy_text(const uint8_t *n, size_t n_length,
+                                const uint8_t *d, size_t d_length,
+                                const uint8_t *in, size_t in_length,
+                                uint8_t *out, size_t out_capacity,
+                                size_t *out_length) {
+    return guarded([&] {
+        PrivateKey key;
+        size_t k = 0;
+        if (int status = rsa_key(n, n_length, d, d_length, key.n, key.d, k)) {
+            return status;
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        if (in_length % k != 0) {
+            return fail(RGR_ERR_BAD_INPUT, "Ciphertext size is not a multiple "
+                                           "of the RSA block size.");
+        }
+        size_t required = in_length / k * (k - 1);
+        if (!reserve_output(required, out_capacity, out_length) ||
+            (!out && required > 0)) {
+            return buffer_too_small(required);
+        }
+        std::vector<BigInt> blocks;
+        for (size_t offset = 0; offset < in_length; offset += k) {
+            blocks.push_back(big_endian_to_bigint(in + offset, k));
+        }
+        std::string text;
+        try {
+            text = decryptTextLegacy(blocks, key, k);
+        } catch (const std::runtime_error &e) {
+            return fail(RGR_ERR_BAD_INPUT, e.what());
+        }
+        if (!text.empty()) {
+            std::memcpy(out, text.data(), text.size());
+        }
+        if (out_length) {
+            *out_length = text.size();
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_rsa_decrypt_crt(const uint8_t *key, size_t key_length,
+                        unsigned prime_count, const uint8_t *in,
+                        size_t in_length, uint8_t *out, size_t out_capacity,
+                        size_t *out_length) {
+    return guarded([&] {
+        if (prime_count < 2 || prime_count > 4) {
+            return fail(RGR_ERR_INVALID_ARGUMENT,
+                        "RSA prime count must be 2, 3 or 4.");
+        }
+        if (key == nullptr || key_length == 0) {
+            return fail(RGR_ERR_INVALID_ARGUMENT,
+                        "RSA key components cannot be empty.");
+        }
+        auto field = [&](size_t index) {
+            return big_endian_to_bigint(key + index * key_length, key_length);
+        };
+        PrivateKey private_key{field(0), field(2), {}};
+        for (unsigned i = 0; i < prime_count; ++i) {
+            private_key.primes.push_back(
+                {field(3 + 3 * i), field(4 + 3 * i), field(5 + 3 * i)});
+        }
+        size_t k = getApproximateByteLength(private_key.n);
+        if (k < 3) {
+            return fail(RGR_ERR_INVALID_KEY,
+                        "Key modulus n is too small (<3 bytes).");
+        }
+        if (!checkPrimeFactors(private_key)) {
+            return fail(RGR_ERR_INVALID_KEY,
+                        "Prime factors do not match n and d.");
+        }
+        return rsa_decrypt_blocks(private_key, k, in, in_length, out,
+                                  out_capacity, out_length);
+    });
+}
+
+int rgr_rsa_encrypt_file(const char *input_path, const char *output_path,
+                         const uint8_t *n, size_t n_length, const uint8_t *e,
+                         size_t e_length, unsigned flags) {
+    return guarded([&] {
+        if (!input_path || !output_path) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "File paths cannot be NULL.");
+        }
+        PublicKey key;
+        size_t k = 0;
+        if (int status = rsa_key(n, n_length, e, e_length, key.n, key.e, k)) {
+            return status;
+        }
+        if (int status = check_flags(flags, RGR_FILE_COMPRESS)) {
+            return status;
+        }
+        if (!encryptFile(input_path, output_path, key, k, nullptr,
+                         (flags & RGR_FILE_COMPRESS) != 0)) {
+            return fail(RGR_ERR_FILE, "RSA file encryption failed.");
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_rsa_decrypt_file(const char *input_path, const char *output_path,
+                         const uint8_t *n, size_t n_length, const uint8_t *d,
+                         size_t d_length) {
+    return guarded([&] {
+        if (!input_path || !output_path) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "File paths cannot be NULL.");
+        }
+        PrivateKey key;
+        size_t k = 0;
+        if (int status = rsa_key(n, n_length, d, d_length, key.n, key.d, k)) {
+            return status;
+        }
+        if (!decryptFile(input_path, output_path, key, k, nullptr)) {
+            return fail(RGR_ERR_FILE, "RSA file decryption failed.");
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+// --- Transport encodings ---
+int rgr_text_encode(int encoding, const uint8_t *in, size_t in_length,
+                    char *out, size_t out_capacity, size_t *out_length) {
+    return guarded([&] {
+        CipherTextEncoding text;
+        if (!text_encoding(encoding, text)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Unknown text encoding.");
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        size_t required =
+            text == CipherTextEncoding::Hex
+                ? in_length * 2
+                : cipher_base64_encoded_length(
+                      in_length, text == CipherTextEncoding::Base64);
+        if (!reserve_output(required, out_capacity, out_length) ||
+            (!out && required > 0)) {
+            return buffer_too_small(required);
+        }
+        std::string encoded = cipher_text_encode(span_data(in), in_length, text);
+        if (!encoded.empty()) {
+            std::memcpy(out, encoded.data(), encoded.size());
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+int rgr_text_decode(int encoding, const char *in, size_t in_length,
+                    uint8_t *out, size_t out_capacity, size_t *out_length) {
+    return guarded([&] {
+        CipherTextEncoding text;
+        if (!text_encoding(encoding, text)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Unknown text encoding.");
+        }
+        if (!valid_span(in, in_length)) {
+            return fail(RGR_ERR_INVALID_ARGUMENT, "Input buffer is NULL.");
+        }
+        size_t required = text == CipherTextEncoding::Hex
+                              ? in_length / 2
+                              : (in_length + 3) / 4 * 3;
+        if (!reserve_output(required, out_capacity, out_length) ||
+            (!out && required > 0)) {
+            return buffer_too_small(required);
+        }
+        std::vector<unsigned char> decoded;
+        try {
+            decoded = cipher_text_decode(
+                in_length > 0 ? std::string(in, in_length) : std::string(),
+                text);
+        } catch (const std::exception &e) {
+            return fail(RGR_ERR_BAD_INPUT, e.what());
+        }
+        if (!decoded.empty()) {
+            std::memcpy(out, decoded.data(), decoded.size());
+        }
+        if (out_length) {
+            *out_length = decoded.size();
+        }
+        return static_cast<int>(RGR_OK);
+    });
+}
+
+} // extern "C"
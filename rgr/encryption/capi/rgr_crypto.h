@@ -0,0 +1,197 @@
+//
+//  rgr_crypto.h
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef RGR_CRYPTO_H
+#define RGR_CRYPTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Plain C interface to the crypto core for the Objective-C wrappers and for
+// services linking rgr_core directly. Every call works on caller-owned
+// buffers and returns an rgr_status code; no call allocates memory the
+// caller has to free, and no C++ exception crosses this boundary.
+//
+// Buffer convention: out/out_capacity is the destination, and *out_length
+// (when out_length is not NULL) receives the bytes written. If out_capacity
+// is too small the call writes nothing, stores the required size in
+// *out_length and returns RGR_ERR_BUFFER_TOO_SMALL, so passing out = NULL
+// with capacity 0 is a size query. For decryption the required size is an
+// upper bound; the actual plaintext may be shorter. Input and output must
+// not overlap. An input pointer may be NULL when its length is 0.
+//
+// All functions are safe to call from several threads at once.
+
+typedef enum rgr_status {
+    RGR_OK = 0,
+    RGR_ERR_INVALID_ARGUMENT = 1, // NULL pointer, bad length or flags
+    RGR_ERR_INVALID_KEY = 2,      // key material rejected by the cipher
+    RGR_ERR_BUFFER_TOO_SMALL = 3, // see the buffer convention above
+    RGR_ERR_BAD_INPUT = 4,        // ciphertext with a bad size or padding
+    RGR_ERR_FILE = 5,             // file operation failed
+    RGR_ERR_INTERNAL = 6,
+} rgr_status;
+
+#define RGR_GOST_KEY_BYTES 32
+#define RGR_GOST_IV_BYTES 8
+
+// Flags for the *_encrypt_file functions.
+#define RGR_FILE_COMPRESS 1u // LZ4 cipher container, see cipher_container.hpp
+
+// Transport encodings for rgr_text_encode/rgr_text_decode.
+#define RGR_TEXT_HEX 0
+#define RGR_TEXT_BASE64 1
+#define RGR_TEXT_BASE64URL 2
+
+// Static description of a status code.
+const char *rgr_status_string(int status);
+// Detail message of the last failed call on this thread ("" after a
+// success); valid until the next rgr_* call on the same thread.
+const char *rgr_last_error(void);
+
+// Fills out with length bytes from the system CSPRNG (arc4random_buf or
+// getrandom), for GOST keys and IVs.
+int rgr_random_bytes(uint8_t *out, size_t length);
+
+// --- Thread pool ---
+// One work-stealing pool runs the parallel parts of every cipher (large
+// files, containers, RSA block runs).
+#define RGR_AFFINITY_NONE 0
+#define RGR_AFFINITY_NODE 1 // keep each worker on one NUMA node (default)
+#define RGR_AFFINITY_CPU 2  // pin each worker to one CPU
+
+// threads 0 means one per core. Takes effect only before the first call
+// that uses the pool and fails with RGR_ERR_INVALID_ARGUMENT afterwards.
+int rgr_thread_pool_configure(unsigned threads, int affinity);
+typedef struct rgr_thread_pool_stats {
+    unsigned threads;
+    unsigned numa_nodes;
+    uint64_t executed;      // tasks run
+    uint64_t steals;        // tasks taken from another worker's queue
+    uint64_t remote_steals; // of those, across NUMA nodes
+    uint64_t queued;
+    double occupancy; // share of worker time spent on tasks
+} rgr_thread_pool_stats;
+int rgr_thread_pool_get_stats(rgr_thread_pool_stats *stats);
+
+// --- GOST ---
+// Output is IV || ciphertext, as encryptBytesGOST. iv may be NULL (iv_length
+// 0) for a random IV.
+int rgr_gost_encrypt(const uint8_t *key, size_t key_length, const uint8_t *iv,
+                     size_t iv_length, const uint8_t *in, size_t in_length,
+                     uint8_t *out, size_t out_capacity, size_t *out_length);
+int rgr_gost_decrypt(const uint8_t *key, size_t key_length, const uint8_t *in,
+                     size_t in_length, uint8_t *out, size_t out_capacity,
+                     size_t *out_length);
+// Paths are NUL-terminated UTF-8. iv_out, when not NULL, receives the
+// RGR_GOST_IV_BYTES IV used (read from the file on decryption); it is
+// zero-filled for compressed containers, whose chunks have their own IVs.
+int rgr_gost_encrypt_file(const char *input_path, const char *output_path,
+                          const uint8_t *key, size_t key_length,
+                          const uint8_t *iv, size_t iv_length, unsigned flags,
+                          uint8_t *iv_out);
+int rgr_gost_decrypt_file(const char *input_path, const char *output_path,
+                          const uint8_t *key, size_t key_length,
+                          uint8_t *iv_out);
+
+// --- Permutation ---
+// The key is the digit string (e.g. "2031"), not NUL-terminated.
+int rgr_permutation_encrypt(const char *key, size_t key_length,
+                            const uint8_t *in, size_t in_length, uint8_t *out,
+                            size_t out_capacity, size_t *out_length);
+int rgr_permutation_decrypt(const char *key, size_t key_length,
+                            const uint8_t *in, size_t in_length, uint8_t *out,
+                            size_t out_capacity, size_t *out_length);
+int rgr_permutation_encrypt_file(const char *input_path,
+                                 const char *output_path, const char *key,
+                                 size_t key_length, unsigned flags);
+int rgr_permutation_decrypt_file(const char *input_path,
+                                 const char *output_path, const char *key,
+                                 size_t key_length);
+
+// --- RSA ---
+// Key components are unsigned big-endian integers; leading zero bytes are
+// allowed. Ciphertext uses the encryptBytesRSA block layout.
+//
+// Writes n, e and d of a new key into three buffers of capacity bytes each,
+// left-padded with zeros to *key_length bytes (the byte length of n).
+// (bits + 7) / 8 bytes are always enough and are the size reported by
+// RGR_ERR_BUFFER_TOO_SMALL. The key comes from the background key pool when
+// one of that size is ready (see rgr_rsa_key_pool_reserve) and is generated
+// on the calling thread otherwise.
+int rgr_rsa_generate_key(unsigned bits, uint8_t *n, uint8_t *e, uint8_t *d,
+                         size_t capacity, size_t *key_length);
+// Like rgr_rsa_generate_key for a key of prime_count (2 to 4) primes, with
+// its CRT values: writes 3 + 3 * prime_count fields of *key_length bytes
+// each into out, namely n, e, d and then, for every prime in order, the
+// prime, its exponent d mod (prime - 1) and its coefficient (the product of
+// the earlier primes)^-1 mod prime, 0 for the first prime. (3 + 3 *
+// prime_count) * ((bits + 7) / 8) bytes are always enough and are the size
+// reported by RGR_ERR_BUFFER_TOO_SMALL.
+int rgr_rsa_generate_key_crt(unsigned bits, unsigned prime_count,
+                             uint8_t *out, size_t capacity,
+                             size_t *key_length);
+// Keeps depth ready key pairs of bits bits, refilled by a low-priority
+// background thread; depth 0 stops refilling that size.
+int rgr_rsa_key_pool_reserve(unsigned bits, size_t depth);
+typedef struct rgr_rsa_key_pool_stats {
+    size_t target_depth;
+    size_t ready;      // pool depth now
+    size_t generating; // keys being generated in the background
+    uint64_t served_from_pool;
+    uint64_t served_synchronously; // requests that found the pool empty
+    uint64_t generated;            // background keys finished
+    double average_generation_ms;
+    double refill_keys_per_second; // per background worker
+} rgr_rsa_key_pool_stats;
+int rgr_rsa_key_pool_get_stats(unsigned bits, rgr_rsa_key_pool_stats *stats);
+int rgr_rsa_encrypt(const uint8_t *n, size_t n_length, const uint8_t *e,
+                    size_t e_length, const uint8_t *in, size_t in_length,
+                    uint8_t *out, size_t out_capacity, size_t *out_length);
+int rgr_rsa_decrypt(const uint8_t *n, size_t n_length, const uint8_t *d,
+                    size_t d_length, const uint8_t *in, size_t in_length,
+                    uint8_t *out, size_t out_capacity, size_t *out_length);
+// Decrypts text ciphertext written before the framed block layout, as
+// decryptTextLegacy does, with every block k bytes wide. For callers whose
+// rgr_rsa_decrypt failed with RGR_ERR_BAD_INPUT on old data; at most
+// (in_length / k) * (k - 1) bytes are written.
+int rgr_rsa_decrypt_legacy_text(const uint8_t *n, size_t n_length,
+                                const uint8_t *d, size_t d_length,
+                                const uint8_t *in, size_t in_length,
+                                uint8_t *out, size_t out_capacity,
+                                size_t *out_length);
+// rgr_rsa_decrypt through CRT, with key in the rgr_rsa_generate_key_crt
+// layout (key_length bytes per field). RGR_ERR_INVALID_KEY when the primes
+// and their CRT values do not match n and d.
+int rgr_rsa_decrypt_crt(const uint8_t *key, size_t key_length,
+                        unsigned prime_count, const uint8_t *in,
+                        size_t in_length, uint8_t *out, size_t out_capacity,
+                        size_t *out_length);
+int rgr_rsa_encrypt_file(const char *input_path, const char *output_path,
+                         const uint8_t *n, size_t n_length, const uint8_t *e,
+                         size_t e_length, unsigned flags);
+int rgr_rsa_decrypt_file(const char *input_path, const char *output_path,
+                         const uint8_t *n, size_t n_length, const uint8_t *d,
+                         size_t d_length);
+
+// --- Transport encodings ---
+// Text output is not NUL-terminated. Hex is lowercase on output and
+// case-insensitive on input.
+int rgr_text_encode(int encoding, const uint8_t *in, size_t in_length,
+                    char *out, size_t out_capacity, size_t *out_length);
+int rgr_text_decode(int encoding, const char *in, size_t in_length,
+                    uint8_t *out, size_t out_capacity, size_t *out_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RGR_CRYPTO_H
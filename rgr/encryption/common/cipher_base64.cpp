@@ -0,0 +1,378 @@
+//
+//  cipher_base64.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_base64.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define B64_HAVE_SSSE3_TARGET 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define B64_HAVE_NEON 1
+#endif
+
+namespace {
+
+const char STANDARD_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char URL_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const unsigned char INVALID = 0xFF;
+
+const char *alphabet_chars(CipherBase64Alphabet alphabet) {
+    return alphabet == CipherBase64Alphabet::Url ? URL_CHARS : STANDARD_CHARS;
+}
+
+struct DecodeTable {
+    unsigned char values[256];
+    explicit DecodeTable(const char *chars) {
+        std::memset(values, INVALID, sizeof(values));
+        for (unsigned char i = 0; i < 64; ++i) {
+            values[static_cast<unsigned char>(chars[i])] = i;
+        }
+    }
+};
+
+const unsigned char *decode_table(CipherBase64Alphabet alphabet) {
+    static const DecodeTable standard(STANDARD_CHARS);
+    static const DecodeTable url(URL_CHARS);
+    return alphabet == CipherBase64Alphabet::Url ? url.values
+                                                 : standard.values;
+}
+
+[[noreturn]] void invalid_base64() {
+    throw std::invalid_argument("Invalid Base64 input.");
+}
+
+#if defined(B64_HAVE_SSSE3_TARGET)
+bool cpu_has_ssse3() {
+    static const bool has = __builtin_cpu_supports("ssse3");
+    return has;
+}
+
+// 12 input bytes -> 16 characters per step (W. Mula's multiply-shift
+// unpacking and pshufb lookup). Reads 16 bytes, so stops 4 bytes early.
+__attribute__((target("ssse3")))
+size_t encode_ssse3(const unsigned char *in, size_t length, char *out,
+                    CipherBase64Alphabet alphabet) {
+    const __m128i shuffle =
+        _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const bool url = alphabet == CipherBase64Alphabet::Url;
+    // Per-class offsets from the 6-bit index to its character.
+    const __m128i shift_lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        static_cast<char>((url ? '-' : '+') - 62),
+        static_cast<char>((url ? '_' : '/') - 63), 'A', 0, 0);
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 16 <= length; i += 12, o += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        v = _mm_shuffle_epi8(v, shuffle);
+        const __m128i t0 = _mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(v, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(t1, t3);
+
+        __m128i cls = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        cls = _mm_or_si128(cls, _mm_and_si128(upper, _mm_set1_epi8(13)));
+        const __m128i chars =
+            _mm_add_epi8(_mm_shuffle_epi8(shift_lut, cls), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o), chars);
+    }
+    return i;
+}
+
+// 16 characters -> 12 bytes per step, validating with nibble lookups. Stops
+// at the first block holding a character outside the alphabet and leaves it
+// to the scalar loop, which reports the error. Writes 16 bytes per step.
+__attribute__((target("ssse3")))
+size_t decode_ssse3(const char *in, size_t length, unsigned char *out,
+                    CipherBase64Alphabet alphabet) {
+    const __m128i lut_lo =
+        _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                      0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi =
+        _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll =
+        _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                       -1, -1, -1, -1);
+    const bool url = alphabet == CipherBase64Alphabet::Url;
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 16 <= length; i += 16, o += 12) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        if (url) {
+            // Map "-_" onto "+/" and reject the standard-only characters.
+            const __m128i standard_only =
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('+')),
+                             _mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+            if (_mm_movemask_epi8(standard_only) != 0) {
+                break;
+            }
+            const __m128i minus = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+            const __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+            v = _mm_add_epi8(v, _mm_and_si128(minus, _mm_set1_epi8('+' - '-')));
+            v = _mm_add_epi8(
+                v, _mm_and_si128(underscore, _mm_set1_epi8('/' - '_')));
+        }
+        const __m128i hi_nibbles =
+            _mm_and_si128(_mm_srli_epi32(v, 4), mask_2f);
+        const __m128i lo_nibbles = _mm_and_si128(v, mask_2f);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                             _mm_setzero_si128())) != 0) {
+            break;
+        }
+        const __m128i eq_2f = _mm_cmpeq_epi8(v, mask_2f);
+        const __m128i roll =
+            _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+        v = _mm_add_epi8(v, roll);
+
+        const __m128i merged =
+            _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        __m128i bytes = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        bytes = _mm_shuffle_epi8(bytes, pack);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o), bytes);
+    }
+    return i;
+}
+#elif defined(B64_HAVE_NEON)
+// 48 input bytes -> 64 characters per step via de-interleaving loads and a
+// 64-entry table lookup.
+size_t encode_neon(const unsigned char *in, size_t length, char *out,
+                   CipherBase64Alphabet alphabet) {
+    const uint8x16x4_t table = vld1q_u8_x4(
+        reinterpret_cast<const uint8_t *>(alphabet_chars(alphabet)));
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 48 <= length; i += 48, o += 64) {
+        uint8x16x3_t src = vld3q_u8(in + i);
+        uint8x16x4_t idx;
+        idx.val[0] = vshrq_n_u8(src.val[0], 2);
+        idx.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(src.val[0], 4),
+                                       vshrq_n_u8(src.val[1], 4)),
+                              mask);
+        idx.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(src.val[1], 2),
+                                       vshrq_n_u8(src.val[2], 6)),
+                              mask);
+        idx.val[3] = vandq_u8(src.val[2], mask);
+        uint8x16x4_t chars;
+        for (int k = 0; k < 4; ++k) {
+            chars.val[k] = vqtbl4q_u8(table, idx.val[k]);
+        }
+        vst4q_u8(reinterpret_cast<uint8_t *>(out + o), chars);
+    }
+    return i;
+}
+
+// 64 characters -> 48 bytes per step through the 128-entry decode table;
+// stops at the first block with an invalid character.
+size_t decode_neon(const char *in, size_t length, unsigned char *out,
+                   CipherBase64Alphabet alphabet) {
+    const unsigned char *values = decode_table(alphabet);
+    const uint8x16x4_t low = vld1q_u8_x4(values);
+    const uint8x16x4_t high = vld1q_u8_x4(values + 64);
+    const uint8x16_t offset = vdupq_n_u8(64);
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 64 <= length; i += 64, o += 48) {
+        uint8x16x4_t src = vld4q_u8(reinterpret_cast<const uint8_t *>(in + i));
+        uint8x16x4_t dec;
+        uint8x16_t bad = vdupq_n_u8(0);
+        for (int k = 0; k < 4; ++k) {
+            uint8x16_t v = src.val[k];
+            uint8x16_t d = vqtbl4q_u8(low, v);
+            d = vqtbx4q_u8(d, high, vsubq_u8(v, offset));
+            bad = vorrq_u8(bad, vorrq_u8(vcgtq_u8(d, vdupq_n_u8(63)),
+                                         vcgeq_u8(v, vdupq_n_u8(128))));
+            dec.val[k] = d;
+        }
+        if (vmaxvq_u8(bad) != 0) {
+            break;
+        }
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(dec.val[0], 2),
+                                vshrq_n_u8(dec.val[1], 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(dec.val[1], 4),
+                                vshrq_n_u8(dec.val[2], 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(dec.val[2], 6), dec.val[3]);
+        vst3q_u8(out + o, bytes);
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+size_t cipher_base64_encoded_length(size_t length, bool pad) {
+    if (pad) {
+        return (length + 2) / 3 * 4;
+    }
+    return length / 3 * 4 + (length % 3 == 0 ? 0 : length % 3 + 1);
+}
+
+std::string cipher_base64_encode(const unsigned char *data, size_t length,
+                                 CipherBase64Alphabet alphabet, bool pad) {
+    std::string out(cipher_base64_encoded_length(length, pad), '\0');
+    const char *chars = alphabet_chars(alphabet);
+    size_t i = 0;
+#if defined(B64_HAVE_SSSE3_TARGET)
+    if (cpu_has_ssse3()) {
+        i = encode_ssse3(data, length, out.data(), alphabet);
+    }
+#elif defined(B64_HAVE_NEON)
+    i = encode_neon(data, length, out.data(), alphabet);
+#endif
+    size_t o = i / 3 * 4;
+    for (; i + 3 <= length; i += 3, o += 4) {
+        uint32_t n = (static_cast<uint32_t>(data[i]) << 16) |
+                     (static_cast<uint32_t>(data[i + 1]) << 8) | data[i + 2];
+        out[o] = chars[n >> 18];
+        out[o + 1] = chars[(n >> 12) & 0x3F];
+        out[o + 2] = chars[(n >> 6) & 0x3F];
+        out[o + 3] = chars[n & 0x3F];
+    }
+    size_t rest = length - i;
+    if (rest > 0) {
+        uint32_t n = static_cast<uint32_t>(data[i]) << 16;
+        if (rest == 2) {
+            n |= static_cast<uint32_t>(data[i + 1]) << 8;
+        }
+        out[o++] = chars[n >> 18];
+        out[o++] = chars[(n >> 12) & 0x3F];
+        if (rest == 2) {
+            out[o++] = chars[(n >> 6) & 0x3F];
+        }
+        if (pad) {
+            while (o < out.size()) {
+                out[o++] = '=';
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<unsigned char> cipher_base64_decode(const char *text,
+                                                size_t length,
+                                                CipherBase64Alphabet alphabet) {
+    if (length % 4 == 0 && length > 0 && text[length - 1] == '=') {
+        length -= text[length - 2] == '=' ? 2 : 1;
+    }
+    if (length % 4 == 1) {
+        invalid_base64();
+    }
+    size_t decoded = length / 4 * 3 + (length % 4 == 0 ? 0 : length % 4 - 1);
+    // The SSSE3 loop stores 16 bytes for every 12 it produces.
+    std::vector<unsigned char> out(decoded + 4);
+    size_t i = 0;
+#if defined(B64_HAVE_SSSE3_TARGET)
+    if (cpu_has_ssse3()) {
+        i = decode_ssse3(text, length, out.data(), alphabet);
+    }
+#elif defined(B64_HAVE_NEON)
+    i = decode_neon(text, length, out.data(), alphabet);
+#endif
+    const unsigned char *values = decode_table(alphabet);
+    size_t o = i / 4 * 3;
+    for (; i + 4 <= length; i += 4, o += 3) {
+        unsigned char a = values[static_cast<unsigned char>(text[i])];
+        unsigned char b = values[static_cast<unsigned char>(text[i + 1])];
+        unsigned char c = values[static_cast<unsigned char>(text[i + 2])];
+        unsigned char d = values[static_cast<unsigned char>(text[i + 3])];
+        if (((a | b | c | d) & 0xC0) != 0) {
+            invalid_base64();
+        }
+        uint32_t n = (static_cast<uint32_t>(a) << 18) |
+                     (static_cast<uint32_t>(b) << 12) |
+                     (static_cast<uint32_t>(c) << 6) | d;
+        out[o] = static_cast<unsigned char>(n >> 16);
+        out[o + 1] = static_cast<unsigned char>(n >> 8);
+        out[o + 2] = static_cast<unsigned char>(n);
+    }
+    size_t rest = length - i;
+    if (rest > 0) {
+        uint32_t n = 0;
+        for (size_t k = 0; k < rest; ++k) {
+            unsigned char v = values[static_cast<unsigned char>(text[i + k])];
+            if (v == INVALID) {
+                invalid_base64();
+            }
+            n |= static_cast<uint32_t>(v) << (18 - 6 * k);
+        }
+        out[o++] = static_cast<unsigned char>(n >> 16);
+        if (rest == 3) {
+            out[o++] = static_cast<unsigned char>(n >> 8);
+        }
+    }
+    out.resize(decoded);
+    return out;
+}
+
+std::vector<unsigned char> cipher_base64_decode(const std::string &text,
+                                                CipherBase64Alphabet alphabet) {
+    return cipher_base64_decode(text.data(), text.size(), alphabet);
+}
+
+std::string cipher_text_encode(const unsigned char *data, size_t length,
+                               CipherTextEncoding encoding) {
+    switch (encoding) {
+    case CipherTextEncoding::Base64:
+        return cipher_base64_encode(data, length,
+                                    CipherBase64Alphabet::Standard, true);
+    case CipherTextEncoding::Base64Url:
+        return cipher_base64_encode(data, length, CipherBase64Alphabet::Url,
+                                    false);
+    case CipherTextEncoding::Hex:
+        break;
+    }
+    static const char digits[] = "0123456789abcdef";
+    std::string out(length * 2, '\0');
+    for (size_t i = 0; i < length; ++i) {
+        out[2 * i] = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 0x0F];
+    }
+    return out;
+}
+
+std::vector<unsigned char> cipher_text_decode(const std::string &text,
+                                              CipherTextEncoding encoding) {
+    switch (encoding) {
+    case CipherTextEncoding::Base64:
+        return cipher_base64_decode(text, CipherBase64Alphabet::Standard);
+    case CipherTextEncoding::Base64Url:
+        return cipher_base64_decode(text, CipherBase64Alphabet::Url);
+    case CipherTextEncoding::Hex:
+        break;
+    }
+    if (text.size() % 2 != 0) {
+        throw std::invalid_argument(
+            "Hex string must have an even number of characters.");
+    }
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        throw std::invalid_argument("Invalid character in hex string.");
+    };
+    std::vector<unsigned char> out(text.size() / 2);
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = static_cast<unsigned char>((nibble(text[2 * i]) << 4) |
+                                            nibble(text[2 * i + 1]));
+    }
+    return out;
+}
@@ -0,0 +1,51 @@
+//
+//  cipher_base64.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_BASE64_HPP
+#define CIPHER_BASE64_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// RFC 4648 Base64 with SSSE3 (x86) and NEON (arm64) fast paths and a scalar
+// fallback. Output is 4/3 of the input instead of hex's 2x.
+enum class CipherBase64Alphabet {
+    Standard, // A-Z a-z 0-9 + /
+    Url,      // A-Z a-z 0-9 - _
+};
+
+size_t cipher_base64_encoded_length(size_t length, bool pad = true);
+std::string cipher_base64_encode(const unsigned char *data, size_t length,
+                                 CipherBase64Alphabet alphabet =
+                                     CipherBase64Alphabet::Standard,
+                                 bool pad = true);
+// Accepts input with or without '=' padding but nothing outside the
+// alphabet (no whitespace); throws std::invalid_argument otherwise.
+std::vector<unsigned char> cipher_base64_decode(const char *text,
+                                                size_t length,
+                                                CipherBase64Alphabet alphabet =
+                                                    CipherBase64Alphabet::Standard);
+std::vector<unsigned char> cipher_base64_decode(const std::string &text,
+                                                CipherBase64Alphabet alphabet =
+                                                    CipherBase64Alphabet::Standard);
+
+// Transport encoding of the text APIs' binary outputs. Hex is lowercase as
+// from bytesToHexString; Base64 is padded, Base64Url is not.
+enum class CipherTextEncoding { Hex, Base64, Base64Url };
+
+std::string cipher_text_encode(const unsigned char *data, size_t length,
+                               CipherTextEncoding encoding);
+inline std::string cipher_text_encode(const std::vector<unsigned char> &data,
+                                      CipherTextEncoding encoding) {
+    return cipher_text_encode(data.data(), data.size(), encoding);
+}
+// Throws std::invalid_argument on malformed input.
+std::vector<unsigned char> cipher_text_decode(const std::string &text,
+                                              CipherTextEncoding encoding);
+
+#endif // CIPHER_BASE64_HPP
@@ -0,0 +1,91 @@
+//
+//  cipher_batch.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_BATCH_HPP
+#define CIPHER_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// One message inside a contiguous batch input buffer.
+struct CipherBatchRecord {
+    size_t offset = 0;
+    size_t length = 0;
+};
+
+enum class CipherBatchStatus : uint8_t {
+    Ok = 0,
+    OutOfRange = 1,   // record does not lie inside the input buffer
+    InvalidInput = 2, // wrong length or format for this cipher
+    CipherError = 3,  // cipher failed, e.g. bad padding on decrypt
+};
+
+// All outputs of a batch call. Record i occupies
+// arena[offsets[i], offsets[i + 1]); failed records are empty.
+struct CipherBatchResult {
+    std::vector<unsigned char> arena;
+    std::vector<size_t> offsets;
+    std::vector<CipherBatchStatus> status;
+    size_t failed_count = 0;
+    bool success = false; // false only when per-batch setup (the key) failed
+    std::string error_message;
+};
+
+inline bool cipher_batch_record_in_range(const CipherBatchRecord &record,
+                                         size_t input_size) {
+    return record.offset <= input_size &&
+           record.length <= input_size - record.offset;
+}
+
+// Sizes offsets/status for count records and reserves the arena.
+inline void cipher_batch_begin(CipherBatchResult &result, size_t count,
+                               size_t arena_reserve) {
+    result.arena.clear();
+    result.arena.reserve(arena_reserve);
+    result.offsets.assign(count + 1, 0);
+    result.status.assign(count, CipherBatchStatus::Ok);
+    result.failed_count = 0;
+}
+
+// Closes record i: everything appended to the arena since offsets[i] belongs
+// to it, unless it failed, in which case that output is dropped.
+inline void cipher_batch_finish_record(CipherBatchResult &result, size_t i,
+                                       CipherBatchStatus status) {
+    if (status != CipherBatchStatus::Ok) {
+        result.arena.resize(result.offsets[i]);
+        ++result.failed_count;
+    }
+    result.status[i] = status;
+    result.offsets[i + 1] = result.arena.size();
+}
+
+// For batches filled out of order: record i was written to
+// arena[slots[i], slots[i] + written[i]) and its status set. Moves the
+// successful outputs together and fills in offsets and failed_count.
+inline void cipher_batch_compact(CipherBatchResult &result,
+                                 const std::vector<size_t> &slots,
+                                 const std::vector<size_t> &written) {
+    size_t end = 0;
+    for (size_t i = 0; i < result.status.size(); ++i) {
+        if (result.status[i] == CipherBatchStatus::Ok) {
+            if (written[i] > 0 && end != slots[i]) {
+                std::memmove(result.arena.data() + end,
+                             result.arena.data() + slots[i], written[i]);
+            }
+            end += written[i];
+        } else {
+            ++result.failed_count;
+        }
+        result.offsets[i + 1] = end;
+    }
+    result.arena.resize(end);
+}
+
+#endif // CIPHER_BATCH_HPP
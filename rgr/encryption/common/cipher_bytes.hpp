@@ -0,0 +1,23 @@
+//
+//  cipher_bytes.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_BYTES_HPP
+#define CIPHER_BYTES_HPP
+
+#include <string>
+#include <vector>
+
+// Result of a binary text API call (encryptBytesGOST and friends). These
+// take and return raw bytes; hex or another transport encoding is left to
+// the caller.
+struct CipherBytesResult {
+    std::vector<unsigned char> data;
+    bool success = false;
+    std::string error_message;
+};
+
+#endif // CIPHER_BYTES_HPP
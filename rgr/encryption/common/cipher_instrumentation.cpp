@@ -0,0 +1,150 @@
+//
+//  cipher_instrumentation.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_instrumentation.hpp"
+#include <sstream>
+
+namespace cipher_instr_detail {
+
+std::atomic<bool> g_enabled{false};
+
+namespace {
+
+struct StageCounters {
+    std::atomic<uint64_t> nanoseconds{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> count{0};
+};
+
+struct AlgorithmCounters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> allocations{0};
+    StageCounters stages[CIPHER_INSTR_STAGE_COUNT];
+};
+
+AlgorithmCounters g_counters[CIPHER_INSTR_ALGORITHM_COUNT];
+
+} // namespace
+
+void record_stage(CipherInstrAlgorithm algorithm, CipherInstrStage stage,
+                  uint64_t nanoseconds, uint64_t bytes) {
+    StageCounters &counters = g_counters[static_cast<size_t>(algorithm)]
+                                  .stages[static_cast<size_t>(stage)];
+    counters.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void record_call(CipherInstrAlgorithm algorithm) {
+    g_counters[static_cast<size_t>(algorithm)].calls.fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+void record_allocation(CipherInstrAlgorithm algorithm, uint64_t count) {
+    g_counters[static_cast<size_t>(algorithm)].allocations.fetch_add(
+        count, std::memory_order_relaxed);
+}
+
+} // namespace cipher_instr_detail
+
+using namespace cipher_instr_detail;
+
+void cipher_instrumentation_set_enabled(bool enabled) {
+    g_enabled.store(enabled && RGR_INSTRUMENTATION, std::memory_order_relaxed);
+}
+
+bool cipher_instrumentation_enabled() { return active(); }
+
+void cipher_instrumentation_reset() {
+    for (AlgorithmCounters &algorithm : g_counters) {
+        algorithm.calls.store(0, std::memory_order_relaxed);
+        algorithm.allocations.store(0, std::memory_order_relaxed);
+        for (StageCounters &stage : algorithm.stages) {
+            stage.nanoseconds.store(0, std::memory_order_relaxed);
+            stage.bytes.store(0, std::memory_order_relaxed);
+            stage.count.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+CipherInstrumentationSnapshot cipher_instrumentation_snapshot() {
+    CipherInstrumentationSnapshot snapshot;
+    snapshot.enabled = active();
+    for (size_t a = 0; a < CIPHER_INSTR_ALGORITHM_COUNT; ++a) {
+        CipherInstrAlgorithmStats &out = snapshot.algorithms[a];
+        out.calls = g_counters[a].calls.load(std::memory_order_relaxed);
+        out.allocations =
+            g_counters[a].allocations.load(std::memory_order_relaxed);
+        for (size_t s = 0; s < CIPHER_INSTR_STAGE_COUNT; ++s) {
+            const StageCounters &in = g_counters[a].stages[s];
+            out.stages[s].nanoseconds =
+                in.nanoseconds.load(std::memory_order_relaxed);
+            out.stages[s].bytes = in.bytes.load(std::memory_order_relaxed);
+            out.stages[s].count = in.count.load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+const char *cipher_instr_algorithm_name(CipherInstrAlgorithm algorithm) {
+    switch (algorithm) {
+    case CipherInstrAlgorithm::Gost:
+        return "gost";
+    case CipherInstrAlgorithm::Rsa:
+        return "rsa";
+    case CipherInstrAlgorithm::Permutation:
+        return "permutation";
+    case CipherInstrAlgorithm::StaticShift:
+        return "static_shift";
+    default:
+        return "other";
+    }
+}
+
+const char *cipher_instr_stage_name(CipherInstrStage stage) {
+    switch (stage) {
+    case CipherInstrStage::Read:
+        return "read";
+    case CipherInstrStage::HexDecode:
+        return "hex_decode";
+    case CipherInstrStage::HexEncode:
+        return "hex_encode";
+    case CipherInstrStage::Padding:
+        return "padding";
+    case CipherInstrStage::Kernel:
+        return "kernel";
+    case CipherInstrStage::Write:
+        return "write";
+    default:
+        return "unknown";
+    }
+}
+
+std::string
+cipher_instrumentation_to_json(const CipherInstrumentationSnapshot &snapshot) {
+    std::ostringstream json;
+    json << "{\"enabled\":" << (snapshot.enabled ? "true" : "false")
+         << ",\"algorithms\":{";
+    for (size_t a = 0; a < CIPHER_INSTR_ALGORITHM_COUNT; ++a) {
+        const CipherInstrAlgorithmStats &stats = snapshot.algorithms[a];
+        json << (a ? "," : "") << "\""
+             << cipher_instr_algorithm_name(static_cast<CipherInstrAlgorithm>(a))
+             << "\":{\"calls\":" << stats.calls
+             << ",\"allocations\":" << stats.allocations << ",\"stages\":{";
+        for (size_t s = 0; s < CIPHER_INSTR_STAGE_COUNT; ++s) {
+            const CipherInstrStageStats &stage = stats.stages[s];
+            json << (s ? "," : "") << "\""
+                 << cipher_instr_stage_name(static_cast<CipherInstrStage>(s))
+                 << "\":{\"ns\":" << stage.nanoseconds
+                 << ",\"bytes\":" << stage.bytes << ",\"count\":" << stage.count
+                 << "}";
+        }
+        json << "}}";
+    }
+    json << "}}";
+    return json.str();
+}
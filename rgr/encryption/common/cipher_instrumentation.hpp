@@ -0,0 +1,156 @@
+//
+//  cipher_instrumentation.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_INSTRUMENTATION_HPP
+#define CIPHER_INSTRUMENTATION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Hot-path timers and counters. Compiled in unless RGR_INSTRUMENTATION is
+// defined to 0, and recording only after cipher_instrumentation_set_enabled
+// (true); while disabled each probe costs one relaxed atomic load.
+#ifndef RGR_INSTRUMENTATION
+#define RGR_INSTRUMENTATION 1
+#endif
+
+enum class CipherInstrAlgorithm : uint8_t {
+    Gost,
+    Rsa,
+    Permutation,
+    StaticShift,
+    Other,
+    Count
+};
+
+enum class CipherInstrStage : uint8_t {
+    Read,
+    HexDecode,
+    HexEncode,
+    Padding, // padding/unpadding, including an engine's finalize()
+    Kernel,
+    Write,
+    Count
+};
+
+const size_t CIPHER_INSTR_ALGORITHM_COUNT =
+    static_cast<size_t>(CipherInstrAlgorithm::Count);
+const size_t CIPHER_INSTR_STAGE_COUNT =
+    static_cast<size_t>(CipherInstrStage::Count);
+
+struct CipherInstrStageStats {
+    uint64_t nanoseconds = 0;
+    uint64_t bytes = 0;
+    uint64_t count = 0;
+};
+
+struct CipherInstrAlgorithmStats {
+    uint64_t calls = 0;
+    uint64_t allocations = 0;
+    CipherInstrStageStats stages[CIPHER_INSTR_STAGE_COUNT];
+};
+
+struct CipherInstrumentationSnapshot {
+    bool enabled = false;
+    CipherInstrAlgorithmStats algorithms[CIPHER_INSTR_ALGORITHM_COUNT];
+};
+
+void cipher_instrumentation_set_enabled(bool enabled);
+bool cipher_instrumentation_enabled();
+void cipher_instrumentation_reset();
+CipherInstrumentationSnapshot cipher_instrumentation_snapshot();
+std::string
+cipher_instrumentation_to_json(const CipherInstrumentationSnapshot &snapshot);
+const char *cipher_instr_algorithm_name(CipherInstrAlgorithm algorithm);
+const char *cipher_instr_stage_name(CipherInstrStage stage);
+
+namespace cipher_instr_detail {
+
+extern std::atomic<bool> g_enabled;
+
+inline bool active() { return g_enabled.load(std::memory_order_relaxed); }
+
+void record_stage(CipherInstrAlgorithm algorithm, CipherInstrStage stage,
+                  uint64_t nanoseconds, uint64_t bytes);
+void record_call(CipherInstrAlgorithm algorithm);
+void record_allocation(CipherInstrAlgorithm algorithm, uint64_t count);
+
+// Times its own lifetime; the byte count may be filled in later via
+// set_bytes() when it is only known after the work.
+class ScopedStage {
+  public:
+    ScopedStage(CipherInstrAlgorithm algorithm, CipherInstrStage stage,
+                uint64_t bytes = 0)
+        : algorithm_(algorithm), stage_(stage), bytes_(bytes),
+          active_(active()) {
+        if (active_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedStage() {
+        if (active_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            record_stage(
+                algorithm_, stage_,
+                static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        elapsed)
+                        .count()),
+                bytes_);
+        }
+    }
+    ScopedStage(const ScopedStage &) = delete;
+    ScopedStage &operator=(const ScopedStage &) = delete;
+    void set_bytes(uint64_t bytes) { bytes_ = bytes; }
+
+  private:
+    CipherInstrAlgorithm algorithm_;
+    CipherInstrStage stage_;
+    uint64_t bytes_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace cipher_instr_detail
+
+#define CIPHER_INSTR_CONCAT_INNER(a, b) a##b
+#define CIPHER_INSTR_CONCAT(a, b) CIPHER_INSTR_CONCAT_INNER(a, b)
+
+#if RGR_INSTRUMENTATION
+// Times the rest of the enclosing scope as one stage of algorithm.
+#define CIPHER_INSTR_SCOPE(algorithm, stage, bytes)                            \
+    cipher_instr_detail::ScopedStage CIPHER_INSTR_CONCAT(cipher_instr_scope_,  \
+                                                         __LINE__)(            \
+        algorithm, stage, bytes)
+// Named variant, for scopes whose byte count is set later.
+#define CIPHER_INSTR_SCOPE_NAMED(name, algorithm, stage)                       \
+    cipher_instr_detail::ScopedStage name(algorithm, stage)
+#define CIPHER_INSTR_SET_BYTES(name, bytes) name.set_bytes(bytes)
+#define CIPHER_INSTR_CALL(algorithm)                                           \
+    do {                                                                       \
+        if (cipher_instr_detail::active())                                     \
+            cipher_instr_detail::record_call(algorithm);                       \
+    } while (0)
+#define CIPHER_INSTR_ALLOC(algorithm, count)                                   \
+    do {                                                                       \
+        if (cipher_instr_detail::active())                                     \
+            cipher_instr_detail::record_allocation(algorithm, count);          \
+    } while (0)
+#else
+// The algorithm is still named so that locals kept only for these macros
+// do not trip -Wunused-variable; the other arguments are not evaluated.
+#define CIPHER_INSTR_SCOPE(algorithm, stage, bytes) ((void)(algorithm))
+#define CIPHER_INSTR_SCOPE_NAMED(name, algorithm, stage) ((void)(algorithm))
+#define CIPHER_INSTR_SET_BYTES(name, bytes) ((void)0)
+#define CIPHER_INSTR_CALL(algorithm) ((void)(algorithm))
+#define CIPHER_INSTR_ALLOC(algorithm, count) ((void)(algorithm))
+#endif
+
+#endif // CIPHER_INSTRUMENTATION_HPP
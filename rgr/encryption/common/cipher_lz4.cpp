@@ -0,0 +1,188 @@
+//
+//  cipher_lz4.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_lz4.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const size_t LZ4_MIN_MATCH = 4;
+// The format requires the last 5 bytes to be literals and the last match to
+// start at least 12 bytes before the end.
+const size_t LZ4_LAST_LITERALS = 5;
+const size_t LZ4_MF_LIMIT = 12;
+const size_t LZ4_MAX_DISTANCE = 65535;
+const int LZ4_HASH_LOG = 12;
+
+inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t lz4_hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+void write_length(std::vector<unsigned char> &out, size_t length) {
+    for (; length >= 255; length -= 255) {
+        out.push_back(255);
+    }
+    out.push_back(static_cast<unsigned char>(length));
+}
+
+void emit_sequence(std::vector<unsigned char> &out, const unsigned char *literals,
+                   size_t literal_length, size_t offset, size_t match_length) {
+    size_t match_code = match_length - LZ4_MIN_MATCH;
+    unsigned char token = static_cast<unsigned char>(
+        (literal_length < 15 ? literal_length : 15) << 4);
+    if (match_length > 0) {
+        token |= static_cast<unsigned char>(match_code < 15 ? match_code : 15);
+    }
+    out.push_back(token);
+    if (literal_length >= 15) {
+        write_length(out, literal_length - 15);
+    }
+    out.insert(out.end(), literals, literals + literal_length);
+    if (match_length == 0) {
+        return; // final literals-only sequence
+    }
+    out.push_back(static_cast<unsigned char>(offset));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+    if (match_code >= 15) {
+        write_length(out, match_code - 15);
+    }
+}
+
+} // namespace
+
+size_t cipher_lz4_compress_bound(size_t length) {
+    return length + length / 255 + 16;
+}
+
+std::vector<unsigned char> cipher_lz4_compress(const unsigned char *data,
+                                               size_t length) {
+    std::vector<unsigned char> out;
+    out.reserve(cipher_lz4_compress_bound(length));
+    size_t anchor = 0;
+    if (length > LZ4_MF_LIMIT) {
+        uint32_t table[1 << LZ4_HASH_LOG] = {};
+        size_t match_limit = length - LZ4_LAST_LITERALS;
+        size_t ip = 1;
+        size_t misses = 0;
+        while (ip < length - LZ4_MF_LIMIT) {
+            uint32_t sequence = read32(data + ip);
+            uint32_t h = lz4_hash(sequence);
+            size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+            if (ref >= ip || ip - ref > LZ4_MAX_DISTANCE ||
+                read32(data + ref) != sequence) {
+                // Skip faster through incompressible data.
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+            while (ip > anchor && ref > 0 && data[ip - 1] == data[ref - 1]) {
+                --ip;
+                --ref;
+            }
+            size_t match_length = LZ4_MIN_MATCH;
+            while (ip + match_length < match_limit &&
+                   data[ref + match_length] == data[ip + match_length]) {
+                ++match_length;
+            }
+            emit_sequence(out, data + anchor, ip - anchor, ip - ref,
+                          match_length);
+            ip += match_length;
+            anchor = ip;
+            if (ip - 2 < length - LZ4_MF_LIMIT) {
+                table[lz4_hash(read32(data + ip - 2))] =
+                    static_cast<uint32_t>(ip - 2);
+            }
+        }
+    }
+    emit_sequence(out, data + anchor, length - anchor, 0, 0);
+    return out;
+}
+
+void cipher_lz4_decompress(const unsigned char *data, size_t length,
+                           unsigned char *output, size_t output_length) {
+    auto malformed = [] {
+        throw std::runtime_error("Malformed LZ4 block.");
+    };
+    size_t ip = 0;
+    size_t op = 0;
+    while (true) {
+        if (ip >= length) {
+            malformed();
+        }
+        unsigned char token = data[ip++];
+        size_t literal_length = token >> 4;
+        if (literal_length == 15) {
+            unsigned char b;
+            do {
+                if (ip >= length) {
+                    malformed();
+                }
+                b = data[ip++];
+                literal_length += b;
+            } while (b == 255);
+        }
+        if (literal_length > length - ip ||
+            literal_length > output_length - op) {
+            malformed();
+        }
+        if (literal_length != 0) {
+            // output may be null when output_length is 0
+            std::memcpy(output + op, data + ip, literal_length);
+        }
+        ip += literal_length;
+        op += literal_length;
+        if (ip == length) {
+            break;
+        }
+
+        if (length - ip < 2) {
+            malformed();
+        }
+        size_t offset = data[ip] | (static_cast<size_t>(data[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            malformed();
+        }
+        size_t match_length = token & 15;
+        if (match_length == 15) {
+            unsigned char b;
+            do {
+                if (ip >= length) {
+                    malformed();
+                }
+                b = data[ip++];
+                match_length += b;
+            } while (b == 255);
+        }
+        match_length += LZ4_MIN_MATCH;
+        if (match_length > output_length - op) {
+            malformed();
+        }
+        const unsigned char *match = output + op - offset;
+        if (offset >= match_length) {
+            std::memcpy(output + op, match, match_length);
+        } else {
+            for (size_t i = 0; i < match_length; ++i) {
+                output[op + i] = match[i]; // overlapping copy
+            }
+        }
+        op += match_length;
+    }
+    if (op != output_length) {
+        malformed();
+    }
+}
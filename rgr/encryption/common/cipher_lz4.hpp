@@ -0,0 +1,25 @@
+//
+//  cipher_lz4.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_LZ4_HPP
+#define CIPHER_LZ4_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Self-contained codec for the LZ4 block format (no frame header), so the
+// output can be read by liblz4's LZ4_decompress_safe and vice versa. Used
+// to compress container chunks before encryption.
+size_t cipher_lz4_compress_bound(size_t length);
+std::vector<unsigned char> cipher_lz4_compress(const unsigned char *data,
+                                               size_t length);
+// Decodes exactly output_length bytes; throws std::runtime_error on a
+// malformed block or a size mismatch.
+void cipher_lz4_decompress(const unsigned char *data, size_t length,
+                           unsigned char *output, size_t output_length);
+
+#endif // CIPHER_LZ4_HPP
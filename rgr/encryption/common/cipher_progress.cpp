@@ -0,0 +1,57 @@
+//
+//  cipher_progress.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_progress.hpp"
+
+CipherProgressToken::CipherProgressToken(Callback callback,
+                                         uint64_t report_interval_bytes)
+    : callback_(std::move(callback)),
+      interval_(report_interval_bytes == 0 ? 1 : report_interval_bytes),
+      start_(std::chrono::steady_clock::now()),
+      next_report_(interval_) {}
+
+void CipherProgressToken::add_bytes(uint64_t bytes) {
+    uint64_t processed =
+        processed_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (!callback_) {
+        return;
+    }
+    uint64_t threshold = next_report_.load(std::memory_order_relaxed);
+    if (processed < threshold) {
+        return;
+    }
+    // Only the thread that moves the threshold forward reports.
+    uint64_t next = processed - processed % interval_ + interval_;
+    if (next_report_.compare_exchange_strong(threshold, next,
+                                             std::memory_order_relaxed)) {
+        report();
+    }
+}
+
+void CipherProgressToken::report() {
+    if (!callback_) {
+        return;
+    }
+    CipherProgress progress = snapshot();
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback_(progress);
+}
+
+CipherProgress CipherProgressToken::snapshot() const {
+    CipherProgress progress;
+    progress.bytes_processed = processed_.load(std::memory_order_relaxed);
+    progress.bytes_total = total_.load(std::memory_order_relaxed);
+    progress.elapsed_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_)
+            .count();
+    if (progress.elapsed_seconds > 0) {
+        progress.bytes_per_second =
+            static_cast<double>(progress.bytes_processed) /
+            progress.elapsed_seconds;
+    }
+    return progress;
+}
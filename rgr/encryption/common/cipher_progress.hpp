@@ -0,0 +1,83 @@
+//
+//  cipher_progress.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_PROGRESS_HPP
+#define CIPHER_PROGRESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+// Callbacks fire at most once per this many processed bytes.
+const uint64_t CIPHER_PROGRESS_DEFAULT_INTERVAL = 4 << 20;
+
+struct CipherProgress {
+    uint64_t bytes_processed = 0;
+    uint64_t bytes_total = 0; // 0 when the size is not known up front
+    double elapsed_seconds = 0;
+    double bytes_per_second = 0;
+};
+
+// Shared between the caller and a running file operation. Drivers report
+// processed bytes after every chunk and stop at the next chunk boundary once
+// cancel() has been called. All members are safe to use from any thread.
+class CipherProgressToken {
+  public:
+    using Callback = std::function<void(const CipherProgress &)>;
+
+    explicit CipherProgressToken(
+        Callback callback = {},
+        uint64_t report_interval_bytes = CIPHER_PROGRESS_DEFAULT_INTERVAL);
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const {
+        return cancelled_.load(std::memory_order_relaxed);
+    }
+
+    void set_total(uint64_t bytes_total) {
+        total_.store(bytes_total, std::memory_order_relaxed);
+    }
+    // Adds to the processed count and runs the callback when another
+    // report interval has been crossed.
+    void add_bytes(uint64_t bytes);
+    // Fires the callback unconditionally, e.g. once the operation finished.
+    void report();
+    CipherProgress snapshot() const;
+
+  private:
+    Callback callback_;
+    uint64_t interval_;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<bool> cancelled_{false};
+    std::atomic<uint64_t> processed_{0};
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> next_report_;
+    std::mutex callback_mutex_;
+};
+
+// Thrown by drivers that notice a cancelled token.
+class CipherCancelledError : public std::runtime_error {
+  public:
+    CipherCancelledError() : std::runtime_error("Operation cancelled.") {}
+};
+
+// Chunk-boundary hook used by the drivers: records progress and throws
+// CipherCancelledError if the operation has been cancelled.
+inline void cipher_progress_step(CipherProgressToken *token, uint64_t bytes) {
+    if (token == nullptr) {
+        return;
+    }
+    if (token->cancelled()) {
+        throw CipherCancelledError();
+    }
+    token->add_bytes(bytes);
+}
+
+#endif // CIPHER_PROGRESS_HPP
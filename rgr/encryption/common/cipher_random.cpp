@@ -0,0 +1,56 @@
+//
+//  cipher_random.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_random.hpp"
+
+#include <cerrno>
+#include <stdexcept>
+
+#if defined(__APPLE__)
+#include <stdlib.h>
+#elif defined(__linux__)
+#include <sys/random.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+void cipher_random_fill(unsigned char *out, size_t length) {
+#if defined(__APPLE__)
+    arc4random_buf(out, length);
+#elif defined(__linux__)
+    while (length > 0) {
+        ssize_t got = getrandom(out, length, 0);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("getrandom failed.");
+        }
+        out += got;
+        length -= static_cast<size_t>(got);
+    }
+#else
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open /dev/urandom.");
+    }
+    while (length > 0) {
+        ssize_t got = read(fd, out, length);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            throw std::runtime_error("Cannot read /dev/urandom.");
+        }
+        out += got;
+        length -= static_cast<size_t>(got);
+    }
+    close(fd);
+#endif
+}
@@ -0,0 +1,19 @@
+//
+//  cipher_random.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_RANDOM_HPP
+#define CIPHER_RANDOM_HPP
+
+#include <cstddef>
+
+// Fills out with length bytes from the operating system CSPRNG:
+// arc4random_buf on Apple platforms, getrandom(2) on Linux and
+// /dev/urandom elsewhere. Throws std::runtime_error when the source fails.
+// Use this, not <random>, for keys, IVs and anything else secret.
+void cipher_random_fill(unsigned char *out, size_t length);
+
+#endif // CIPHER_RANDOM_HPP
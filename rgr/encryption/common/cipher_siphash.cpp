@@ -0,0 +1,107 @@
+//
+//  cipher_siphash.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_siphash.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+inline uint64_t rotl64(uint64_t x, int b) { return (x << b) | (x >> (64 - b)); }
+
+inline uint64_t load_le64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+inline void sip_round(uint64_t &v0, uint64_t &v1, uint64_t &v2, uint64_t &v3) {
+    v0 += v1;
+    v1 = rotl64(v1, 13);
+    v1 ^= v0;
+    v0 = rotl64(v0, 32);
+    v2 += v3;
+    v3 = rotl64(v3, 16);
+    v3 ^= v2;
+    v0 += v3;
+    v3 = rotl64(v3, 21);
+    v3 ^= v0;
+    v2 += v1;
+    v1 = rotl64(v1, 17);
+    v1 ^= v2;
+    v2 = rotl64(v2, 32);
+}
+
+} // namespace
+
+CipherSipHash::CipherSipHash(const unsigned char *key) {
+    uint64_t k0 = load_le64(key);
+    uint64_t k1 = load_le64(key + 8);
+    v0_ = k0 ^ 0x736f6d6570736575ULL;
+    v1_ = k1 ^ 0x646f72616e646f6dULL;
+    v2_ = k0 ^ 0x6c7967656e657261ULL;
+    v3_ = k1 ^ 0x7465646279746573ULL;
+}
+
+void CipherSipHash::compress(uint64_t m) {
+    v3_ ^= m;
+    sip_round(v0_, v1_, v2_, v3_);
+    sip_round(v0_, v1_, v2_, v3_);
+    v0_ ^= m;
+}
+
+void CipherSipHash::update(const unsigned char *data, size_t length) {
+    total_length_ += length;
+    if (pending_length_ > 0) {
+        size_t take = std::min(length, 8 - pending_length_);
+        std::memcpy(pending_ + pending_length_, data, take);
+        pending_length_ += take;
+        data += take;
+        length -= take;
+        if (pending_length_ < 8) {
+            return;
+        }
+        compress(load_le64(pending_));
+        pending_length_ = 0;
+    }
+    for (; length >= 8; data += 8, length -= 8) {
+        compress(load_le64(data));
+    }
+    std::memcpy(pending_, data, length);
+    pending_length_ = length;
+}
+
+void CipherSipHash::update_u64(uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+    update(bytes, sizeof(bytes));
+}
+
+uint64_t CipherSipHash::finish() {
+    uint64_t b = total_length_ << 56;
+    for (size_t i = 0; i < pending_length_; ++i) {
+        b |= static_cast<uint64_t>(pending_[i]) << (8 * i);
+    }
+    compress(b);
+    v2_ ^= 0xff;
+    for (int i = 0; i < 4; ++i) {
+        sip_round(v0_, v1_, v2_, v3_);
+    }
+    return v0_ ^ v1_ ^ v2_ ^ v3_;
+}
+
+uint64_t cipher_siphash24(const unsigned char *key, const unsigned char *data,
+                          size_t length) {
+    CipherSipHash hash(key);
+    hash.update(data, length);
+    return hash.finish();
+}
@@ -0,0 +1,37 @@
+//
+//  cipher_siphash.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_SIPHASH_HPP
+#define CIPHER_SIPHASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+const size_t CIPHER_SIPHASH_KEY_BYTES = 16;
+
+// SipHash-2-4 (64-bit output) keyed with a 16-byte key; used as a short
+// per-chunk MAC. Incremental so a tag can cover non-contiguous fields.
+class CipherSipHash {
+  public:
+    explicit CipherSipHash(const unsigned char *key);
+    void update(const unsigned char *data, size_t length);
+    void update_u64(uint64_t value); // little-endian
+    uint64_t finish();
+
+  private:
+    void compress(uint64_t m);
+
+    uint64_t v0_, v1_, v2_, v3_;
+    unsigned char pending_[8];
+    size_t pending_length_ = 0;
+    uint64_t total_length_ = 0;
+};
+
+uint64_t cipher_siphash24(const unsigned char *key, const unsigned char *data,
+                          size_t length);
+
+#endif // CIPHER_SIPHASH_HPP
@@ -0,0 +1,525 @@
+//
+//  cipher_thread_pool.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_thread_pool.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t PRIORITY_LEVELS = 3;
+
+// CPUs this process may run on and the NUMA node of each.
+struct CpuTopology {
+    std::vector<int> cpus;
+    std::map<int, int> node_of_cpu;
+    // Allowed CPUs grouped by node, nodes in ascending order.
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+};
+
+#ifdef __linux__
+// "0-3,8,10-11" as in /sys/devices/system/node/node*/cpulist.
+std::vector<int> parse_cpu_list(const std::string &text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        size_t dash = part.find('-');
+        try {
+            int first = std::stoi(part.substr(0, dash));
+            int last = dash == std::string::npos ? first
+                                                 : std::stoi(part.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception &) {
+        }
+    }
+    return cpus;
+}
+#endif
+
+CpuTopology load_cpu_topology() {
+    CpuTopology topology;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                topology.cpus.push_back(cpu);
+            }
+        }
+    }
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(
+             "/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+        std::ifstream list(entry.path() / "cpulist");
+        std::string text;
+        std::getline(list, text);
+        for (int cpu : parse_cpu_list(text)) {
+            topology.node_of_cpu[cpu] = std::stoi(name.substr(4));
+        }
+    }
+#endif
+    if (topology.cpus.empty()) {
+        for (unsigned int cpu = 0;
+             cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            topology.cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    std::map<int, std::vector<int>> by_node;
+    for (int cpu : topology.cpus) {
+        auto it = topology.node_of_cpu.find(cpu);
+        by_node[it == topology.node_of_cpu.end() ? 0 : it->second].push_back(cpu);
+    }
+    topology.nodes.assign(by_node.begin(), by_node.end());
+    return topology;
+}
+
+const CpuTopology &cpu_topology() {
+    static const CpuTopology topology = load_cpu_topology();
+    return topology;
+}
+
+#ifdef __linux__
+void set_thread_affinity(const std::vector<int> &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    // Best effort: a failure leaves the worker unbound.
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+#endif
+
+thread_local const CipherThreadPool *current_pool = nullptr;
+thread_local int current_index = -1;
+
+// Shared by the caller and the helpers of one parallel_for. Helpers hold a
+// reference, so one that starts after the loop has returned only finds the
+// indices exhausted and never touches fn.
+struct ParallelForState {
+    const std::function<void(size_t)> *fn = nullptr;
+    size_t count = 0;
+    std::atomic<size_t> next{0};
+    std::atomic<unsigned int> active{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+
+    void run() {
+        ++active;
+        try {
+            for (size_t i = next++; i < count; i = next++) {
+                (*fn)(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = count;
+        }
+        if (--active == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+    }
+
+    // Once the caller has seen the indices exhausted, only helpers already
+    // inside fn can be active.
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return active == 0; });
+    }
+};
+
+const char *affinity_name(CipherThreadAffinity affinity) {
+    switch (affinity) {
+    case CipherThreadAffinity::Node:
+        return "node";
+    case CipherThreadAffinity::Cpu:
+        return "cpu";
+    default:
+        return "none";
+    }
+}
+
+} // namespace
+
+struct CipherThreadPool::Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> queues[PRIORITY_LEVELS];
+    std::vector<int> cpus; // affinity; empty means unbound
+    int cpu = -1;
+    int node = 0;
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> remote_steals{0};
+    std::atomic<uint64_t> busy_ns{0};
+    std::thread thread;
+};
+
+CipherThreadPool::CipherThreadPool(const CipherThreadPoolOptions &options)
+    : options_(options), started_(Clock::now()) {
+    unsigned int threads = options.threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const CpuTopology &topology = cpu_topology();
+    numa_nodes_ = static_cast<unsigned int>(topology.nodes.size());
+    for (unsigned int i = 0; i < threads; ++i) {
+        auto worker = std::make_unique<Worker>();
+        const auto &node = topology.nodes[i % topology.nodes.size()];
+        worker->node = node.first;
+        if (options.affinity == CipherThreadAffinity::Node) {
+            worker->cpus = node.second;
+        } else if (options.affinity == CipherThreadAffinity::Cpu) {
+            worker->cpu =
+                node.second[(i / topology.nodes.size()) % node.second.size()];
+            worker->cpus = {worker->cpu};
+        }
+        workers_.push_back(std::move(worker));
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        std::vector<size_t> near, far;
+        for (size_t step = 1; step < workers_.size(); ++step) {
+            size_t victim = (i + step) % workers_.size();
+            (workers_[victim]->node == workers_[i]->node ? near : far)
+                .push_back(victim);
+        }
+        near.insert(near.end(), far.begin(), far.end());
+        victims_.push_back(std::move(near));
+        node_workers_[workers_[i]->node].push_back(i);
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread([this, i] { worker_loop(i); });
+    }
+}
+
+CipherThreadPool::~CipherThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (const std::unique_ptr<Worker> &worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+int CipherThreadPool::current_worker() const {
+    return current_pool == this ? current_index : -1;
+}
+
+// Round robin over the workers of the caller's node.
+size_t CipherThreadPool::pick_worker() const {
+    size_t n = next_worker_++;
+    if (numa_nodes_ > 1) {
+        auto it = node_workers_.find(cipher_current_numa_node());
+        if (it != node_workers_.end()) {
+            return it->second[n % it->second.size()];
+        }
+    }
+    return n % workers_.size();
+}
+
+void CipherThreadPool::submit(std::function<void()> task,
+                              CipherTaskPriority priority) {
+    int self = current_worker();
+    Worker &worker =
+        *workers_[self >= 0 ? static_cast<size_t>(self) : pick_worker()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[static_cast<size_t>(priority)].push_back(std::move(task));
+        ++queued_;
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    // Pairs with the sleeping_ increment in worker_loop: either the worker
+    // sees queued_ or this sees it asleep.
+    if (sleeping_ > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
+
+// The owner takes its oldest task; a thief takes the newest, which is the
+// one its owner would get to last.
+bool CipherThreadPool::pop_from(Worker &worker, bool steal,
+                                std::function<void()> &task) {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    for (std::deque<std::function<void()>> &queue : worker.queues) {
+        if (queue.empty()) {
+            continue;
+        }
+        if (steal) {
+            task = std::move(queue.back());
+            queue.pop_back();
+        } else {
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        --queued_;
+        return true;
+    }
+    return false;
+}
+
+bool CipherThreadPool::take_task(size_t index, std::function<void()> &task) {
+    Worker &self = *workers_[index];
+    if (pop_from(self, false, task)) {
+        return true;
+    }
+    for (size_t victim : victims_[index]) {
+        Worker &other = *workers_[victim];
+        if (pop_from(other, true, task)) {
+            self.steals.fetch_add(1, std::memory_order_relaxed);
+            if (other.node != self.node) {
+                self.remote_steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Queued tasks are drained before a worker exits.
+void CipherThreadPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = static_cast<int>(index);
+    Worker &self = *workers_[index];
+#ifdef __linux__
+    if (!self.cpus.empty()) {
+        set_thread_affinity(self.cpus);
+    }
+#endif
+    std::function<void()> task;
+    while (true) {
+        if (take_task(index, task)) {
+            Clock::time_point start = Clock::now();
+            try {
+                task();
+            } catch (...) {
+            }
+            task = nullptr;
+            self.busy_ns.fetch_add(
+                static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - start)
+                        .count()),
+                std::memory_order_relaxed);
+            self.executed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        ++sleeping_;
+        sleep_cv_.wait(lock, [&] { return queued_ > 0 || stopping_; });
+        --sleeping_;
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
+
+void CipherThreadPool::parallel_for(size_t count,
+                                    const std::function<void(size_t)> &fn,
+                                    unsigned int max_threads,
+                                    CipherTaskPriority priority) {
+    size_t threads = max_threads == 0 ? workers_.size() + 1 : max_threads;
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+    auto state = std::make_shared<ParallelForState>();
+    state->fn = &fn;
+    state->count = count;
+    for (size_t t = 1; t < threads; ++t) {
+        submit([state] { state->run(); }, priority);
+    }
+    state->run();
+    state->wait();
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+CipherThreadPoolStats CipherThreadPool::stats() const {
+    CipherThreadPoolStats stats;
+    stats.threads = thread_count();
+    stats.numa_nodes = numa_nodes_;
+    stats.affinity = options_.affinity;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.queued = queued_.load();
+    stats.uptime_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             started_)
+            .count());
+    uint64_t busy = 0;
+    for (const std::unique_ptr<Worker> &worker : workers_) {
+        CipherThreadPoolWorkerStats w;
+        w.cpu = worker->cpu;
+        w.node = worker->node;
+        w.executed = worker->executed.load(std::memory_order_relaxed);
+        w.steals = worker->steals.load(std::memory_order_relaxed);
+        w.remote_steals = worker->remote_steals.load(std::memory_order_relaxed);
+        w.busy_ns = worker->busy_ns.load(std::memory_order_relaxed);
+        stats.executed += w.executed;
+        stats.steals += w.steals;
+        stats.remote_steals += w.remote_steals;
+        busy += w.busy_ns;
+        stats.workers.push_back(w);
+    }
+    if (stats.uptime_ns > 0 && stats.threads > 0) {
+        stats.occupancy = static_cast<double>(busy) /
+                          (static_cast<double>(stats.uptime_ns) * stats.threads);
+    }
+    return stats;
+}
+
+namespace {
+
+std::mutex shared_pool_mutex;
+CipherThreadPoolOptions shared_pool_options;
+CipherThreadPool *shared_pool = nullptr;
+
+} // namespace
+
+CipherThreadPool &cipher_thread_pool() {
+    std::lock_guard<std::mutex> lock(shared_pool_mutex);
+    if (!shared_pool) {
+        shared_pool = new CipherThreadPool(shared_pool_options);
+    }
+    return *shared_pool;
+}
+
+bool cipher_thread_pool_configure(const CipherThreadPoolOptions &options) {
+    std::lock_guard<std::mutex> lock(shared_pool_mutex);
+    if (shared_pool) {
+        return false;
+    }
+    shared_pool_options = options;
+    return true;
+}
+
+std::string cipher_thread_pool_stats_to_json(const CipherThreadPoolStats &stats) {
+    std::ostringstream json;
+    json << "{\"threads\":" << stats.threads
+         << ",\"numa_nodes\":" << stats.numa_nodes << ",\"affinity\":\""
+         << affinity_name(stats.affinity) << "\""
+         << ",\"submitted\":" << stats.submitted
+         << ",\"executed\":" << stats.executed << ",\"steals\":" << stats.steals
+         << ",\"remote_steals\":" << stats.remote_steals
+         << ",\"queued\":" << stats.queued
+         << ",\"uptime_ms\":" << stats.uptime_ns / 1000000
+         << ",\"occupancy\":" << stats.occupancy << ",\"workers\":[";
+    for (size_t i = 0; i < stats.workers.size(); ++i) {
+        const CipherThreadPoolWorkerStats &w = stats.workers[i];
+        json << (i ? "," : "") << "{\"cpu\":" << w.cpu << ",\"node\":" << w.node
+             << ",\"executed\":" << w.executed << ",\"steals\":" << w.steals
+             << ",\"remote_steals\":" << w.remote_steals
+             << ",\"busy_ms\":" << w.busy_ns / 1000000 << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+int cipher_current_numa_node() {
+#ifdef __linux__
+    int cpu = sched_getcpu();
+    const CpuTopology &topology = cpu_topology();
+    auto it = topology.node_of_cpu.find(cpu);
+    if (it != topology.node_of_cpu.end()) {
+        return it->second;
+    }
+#endif
+    return 0;
+}
+
+// --- CipherLocalBuffer ---
+CipherLocalBuffer::CipherLocalBuffer(size_t size) : size_(size) {
+    if (size == 0) {
+        return;
+    }
+#ifdef __linux__
+    if (cpu_topology().nodes.size() > 1) {
+        void *pages = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pages != MAP_FAILED) {
+            const unsigned long bits = 8 * sizeof(unsigned long);
+            unsigned long node = static_cast<unsigned long>(
+                cipher_current_numa_node());
+            std::vector<unsigned long> mask(node / bits + 1, 0);
+            mask[node / bits] |= 1ul << (node % bits);
+            // On failure the pages keep the default first-touch policy,
+            // which also places them here when this thread writes first.
+            syscall(SYS_mbind, pages, size, MPOL_PREFERRED, mask.data(),
+                    mask.size() * bits + 1, 0);
+            data_ = static_cast<unsigned char *>(pages);
+            mapped_ = true;
+            return;
+        }
+    }
+#endif
+    data_ = new unsigned char[size];
+}
+
+CipherLocalBuffer::~CipherLocalBuffer() { release(); }
+
+CipherLocalBuffer::CipherLocalBuffer(CipherLocalBuffer &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapped_(std::exchange(other.mapped_, false)) {}
+
+CipherLocalBuffer &
+CipherLocalBuffer::operator=(CipherLocalBuffer &&other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mapped_ = std::exchange(other.mapped_, false);
+    }
+    return *this;
+}
+
+void CipherLocalBuffer::release() {
+#ifdef __linux__
+    if (mapped_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        return;
+    }
+#endif
+    delete[] data_;
+    data_ = nullptr;
+}
@@ -0,0 +1,163 @@
+//
+//  cipher_thread_pool.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_THREAD_POOL_HPP
+#define CIPHER_THREAD_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Tasks of a higher priority are taken first, by their own worker and by
+// thieves alike; within one priority a worker runs its tasks in order.
+enum class CipherTaskPriority : uint8_t { High = 0, Normal = 1, Low = 2 };
+
+// Where workers may run. Node keeps each worker on the CPUs of one NUMA
+// node (workers are spread over the nodes round robin) and lets the kernel
+// balance inside it; Cpu pins every worker to a single CPU. Both only
+// affect Linux and respect the process affinity mask.
+enum class CipherThreadAffinity { None, Node, Cpu };
+
+struct CipherThreadPoolOptions {
+    // Workers; 0 means std::thread::hardware_concurrency().
+    unsigned int threads = 0;
+    CipherThreadAffinity affinity = CipherThreadAffinity::Node;
+};
+
+struct CipherThreadPoolWorkerStats {
+    int cpu = -1; // pinned CPU, -1 unless the affinity is Cpu
+    int node = 0;
+    uint64_t executed = 0;
+    uint64_t steals = 0;        // tasks taken from another worker's queue
+    uint64_t remote_steals = 0; // of those, from a worker on another node
+    uint64_t busy_ns = 0;
+};
+
+// occupancy is the share of worker time spent running tasks since the pool
+// started: total busy time / (threads * uptime).
+struct CipherThreadPoolStats {
+    unsigned int threads = 0;
+    unsigned int numa_nodes = 1;
+    CipherThreadAffinity affinity = CipherThreadAffinity::None;
+    uint64_t submitted = 0;
+    uint64_t executed = 0;
+    uint64_t steals = 0;
+    uint64_t remote_steals = 0;
+    uint64_t queued = 0;
+    uint64_t uptime_ns = 0;
+    double occupancy = 0.0;
+    std::vector<CipherThreadPoolWorkerStats> workers;
+};
+
+// Work-stealing pool shared by every parallel cipher path. Each worker owns
+// one queue per priority; a task submitted from a worker stays on that
+// worker's queue, other tasks go to a worker on the submitting thread's
+// NUMA node. An idle worker steals from the workers of its own node before
+// it looks at other nodes, so data prepared on a node tends to be processed
+// there.
+class CipherThreadPool {
+  public:
+    explicit CipherThreadPool(const CipherThreadPoolOptions &options = {});
+    // Runs the tasks still queued, then joins the workers.
+    ~CipherThreadPool();
+    CipherThreadPool(const CipherThreadPool &) = delete;
+    CipherThreadPool &operator=(const CipherThreadPool &) = delete;
+
+    // Exceptions a task lets escape are dropped.
+    void submit(std::function<void()> task,
+                CipherTaskPriority priority = CipherTaskPriority::Normal);
+
+    // Runs fn(i) for every i in [0, count) on up to max_threads threads (0
+    // means every worker plus the caller) and returns when all calls have
+    // finished. The calling thread takes part, so a pool task may call this
+    // without waiting on itself. After a call throws, the indices not yet
+    // started are skipped and the first exception is rethrown.
+    void parallel_for(size_t count, const std::function<void(size_t)> &fn,
+                      unsigned int max_threads = 0,
+                      CipherTaskPriority priority = CipherTaskPriority::Normal);
+
+    unsigned int thread_count() const {
+        return static_cast<unsigned int>(workers_.size());
+    }
+    unsigned int numa_nodes() const { return numa_nodes_; }
+    // Index of the calling thread among this pool's workers, or -1.
+    int current_worker() const;
+    CipherThreadPoolStats stats() const;
+
+  private:
+    struct Worker;
+    using Clock = std::chrono::steady_clock;
+
+    void worker_loop(size_t index);
+    bool take_task(size_t index, std::function<void()> &task);
+    bool pop_from(Worker &worker, bool steal, std::function<void()> &task);
+    size_t pick_worker() const;
+
+    CipherThreadPoolOptions options_;
+    unsigned int numa_nodes_ = 1;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    // Per worker, the other workers in steal order: same node first.
+    std::vector<std::vector<size_t>> victims_;
+    std::map<int, std::vector<size_t>> node_workers_;
+    Clock::time_point started_;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    std::atomic<uint64_t> queued_{0};
+    std::atomic<unsigned int> sleeping_{0};
+    std::atomic<uint64_t> submitted_{0};
+    mutable std::atomic<size_t> next_worker_{0};
+    bool stopping_ = false;
+};
+
+// Process-wide pool behind the engine drivers, file batches, cipher
+// containers, the RSA block loops and the coroutine executor. Created on
+// first use and never destroyed, so process exit does not wait for queued
+// work.
+CipherThreadPool &cipher_thread_pool();
+// Options for the process-wide pool; false (and ignored) once it exists.
+bool cipher_thread_pool_configure(const CipherThreadPoolOptions &options);
+
+std::string cipher_thread_pool_stats_to_json(const CipherThreadPoolStats &stats);
+
+// NUMA node of the calling thread's current CPU; 0 when unknown.
+int cipher_current_numa_node();
+
+// Fixed-size scratch buffer whose pages come from the NUMA node of the
+// thread that creates it. On multi-node Linux systems the pages are bound
+// there with mbind(MPOL_PREFERRED); elsewhere it is an ordinary heap block.
+// Contents start uninitialised.
+class CipherLocalBuffer {
+  public:
+    CipherLocalBuffer() = default;
+    explicit CipherLocalBuffer(size_t size);
+    ~CipherLocalBuffer();
+    CipherLocalBuffer(CipherLocalBuffer &&other) noexcept;
+    CipherLocalBuffer &operator=(CipherLocalBuffer &&other) noexcept;
+    CipherLocalBuffer(const CipherLocalBuffer &) = delete;
+    CipherLocalBuffer &operator=(const CipherLocalBuffer &) = delete;
+
+    unsigned char *data() { return data_; }
+    const unsigned char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+  private:
+    void release();
+
+    unsigned char *data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+};
+
+#endif // CIPHER_THREAD_POOL_HPP
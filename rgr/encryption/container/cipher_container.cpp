@@ -0,0 +1,558 @@
+//
+//  cipher_container.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_container.hpp"
+#include "../common/cipher_lz4.hpp"
+#include "../common/cipher_siphash.hpp"
+#include "../common/cipher_thread_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const unsigned char CONTAINER_MAGIC[4] = {'R', 'G', 'R', 'C'};
+const unsigned char INDEX_MAGIC[4] = {'R', 'G', 'R', 'I'};
+const unsigned char CHUNK_STORED = 1;
+const unsigned char CHUNK_LZ4 = 2;
+
+void put_le(std::vector<unsigned char> &out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+uint64_t get_le(const unsigned char *in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i-- > 0;) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+uint64_t chunk_tag(const std::vector<unsigned char> &mac_key, uint64_t chunk,
+                   uint64_t plaintext_offset, const unsigned char *record,
+                   size_t length) {
+    CipherSipHash hash(mac_key.data());
+    hash.update_u64(chunk);
+    hash.update_u64(plaintext_offset);
+    hash.update(record, length);
+    return hash.finish();
+}
+
+// Covers the header too, so its flags, chunk size and engine name cannot be
+// changed without the key.
+uint64_t index_tag(const std::vector<unsigned char> &mac_key,
+                   const unsigned char *header,
+                   const std::vector<unsigned char> &index,
+                   uint64_t plaintext_size) {
+    CipherSipHash hash(mac_key.data());
+    hash.update(header, CIPHER_CONTAINER_HEADER_BYTES);
+    hash.update(index.data(), index.size());
+    hash.update_u64(plaintext_size);
+    return hash.finish();
+}
+
+void check_mac_key(const std::vector<unsigned char> &mac_key) {
+    if (!mac_key.empty() && mac_key.size() != CIPHER_SIPHASH_KEY_BYTES) {
+        throw std::invalid_argument("Container MAC key must be " +
+                                    std::to_string(CIPHER_SIPHASH_KEY_BYTES) +
+                                    " bytes.");
+    }
+}
+
+// Runs fn(i) for i in [0, count) on up to threads threads of the shared pool
+// and rethrows the first failure.
+template <typename Fn>
+void for_each_chunk(size_t count, unsigned int threads, Fn fn) {
+    cipher_thread_pool().parallel_for(count, fn, std::max(1u, threads));
+}
+
+const size_t CHUNK_PACK_HEADER_BYTES = 5;
+
+// Payload length, mode byte, then the LZ4 block or, when that is not
+// smaller, the chunk itself.
+std::vector<unsigned char> pack_chunk(const std::vector<unsigned char> &plain) {
+    std::vector<unsigned char> compressed =
+        cipher_lz4_compress(plain.data(), plain.size());
+    bool stored = compressed.size() >= plain.size();
+    const std::vector<unsigned char> &payload = stored ? plain : compressed;
+    std::vector<unsigned char> packed;
+    packed.reserve(CHUNK_PACK_HEADER_BYTES + payload.size());
+    put_le(packed, payload.size(), 4);
+    packed.push_back(stored ? CHUNK_STORED : CHUNK_LZ4);
+    packed.insert(packed.end(), payload.begin(), payload.end());
+    return packed;
+}
+
+std::vector<unsigned char> unpack_chunk(std::vector<unsigned char> packed,
+                                        size_t plaintext_length) {
+    if (packed.size() < CHUNK_PACK_HEADER_BYTES) {
+        throw std::runtime_error("Truncated compressed chunk.");
+    }
+    size_t payload = static_cast<size_t>(get_le(packed.data(), 4));
+    unsigned char mode = packed[4];
+    if (packed.size() != CHUNK_PACK_HEADER_BYTES + payload) {
+        throw std::runtime_error("Corrupt compressed chunk.");
+    }
+    if (mode == CHUNK_STORED) {
+        packed.erase(packed.begin(), packed.begin() + CHUNK_PACK_HEADER_BYTES);
+        return packed;
+    }
+    if (mode != CHUNK_LZ4) {
+        throw std::runtime_error("Unknown chunk compression mode.");
+    }
+    std::vector<unsigned char> plain(plaintext_length);
+    cipher_lz4_decompress(packed.data() + CHUNK_PACK_HEADER_BYTES, payload,
+                          plain.data(), plain.size());
+    return plain;
+}
+
+unsigned int container_threads(unsigned int threads) {
+    return threads == 0 ? cipher_thread_pool().thread_count() : threads;
+}
+
+size_t chunks_per_wave(unsigned int threads) {
+    return threads <= 1 ? 1 : static_cast<size_t>(threads) * 2;
+}
+
+} // namespace
+
+bool is_cipher_container(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char magic[4];
+    if (!file.read(reinterpret_cast<char *>(magic), sizeof(magic)) ||
+        std::memcmp(magic, CONTAINER_MAGIC, 4) != 0) {
+        return false;
+    }
+    file.seekg(-static_cast<std::streamoff>(CIPHER_CONTAINER_TRAILER_BYTES) + 32,
+               std::ios::end);
+    return file.read(reinterpret_cast<char *>(magic), sizeof(magic)) &&
+           std::memcmp(magic, INDEX_MAGIC, 4) == 0;
+}
+
+CipherContainerResult
+write_cipher_container(const CipherEngine &encryptor,
+                       const std::string &inputFilePath,
+                       const std::string &outputFilePath,
+                       const CipherContainerOptions &options) {
+    CipherContainerResult result;
+    bool output_started = false;
+    try {
+        if (encryptor.direction() != CipherDirection::Encrypt) {
+            result.message = "Container writer needs an encrypting engine.";
+            return result;
+        }
+        if (options.chunk_size == 0) {
+            result.message = "Container chunk size must be positive.";
+            return result;
+        }
+        check_mac_key(options.mac_key);
+        std::string name = encryptor.name();
+        if (name.size() > CIPHER_CONTAINER_MAX_ENGINE_NAME) {
+            result.message = "Engine name is too long for the container header.";
+            return result;
+        }
+
+        std::ifstream input(inputFilePath, std::ios::binary);
+        if (!input) {
+            result.message = "Error opening input file: " + inputFilePath;
+            return result;
+        }
+        std::ofstream output(outputFilePath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            result.message = "Error opening output file: " + outputFilePath;
+            return result;
+        }
+        output_started = true;
+        if (options.progress) {
+            std::error_code ec;
+            uint64_t total = std::filesystem::file_size(inputFilePath, ec);
+            options.progress->set_total(ec ? 0 : total);
+        }
+
+        bool mac = !options.mac_key.empty();
+        bool lz4 = options.compression == CipherContainerCompression::Lz4;
+        uint16_t flags = (mac ? CIPHER_CONTAINER_FLAG_MAC : 0) |
+                         (lz4 ? CIPHER_CONTAINER_FLAG_LZ4 : 0);
+        std::vector<unsigned char> header(CONTAINER_MAGIC, CONTAINER_MAGIC + 4);
+        put_le(header, CIPHER_CONTAINER_VERSION, 2);
+        put_le(header, flags, 2);
+        put_le(header, options.chunk_size, 4);
+        header.push_back(static_cast<unsigned char>(name.size()));
+        header.insert(header.end(), name.begin(), name.end());
+        header.resize(CIPHER_CONTAINER_HEADER_BYTES, 0);
+        output.write(reinterpret_cast<const char *>(header.data()),
+                     static_cast<std::streamsize>(header.size()));
+
+        unsigned int threads = container_threads(options.threads);
+        size_t wave = chunks_per_wave(threads);
+        std::vector<std::vector<unsigned char>> plain(wave);
+        std::vector<std::vector<unsigned char>> records(wave);
+        std::vector<unsigned char> index;
+        uint64_t offset = CIPHER_CONTAINER_HEADER_BYTES;
+        uint64_t chunk = 0;
+        bool at_end = false;
+        while (!at_end) {
+            size_t count = 0;
+            uint64_t wave_bytes = 0;
+            while (count < wave && !at_end) {
+                plain[count].resize(options.chunk_size);
+                input.read(reinterpret_cast<char *>(plain[count].data()),
+                           static_cast<std::streamsize>(options.chunk_size));
+                size_t got = static_cast<size_t>(input.gcount());
+                if (input.bad()) {
+                    throw std::runtime_error("Error reading input file content.");
+                }
+                at_end = got < options.chunk_size;
+                if (got == 0) {
+                    break;
+                }
+                plain[count].resize(got);
+                wave_bytes += got;
+                ++count;
+            }
+
+            for_each_chunk(count, threads, [&](size_t i) {
+                std::unique_ptr<CipherEngine> engine = encryptor.clone();
+                if (lz4) {
+                    std::vector<unsigned char> packed = pack_chunk(plain[i]);
+                    records[i] =
+                        run_cipher_buffer(*engine, packed.data(), packed.size());
+                } else {
+                    records[i] = run_cipher_buffer(*engine, plain[i].data(),
+                                                   plain[i].size());
+                }
+                if (mac) {
+                    uint64_t c = chunk + i;
+                    uint64_t tag =
+                        chunk_tag(options.mac_key, c, c * options.chunk_size,
+                                  records[i].data(), records[i].size());
+                    put_le(records[i], tag, CIPHER_CONTAINER_TAG_BYTES);
+                }
+            });
+
+            for (size_t i = 0; i < count; ++i) {
+                output.write(reinterpret_cast<const char *>(records[i].data()),
+                             static_cast<std::streamsize>(records[i].size()));
+                put_le(index, offset, 8);
+                put_le(index, records[i].size(), 4);
+                put_le(index, plain[i].size(), 4);
+                offset += records[i].size();
+            }
+            if (!output) {
+                throw std::runtime_error("Error writing to output file.");
+            }
+            chunk += count;
+            result.plaintext_bytes += wave_bytes;
+            if (at_end) {
+                if (options.progress) {
+                    options.progress->add_bytes(wave_bytes);
+                }
+            } else {
+                cipher_progress_step(options.progress, wave_bytes);
+            }
+        }
+
+        std::vector<unsigned char> trailer;
+        put_le(trailer, offset, 8);
+        put_le(trailer, chunk, 8);
+        put_le(trailer, result.plaintext_bytes, 8);
+        put_le(trailer,
+               mac ? index_tag(options.mac_key, header.data(), index,
+                               result.plaintext_bytes)
+                   : 0,
+               8);
+        trailer.insert(trailer.end(), INDEX_MAGIC, INDEX_MAGIC + 4);
+        put_le(trailer, 0, 4);
+        output.write(reinterpret_cast<const char *>(index.data()),
+                     static_cast<std::streamsize>(index.size()));
+        output.write(reinterpret_cast<const char *>(trailer.data()),
+                     static_cast<std::streamsize>(trailer.size()));
+        output.close();
+        if (!output) {
+            throw std::runtime_error("Error writing to output file.");
+        }
+        result.chunks = chunk;
+        result.container_bytes = offset + index.size() + trailer.size();
+        result.success = true;
+        if (options.progress) {
+            options.progress->report();
+        }
+    } catch (const CipherCancelledError &e) {
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.message =
+            std::string("C++ Exception in cipher container: ") + e.what();
+    }
+    // Like run_cipher_file: no partial plaintext or truncated container.
+    if (!result.success && output_started) {
+        cipher_remove_failed_output(outputFilePath);
+    }
+    return result;
+}
+
+CipherContainerResult
+read_cipher_container(const CipherEngine &decryptor,
+                      const std::string &inputFilePath,
+                      const std::string &outputFilePath,
+                      const CipherContainerOptions &options) {
+    CipherContainerResult result;
+    bool output_started = false;
+    try {
+        CipherContainerReader reader(inputFilePath, decryptor, options.mac_key);
+        std::ofstream output(outputFilePath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            result.message = "Error opening output file: " + outputFilePath;
+            return result;
+        }
+        output_started = true;
+        if (options.progress) {
+            options.progress->set_total(reader.size());
+        }
+
+        unsigned int threads = container_threads(options.threads);
+        size_t wave = chunks_per_wave(threads);
+        std::vector<std::vector<unsigned char>> records(wave);
+        std::vector<std::vector<unsigned char>> plain(wave);
+        size_t total = reader.chunk_count();
+        for (size_t first = 0; first < total; first += wave) {
+            size_t count = std::min(wave, total - first);
+            for (size_t i = 0; i < count; ++i) {
+                records[i] = reader.read_record(first + i);
+            }
+            for_each_chunk(count, threads, [&](size_t i) {
+                plain[i] = reader.decrypt_record(first + i, records[i]);
+            });
+            uint64_t wave_bytes = 0;
+            for (size_t i = 0; i < count; ++i) {
+                output.write(reinterpret_cast<const char *>(plain[i].data()),
+                             static_cast<std::streamsize>(plain[i].size()));
+                wave_bytes += plain[i].size();
+            }
+            if (!output) {
+                throw std::runtime_error("Error writing to output file.");
+            }
+            result.plaintext_bytes += wave_bytes;
+            if (first + count < total) {
+                cipher_progress_step(options.progress, wave_bytes);
+            } else if (options.progress) {
+                options.progress->add_bytes(wave_bytes);
+            }
+        }
+        result.chunks = total;
+        std::error_code ec;
+        result.container_bytes = std::filesystem::file_size(inputFilePath, ec);
+        result.success = true;
+        if (options.progress) {
+            options.progress->report();
+        }
+    } catch (const CipherCancelledError &e) {
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.message =
+            std::string("C++ Exception in cipher container: ") + e.what();
+    }
+    // Like run_cipher_file: no partial plaintext or truncated container.
+    if (!result.success && output_started) {
+        cipher_remove_failed_output(outputFilePath);
+    }
+    return result;
+}
+
+// --- Random access reader ---
+CipherContainerReader::CipherContainerReader(
+    const std::string &path, const CipherEngine &decryptor,
+    const std::vector<unsigned char> &mac_key)
+    : file_(path, std::ios::binary), decryptor_(decryptor.clone()),
+      mac_key_(mac_key) {
+    if (!file_) {
+        throw std::runtime_error("Error opening container file: " + path);
+    }
+    if (decryptor.direction() != CipherDirection::Decrypt) {
+        throw std::invalid_argument(
+            "Container reader needs a decrypting engine.");
+    }
+    check_mac_key(mac_key_);
+    file_.seekg(0, std::ios::end);
+    uint64_t file_size = static_cast<uint64_t>(file_.tellg());
+    if (file_size <
+        CIPHER_CONTAINER_HEADER_BYTES + CIPHER_CONTAINER_TRAILER_BYTES) {
+        throw std::runtime_error("File is not a cipher container (too short).");
+    }
+
+    unsigned char header[CIPHER_CONTAINER_HEADER_BYTES];
+    file_.seekg(0);
+    file_.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (std::memcmp(header, CONTAINER_MAGIC, 4) != 0) {
+        throw std::runtime_error("File is not a cipher container.");
+    }
+    if (get_le(header + 4, 2) != CIPHER_CONTAINER_VERSION) {
+        throw std::runtime_error("Unsupported cipher container version.");
+    }
+    uint64_t flags = get_le(header + 6, 2);
+    if (flags & ~static_cast<uint64_t>(CIPHER_CONTAINER_FLAG_MAC |
+                                       CIPHER_CONTAINER_FLAG_LZ4)) {
+        throw std::runtime_error("Unsupported cipher container flags.");
+    }
+    mac_ = (flags & CIPHER_CONTAINER_FLAG_MAC) != 0;
+    lz4_ = (flags & CIPHER_CONTAINER_FLAG_LZ4) != 0;
+    chunk_size_ = static_cast<uint32_t>(get_le(header + 8, 4));
+    size_t name_length = std::min<size_t>(header[12],
+                                          CIPHER_CONTAINER_MAX_ENGINE_NAME);
+    std::string name(reinterpret_cast<const char *>(header + 13), name_length);
+    if (name != decryptor.name()) {
+        throw std::runtime_error("Container was written with engine '" + name +
+                                 "', not '" + decryptor.name() + "'.");
+    }
+    if (mac_ && mac_key_.empty()) {
+        throw std::runtime_error(
+            "Container is authenticated; a MAC key is required.");
+    }
+    // The flag itself is not authenticated: a caller holding a key must not
+    // accept a container whose tags were stripped.
+    if (!mac_ && !mac_key_.empty()) {
+        throw std::runtime_error(
+            "Container is not authenticated but a MAC key was given.");
+    }
+    if (chunk_size_ == 0) {
+        throw std::runtime_error("Corrupt container header.");
+    }
+
+    unsigned char trailer[CIPHER_CONTAINER_TRAILER_BYTES];
+    file_.seekg(
+        static_cast<std::streamoff>(file_size - CIPHER_CONTAINER_TRAILER_BYTES));
+    file_.read(reinterpret_cast<char *>(trailer), sizeof(trailer));
+    uint64_t index_offset = get_le(trailer, 8);
+    uint64_t count = get_le(trailer + 8, 8);
+    plaintext_size_ = get_le(trailer + 16, 8);
+    uint64_t tag = get_le(trailer + 24, 8);
+    if (!file_ || std::memcmp(trailer + 32, INDEX_MAGIC, 4) != 0 ||
+        index_offset < CIPHER_CONTAINER_HEADER_BYTES ||
+        count > (file_size - CIPHER_CONTAINER_TRAILER_BYTES) /
+                    CIPHER_CONTAINER_INDEX_ENTRY_BYTES ||
+        index_offset + count * CIPHER_CONTAINER_INDEX_ENTRY_BYTES +
+                CIPHER_CONTAINER_TRAILER_BYTES !=
+            file_size) {
+        throw std::runtime_error("Corrupt container index.");
+    }
+
+    std::vector<unsigned char> index(
+        static_cast<size_t>(count * CIPHER_CONTAINER_INDEX_ENTRY_BYTES));
+    file_.seekg(static_cast<std::streamoff>(index_offset));
+    file_.read(reinterpret_cast<char *>(index.data()),
+               static_cast<std::streamsize>(index.size()));
+    if (!file_) {
+        throw std::runtime_error("Error reading container index.");
+    }
+    if (mac_ && index_tag(mac_key_, header, index, plaintext_size_) != tag) {
+        throw std::runtime_error("Container index failed authentication.");
+    }
+
+    index_.resize(static_cast<size_t>(count));
+    uint64_t plaintext = 0;
+    for (size_t i = 0; i < index_.size(); ++i) {
+        const unsigned char *raw =
+            index.data() + i * CIPHER_CONTAINER_INDEX_ENTRY_BYTES;
+        CipherContainerIndexEntry &entry = index_[i];
+        entry.record_offset = get_le(raw, 8);
+        entry.record_length = static_cast<uint32_t>(get_le(raw + 8, 4));
+        entry.plaintext_length = static_cast<uint32_t>(get_le(raw + 12, 4));
+        bool last = i + 1 == index_.size();
+        if (entry.record_offset < CIPHER_CONTAINER_HEADER_BYTES ||
+            entry.record_offset + entry.record_length > index_offset ||
+            entry.plaintext_length == 0 ||
+            entry.plaintext_length > chunk_size_ ||
+            (!last && entry.plaintext_length != chunk_size_)) {
+            throw std::runtime_error("Corrupt container index entry " +
+                                     std::to_string(i) + ".");
+        }
+        plaintext += entry.plaintext_length;
+    }
+    if (plaintext != plaintext_size_) {
+        throw std::runtime_error("Corrupt container index.");
+    }
+}
+
+std::vector<unsigned char> CipherContainerReader::read_record(size_t chunk) {
+    const CipherContainerIndexEntry &entry = index_.at(chunk);
+    std::vector<unsigned char> record(entry.record_length);
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(entry.record_offset));
+    file_.read(reinterpret_cast<char *>(record.data()),
+               static_cast<std::streamsize>(record.size()));
+    if (static_cast<size_t>(file_.gcount()) != record.size()) {
+        throw std::runtime_error("Error reading container chunk " +
+                                 std::to_string(chunk) + ".");
+    }
+    return record;
+}
+
+std::vector<unsigned char> CipherContainerReader::decrypt_record(
+    size_t chunk, const std::vector<unsigned char> &record) const {
+    const CipherContainerIndexEntry &entry = index_.at(chunk);
+    size_t body = record.size();
+    if (body != entry.record_length ||
+        (mac_ && body < CIPHER_CONTAINER_TAG_BYTES)) {
+        throw std::runtime_error("Corrupt container chunk " +
+                                 std::to_string(chunk) + ".");
+    }
+    if (mac_) {
+        body -= CIPHER_CONTAINER_TAG_BYTES;
+        uint64_t expected = chunk_tag(mac_key_, chunk,
+                                      static_cast<uint64_t>(chunk) * chunk_size_,
+                                      record.data(), body);
+        if (get_le(record.data() + body, CIPHER_CONTAINER_TAG_BYTES) !=
+            expected) {
+            throw std::runtime_error("Container chunk " +
+                                     std::to_string(chunk) +
+                                     " failed authentication.");
+        }
+    }
+    std::unique_ptr<CipherEngine> engine = decryptor_->clone();
+    std::vector<unsigned char> plain =
+        run_cipher_buffer(*engine, record.data(), body);
+    if (lz4_) {
+        plain = unpack_chunk(std::move(plain), entry.plaintext_length);
+    }
+    if (plain.size() != entry.plaintext_length) {
+        throw std::runtime_error("Corrupt container chunk " +
+                                 std::to_string(chunk) + ".");
+    }
+    return plain;
+}
+
+std::vector<unsigned char> CipherContainerReader::read_chunk(size_t chunk) {
+    return decrypt_record(chunk, read_record(chunk));
+}
+
+std::vector<unsigned char> CipherContainerReader::read_at(uint64_t offset,
+                                                          size_t length) {
+    std::vector<unsigned char> out;
+    if (offset >= plaintext_size_ || length == 0) {
+        return out;
+    }
+    uint64_t end = std::min<uint64_t>(plaintext_size_, offset + length);
+    out.reserve(static_cast<size_t>(end - offset));
+    for (uint64_t chunk = offset / chunk_size_;
+         chunk <= (end - 1) / chunk_size_; ++chunk) {
+        std::vector<unsigned char> plain = read_chunk(static_cast<size_t>(chunk));
+        uint64_t chunk_start = chunk * chunk_size_;
+        size_t from = static_cast<size_t>(std::max(offset, chunk_start) -
+                                          chunk_start);
+        size_t to = static_cast<size_t>(
+            std::min<uint64_t>(end, chunk_start + plain.size()) - chunk_start);
+        out.insert(out.end(), plain.begin() + from, plain.begin() + to);
+    }
+    return out;
+}
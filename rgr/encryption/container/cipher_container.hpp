@@ -0,0 +1,144 @@
+//
+//  cipher_container.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_CONTAINER_HPP
+#define CIPHER_CONTAINER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../engine/cipher_engine.hpp"
+
+// Seekable chunked ciphertext file (little-endian throughout):
+//
+//   header   "RGRC", u16 version, u16 flags, u32 chunk_size,
+//            u8 name length, engine name (32 bytes, zero padded), 3 zero bytes
+//   records  per chunk: engine output for the chunk (its header, e.g. a
+//            fresh GOST IV, then the ciphertext), plus a u64 SipHash-2-4 tag
+//            over (chunk index, plaintext offset, record) when flagged. With
+//            the LZ4 flag the engine encrypts the u32 payload length, a u8
+//            mode (1 stored, 2 LZ4 block) and the payload, so compression is
+//            not observable outside the ciphertext
+//   index    per chunk: u64 record offset, u32 record length, u32 plaintext
+//            length
+//   trailer  u64 index offset, u64 chunk count, u64 plaintext size, u64
+//            SipHash-2-4 tag over (header, index, plaintext size) (0 without
+//            MAC), "RGRI", u32 zero
+//
+// Chunks are encrypted independently by clones of one engine, so any chunk
+// can be decrypted on its own and chunks can be processed in parallel.
+const uint32_t CIPHER_CONTAINER_DEFAULT_CHUNK_BYTES = 1 << 20;
+const uint16_t CIPHER_CONTAINER_VERSION = 1;
+const uint16_t CIPHER_CONTAINER_FLAG_MAC = 1;
+const uint16_t CIPHER_CONTAINER_FLAG_LZ4 = 2;
+const size_t CIPHER_CONTAINER_HEADER_BYTES = 48;
+const size_t CIPHER_CONTAINER_TRAILER_BYTES = 40;
+const size_t CIPHER_CONTAINER_INDEX_ENTRY_BYTES = 16;
+const size_t CIPHER_CONTAINER_TAG_BYTES = 8;
+const size_t CIPHER_CONTAINER_MAX_ENGINE_NAME = 32;
+
+enum class CipherContainerCompression { None, Lz4 };
+
+struct CipherContainerOptions {
+    uint32_t chunk_size = CIPHER_CONTAINER_DEFAULT_CHUNK_BYTES;
+    // Threads of the shared cipher_thread_pool(); 0 means all of its
+    // workers.
+    unsigned int threads = 1;
+    // Writer only; readers take it from the header. Chunks that do not
+    // shrink are stored as they are.
+    CipherContainerCompression compression = CipherContainerCompression::None;
+    // 16-byte SipHash key. When set, chunks and the index carry tags that
+    // are verified on every read; a reader given a key refuses containers
+    // written without one.
+    std::vector<unsigned char> mac_key;
+    CipherProgressToken *progress = nullptr;
+};
+
+struct CipherContainerResult {
+    bool success = false;
+    bool cancelled = false;
+    std::string message;
+    uint64_t chunks = 0;
+    uint64_t plaintext_bytes = 0;
+    uint64_t container_bytes = 0;
+};
+
+struct CipherContainerIndexEntry {
+    uint64_t record_offset = 0;
+    uint32_t record_length = 0;
+    uint32_t plaintext_length = 0;
+};
+
+// Cheap check of the header and trailer magic, used by the legacy file
+// entry points to tell containers from their own formats.
+bool is_cipher_container(const std::string &path);
+
+// Encrypts inputFilePath into a container. encryptor is an initialised
+// encrypting engine; it is only cloned. A GOST prototype without a fixed IV
+// gives every chunk its own random IV. A failed or cancelled call removes
+// its output file, as run_cipher_file does.
+CipherContainerResult
+write_cipher_container(const CipherEngine &encryptor,
+                       const std::string &inputFilePath,
+                       const std::string &outputFilePath,
+                       const CipherContainerOptions &options = {});
+
+// Decrypts a whole container, chunks in parallel when options.threads > 1.
+// On failure no partial plaintext is left behind.
+CipherContainerResult
+read_cipher_container(const CipherEngine &decryptor,
+                      const std::string &inputFilePath,
+                      const std::string &outputFilePath,
+                      const CipherContainerOptions &options = {});
+
+// Random access into a container. Not thread-safe; use one reader per
+// thread.
+class CipherContainerReader {
+  public:
+    // Loads the header and index; throws std::runtime_error on a malformed
+    // container, an engine mismatch, a bad index tag or a MAC key given for
+    // a container without tags.
+    CipherContainerReader(const std::string &path,
+                          const CipherEngine &decryptor,
+                          const std::vector<unsigned char> &mac_key = {});
+
+    uint64_t size() const { return plaintext_size_; }
+    uint32_t chunk_size() const { return chunk_size_; }
+    size_t chunk_count() const { return index_.size(); }
+    bool authenticated() const { return mac_; }
+    bool compressed() const { return lz4_; }
+    const CipherContainerIndexEntry &index_entry(size_t chunk) const {
+        return index_.at(chunk);
+    }
+
+    // Decrypts only the chunks overlapping [offset, offset + length);
+    // returns fewer bytes past the end. Throws std::runtime_error on a tag
+    // mismatch or a corrupt chunk.
+    std::vector<unsigned char> read_at(uint64_t offset, size_t length);
+    std::vector<unsigned char> read_chunk(size_t chunk);
+    // Raw record bytes of a chunk, for callers that decrypt elsewhere.
+    std::vector<unsigned char> read_record(size_t chunk);
+    // Verifies the tag of record (as returned by read_record) and decrypts
+    // it; safe to call from several threads at once.
+    std::vector<unsigned char>
+    decrypt_record(size_t chunk, const std::vector<unsigned char> &record) const;
+
+  private:
+    std::ifstream file_;
+    std::unique_ptr<CipherEngine> decryptor_;
+    std::vector<unsigned char> mac_key_;
+    bool mac_ = false;
+    bool lz4_ = false;
+    uint32_t chunk_size_ = 0;
+    uint64_t plaintext_size_ = 0;
+    std::vector<CipherContainerIndexEntry> index_;
+};
+
+#endif // CIPHER_CONTAINER_HPP
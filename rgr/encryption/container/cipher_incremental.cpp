@@ -0,0 +1,708 @@
+//
+//  cipher_incremental.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_incremental.hpp"
+#include "../common/cipher_siphash.hpp"
+#include "../gost/gost.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+const unsigned char ARCHIVE_MAGIC[4] = {'R', 'G', 'R', 'D'};
+const unsigned char MANIFEST_MAGIC[4] = {'R', 'G', 'R', 'M'};
+// Input is read and its new chunks encrypted in waves of this many bytes.
+const size_t WAVE_BYTES = 4 << 20;
+
+void put_le(std::vector<unsigned char> &out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+uint64_t get_le(const unsigned char *in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i-- > 0;) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+// Gear table of the rolling hash: fixed pseudo-random words, so every build
+// cuts the same content at the same places.
+constexpr std::array<uint64_t, 256> make_gear_table() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x5247524443444331ULL;
+    for (uint64_t &entry : table) {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        entry = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr std::array<uint64_t, 256> GEAR = make_gear_table();
+
+unsigned int log2_exact(uint32_t value) {
+    unsigned int bits = 0;
+    while ((1u << bits) < value) {
+        ++bits;
+    }
+    return bits;
+}
+
+void check_chunk_sizes(uint32_t min_chunk, uint32_t average_chunk,
+                       uint32_t max_chunk) {
+    if (average_chunk < 64 || (average_chunk & (average_chunk - 1)) != 0 ||
+        min_chunk == 0 || min_chunk >= average_chunk ||
+        average_chunk >= max_chunk) {
+        throw std::invalid_argument(
+            "Chunk sizes need min < average < max with a power-of-two "
+            "average of at least 64 bytes.");
+    }
+}
+
+using Fingerprint = std::array<unsigned char, CIPHER_INCREMENTAL_FINGERPRINT_BYTES>;
+
+struct FingerprintHash {
+    size_t operator()(const Fingerprint &fingerprint) const {
+        // Already a keyed hash.
+        return static_cast<size_t>(get_le(fingerprint.data(), 8));
+    }
+};
+
+// Keys derived from the GOST key with SipHash keyed by its first half.
+struct ArchiveKeys {
+    std::vector<unsigned char> key;
+    unsigned char fingerprint[2][CIPHER_SIPHASH_KEY_BYTES];
+    unsigned char iv[CIPHER_SIPHASH_KEY_BYTES];
+    unsigned char mac[CIPHER_SIPHASH_KEY_BYTES];
+};
+
+void derive_key(const std::vector<unsigned char> &key, const char *label,
+                unsigned char *out) {
+    for (uint64_t half = 0; half < 2; ++half) {
+        CipherSipHash hash(key.data());
+        hash.update(key.data() + CIPHER_SIPHASH_KEY_BYTES,
+                    GOST_KEY_SIZE_BYTES - CIPHER_SIPHASH_KEY_BYTES);
+        hash.update(reinterpret_cast<const unsigned char *>(label),
+                    std::strlen(label));
+        hash.update_u64(half);
+        uint64_t word = hash.finish();
+        for (size_t i = 0; i < 8; ++i) {
+            out[half * 8 + i] = static_cast<unsigned char>(word >> (8 * i));
+        }
+    }
+}
+
+ArchiveKeys archive_keys(const std::string &key_hex) {
+    ArchiveKeys keys;
+    keys.key = hexStringToBytes(key_hex);
+    if (keys.key.size() != GOST_KEY_SIZE_BYTES) {
+        throw std::invalid_argument("Invalid key length for file encryption.");
+    }
+    derive_key(keys.key, "rgr-cdc-fingerprint-0", keys.fingerprint[0]);
+    derive_key(keys.key, "rgr-cdc-fingerprint-1", keys.fingerprint[1]);
+    derive_key(keys.key, "rgr-cdc-iv", keys.iv);
+    derive_key(keys.key, "rgr-cdc-manifest", keys.mac);
+    return keys;
+}
+
+Fingerprint chunk_fingerprint(const ArchiveKeys &keys, const unsigned char *data,
+                              size_t length) {
+    Fingerprint fingerprint;
+    for (size_t half = 0; half < 2; ++half) {
+        uint64_t word = cipher_siphash24(keys.fingerprint[half], data, length);
+        for (size_t i = 0; i < 8; ++i) {
+            fingerprint[half * 8 + i] = static_cast<unsigned char>(word >> (8 * i));
+        }
+    }
+    return fingerprint;
+}
+
+void chunk_iv(const ArchiveKeys &keys, const Fingerprint &fingerprint,
+              unsigned char *iv) {
+    uint64_t word =
+        cipher_siphash24(keys.iv, fingerprint.data(), fingerprint.size());
+    for (size_t i = 0; i < GOST_IV_SIZE_BYTES; ++i) {
+        iv[i] = static_cast<unsigned char>(word >> (8 * i));
+    }
+}
+
+struct ManifestEntry {
+    uint64_t record_offset = 0;
+    uint32_t record_length = 0;
+    uint32_t plaintext_length = 0;
+    Fingerprint fingerprint{};
+};
+
+bool operator==(const ManifestEntry &a, const ManifestEntry &b) {
+    return a.record_offset == b.record_offset &&
+           a.record_length == b.record_length &&
+           a.plaintext_length == b.plaintext_length &&
+           a.fingerprint == b.fingerprint;
+}
+
+// A chunk of the current wave that is not stored yet.
+struct FreshChunk {
+    size_t position;
+    size_t length;
+    size_t record; // offset in the wave's record buffer
+    Fingerprint fingerprint;
+};
+
+struct Archive {
+    uint32_t min_chunk = 0;
+    uint32_t average_chunk = 0;
+    uint32_t max_chunk = 0;
+    std::vector<ManifestEntry> manifest;
+    uint64_t plaintext_size = 0;
+    uint64_t live_bytes = 0;
+    uint64_t file_size = 0;
+};
+
+std::vector<unsigned char> archive_header(uint32_t min_chunk,
+                                          uint32_t average_chunk,
+                                          uint32_t max_chunk) {
+    std::vector<unsigned char> header(ARCHIVE_MAGIC, ARCHIVE_MAGIC + 4);
+    put_le(header, CIPHER_INCREMENTAL_VERSION, 2);
+    put_le(header, 0, 2);
+    put_le(header, min_chunk, 4);
+    put_le(header, average_chunk, 4);
+    put_le(header, max_chunk, 4);
+    header.resize(CIPHER_INCREMENTAL_HEADER_BYTES, 0);
+    return header;
+}
+
+uint64_t manifest_tag(const ArchiveKeys &keys,
+                      const std::vector<unsigned char> &manifest,
+                      uint64_t plaintext_size, uint64_t live_bytes) {
+    CipherSipHash hash(keys.mac);
+    hash.update(manifest.data(), manifest.size());
+    hash.update_u64(plaintext_size);
+    hash.update_u64(live_bytes);
+    return hash.finish();
+}
+
+// Bytes of distinct records the manifest refers to.
+uint64_t live_record_bytes(const std::vector<ManifestEntry> &manifest) {
+    std::unordered_set<uint64_t> seen;
+    uint64_t bytes = 0;
+    for (const ManifestEntry &entry : manifest) {
+        if (seen.insert(entry.record_offset).second) {
+            bytes += entry.record_length;
+        }
+    }
+    return bytes;
+}
+
+// Manifest and trailer for a manifest written at offset.
+std::vector<unsigned char> archive_tail(const ArchiveKeys &keys,
+                                        const std::vector<ManifestEntry> &manifest,
+                                        uint64_t offset,
+                                        uint64_t plaintext_size) {
+    std::vector<unsigned char> tail;
+    tail.reserve(manifest.size() * CIPHER_INCREMENTAL_MANIFEST_ENTRY_BYTES +
+                 CIPHER_INCREMENTAL_TRAILER_BYTES);
+    for (const ManifestEntry &entry : manifest) {
+        put_le(tail, entry.record_offset, 8);
+        put_le(tail, entry.record_length, 4);
+        put_le(tail, entry.plaintext_length, 4);
+        tail.insert(tail.end(), entry.fingerprint.begin(),
+                    entry.fingerprint.end());
+    }
+    uint64_t live_bytes = live_record_bytes(manifest);
+    uint64_t tag = manifest_tag(keys, tail, plaintext_size, live_bytes);
+    put_le(tail, offset, 8);
+    put_le(tail, manifest.size(), 8);
+    put_le(tail, plaintext_size, 8);
+    put_le(tail, live_bytes, 8);
+    put_le(tail, tag, 8);
+    tail.insert(tail.end(), MANIFEST_MAGIC, MANIFEST_MAGIC + 4);
+    put_le(tail, 0, 4);
+    return tail;
+}
+
+void read_exact(std::ifstream &file, uint64_t offset, unsigned char *out,
+                size_t length) {
+    file.seekg(static_cast<std::streamoff>(offset));
+    if (!file.read(reinterpret_cast<char *>(out),
+                   static_cast<std::streamsize>(length))) {
+        throw std::runtime_error("Truncated incremental archive.");
+    }
+}
+
+// Loads and authenticates the header, trailer and manifest; throws
+// std::runtime_error on a malformed archive or a wrong key.
+Archive load_archive(const std::string &path, const ArchiveKeys &keys) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Error opening archive file: " + path);
+    }
+    Archive archive;
+    std::error_code ec;
+    archive.file_size = std::filesystem::file_size(path, ec);
+    if (ec || archive.file_size < CIPHER_INCREMENTAL_HEADER_BYTES +
+                                      CIPHER_INCREMENTAL_TRAILER_BYTES) {
+        throw std::runtime_error("Not an incremental archive: " + path);
+    }
+    unsigned char header[CIPHER_INCREMENTAL_HEADER_BYTES];
+    read_exact(file, 0, header, sizeof(header));
+    if (std::memcmp(header, ARCHIVE_MAGIC, 4) != 0 ||
+        get_le(header + 4, 2) != CIPHER_INCREMENTAL_VERSION) {
+        throw std::runtime_error("Not an incremental archive or unsupported "
+                                 "version: " + path);
+    }
+    archive.min_chunk = static_cast<uint32_t>(get_le(header + 8, 4));
+    archive.average_chunk = static_cast<uint32_t>(get_le(header + 12, 4));
+    archive.max_chunk = static_cast<uint32_t>(get_le(header + 16, 4));
+    check_chunk_sizes(archive.min_chunk, archive.average_chunk,
+                      archive.max_chunk);
+
+    unsigned char trailer[CIPHER_INCREMENTAL_TRAILER_BYTES];
+    uint64_t trailer_offset =
+        archive.file_size - CIPHER_INCREMENTAL_TRAILER_BYTES;
+    read_exact(file, trailer_offset, trailer, sizeof(trailer));
+    uint64_t manifest_offset = get_le(trailer, 8);
+    uint64_t chunks = get_le(trailer + 8, 8);
+    archive.plaintext_size = get_le(trailer + 16, 8);
+    archive.live_bytes = get_le(trailer + 24, 8);
+    uint64_t tag = get_le(trailer + 32, 8);
+    if (std::memcmp(trailer + 40, MANIFEST_MAGIC, 4) != 0 ||
+        manifest_offset < CIPHER_INCREMENTAL_HEADER_BYTES ||
+        manifest_offset > trailer_offset ||
+        (trailer_offset - manifest_offset) /
+                CIPHER_INCREMENTAL_MANIFEST_ENTRY_BYTES !=
+            chunks ||
+        (trailer_offset - manifest_offset) %
+                CIPHER_INCREMENTAL_MANIFEST_ENTRY_BYTES !=
+            0) {
+        throw std::runtime_error("Corrupt incremental archive trailer.");
+    }
+
+    std::vector<unsigned char> manifest(
+        static_cast<size_t>(trailer_offset - manifest_offset));
+    read_exact(file, manifest_offset, manifest.data(), manifest.size());
+    if (manifest_tag(keys, manifest, archive.plaintext_size,
+                     archive.live_bytes) != tag) {
+        throw std::runtime_error(
+            "Archive manifest does not verify (wrong key or corrupt file).");
+    }
+    archive.manifest.resize(static_cast<size_t>(chunks));
+    uint64_t plaintext_size = 0;
+    for (size_t i = 0; i < archive.manifest.size(); ++i) {
+        const unsigned char *raw =
+            manifest.data() + i * CIPHER_INCREMENTAL_MANIFEST_ENTRY_BYTES;
+        ManifestEntry &entry = archive.manifest[i];
+        entry.record_offset = get_le(raw, 8);
+        entry.record_length = static_cast<uint32_t>(get_le(raw + 8, 4));
+        entry.plaintext_length = static_cast<uint32_t>(get_le(raw + 12, 4));
+        std::memcpy(entry.fingerprint.data(), raw + 16,
+                    CIPHER_INCREMENTAL_FINGERPRINT_BYTES);
+        if (entry.record_offset < CIPHER_INCREMENTAL_HEADER_BYTES ||
+            entry.record_offset > manifest_offset ||
+            entry.record_length > manifest_offset - entry.record_offset ||
+            entry.record_length !=
+                GOST_IV_SIZE_BYTES + gost_padded_length(entry.plaintext_length)) {
+            throw std::runtime_error("Corrupt incremental archive manifest.");
+        }
+        plaintext_size += entry.plaintext_length;
+    }
+    if (plaintext_size != archive.plaintext_size) {
+        throw std::runtime_error("Corrupt incremental archive manifest.");
+    }
+    return archive;
+}
+
+// Rewrites the archive with only the records its manifest refers to; the
+// records are copied, not re-encrypted. Returns the new archive size.
+uint64_t compact_archive(const std::string &path, const ArchiveKeys &keys,
+                         const Archive &archive) {
+    std::string temporary = path + ".tmp";
+    try {
+        std::ifstream input(path, std::ios::binary);
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        if (!input || !output) {
+            throw std::runtime_error("Error opening files to compact archive.");
+        }
+        std::vector<unsigned char> header = archive_header(
+            archive.min_chunk, archive.average_chunk, archive.max_chunk);
+        output.write(reinterpret_cast<const char *>(header.data()),
+                     static_cast<std::streamsize>(header.size()));
+
+        std::unordered_map<uint64_t, uint64_t> moved;
+        std::vector<ManifestEntry> manifest = archive.manifest;
+        std::vector<unsigned char> record;
+        uint64_t offset = CIPHER_INCREMENTAL_HEADER_BYTES;
+        for (ManifestEntry &entry : manifest) {
+            auto [it, inserted] = moved.emplace(entry.record_offset, offset);
+            if (inserted) {
+                record.resize(entry.record_length);
+                read_exact(input, entry.record_offset, record.data(),
+                           record.size());
+                output.write(reinterpret_cast<const char *>(record.data()),
+                             static_cast<std::streamsize>(record.size()));
+                offset += record.size();
+            }
+            entry.record_offset = it->second;
+        }
+        std::vector<unsigned char> tail =
+            archive_tail(keys, manifest, offset, archive.plaintext_size);
+        output.write(reinterpret_cast<const char *>(tail.data()),
+                     static_cast<std::streamsize>(tail.size()));
+        output.close();
+        if (!output) {
+            throw std::runtime_error("Error writing compacted archive.");
+        }
+        input.close();
+        std::filesystem::rename(temporary, path);
+        return offset + tail.size();
+    } catch (...) {
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
+        throw;
+    }
+}
+
+} // namespace
+
+size_t cipher_cdc_cut(const unsigned char *data, size_t length,
+                      uint32_t min_chunk, uint32_t average_chunk,
+                      uint32_t max_chunk) {
+    if (length <= min_chunk) {
+        return length;
+    }
+    // Normalized chunking: a stricter mask before the average size and a
+    // looser one after it keep chunk sizes close to the average. The masks
+    // test the top bits, which depend on the last 64 bytes.
+    unsigned int bits = log2_exact(average_chunk);
+    uint64_t strict_mask = ~0ULL << (64 - (bits + 1));
+    uint64_t loose_mask = ~0ULL << (64 - (bits - 1));
+    size_t end = std::min<size_t>(length, max_chunk);
+    size_t normal = std::min<size_t>(end, average_chunk);
+    uint64_t hash = 0;
+    size_t i = min_chunk;
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + GEAR[data[i]];
+        if ((hash & strict_mask) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < end; ++i) {
+        hash = (hash << 1) + GEAR[data[i]];
+        if ((hash & loose_mask) == 0) {
+            return i + 1;
+        }
+    }
+    return end;
+}
+
+bool is_cipher_incremental_archive(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char magic[4];
+    if (!file.read(reinterpret_cast<char *>(magic), sizeof(magic)) ||
+        std::memcmp(magic, ARCHIVE_MAGIC, 4) != 0) {
+        return false;
+    }
+    file.seekg(-static_cast<std::streamoff>(CIPHER_INCREMENTAL_TRAILER_BYTES) +
+                   40,
+               std::ios::end);
+    return file.read(reinterpret_cast<char *>(magic), sizeof(magic)) &&
+           std::memcmp(magic, MANIFEST_MAGIC, 4) == 0;
+}
+
+CipherIncrementalResult
+encryptFileIncrementalGOST(const std::string &inputFilePath,
+                           const std::string &archivePath,
+                           const std::string &key_hex,
+                           const CipherIncrementalOptions &options) {
+    CipherIncrementalResult result;
+    std::string temporary = archivePath + ".tmp";
+    bool appending = false;
+    bool creating = false;
+    uint64_t restore_size = 0;
+    try {
+        ArchiveKeys keys = archive_keys(key_hex);
+        std::ifstream input(inputFilePath, std::ios::binary);
+        if (!input) {
+            result.message = "Error opening input file: " + inputFilePath;
+            return result;
+        }
+
+        bool update = is_cipher_incremental_archive(archivePath);
+        Archive archive;
+        if (update) {
+            archive = load_archive(archivePath, keys);
+        } else {
+            check_chunk_sizes(options.min_chunk, options.average_chunk,
+                              options.max_chunk);
+            archive.min_chunk = options.min_chunk;
+            archive.average_chunk = options.average_chunk;
+            archive.max_chunk = options.max_chunk;
+        }
+        if (options.progress) {
+            std::error_code ec;
+            uint64_t total = std::filesystem::file_size(inputFilePath, ec);
+            options.progress->set_total(ec ? 0 : total);
+        }
+
+        std::unordered_map<Fingerprint, ManifestEntry, FingerprintHash> stored;
+        for (const ManifestEntry &entry : archive.manifest) {
+            stored.emplace(entry.fingerprint, entry);
+        }
+
+        std::fstream output;
+        uint64_t offset = 0;
+        if (update) {
+            output.open(archivePath,
+                        std::ios::binary | std::ios::in | std::ios::out);
+            if (!output) {
+                result.message = "Error opening archive file: " + archivePath;
+                return result;
+            }
+            output.seekp(0, std::ios::end);
+            restore_size = archive.file_size;
+            offset = archive.file_size;
+            appending = true;
+        } else {
+            output.open(temporary, std::ios::binary | std::ios::out |
+                                       std::ios::trunc);
+            if (!output) {
+                result.message = "Error opening output file: " + temporary;
+                return result;
+            }
+            creating = true;
+            std::vector<unsigned char> header = archive_header(
+                archive.min_chunk, archive.average_chunk, archive.max_chunk);
+            output.write(reinterpret_cast<const char *>(header.data()),
+                         static_cast<std::streamsize>(header.size()));
+            offset = header.size();
+        }
+
+        std::vector<ManifestEntry> manifest;
+        std::vector<unsigned char> buffer;
+        std::vector<unsigned char> records;
+        std::vector<GostMultiBufferJob> jobs;
+        std::vector<FreshChunk> fresh;
+        size_t read_size = std::max<size_t>(WAVE_BYTES, archive.max_chunk);
+        size_t start = 0;
+        bool at_end = false;
+        while (true) {
+            if (!at_end && buffer.size() - start < archive.max_chunk) {
+                buffer.erase(buffer.begin(),
+                             buffer.begin() + static_cast<std::ptrdiff_t>(start));
+                start = 0;
+                size_t have = buffer.size();
+                buffer.resize(have + read_size);
+                input.read(reinterpret_cast<char *>(buffer.data() + have),
+                           static_cast<std::streamsize>(read_size));
+                if (input.bad()) {
+                    throw std::runtime_error("Error reading input file content.");
+                }
+                size_t got = static_cast<size_t>(input.gcount());
+                buffer.resize(have + got);
+                at_end = got < read_size;
+            }
+            if (start == buffer.size()) {
+                break;
+            }
+
+            // Cut every chunk whose boundary the buffered bytes decide, then
+            // encrypt the new ones of this wave in one multi-buffer call.
+            records.clear();
+            jobs.clear();
+            fresh.clear();
+            size_t position = start;
+            while (position < buffer.size() &&
+                   (at_end || buffer.size() - position >= archive.max_chunk)) {
+                const unsigned char *chunk = buffer.data() + position;
+                size_t length = cipher_cdc_cut(
+                    chunk, buffer.size() - position, archive.min_chunk,
+                    archive.average_chunk, archive.max_chunk);
+                ManifestEntry entry;
+                entry.plaintext_length = static_cast<uint32_t>(length);
+                entry.fingerprint = chunk_fingerprint(keys, chunk, length);
+                auto it = stored.find(entry.fingerprint);
+                if (it != stored.end() &&
+                    it->second.plaintext_length == entry.plaintext_length) {
+                    entry = it->second;
+                    ++result.reused_chunks;
+                } else {
+                    entry.record_offset = offset;
+                    entry.record_length = static_cast<uint32_t>(
+                        GOST_IV_SIZE_BYTES + gost_padded_length(length));
+                    offset += entry.record_length;
+                    stored[entry.fingerprint] = entry;
+                    fresh.push_back({position, length, records.size(),
+                                     entry.fingerprint});
+                    records.resize(records.size() + entry.record_length);
+                    ++result.encrypted_chunks;
+                }
+                manifest.push_back(entry);
+                position += length;
+            }
+            for (const FreshChunk &chunk : fresh) {
+                unsigned char *record = records.data() + chunk.record;
+                chunk_iv(keys, chunk.fingerprint, record);
+                GostMultiBufferJob job;
+                job.iv = record;
+                job.in = buffer.data() + chunk.position;
+                job.length = chunk.length;
+                job.out = record + GOST_IV_SIZE_BYTES;
+                jobs.push_back(job);
+            }
+            gost_encrypt_multi(keys.key.data(), jobs);
+            output.write(reinterpret_cast<const char *>(records.data()),
+                         static_cast<std::streamsize>(records.size()));
+            if (!output) {
+                throw std::runtime_error("Error writing to archive file.");
+            }
+            result.bytes_written += records.size();
+            result.plaintext_bytes += position - start;
+            cipher_progress_step(options.progress, position - start);
+            start = position;
+        }
+        result.chunks = manifest.size();
+
+        if (update && manifest == archive.manifest) {
+            // Nothing changed; the archive is left as it was.
+            appending = false;
+            result.archive_bytes = archive.file_size;
+        } else {
+            std::vector<unsigned char> tail =
+                archive_tail(keys, manifest, offset, result.plaintext_bytes);
+            output.write(reinterpret_cast<const char *>(tail.data()),
+                         static_cast<std::streamsize>(tail.size()));
+            output.close();
+            if (!output) {
+                throw std::runtime_error("Error writing to archive file.");
+            }
+            result.bytes_written += tail.size();
+            result.archive_bytes = offset + tail.size();
+            if (creating) {
+                std::filesystem::rename(temporary, archivePath);
+                creating = false;
+            }
+            appending = false;
+
+            uint64_t live = live_record_bytes(manifest);
+            uint64_t dead = result.archive_bytes - tail.size() -
+                            CIPHER_INCREMENTAL_HEADER_BYTES - live;
+            if (update && static_cast<double>(dead) >
+                              options.compact_garbage_ratio *
+                                  static_cast<double>(result.archive_bytes)) {
+                Archive latest = load_archive(archivePath, keys);
+                result.archive_bytes = compact_archive(archivePath, keys, latest);
+                result.bytes_written += result.archive_bytes;
+                result.compacted = true;
+            }
+        }
+        result.success = true;
+        result.message = update ? "Archive updated successfully."
+                                : "Archive created successfully.";
+        if (options.progress) {
+            options.progress->report();
+        }
+    } catch (const CipherCancelledError &e) {
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.message =
+            std::string("C++ Exception in incremental archive: ") + e.what();
+    }
+    if (!result.success) {
+        std::error_code ignored;
+        if (creating) {
+            std::filesystem::remove(temporary, ignored);
+        }
+        if (appending) {
+            std::filesystem::resize_file(archivePath, restore_size, ignored);
+        }
+    }
+    return result;
+}
+
+CipherIncrementalResult
+decryptFileIncrementalGOST(const std::string &archivePath,
+                           const std::string &outputFilePath,
+                           const std::string &key_hex,
+                           CipherProgressToken *progress) {
+    CipherIncrementalResult result;
+    bool opened = false;
+    try {
+        ArchiveKeys keys = archive_keys(key_hex);
+        Archive archive = load_archive(archivePath, keys);
+        std::ifstream input(archivePath, std::ios::binary);
+        std::ofstream output(outputFilePath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            result.message = "Error opening output file: " + outputFilePath;
+            return result;
+        }
+        opened = true;
+        if (progress) {
+            progress->set_total(archive.plaintext_size);
+        }
+
+        std::vector<unsigned char> record;
+        std::vector<unsigned char> plain;
+        for (size_t i = 0; i < archive.manifest.size(); ++i) {
+            const ManifestEntry &entry = archive.manifest[i];
+            record.resize(entry.record_length);
+            read_exact(input, entry.record_offset, record.data(), record.size());
+            plain.resize(record.size() - GOST_IV_SIZE_BYTES);
+            size_t length = gost_decrypt_to(
+                keys.key.data(), record.data(),
+                record.data() + GOST_IV_SIZE_BYTES,
+                record.size() - GOST_IV_SIZE_BYTES, plain.data());
+            if (length != entry.plaintext_length ||
+                chunk_fingerprint(keys, plain.data(), length) !=
+                    entry.fingerprint) {
+                throw std::runtime_error("Chunk " + std::to_string(i) +
+                                         " does not match its fingerprint.");
+            }
+            output.write(reinterpret_cast<const char *>(plain.data()),
+                         static_cast<std::streamsize>(length));
+            if (!output) {
+                throw std::runtime_error("Error writing to output file.");
+            }
+            result.plaintext_bytes += length;
+            cipher_progress_step(progress, length);
+        }
+        output.close();
+        if (!output) {
+            throw std::runtime_error("Error writing to output file.");
+        }
+        result.chunks = archive.manifest.size();
+        result.archive_bytes = archive.file_size;
+        result.success = true;
+        result.message = "Archive decrypted successfully.";
+        if (progress) {
+            progress->report();
+        }
+    } catch (const CipherCancelledError &e) {
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.message =
+            std::string("C++ Exception in incremental archive: ") + e.what();
+    }
+    if (!result.success && opened) {
+        std::error_code ignored;
+        std::filesystem::remove(outputFilePath, ignored);
+    }
+    return result;
+}
@@ -0,0 +1,100 @@
+//
+//  cipher_incremental.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_INCREMENTAL_HPP
+#define CIPHER_INCREMENTAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../common/cipher_progress.hpp"
+
+// Incrementally updatable GOST archive of one file (little-endian
+// throughout):
+//
+//   header    "RGRD", u16 version, u16 zero, u32 min / average / max chunk
+//             size, zero padding to 32 bytes
+//   records   per stored chunk: IV, then the CBC ciphertext of the chunk
+//   manifest  per chunk of the file: u64 record offset, u32 record length,
+//             u32 plaintext length, 16-byte keyed fingerprint of the chunk
+//   trailer   u64 manifest offset, u64 chunk count, u64 plaintext size,
+//             u64 live record bytes, u64 SipHash tag of the manifest,
+//             "RGRM", u32 zero
+//
+// The input is cut with content-defined chunking (a gear rolling hash), so
+// an edit moves only the boundaries next to it. Each chunk is encrypted on
+// its own under an IV derived from its fingerprint, and fingerprint and IV
+// keys are derived from the GOST key. Updating an archive re-encrypts only
+// chunks whose fingerprint is not already stored, appends them with a new
+// manifest and trailer, and leaves every existing record in place; the
+// archive is rewritten without dead records once they outweigh live ones.
+//
+// Deriving the IV from the content makes equal chunks encrypt to equal
+// records, which is what lets them be kept, but also shows which chunks an
+// update left unchanged.
+const uint16_t CIPHER_INCREMENTAL_VERSION = 1;
+const size_t CIPHER_INCREMENTAL_HEADER_BYTES = 32;
+const size_t CIPHER_INCREMENTAL_MANIFEST_ENTRY_BYTES = 32;
+const size_t CIPHER_INCREMENTAL_TRAILER_BYTES = 48;
+const size_t CIPHER_INCREMENTAL_FINGERPRINT_BYTES = 16;
+
+struct CipherIncrementalOptions {
+    // Used when the archive is created; updates keep the archive's own
+    // sizes so unchanged content is cut at the same places. average_chunk
+    // must be a power of two with min_chunk < average_chunk < max_chunk.
+    uint32_t min_chunk = 16 << 10;
+    uint32_t average_chunk = 64 << 10;
+    uint32_t max_chunk = 256 << 10;
+    // Rewrite the archive when dead records exceed this share of it.
+    double compact_garbage_ratio = 0.5;
+    CipherProgressToken *progress = nullptr;
+};
+
+struct CipherIncrementalResult {
+    bool success = false;
+    bool cancelled = false;
+    std::string message;
+    uint64_t chunks = 0;
+    // Chunks already stored in the archive (or earlier in the same file).
+    uint64_t reused_chunks = 0;
+    uint64_t encrypted_chunks = 0;
+    uint64_t plaintext_bytes = 0;
+    // Bytes appended or, after compaction, written in total.
+    uint64_t bytes_written = 0;
+    uint64_t archive_bytes = 0;
+    bool compacted = false;
+};
+
+// Length of the next content-defined chunk of data[0, length): a cut point
+// in [min_chunk, max_chunk], or length when that is shorter. Cut points
+// depend only on the bytes before them, so callers may stream as long as at
+// least max_chunk bytes (or the rest of the input) are passed in.
+size_t cipher_cdc_cut(const unsigned char *data, size_t length,
+                      uint32_t min_chunk, uint32_t average_chunk,
+                      uint32_t max_chunk);
+
+// Creates archivePath from inputFilePath, or updates it when it already is
+// an incremental archive under key_hex (64 hex characters). A failed or
+// cancelled update truncates the archive back to its previous state.
+CipherIncrementalResult
+encryptFileIncrementalGOST(const std::string &inputFilePath,
+                           const std::string &archivePath,
+                           const std::string &key_hex,
+                           const CipherIncrementalOptions &options = {});
+// Restores the latest version from an archive, verifying the fingerprint of
+// every chunk.
+CipherIncrementalResult
+decryptFileIncrementalGOST(const std::string &archivePath,
+                           const std::string &outputFilePath,
+                           const std::string &key_hex,
+                           CipherProgressToken *progress = nullptr);
+
+// Cheap check of the header and trailer magic.
+bool is_cipher_incremental_archive(const std::string &path);
+
+#endif // CIPHER_INCREMENTAL_HPP
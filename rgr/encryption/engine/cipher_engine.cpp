@@ -0,0 +1,540 @@
+//
+//  cipher_engine.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_engine.hpp"
+#include "cipher_file_pipeline.hpp"
+#include "../common/cipher_thread_pool.hpp"
+#include "../gost/gost.hpp"
+#include "../permutationCipher/permutation_cipher.hpp"
+#include "../rsa/rsa.hpp"
+#include "../staticShift/static_shift.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+// --- Registry ---
+CipherEngineRegistry &CipherEngineRegistry::instance() {
+    static CipherEngineRegistry registry;
+    return registry;
+}
+
+CipherEngineRegistry::CipherEngineRegistry() {
+    factories_["gost"] = [] { return std::make_unique<GostCipherEngine>(); };
+    factories_["permutation"] = [] {
+        return std::make_unique<PermutationCipherEngine>();
+    };
+    factories_["rsa"] = [] { return std::make_unique<RsaCipherEngine>(); };
+    factories_["static_shift"] = [] {
+        return std::make_unique<StaticShiftCipherEngine>();
+    };
+}
+
+void CipherEngineRegistry::register_engine(const std::string &name,
+                                           CipherEngineFactory factory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    factories_[name] = std::move(factory);
+}
+
+std::unique_ptr<CipherEngine>
+CipherEngineRegistry::create(const std::string &name) const {
+    CipherEngineFactory factory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = factories_.find(name);
+        if (it == factories_.end()) {
+            return nullptr;
+        }
+        factory = it->second;
+    }
+    return factory();
+}
+
+std::unique_ptr<CipherEngine>
+CipherEngineRegistry::create(const std::string &name, const std::string &key,
+                             CipherDirection direction) const {
+    std::unique_ptr<CipherEngine> engine = create(name);
+    if (!engine) {
+        throw std::invalid_argument("Unknown cipher engine: " + name);
+    }
+    engine->init(key, direction);
+    return engine;
+}
+
+std::vector<std::string> CipherEngineRegistry::names() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> result;
+    for (const auto &entry : factories_) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+// --- Drivers ---
+size_t cipher_aligned_chunk_size(size_t requested, size_t block_size) {
+    size_t chunk = requested - requested % block_size;
+    return chunk == 0 ? block_size : chunk;
+}
+
+CipherPayloadSplit cipher_split_payload(const CipherEngine &engine,
+                                        uint64_t payload) {
+    uint64_t keep = std::min<uint64_t>(engine.tail_size(), payload);
+    uint64_t body = payload - keep;
+    body -= body % engine.block_size();
+    return {body, payload - body};
+}
+
+namespace {
+
+unsigned int effective_threads(const CipherEngine &engine,
+                               const CipherDriverOptions &options,
+                               uint64_t body) {
+    unsigned int threads = options.threads == 0
+                               ? cipher_thread_pool().thread_count()
+                               : options.threads;
+    if (threads <= 1 || !engine.supports_seek() ||
+        body < CIPHER_PARALLEL_MIN_BYTES) {
+        return 1;
+    }
+    return threads;
+}
+
+// Runs fn(range_begin, range_end) for block-aligned slices of [0, body) on
+// up to threads threads of the shared pool and rethrows the first failure.
+template <typename RangeFn>
+void for_each_body_range(uint64_t body, size_t block_size,
+                         unsigned int threads, RangeFn fn) {
+    if (threads <= 1 || body == 0) {
+        fn(0, body);
+        return;
+    }
+    uint64_t blocks = body / block_size;
+    uint64_t per_thread = (blocks + threads - 1) / threads;
+    size_t ranges = static_cast<size_t>((blocks + per_thread - 1) / per_thread);
+    cipher_thread_pool().parallel_for(
+        ranges,
+        [&](size_t r) {
+            fn(per_thread * r * block_size,
+               std::min(blocks, per_thread * (r + 1)) * block_size);
+        },
+        threads);
+}
+
+} // namespace
+
+CipherStreamChunker::CipherStreamChunker(CipherEngine &engine,
+                                         const CipherDriverOptions &options)
+    : engine_(engine), progress_(options.progress),
+      header_(engine.header_size()),
+      chunk_size_(cipher_aligned_chunk_size(options.chunk_size,
+                                            engine.block_size())),
+      in_buffer_(chunk_size_ + engine.tail_size() + engine.block_size()),
+      out_buffer_(engine.max_output_size(in_buffer_.size())) {
+    CIPHER_INSTR_ALLOC(engine.instrumentation_algorithm(), 2);
+    if (!header_.empty() && engine.direction() == CipherDirection::Encrypt) {
+        engine.write_header(header_.data());
+    }
+}
+
+size_t CipherStreamChunker::process(size_t bytes_read) {
+    const CipherInstrAlgorithm algorithm = engine_.instrumentation_algorithm();
+    bytes_read_ = bytes_read;
+    at_end_ = bytes_read < chunk_size_;
+    size_t available = held_ + bytes_read;
+    processed_ =
+        static_cast<size_t>(cipher_split_payload(engine_, available).body);
+    size_t written = 0;
+    {
+        CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Kernel, processed_);
+        written = engine_.process(in_buffer_.data(), processed_,
+                                  out_buffer_.data());
+    }
+    if (at_end_) {
+        CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Padding,
+                           available - processed_);
+        written += engine_.finalize(in_buffer_.data() + processed_,
+                                    available - processed_,
+                                    out_buffer_.data() + written);
+    }
+    return written;
+}
+
+bool CipherStreamChunker::next() {
+    if (at_end_) {
+        if (progress_) {
+            progress_->add_bytes(bytes_read_);
+        }
+        return false;
+    }
+    cipher_progress_step(progress_, bytes_read_);
+    size_t available = held_ + bytes_read_;
+    std::memmove(in_buffer_.data(), in_buffer_.data() + processed_,
+                 available - processed_);
+    held_ = available - processed_;
+    return true;
+}
+
+CipherDriverResult run_cipher_stream(CipherEngine &engine, std::istream &input,
+                                     std::ostream &output,
+                                     const CipherDriverOptions &options) {
+    CipherDriverResult result;
+    const CipherInstrAlgorithm algorithm = engine.instrumentation_algorithm();
+    CIPHER_INSTR_CALL(algorithm);
+    try {
+        CipherStreamChunker chunker(engine, options);
+        std::vector<unsigned char> &header = chunker.header();
+        if (!header.empty()) {
+            if (engine.direction() == CipherDirection::Encrypt) {
+                output.write(reinterpret_cast<const char *>(header.data()),
+                             static_cast<std::streamsize>(header.size()));
+                result.bytes_out += header.size();
+            } else {
+                input.read(reinterpret_cast<char *>(header.data()),
+                           static_cast<std::streamsize>(header.size()));
+                if (static_cast<size_t>(input.gcount()) != header.size()) {
+                    result.message = "Error reading header from input file "
+                                     "(file too short or read error).";
+                    return result;
+                }
+                result.bytes_in += header.size();
+                chunker.read_header();
+            }
+        }
+
+        do {
+            size_t bytes_read = 0;
+            {
+                CIPHER_INSTR_SCOPE_NAMED(read_stage, algorithm,
+                                         CipherInstrStage::Read);
+                input.read(reinterpret_cast<char *>(chunker.input()),
+                           static_cast<std::streamsize>(chunker.chunk_size()));
+                bytes_read = static_cast<size_t>(input.gcount());
+                CIPHER_INSTR_SET_BYTES(read_stage, bytes_read);
+            }
+            if (input.bad()) {
+                result.message = "Error reading input file content.";
+                return result;
+            }
+            result.bytes_in += bytes_read;
+            size_t written = chunker.process(bytes_read);
+            {
+                CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Write, written);
+                output.write(reinterpret_cast<const char *>(chunker.output()),
+                             static_cast<std::streamsize>(written));
+            }
+            if (!output) {
+                result.message = "Error writing to output file.";
+                return result;
+            }
+            result.bytes_out += written;
+        } while (chunker.next());
+        result.success = true;
+    } catch (const CipherCancelledError &e) {
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.message =
+            std::string("C++ Exception in cipher stream: ") + e.what();
+    }
+    return result;
+}
+
+CipherFileSplit cipher_prepare_file_split(CipherEngine &engine,
+                                          const std::string &inputFilePath,
+                                          const std::string &outputFilePath,
+                                          uint64_t file_size) {
+    const CipherInstrAlgorithm algorithm = engine.instrumentation_algorithm();
+    CipherFileSplit layout;
+    layout.file_size = file_size;
+    std::vector<unsigned char> header(engine.header_size());
+    if (engine.direction() == CipherDirection::Encrypt) {
+        engine.write_header(header.data());
+        layout.header_out = header.size();
+    } else {
+        std::ifstream headerFile(inputFilePath, std::ios::binary);
+        headerFile.read(reinterpret_cast<char *>(header.data()),
+                        static_cast<std::streamsize>(header.size()));
+        if (static_cast<size_t>(headerFile.gcount()) != header.size()) {
+            throw std::runtime_error("Error reading header from input file "
+                                     "(file too short or read error).");
+        }
+        engine.read_header(header.data());
+        layout.header_in = header.size();
+    }
+    CipherPayloadSplit split =
+        cipher_split_payload(engine, file_size - layout.header_in);
+    layout.body = split.body;
+
+    // The tail goes first so padding errors surface before any bulk work.
+    std::vector<unsigned char> tail_in(static_cast<size_t>(split.tail));
+    {
+        std::ifstream tailFile(inputFilePath, std::ios::binary);
+        tailFile.seekg(
+            static_cast<std::streamoff>(layout.header_in + split.body));
+        tailFile.read(reinterpret_cast<char *>(tail_in.data()),
+                      static_cast<std::streamsize>(tail_in.size()));
+        if (static_cast<size_t>(tailFile.gcount()) != tail_in.size()) {
+            throw std::runtime_error("Error reading input file content.");
+        }
+    }
+    std::unique_ptr<CipherEngine> tail_engine = engine.clone();
+    tail_engine->seek(split.body);
+    std::vector<unsigned char> tail_out(engine.max_output_size(tail_in.size()));
+    {
+        CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Padding, tail_in.size());
+        tail_out.resize(tail_engine->finalize(tail_in.data(), tail_in.size(),
+                                              tail_out.data()));
+    }
+
+    uint64_t tail_offset = layout.header_out + engine.output_offset(split.body);
+    layout.output_size = tail_offset + tail_out.size();
+    {
+        std::ofstream outputFile(outputFilePath,
+                                 std::ios::binary | std::ios::trunc);
+        if (!outputFile) {
+            throw std::runtime_error("Error opening output file: " +
+                                     outputFilePath);
+        }
+        outputFile.write(reinterpret_cast<const char *>(header.data()),
+                         static_cast<std::streamsize>(layout.header_out));
+    }
+    std::filesystem::resize_file(outputFilePath, layout.output_size);
+    {
+        std::fstream out(outputFilePath,
+                         std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(tail_offset));
+        out.write(reinterpret_cast<const char *>(tail_out.data()),
+                  static_cast<std::streamsize>(tail_out.size()));
+        if (!out) {
+            throw std::runtime_error("Error writing to output file.");
+        }
+    }
+    return layout;
+}
+
+void cipher_process_file_range(const CipherEngine &engine,
+                               const CipherFileSplit &layout,
+                               const std::string &inputFilePath,
+                               const std::string &outputFilePath,
+                               uint64_t begin, uint64_t end, size_t chunk_size,
+                               CipherProgressToken *progress) {
+    const CipherInstrAlgorithm algorithm = engine.instrumentation_algorithm();
+    chunk_size = cipher_aligned_chunk_size(chunk_size, engine.block_size());
+    std::unique_ptr<CipherEngine> worker = engine.clone();
+    worker->seek(begin);
+    std::ifstream in(inputFilePath, std::ios::binary);
+    std::fstream out(outputFilePath,
+                     std::ios::binary | std::ios::in | std::ios::out);
+    if (!in || !out) {
+        throw std::runtime_error("Error opening files for parallel I/O.");
+    }
+    in.seekg(static_cast<std::streamoff>(layout.header_in + begin));
+    out.seekp(static_cast<std::streamoff>(layout.header_out +
+                                          engine.output_offset(begin)));
+    // Allocated on the worker that runs this range, so on its NUMA node.
+    CipherLocalBuffer in_buffer(chunk_size);
+    CipherLocalBuffer out_buffer(engine.max_output_size(chunk_size));
+    CIPHER_INSTR_ALLOC(algorithm, 2);
+    for (uint64_t pos = begin; pos < end; pos += chunk_size) {
+        size_t length =
+            static_cast<size_t>(std::min<uint64_t>(chunk_size, end - pos));
+        {
+            CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Read, length);
+            in.read(reinterpret_cast<char *>(in_buffer.data()),
+                    static_cast<std::streamsize>(length));
+        }
+        if (static_cast<size_t>(in.gcount()) != length) {
+            throw std::runtime_error("Error reading input file content.");
+        }
+        size_t written = 0;
+        {
+            CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Kernel, length);
+            written =
+                worker->process(in_buffer.data(), length, out_buffer.data());
+        }
+        {
+            CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Write, written);
+            out.write(reinterpret_cast<const char *>(out_buffer.data()),
+                      static_cast<std::streamsize>(written));
+        }
+        if (!out) {
+            throw std::runtime_error("Error writing to output file.");
+        }
+        cipher_progress_step(progress, length);
+    }
+}
+
+namespace {
+
+CipherDriverResult run_cipher_file_parallel(CipherEngine &engine,
+                                            const std::string &inputFilePath,
+                                            const std::string &outputFilePath,
+                                            const CipherDriverOptions &options,
+                                            uint64_t file_size) {
+    CipherDriverResult result;
+    CIPHER_INSTR_CALL(engine.instrumentation_algorithm());
+    CipherFileSplit layout = cipher_prepare_file_split(
+        engine, inputFilePath, outputFilePath, file_size);
+    unsigned int threads = effective_threads(engine, options, layout.body);
+    for_each_body_range(
+        layout.body, engine.block_size(), threads,
+        [&](uint64_t begin, uint64_t end) {
+            cipher_process_file_range(engine, layout, inputFilePath,
+                                      outputFilePath, begin, end,
+                                      options.chunk_size, options.progress);
+        });
+    result.bytes_in = file_size;
+    result.bytes_out = layout.output_size;
+    result.success = true;
+    return result;
+}
+
+} // namespace
+
+CipherDriverResult run_cipher_file(CipherEngine &engine,
+                                   const std::string &inputFilePath,
+                                   const std::string &outputFilePath,
+                                   const CipherDriverOptions &options) {
+    CipherDriverResult result;
+    std::ifstream inputFile(inputFilePath, std::ios::binary);
+    if (!inputFile) {
+        result.message = "Error opening input file: " + inputFilePath;
+        return result;
+    }
+
+    bool handled = false;
+    bool output_started = false;
+    try {
+        uint64_t file_size = std::filesystem::file_size(inputFilePath);
+        if (options.progress) {
+            options.progress->set_total(file_size);
+        }
+        uint64_t header_in = engine.direction() == CipherDirection::Decrypt
+                                 ? engine.header_size()
+                                 : 0;
+        if (file_size >= header_in &&
+            effective_threads(engine, options,
+                              cipher_split_payload(engine, file_size - header_in)
+                                  .body) > 1) {
+            handled = true;
+            output_started = true;
+            inputFile.close();
+            result = run_cipher_file_parallel(engine, inputFilePath,
+                                              outputFilePath, options,
+                                              file_size);
+        }
+    } catch (const CipherCancelledError &e) {
+        handled = true;
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        handled = true;
+        result.message =
+            std::string("C++ Exception in cipher file driver: ") + e.what();
+    }
+
+    // The overlapped pipeline needs positional reads, so pipes and devices
+    // stay on the stream path.
+    std::error_code type_error;
+    if (!handled && options.io_backend != CipherIoBackend::Stream &&
+        std::filesystem::is_regular_file(inputFilePath, type_error)) {
+        handled = true;
+        output_started = true;
+        inputFile.close();
+        result = run_cipher_file_pipeline(engine, inputFilePath,
+                                          outputFilePath, options);
+    }
+
+    if (!handled) {
+        std::ofstream outputFile(outputFilePath,
+                                 std::ios::binary | std::ios::trunc);
+        if (!outputFile) {
+            result.message = "Error opening output file: " + outputFilePath;
+            return result;
+        }
+        output_started = true;
+        result = run_cipher_stream(engine, inputFile, outputFile, options);
+        inputFile.close();
+        outputFile.close();
+    }
+
+    if (!result.success && output_started) {
+        cipher_remove_failed_output(outputFilePath);
+    } else if (result.success && options.progress) {
+        options.progress->report();
+    }
+    return result;
+}
+
+void cipher_remove_failed_output(const std::string &outputFilePath) {
+    // Only regular files: an output such as /dev/null must survive.
+    std::error_code ignored;
+    if (std::filesystem::is_regular_file(outputFilePath, ignored)) {
+        std::filesystem::remove(outputFilePath, ignored);
+    }
+}
+
+std::vector<unsigned char> run_cipher_buffer(CipherEngine &engine,
+                                             const unsigned char *data,
+                                             size_t length,
+                                             const CipherDriverOptions &options) {
+    const CipherInstrAlgorithm algorithm = engine.instrumentation_algorithm();
+    CIPHER_INSTR_CALL(algorithm);
+    size_t header_size = engine.header_size();
+    std::vector<unsigned char> output;
+    if (engine.direction() == CipherDirection::Encrypt) {
+        output.resize(header_size);
+        engine.write_header(output.data());
+    } else {
+        if (length < header_size) {
+            throw std::invalid_argument("Input is shorter than the cipher header.");
+        }
+        engine.read_header(data);
+        data += header_size;
+        length -= header_size;
+    }
+    size_t header_out = output.size();
+
+    CipherPayloadSplit split = cipher_split_payload(engine, length);
+    size_t body = static_cast<size_t>(split.body);
+    size_t body_out = static_cast<size_t>(engine.output_offset(body));
+    output.resize(header_out + body_out +
+                  engine.max_output_size(static_cast<size_t>(split.tail)));
+    CIPHER_INSTR_ALLOC(algorithm, 1);
+
+    unsigned int threads = effective_threads(engine, options, body);
+    if (threads <= 1) {
+        CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Kernel, body);
+        engine.process(data, body, output.data() + header_out);
+    } else {
+        CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Kernel, body);
+        for_each_body_range(body, engine.block_size(), threads,
+                            [&](uint64_t begin, uint64_t end) {
+                                std::unique_ptr<CipherEngine> worker =
+                                    engine.clone();
+                                worker->seek(begin);
+                                worker->process(
+                                    data + begin, static_cast<size_t>(end - begin),
+                                    output.data() + header_out +
+                                        engine.output_offset(begin));
+                            });
+        engine.seek(body);
+    }
+    size_t tail_out = 0;
+    {
+        CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Padding, split.tail);
+        tail_out = engine.finalize(data + body, static_cast<size_t>(split.tail),
+                                   output.data() + header_out + body_out);
+    }
+    output.resize(header_out + body_out + tail_out);
+    return output;
+}
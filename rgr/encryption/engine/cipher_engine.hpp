@@ -0,0 +1,239 @@
+//
+//  cipher_engine.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_ENGINE_HPP
+#define CIPHER_ENGINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../common/cipher_instrumentation.hpp"
+#include "../common/cipher_progress.hpp"
+
+enum class CipherDirection { Encrypt, Decrypt };
+
+// Common streaming interface over every cipher in the project. An engine is
+// initialised with a key and a direction, then fed block-aligned spans
+// through process() and the trailing bytes through finalize(), which applies
+// or removes padding.
+class CipherEngine {
+  public:
+    virtual ~CipherEngine() = default;
+
+    virtual std::string name() const = 0;
+    // Bucket the drivers record stage timings under.
+    virtual CipherInstrAlgorithm instrumentation_algorithm() const {
+        return CipherInstrAlgorithm::Other;
+    }
+    // Parses key material; throws std::invalid_argument on a bad key.
+    virtual void init(const std::string &key, CipherDirection direction) = 0;
+    CipherDirection direction() const { return direction_; }
+    // Granularity of process() input.
+    virtual size_t block_size() const = 0;
+    // Upper bound on output bytes for length input bytes of process() or
+    // finalize().
+    virtual size_t max_output_size(size_t length) const { return length; }
+    // Input bytes a decrypting engine must keep back for finalize() (the
+    // padded last block); the drivers never pass them to process().
+    virtual size_t tail_size() const { return 0; }
+
+    // Bytes written in front of the ciphertext on encrypt and read back on
+    // decrypt (e.g. the GOST IV).
+    virtual size_t header_size() const { return 0; }
+    virtual void write_header(unsigned char * /*out*/) {}
+    virtual void read_header(const unsigned char * /*in*/) {}
+
+    // Transforms length bytes (a multiple of block_size()); returns the
+    // number of bytes written to out. in and out may alias when the engine
+    // is length preserving.
+    virtual size_t process(const unsigned char *in, size_t length,
+                           unsigned char *out) = 0;
+    // Handles the final length bytes of the stream (fewer than a block on
+    // encrypt, tail_size() bytes on decrypt); returns bytes written.
+    virtual size_t finalize(const unsigned char *in, size_t length,
+                            unsigned char *out) = 0;
+
+    // Engines whose blocks are independent can be repositioned to any
+    // block-aligned payload offset, which lets the drivers split work
+    // across threads.
+    virtual bool supports_seek() const { return false; }
+    virtual void seek(uint64_t /*payload_offset*/) {}
+    // Output offset (excluding the header) matching a block-aligned input
+    // offset.
+    virtual uint64_t output_offset(uint64_t input_offset) const {
+        return input_offset;
+    }
+
+    virtual std::unique_ptr<CipherEngine> clone() const = 0;
+
+  protected:
+    CipherDirection direction_ = CipherDirection::Encrypt;
+};
+
+using CipherEngineFactory = std::function<std::unique_ptr<CipherEngine>()>;
+
+// Process-wide name -> factory table. The built-in engines ("gost",
+// "permutation", "rsa", "static_shift") are registered on first use.
+class CipherEngineRegistry {
+  public:
+    static CipherEngineRegistry &instance();
+
+    void register_engine(const std::string &name, CipherEngineFactory factory);
+    // Returns nullptr for an unknown name.
+    std::unique_ptr<CipherEngine> create(const std::string &name) const;
+    // Creates and initialises an engine; throws std::invalid_argument for an
+    // unknown name or a bad key.
+    std::unique_ptr<CipherEngine> create(const std::string &name,
+                                         const std::string &key,
+                                         CipherDirection direction) const;
+    std::vector<std::string> names() const;
+
+  private:
+    CipherEngineRegistry();
+    mutable std::mutex mutex_;
+    std::map<std::string, CipherEngineFactory> factories_;
+};
+
+const size_t CIPHER_STREAM_CHUNK_BYTES = 1 << 16;
+// Files smaller than this are never split across threads.
+const uint64_t CIPHER_PARALLEL_MIN_BYTES = 1 << 20;
+// Chunks in flight per direction in the overlapped file pipeline.
+const unsigned int CIPHER_IO_DEFAULT_QUEUE_DEPTH = 4;
+
+// How the single-threaded file path moves bytes. Stream is the plain
+// read -> process -> write loop; the others overlap disk and cipher work
+// (see cipher_file_pipeline.hpp). Auto picks io_uring when the kernel
+// offers it and the thread-based pipeline otherwise.
+enum class CipherIoBackend { Stream, Threaded, IoUring, Auto };
+
+struct CipherDriverOptions {
+    size_t chunk_size = CIPHER_STREAM_CHUNK_BYTES;
+    // Threads of the shared cipher_thread_pool() for a split payload; 0
+    // means all of its workers.
+    unsigned int threads = 1;
+    CipherIoBackend io_backend = CipherIoBackend::Stream;
+    unsigned int queue_depth = CIPHER_IO_DEFAULT_QUEUE_DEPTH;
+    // Optional; checked for cancellation and fed input byte counts between
+    // chunks.
+    CipherProgressToken *progress = nullptr;
+};
+
+struct CipherDriverResult {
+    bool success = false;
+    bool cancelled = false;
+    std::string message;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+};
+
+// How a payload of known size splits into a block-aligned body that may be
+// processed in any order and the trailing bytes handed to finalize().
+struct CipherPayloadSplit {
+    uint64_t body = 0;
+    uint64_t tail = 0;
+};
+
+CipherPayloadSplit cipher_split_payload(const CipherEngine &engine,
+                                        uint64_t payload);
+// requested rounded down to a whole number of blocks (at least one).
+size_t cipher_aligned_chunk_size(size_t requested, size_t block_size);
+
+// Output layout of a file whose block-aligned body is processed as
+// independent ranges (engines with supports_seek()).
+struct CipherFileSplit {
+    uint64_t file_size = 0;
+    uint64_t header_in = 0;
+    uint64_t header_out = 0;
+    uint64_t body = 0;
+    uint64_t output_size = 0;
+};
+
+// Handles the header, finalizes the tail and leaves the output file at its
+// final size with header and tail in place; body ranges can then be filled
+// in any order with cipher_process_file_range(). Both throw
+// std::runtime_error on I/O failure.
+CipherFileSplit cipher_prepare_file_split(CipherEngine &engine,
+                                          const std::string &inputFilePath,
+                                          const std::string &outputFilePath,
+                                          uint64_t file_size);
+// Processes body bytes [begin, end) (block aligned) on a clone of engine.
+void cipher_process_file_range(const CipherEngine &engine,
+                               const CipherFileSplit &layout,
+                               const std::string &inputFilePath,
+                               const std::string &outputFilePath,
+                               uint64_t begin, uint64_t end, size_t chunk_size,
+                               CipherProgressToken *progress);
+
+// Per-chunk state of a single sequential pass, shared by run_cipher_stream
+// and the coroutine file driver so both handle the header, the bytes held
+// back for finalize() and progress the same way. A pass writes or reads
+// header() first, then repeats: fill input() with up to chunk_size() bytes,
+// process() them, write output(), and call next() until it returns false.
+class CipherStreamChunker {
+  public:
+    // Produces the header on encrypt and sizes the buffers.
+    CipherStreamChunker(CipherEngine &engine, const CipherDriverOptions &options);
+
+    // Encrypt: the header to write before any output. Decrypt: the buffer
+    // to read the header into before calling read_header(). Empty when the
+    // engine has no header.
+    std::vector<unsigned char> &header() { return header_; }
+    void read_header() { engine_.read_header(header_.data()); }
+
+    size_t chunk_size() const { return chunk_size_; }
+    unsigned char *input() { return in_buffer_.data() + held_; }
+    // Ciphers the bytes held from the previous chunk plus bytes_read new
+    // ones; a short read ends the input and finalizes the engine. Returns
+    // the number of bytes at output().
+    size_t process(size_t bytes_read);
+    const unsigned char *output() const { return out_buffer_.data(); }
+    // Call once output() is written: reports progress (a cancellation
+    // throws CipherCancelledError) and keeps the unprocessed bytes. False
+    // after the last chunk.
+    bool next();
+
+  private:
+    CipherEngine &engine_;
+    CipherProgressToken *progress_;
+    std::vector<unsigned char> header_;
+    size_t chunk_size_;
+    std::vector<unsigned char> in_buffer_;
+    std::vector<unsigned char> out_buffer_;
+    size_t held_ = 0;
+    size_t bytes_read_ = 0;
+    size_t processed_ = 0;
+    bool at_end_ = false;
+};
+
+// Single pass over a stream with buffers bounded by options.chunk_size.
+CipherDriverResult run_cipher_stream(CipherEngine &engine, std::istream &input,
+                                     std::ostream &output,
+                                     const CipherDriverOptions &options = {});
+// File driver: splits the payload across options.threads when the engine
+// supports seeking and the file is large enough, otherwise runs a single
+// pass with options.io_backend. A failed or cancelled operation removes its
+// output file, so a wrong key or a read error leaves no partial output.
+CipherDriverResult run_cipher_file(CipherEngine &engine,
+                                   const std::string &inputFilePath,
+                                   const std::string &outputFilePath,
+                                   const CipherDriverOptions &options = {});
+// Removes the output of a failed file operation when it is a regular file.
+void cipher_remove_failed_output(const std::string &outputFilePath);
+// In-memory variant of the file driver.
+std::vector<unsigned char> run_cipher_buffer(CipherEngine &engine,
+                                             const unsigned char *data,
+                                             size_t length,
+                                             const CipherDriverOptions &options = {});
+
+#endif // CIPHER_ENGINE_HPP
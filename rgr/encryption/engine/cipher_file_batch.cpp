@@ -0,0 +1,341 @@
+//
+//  cipher_file_batch.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_file_batch.hpp"
+#include "../common/cipher_thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+namespace {
+
+using BatchClock = std::chrono::steady_clock;
+
+// Task queue drained by the batch workers, which run on the shared thread
+// pool. Tasks may queue more tasks; run() returns once the queue is empty
+// and no task is still running.
+class BatchWorkQueue {
+  public:
+    void push_back(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    // Used for the ranges of a split file so a started file finishes before
+    // new ones are opened.
+    void push_front(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_front(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    // The calling thread is one of the workers.
+    void run(unsigned int threads) {
+        cipher_thread_pool().parallel_for(
+            threads, [this](size_t) { work(); }, threads);
+    }
+
+  private:
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [&] { return !tasks_.empty() || running_ == 0; });
+            if (tasks_.empty()) {
+                cv_.notify_all();
+                return;
+            }
+            std::function<void()> task = std::move(tasks_.front());
+            tasks_.pop_front();
+            ++running_;
+            lock.unlock();
+            task();
+            lock.lock();
+            --running_;
+            cv_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    size_t running_ = 0;
+};
+
+struct BatchFile {
+    const CipherFileJob *job = nullptr;
+    CipherFileJobResult *result = nullptr;
+    uint64_t size = 0;
+    std::string temp_path;
+    BatchClock::time_point start;
+
+    // Split files only.
+    std::unique_ptr<CipherEngine> engine;
+    CipherFileSplit layout;
+    std::atomic<size_t> ranges_left{0};
+    std::mutex mutex;
+    std::string error;
+    bool cancelled = false;
+};
+
+bool batch_cancelled(const CipherFileBatchOptions &options) {
+    return options.progress && options.progress->cancelled();
+}
+
+// Moves the temporary output into place or discards it.
+void finish_file(BatchFile &file, bool success, bool cancelled,
+                 const std::string &message, uint64_t bytes_out) {
+    CipherFileJobResult &result = *file.result;
+    std::error_code ec;
+    if (success) {
+        std::filesystem::rename(file.temp_path, file.job->output_path, ec);
+        if (ec) {
+            success = false;
+            result.message = "Error renaming output file: " + ec.message();
+        }
+    }
+    if (!success) {
+        std::filesystem::remove(file.temp_path, ec);
+        if (result.message.empty()) {
+            result.message = message;
+        }
+    }
+    result.success = success;
+    result.cancelled = cancelled;
+    result.bytes_in = file.size;
+    result.bytes_out = success ? bytes_out : 0;
+    result.seconds =
+        std::chrono::duration<double>(BatchClock::now() - file.start).count();
+}
+
+void run_whole_file(const CipherEngine &prototype, BatchFile &file,
+                    const CipherFileBatchOptions &options) {
+    file.start = BatchClock::now();
+    if (batch_cancelled(options)) {
+        finish_file(file, false, true, "Operation cancelled.", 0);
+        return;
+    }
+    std::unique_ptr<CipherEngine> engine = prototype.clone();
+    CipherDriverOptions driver_options;
+    driver_options.chunk_size = options.chunk_size;
+    CipherDriverResult result = run_cipher_file(
+        *engine, file.job->input_path, file.temp_path, driver_options);
+    if (options.progress) {
+        options.progress->add_bytes(file.size);
+    }
+    finish_file(file, result.success, result.cancelled, result.message,
+                result.bytes_out);
+}
+
+void finish_split_range(BatchFile &file) {
+    if (file.ranges_left.fetch_sub(1) != 1) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(file.mutex);
+    finish_file(file, file.error.empty() && !file.cancelled, file.cancelled,
+                file.error, file.layout.output_size);
+}
+
+void run_split_range(BatchFile &file, uint64_t begin, uint64_t end,
+                     const CipherFileBatchOptions &options) {
+    bool skip = false;
+    {
+        std::lock_guard<std::mutex> lock(file.mutex);
+        skip = !file.error.empty() || file.cancelled;
+    }
+    if (skip) {
+        finish_split_range(file);
+        return;
+    }
+    std::string error;
+    bool cancelled = false;
+    try {
+        cipher_process_file_range(*file.engine, file.layout,
+                                  file.job->input_path, file.temp_path, begin,
+                                  end, options.chunk_size, options.progress);
+    } catch (const CipherCancelledError &e) {
+        cancelled = true;
+        error = e.what();
+    } catch (const std::exception &e) {
+        error = std::string("C++ Exception in cipher file batch: ") + e.what();
+    }
+    if (!error.empty()) {
+        std::lock_guard<std::mutex> lock(file.mutex);
+        file.cancelled = file.cancelled || cancelled;
+        if (file.error.empty()) {
+            file.error = error;
+        }
+    }
+    finish_split_range(file);
+}
+
+void start_split_file(const CipherEngine &prototype, BatchFile &file,
+                      const CipherFileBatchOptions &options,
+                      BatchWorkQueue &queue) {
+    file.start = BatchClock::now();
+    if (batch_cancelled(options)) {
+        finish_file(file, false, true, "Operation cancelled.", 0);
+        return;
+    }
+    try {
+        file.engine = prototype.clone();
+        file.layout = cipher_prepare_file_split(
+            *file.engine, file.job->input_path, file.temp_path, file.size);
+    } catch (const std::exception &e) {
+        finish_file(file, false, false,
+                    std::string("C++ Exception in cipher file batch: ") +
+                        e.what(),
+                    0);
+        return;
+    }
+    if (options.progress) {
+        options.progress->add_bytes(file.size - file.layout.body);
+    }
+    uint64_t range = cipher_aligned_chunk_size(
+        static_cast<size_t>(options.range_bytes), file.engine->block_size());
+    size_t ranges = static_cast<size_t>((file.layout.body + range - 1) / range);
+    if (ranges == 0) {
+        finish_file(file, true, false, "", file.layout.output_size);
+        return;
+    }
+    file.ranges_left = ranges;
+    for (size_t r = ranges; r-- > 0;) {
+        uint64_t begin = r * range;
+        uint64_t end = std::min(file.layout.body, begin + range);
+        queue.push_front([&file, begin, end, &options] {
+            run_split_range(file, begin, end, options);
+        });
+    }
+}
+
+std::string batch_temp_token() {
+    std::random_device rd;
+    std::ostringstream oss;
+    oss << std::hex << rd() << rd();
+    return oss.str();
+}
+
+} // namespace
+
+CipherFileBatchResult run_cipher_file_batch(const CipherEngine &prototype,
+                                            const std::vector<CipherFileJob> &jobs,
+                                            const CipherFileBatchOptions &options) {
+    BatchClock::time_point batch_start = BatchClock::now();
+    CipherFileBatchResult batch;
+    batch.files.resize(jobs.size());
+
+    unsigned int threads = options.threads;
+    if (threads == 0) {
+        threads = cipher_thread_pool().thread_count();
+    }
+    std::string token = batch_temp_token();
+    std::vector<std::unique_ptr<BatchFile>> files(jobs.size());
+    uint64_t total = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        files[i] = std::make_unique<BatchFile>();
+        BatchFile &file = *files[i];
+        file.job = &jobs[i];
+        file.result = &batch.files[i];
+        file.temp_path =
+            jobs[i].output_path + ".rgr-tmp-" + token + "-" + std::to_string(i);
+        std::error_code ec;
+        file.size = std::filesystem::file_size(jobs[i].input_path, ec);
+        if (ec) {
+            file.size = 0;
+        }
+        total += file.size;
+    }
+    if (options.progress) {
+        options.progress->set_total(total);
+    }
+
+    // Largest first, so the long files are not left for the end.
+    std::vector<size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return files[a]->size > files[b]->size;
+    });
+
+    BatchWorkQueue queue;
+    for (size_t i : order) {
+        BatchFile &file = *files[i];
+        std::error_code ec;
+        std::filesystem::path parent =
+            std::filesystem::path(file.job->output_path).parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent, ec);
+        }
+        bool split = threads > 1 && prototype.supports_seek() &&
+                     file.size >= options.split_min_bytes;
+        if (split) {
+            queue.push_back([&prototype, &file, &options, &queue] {
+                start_split_file(prototype, file, options, queue);
+            });
+        } else {
+            queue.push_back([&prototype, &file, &options] {
+                run_whole_file(prototype, file, options);
+            });
+        }
+    }
+    queue.run(threads);
+
+    for (const CipherFileJobResult &file : batch.files) {
+        if (file.success) {
+            ++batch.files_succeeded;
+        } else {
+            ++batch.files_failed;
+        }
+        batch.bytes_in += file.bytes_in;
+        batch.bytes_out += file.bytes_out;
+    }
+    batch.cancelled = batch_cancelled(options);
+    batch.success = batch.files_failed == 0 && !batch.cancelled;
+    batch.elapsed_seconds =
+        std::chrono::duration<double>(BatchClock::now() - batch_start).count();
+    if (batch.success && options.progress) {
+        options.progress->report();
+    }
+    return batch;
+}
+
+std::vector<CipherFileJob>
+cipher_file_jobs_from_directory(const std::string &input_dir,
+                                const std::string &output_dir,
+                                const std::string &output_suffix) {
+    std::vector<CipherFileJob> jobs;
+    std::filesystem::path root(input_dir);
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::filesystem::path relative =
+            entry.path().lexically_relative(root);
+        std::filesystem::path output = std::filesystem::path(output_dir) / relative;
+        output += output_suffix;
+        jobs.push_back({entry.path().string(), output.string()});
+    }
+    std::sort(jobs.begin(), jobs.end(),
+              [](const CipherFileJob &a, const CipherFileJob &b) {
+                  return a.input_path < b.input_path;
+              });
+    return jobs;
+}
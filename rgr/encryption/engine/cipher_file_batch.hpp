@@ -0,0 +1,79 @@
+//
+//  cipher_file_batch.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_FILE_BATCH_HPP
+#define CIPHER_FILE_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cipher_engine.hpp"
+
+// Files at least this large are split into range tasks when the engine
+// supports seeking; smaller ones are one task each.
+const uint64_t CIPHER_BATCH_SPLIT_MIN_BYTES = 8 << 20;
+// Body bytes per range task of a split file.
+const uint64_t CIPHER_BATCH_RANGE_BYTES = 4 << 20;
+
+struct CipherFileJob {
+    std::string input_path;
+    std::string output_path;
+};
+
+struct CipherFileJobResult {
+    bool success = false;
+    bool cancelled = false;
+    std::string message;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    double seconds = 0.0;
+};
+
+struct CipherFileBatchOptions {
+    // Threads of the shared cipher_thread_pool(); 0 means all of its
+    // workers.
+    unsigned int threads = 0;
+    size_t chunk_size = CIPHER_STREAM_CHUNK_BYTES;
+    uint64_t split_min_bytes = CIPHER_BATCH_SPLIT_MIN_BYTES;
+    uint64_t range_bytes = CIPHER_BATCH_RANGE_BYTES;
+    // Optional; its total is the sum of the input sizes. Cancelling stops
+    // scheduling new work and discards unfinished outputs.
+    CipherProgressToken *progress = nullptr;
+};
+
+// files[i] belongs to jobs[i]; success means every file succeeded.
+struct CipherFileBatchResult {
+    bool success = false;
+    bool cancelled = false;
+    std::vector<CipherFileJobResult> files;
+    size_t files_succeeded = 0;
+    size_t files_failed = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    double elapsed_seconds = 0.0;
+};
+
+// Runs every job on one worker pool with clones of prototype (an
+// initialised engine). Jobs are scheduled largest first; a large file is
+// split into range tasks that idle workers pick up alongside small files.
+// Each output is written to a temporary file next to it and renamed into
+// place only on success, so readers never see a partial output.
+CipherFileBatchResult run_cipher_file_batch(const CipherEngine &prototype,
+                                            const std::vector<CipherFileJob> &jobs,
+                                            const CipherFileBatchOptions &options = {});
+
+// One job per regular file under input_dir (recursively), writing to the
+// same relative path under output_dir with output_suffix appended.
+// Throws std::filesystem::filesystem_error if input_dir cannot be listed.
+std::vector<CipherFileJob>
+cipher_file_jobs_from_directory(const std::string &input_dir,
+                                const std::string &output_dir,
+                                const std::string &output_suffix = "");
+
+#endif // CIPHER_FILE_BATCH_HPP
@@ -0,0 +1,699 @@
+//
+//  cipher_file_pipeline.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_file_pipeline.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace {
+
+const size_t PIPELINE_BUFFER_ALIGNMENT = 4096;
+
+class FileDescriptor {
+  public:
+    explicit FileDescriptor(int fd) : fd_(fd) {}
+    ~FileDescriptor() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+    FileDescriptor(const FileDescriptor &) = delete;
+    FileDescriptor &operator=(const FileDescriptor &) = delete;
+    int get() const { return fd_; }
+
+  private:
+    int fd_;
+};
+
+void read_fully(int fd, unsigned char *buffer, size_t length,
+                uint64_t offset) {
+    while (length > 0) {
+        ssize_t n = ::pread(fd, buffer, length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("Error reading input file content.");
+        }
+        buffer += n;
+        length -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+void write_fully(int fd, const unsigned char *buffer, size_t length,
+                 uint64_t offset) {
+    while (length > 0) {
+        ssize_t n = ::pwrite(fd, buffer, length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("Error writing to output file.");
+        }
+        buffer += n;
+        length -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+size_t round_up_to_alignment(size_t size) {
+    return (size + PIPELINE_BUFFER_ALIGNMENT - 1) / PIPELINE_BUFFER_ALIGNMENT *
+           PIPELINE_BUFFER_ALIGNMENT;
+}
+
+// slots input buffers followed by slots output buffers, page aligned and in
+// one allocation so the whole pool can be registered with a ring.
+class BufferPool {
+  public:
+    BufferPool(size_t slots, size_t input_size, size_t output_size)
+        : slots_(slots), input_size_(round_up_to_alignment(input_size)),
+          output_size_(round_up_to_alignment(output_size)),
+          memory_(static_cast<unsigned char *>(std::aligned_alloc(
+              PIPELINE_BUFFER_ALIGNMENT,
+              slots * (input_size_ + output_size_)))) {
+        if (!memory_) {
+            throw std::bad_alloc();
+        }
+    }
+
+    size_t slots() const { return slots_; }
+    size_t buffer_count() const { return 2 * slots_; }
+    // Buffer index i in registration order (inputs first).
+    unsigned char *buffer(size_t i) const {
+        return i < slots_ ? input(i) : output(i - slots_);
+    }
+    size_t buffer_size(size_t i) const {
+        return i < slots_ ? input_size_ : output_size_;
+    }
+    unsigned char *input(size_t slot) const {
+        return memory_.get() + slot * input_size_;
+    }
+    unsigned char *output(size_t slot) const {
+        return memory_.get() + slots_ * input_size_ + slot * output_size_;
+    }
+
+  private:
+    struct FreeDeleter {
+        void operator()(unsigned char *p) const { std::free(p); }
+    };
+    size_t slots_;
+    size_t input_size_;
+    size_t output_size_;
+    std::unique_ptr<unsigned char, FreeDeleter> memory_;
+};
+
+// Positional I/O on pool slots. Each slot has at most one read and one
+// write outstanding; wait_*() rethrow the first I/O failure.
+class PipelineIo {
+  public:
+    virtual ~PipelineIo() = default;
+    virtual void submit_read(size_t slot, uint64_t offset, size_t length) = 0;
+    virtual void submit_write(size_t slot, uint64_t offset, size_t length) = 0;
+    virtual void wait_read(size_t slot) = 0;
+    virtual void wait_write(size_t slot) = 0;
+};
+
+// Fallback backend: one reader and one writer thread doing pread/pwrite.
+class ThreadedPipelineIo : public PipelineIo {
+  public:
+    ThreadedPipelineIo(int input_fd, int output_fd, const BufferPool &pool)
+        : input_fd_(input_fd), output_fd_(output_fd), pool_(pool) {
+        reads_.pending.assign(pool.slots(), false);
+        writes_.pending.assign(pool.slots(), false);
+        reads_.thread = std::thread([this] { run(reads_, false); });
+        writes_.thread = std::thread([this] { run(writes_, true); });
+    }
+
+    ~ThreadedPipelineIo() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        reads_.thread.join();
+        writes_.thread.join();
+    }
+
+    void submit_read(size_t slot, uint64_t offset, size_t length) override {
+        submit(reads_, slot, offset, length);
+    }
+    void submit_write(size_t slot, uint64_t offset, size_t length) override {
+        submit(writes_, slot, offset, length);
+    }
+    void wait_read(size_t slot) override { wait(reads_, slot); }
+    void wait_write(size_t slot) override { wait(writes_, slot); }
+
+  private:
+    struct Op {
+        size_t slot;
+        uint64_t offset;
+        size_t length;
+    };
+    struct Lane {
+        std::deque<Op> queue;
+        std::vector<bool> pending;
+        std::string error;
+        std::thread thread;
+    };
+
+    void submit(Lane &lane, size_t slot, uint64_t offset, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            lane.pending[slot] = true;
+            lane.queue.push_back({slot, offset, length});
+        }
+        cv_.notify_all();
+    }
+
+    void wait(Lane &lane, size_t slot) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return !lane.pending[slot]; });
+        if (!lane.error.empty()) {
+            throw std::runtime_error(lane.error);
+        }
+    }
+
+    // Queued operations are finished even when stopping, so the pool is
+    // never released under an in-flight transfer.
+    void run(Lane &lane, bool write) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [&] { return stopping_ || !lane.queue.empty(); });
+            if (lane.queue.empty()) {
+                return;
+            }
+            Op op = lane.queue.front();
+            lane.queue.pop_front();
+            lock.unlock();
+            std::string error;
+            try {
+                if (write) {
+                    write_fully(output_fd_, pool_.output(op.slot), op.length,
+                                op.offset);
+                } else {
+                    read_fully(input_fd_, pool_.input(op.slot), op.length,
+                               op.offset);
+                }
+            } catch (const std::exception &e) {
+                error = e.what();
+            }
+            lock.lock();
+            if (!error.empty() && lane.error.empty()) {
+                lane.error = error;
+            }
+            lane.pending[op.slot] = false;
+            cv_.notify_all();
+        }
+    }
+
+    int input_fd_;
+    int output_fd_;
+    const BufferPool &pool_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    Lane reads_;
+    Lane writes_;
+};
+
+#ifdef __linux__
+int io_uring_setup_syscall(unsigned entries, io_uring_params *params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+// Rings exist since Linux 5.1, IORING_OP_READ/WRITE and the probe since 5.6;
+// on a kernel in between the probe itself fails.
+bool io_uring_ring_supports_read_write(int ring_fd) {
+    const unsigned ops = 256;
+    std::vector<uint64_t> buffer(
+        (sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op) + 7) / 8, 0);
+    io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+    if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe,
+                  ops) != 0) {
+        return false;
+    }
+    auto supported = [&](unsigned op) {
+        return op <= probe->last_op &&
+               (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    };
+    return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+}
+
+// io_uring backend over raw syscalls (no liburing). The pool is registered
+// as fixed buffers when the memlock limit allows it; otherwise plain
+// READ/WRITE opcodes are used on the same buffers, and a kernel without them
+// gets no ring at all.
+class IoUringPipelineIo : public PipelineIo {
+  public:
+    static std::unique_ptr<IoUringPipelineIo>
+    create(int input_fd, int output_fd, const BufferPool &pool) {
+        std::unique_ptr<IoUringPipelineIo> io(
+            new IoUringPipelineIo(input_fd, output_fd, pool));
+        if (!io->setup()) {
+            return nullptr;
+        }
+        return io;
+    }
+
+    ~IoUringPipelineIo() override {
+        if (sqes_ != MAP_FAILED) {
+            drain();
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != MAP_FAILED) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+        }
+    }
+
+    void submit_read(size_t slot, uint64_t offset, size_t length) override {
+        start(reads_[slot], false, slot, offset, length);
+    }
+    void submit_write(size_t slot, uint64_t offset, size_t length) override {
+        start(writes_[slot], true, slot, offset, length);
+    }
+    void wait_read(size_t slot) override { wait(reads_[slot]); }
+    void wait_write(size_t slot) override { wait(writes_[slot]); }
+
+  private:
+    struct Op {
+        bool pending = false;
+        uint64_t offset = 0;
+        size_t length = 0;
+        size_t done = 0;
+    };
+
+    IoUringPipelineIo(int input_fd, int output_fd, const BufferPool &pool)
+        : input_fd_(input_fd), output_fd_(output_fd), pool_(pool),
+          reads_(pool.slots()), writes_(pool.slots()) {}
+
+    bool setup() {
+        // Every slot can have a read and a write in flight at once.
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = io_uring_setup_syscall(
+            static_cast<unsigned>(pool_.buffer_count()), &params);
+        if (ring_fd_ < 0) {
+            return false;
+        }
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd_,
+                          IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            return false;
+        }
+        cq_ring_ = single_mmap
+                       ? sq_ring_
+                       : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            return false;
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd_,
+                            IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = sqes;
+
+        unsigned char *sq = static_cast<unsigned char *>(sq_ring_);
+        unsigned char *cq = static_cast<unsigned char *>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        std::vector<iovec> iovecs(pool_.buffer_count());
+        for (size_t i = 0; i < iovecs.size(); ++i) {
+            iovecs[i].iov_base = pool_.buffer(i);
+            iovecs[i].iov_len = pool_.buffer_size(i);
+        }
+        registered_ =
+            ::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS,
+                      iovecs.data(), static_cast<unsigned>(iovecs.size())) == 0;
+        return registered_ || io_uring_ring_supports_read_write(ring_fd_);
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        while (true) {
+            long ret = ::syscall(__NR_io_uring_enter, ring_fd_, to_submit,
+                                 min_complete, flags, nullptr, 0);
+            if (ret >= 0) {
+                return static_cast<int>(ret);
+            }
+            if (errno != EINTR) {
+                throw std::runtime_error(std::string("io_uring_enter failed: ") +
+                                         std::strerror(errno));
+            }
+        }
+    }
+
+    void start(Op &op, bool write, size_t slot, uint64_t offset,
+               size_t length) {
+        if (length == 0) {
+            return;
+        }
+        op.pending = true;
+        op.offset = offset;
+        op.length = length;
+        op.done = 0;
+        queue(op, write, slot);
+    }
+
+    // Pushes one SQE for the part of op not yet transferred and submits it.
+    void queue(const Op &op, bool write, size_t slot) {
+        io_uring_sqe *sqes = static_cast<io_uring_sqe *>(sqes_);
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & sq_mask_;
+        io_uring_sqe &sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        if (registered_) {
+            sqe.opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe.buf_index =
+                static_cast<uint16_t>(write ? pool_.slots() + slot : slot);
+        } else {
+            sqe.opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        }
+        unsigned char *buffer = write ? pool_.output(slot) : pool_.input(slot);
+        sqe.fd = write ? output_fd_ : input_fd_;
+        sqe.off = op.offset + op.done;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer + op.done);
+        sqe.len = static_cast<uint32_t>(op.length - op.done);
+        sqe.user_data = slot * 2 + (write ? 1 : 0);
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        enter(1, 0, 0);
+    }
+
+    // Consumes available completions, blocking for at least one first.
+    void reap() {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            enter(0, 1, IORING_ENTER_GETEVENTS);
+        }
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+            size_t slot = static_cast<size_t>(cqe.user_data / 2);
+            bool write = (cqe.user_data & 1) != 0;
+            complete(write ? writes_[slot] : reads_[slot], write, slot,
+                     cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+    void complete(Op &op, bool write, size_t slot, int res) {
+        if (res <= 0) {
+            if (error_.empty()) {
+                error_ = write ? "Error writing to output file."
+                               : "Error reading input file content.";
+            }
+            op.pending = false;
+            return;
+        }
+        op.done += static_cast<size_t>(res);
+        if (op.done < op.length) {
+            queue(op, write, slot); // short transfer
+        } else {
+            op.pending = false;
+        }
+    }
+
+    void wait(const Op &op) {
+        while (op.pending) {
+            reap();
+        }
+        if (!error_.empty()) {
+            throw std::runtime_error(error_);
+        }
+    }
+
+    void drain() noexcept {
+        try {
+            for (const std::vector<Op> *ops : {&reads_, &writes_}) {
+                for (const Op &op : *ops) {
+                    while (op.pending) {
+                        reap();
+                    }
+                }
+            }
+        } catch (...) {
+        }
+    }
+
+    int input_fd_;
+    int output_fd_;
+    const BufferPool &pool_;
+    std::vector<Op> reads_;
+    std::vector<Op> writes_;
+    std::string error_;
+    bool registered_ = false;
+
+    int ring_fd_ = -1;
+    void *sq_ring_ = MAP_FAILED;
+    void *cq_ring_ = MAP_FAILED;
+    void *sqes_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+};
+#endif // __linux__
+
+std::unique_ptr<PipelineIo> make_pipeline_io(CipherIoBackend backend,
+                                             int input_fd, int output_fd,
+                                             const BufferPool &pool) {
+#ifdef __linux__
+    if (backend == CipherIoBackend::IoUring ||
+        backend == CipherIoBackend::Auto) {
+        std::unique_ptr<IoUringPipelineIo> ring =
+            IoUringPipelineIo::create(input_fd, output_fd, pool);
+        if (ring) {
+            return ring;
+        }
+    }
+#else
+    (void)backend;
+#endif
+    return std::make_unique<ThreadedPipelineIo>(input_fd, output_fd, pool);
+}
+
+} // namespace
+
+bool cipher_io_uring_available() {
+#ifdef __linux__
+    static const bool available = [] {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = io_uring_setup_syscall(2, &params);
+        if (fd < 0) {
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+bool cipher_io_uring_read_write_available() {
+#ifdef __linux__
+    static const bool available = [] {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = io_uring_setup_syscall(2, &params);
+        if (fd < 0) {
+            return false;
+        }
+        bool supported = io_uring_ring_supports_read_write(fd);
+        ::close(fd);
+        return supported;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+CipherDriverResult run_cipher_file_pipeline(CipherEngine &engine,
+                                            const std::string &inputFilePath,
+                                            const std::string &outputFilePath,
+                                            const CipherDriverOptions &options) {
+    CipherDriverResult result;
+    const CipherInstrAlgorithm algorithm = engine.instrumentation_algorithm();
+    CIPHER_INSTR_CALL(algorithm);
+    try {
+        FileDescriptor input(::open(inputFilePath.c_str(), O_RDONLY | O_CLOEXEC));
+        struct stat input_stat;
+        if (input.get() < 0 || ::fstat(input.get(), &input_stat) != 0) {
+            result.message = "Error opening input file: " + inputFilePath;
+            return result;
+        }
+        uint64_t file_size = static_cast<uint64_t>(input_stat.st_size);
+        FileDescriptor output(::open(outputFilePath.c_str(),
+                                     O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                     0644));
+        if (output.get() < 0) {
+            result.message = "Error opening output file: " + outputFilePath;
+            return result;
+        }
+        if (options.progress) {
+            options.progress->set_total(file_size);
+        }
+
+        size_t block_size = engine.block_size();
+        size_t chunk_size =
+            cipher_aligned_chunk_size(options.chunk_size, block_size);
+        std::vector<unsigned char> header(engine.header_size());
+        uint64_t header_in = 0;
+        uint64_t out_pos = 0;
+        if (engine.direction() == CipherDirection::Encrypt) {
+            engine.write_header(header.data());
+            write_fully(output.get(), header.data(), header.size(), 0);
+            out_pos = header.size();
+        } else {
+            if (file_size < header.size()) {
+                result.message = "Error reading header from input file "
+                                 "(file too short or read error).";
+                return result;
+            }
+            read_fully(input.get(), header.data(), header.size(), 0);
+            engine.read_header(header.data());
+            header_in = header.size();
+        }
+
+        CipherPayloadSplit split =
+            cipher_split_payload(engine, file_size - header_in);
+        std::vector<unsigned char> tail(static_cast<size_t>(split.tail));
+        read_fully(input.get(), tail.data(), tail.size(),
+                   header_in + split.body);
+
+        uint64_t chunks = (split.body + chunk_size - 1) / chunk_size;
+        if (chunks > 0) {
+            size_t slots = static_cast<size_t>(std::min<uint64_t>(
+                std::max(1u, options.queue_depth), chunks));
+            BufferPool pool(slots, chunk_size, engine.max_output_size(chunk_size));
+            CIPHER_INSTR_ALLOC(algorithm, 1);
+            std::unique_ptr<PipelineIo> io = make_pipeline_io(
+                options.io_backend, input.get(), output.get(), pool);
+
+            auto chunk_offset = [&](uint64_t i) { return i * chunk_size; };
+            auto chunk_length = [&](uint64_t i) {
+                return static_cast<size_t>(std::min<uint64_t>(
+                    chunk_size, split.body - chunk_offset(i)));
+            };
+            for (uint64_t i = 0; i < slots; ++i) {
+                io->submit_read(static_cast<size_t>(i),
+                                header_in + chunk_offset(i), chunk_length(i));
+            }
+            for (uint64_t i = 0; i < chunks; ++i) {
+                size_t slot = static_cast<size_t>(i % slots);
+                size_t length = chunk_length(i);
+                {
+                    // Only the time spent stalled on the disk shows up here.
+                    CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Read,
+                                       length);
+                    io->wait_read(slot);
+                }
+                if (i >= slots) {
+                    CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Write, 0);
+                    io->wait_write(slot);
+                }
+                size_t written = 0;
+                {
+                    CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Kernel,
+                                       length);
+                    written = engine.process(pool.input(slot), length,
+                                             pool.output(slot));
+                }
+                io->submit_write(slot, out_pos, written);
+                out_pos += written;
+                if (i + slots < chunks) {
+                    io->submit_read(slot, header_in + chunk_offset(i + slots),
+                                    chunk_length(i + slots));
+                }
+                cipher_progress_step(options.progress, length);
+            }
+            for (size_t slot = 0; slot < slots; ++slot) {
+                io->wait_write(slot);
+            }
+        }
+
+        std::vector<unsigned char> tail_out(engine.max_output_size(tail.size()));
+        {
+            CIPHER_INSTR_SCOPE(algorithm, CipherInstrStage::Padding,
+                               tail.size());
+            tail_out.resize(
+                engine.finalize(tail.data(), tail.size(), tail_out.data()));
+        }
+        write_fully(output.get(), tail_out.data(), tail_out.size(), out_pos);
+        if (options.progress) {
+            options.progress->add_bytes(header_in + tail.size());
+        }
+        result.bytes_in = file_size;
+        result.bytes_out = out_pos + tail_out.size();
+        result.success = true;
+    } catch (const CipherCancelledError &e) {
+        result.cancelled = true;
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.message =
+            std::string("C++ Exception in cipher file pipeline: ") + e.what();
+    }
+    return result;
+}
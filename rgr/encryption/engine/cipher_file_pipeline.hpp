@@ -0,0 +1,34 @@
+//
+//  cipher_file_pipeline.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_FILE_PIPELINE_HPP
+#define CIPHER_FILE_PIPELINE_HPP
+
+#include <string>
+
+#include "cipher_engine.hpp"
+
+// True when the running kernel accepts io_uring rings (always false off
+// Linux). Probed once per process.
+bool cipher_io_uring_available();
+// True when, in addition, rings take IORING_OP_READ and IORING_OP_WRITE
+// (Linux 5.6 and later), which unregistered buffers need.
+bool cipher_io_uring_read_write_available();
+
+// Overlapped read -> process -> write pass over one file pair. Up to
+// options.queue_depth reads and writes stay in flight over a fixed pool of
+// chunk buffers while the engine runs on the calling thread, so the disk
+// and the cipher work at the same time. With CipherIoBackend::IoUring (or
+// Auto) the pool is registered with an io_uring ring; when no ring can be
+// set up, or the kernel can neither register the pool nor do plain
+// READ/WRITE, a reader and a writer thread do positional I/O instead.
+CipherDriverResult run_cipher_file_pipeline(CipherEngine &engine,
+                                            const std::string &inputFilePath,
+                                            const std::string &outputFilePath,
+                                            const CipherDriverOptions &options);
+
+#endif // CIPHER_FILE_PIPELINE_HPP
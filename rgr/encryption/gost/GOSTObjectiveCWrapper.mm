@@ -6,52 +6,92 @@
 //
 
 #import "GOSTObjectiveCWrapper.h"
-#include "gost.hpp"
+#include "../capi/rgr_crypto.h"
 
-#import <iomanip>
-#import <sstream>
-#import <string>
-#import <vector>
+// Thin shim over the C ABI in rgr_crypto.h: hex strings are decoded into
+// NSData once and the core works on those buffers directly.
 
-static std::string NSStringToStdString(NSString *nsString) {
-    if (nsString == nil) {
-        return "";
+typedef int (^RgrOutputCall)(uint8_t *out, size_t capacity, size_t *length);
+
+// Runs call once as a size query and once into a buffer of that size;
+// returns nil with *status set on failure.
+static NSData *RunWithOutput(RgrOutputCall call, int *status) {
+    size_t length = 0;
+    *status = call(NULL, 0, &length);
+    if (*status == RGR_OK) {
+        return [NSData data];
+    }
+    if (*status != RGR_ERR_BUFFER_TOO_SMALL) {
+        return nil;
+    }
+    NSMutableData *output = [NSMutableData dataWithLength:length];
+    *status = call((uint8_t *)output.mutableBytes, length, &length);
+    if (*status != RGR_OK) {
+        return nil;
     }
-    return std::string([nsString UTF8String]);
+    output.length = length;
+    return output;
+}
+
+static NSString *LastError(void) {
+    return [NSString stringWithUTF8String:rgr_last_error()];
 }
 
-static NSString *StdStringToNSString(const std::string &stdString) {
-    return [NSString stringWithUTF8String:stdString.c_str()];
+static NSString *HexStringFromBytes(const uint8_t *bytes, size_t length) {
+    NSMutableData *text = [NSMutableData dataWithLength:length * 2];
+    size_t text_length = 0;
+    rgr_text_encode(RGR_TEXT_HEX, bytes, length, (char *)text.mutableBytes,
+                    text.length, &text_length);
+    return [[NSString alloc] initWithBytes:text.bytes
+                                    length:text_length
+                                  encoding:NSASCIIStringEncoding];
+}
+
+// nil when hex is not a valid even-length hex string.
+static NSData *BytesFromHexString(NSString *hex) {
+    const char *text = [hex UTF8String];
+    size_t text_length = strlen(text);
+    NSMutableData *bytes = [NSMutableData dataWithLength:text_length / 2];
+    size_t length = 0;
+    if (rgr_text_decode(RGR_TEXT_HEX, text, text_length,
+                        (uint8_t *)bytes.mutableBytes, bytes.length,
+                        &length) != RGR_OK) {
+        return nil;
+    }
+    bytes.length = length;
+    return bytes;
+}
+
+static NSString *RandomHexString(size_t length) {
+    NSMutableData *bytes = [NSMutableData dataWithLength:length];
+    if (rgr_random_bytes((uint8_t *)bytes.mutableBytes, length) != RGR_OK) {
+        return nil;
+    }
+    return HexStringFromBytes((const uint8_t *)bytes.bytes, length);
+}
+
+static const char *FileSystemPath(NSString *path) {
+    return [path fileSystemRepresentation];
 }
 
 @implementation GOSTObjectiveCWrapper
 
 - (NSString *)generateGOSTKeyHex {
-    try {
-        std::vector<unsigned char> key_bytes;
-        generateRandomBytes(key_bytes, GOST_KEY_SIZE_BYTES);
-        return StdStringToNSString(bytesToHexString(key_bytes));
-    } catch (const std::exception &e) {
+    NSString *key = RandomHexString(RGR_GOST_KEY_BYTES);
+    if (key == nil) {
         return [NSString
-            stringWithFormat:@"Error: C++ Exception during key generation - %s",
-                             e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during key generation.";
+            stringWithFormat:@"Error: Key generation failed - %@", LastError()];
     }
+    return key;
 }
 
 - (NSString *)generateGOSTIvHex {
-    try {
-        std::vector<unsigned char> iv_bytes;
-        generateRandomBytes(iv_bytes, GOST_IV_SIZE_BYTES);
-        return StdStringToNSString(bytesToHexString(iv_bytes));
-    } catch (const std::exception &e) {
+    NSString *iv = RandomHexString(RGR_GOST_IV_BYTES);
+    if (iv == nil) {
         return [NSString
-            stringWithFormat:@"Error: C++ Exception during IV generation - %s",
-                             e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during IV generation.";
+            stringWithFormat:@"Error: IV generation failed - %@", LastError()];
     }
+    return iv;
 }
 
 - (NSString *)encryptTextGOST:(NSString *)plaintext
@@ -60,45 +100,49 @@ static NSString *StdStringToNSString(const std::string &stdString) {
     if (plaintext == nil || keyHex == nil) {
         return @"Error: Plaintext and KeyHex parameters cannot be nil.";
     }
-    if ([plaintext length] == 0) {
-    }
-    if ([keyHex length] != GOST_KEY_SIZE_BYTES * 2) {
+    if ([keyHex length] != RGR_GOST_KEY_BYTES * 2) {
         return [NSString
             stringWithFormat:@"Error: KeyHex must be %u characters long.",
-                             GOST_KEY_SIZE_BYTES * 2];
+                             RGR_GOST_KEY_BYTES * 2];
     }
     if (initialIvHex != nil && [initialIvHex length] > 0 &&
-        [initialIvHex length] != GOST_IV_SIZE_BYTES * 2) {
+        [initialIvHex length] != RGR_GOST_IV_BYTES * 2) {
         return [NSString
             stringWithFormat:
                 @"Error: If provided, InitialIvHex must be %u characters long.",
-                GOST_IV_SIZE_BYTES * 2];
+                RGR_GOST_IV_BYTES * 2];
     }
 
-    try {
-        std::string std_plaintext = NSStringToStdString(plaintext);
-        std::string std_key_hex = NSStringToStdString(keyHex);
-        std::string std_initial_iv_hex =
-            (initialIvHex != nil) ? NSStringToStdString(initialIvHex) : "";
-
-        GostEncryptedTextResult cpp_result =
-            encryptTextGOST(std_plaintext, std_key_hex, std_initial_iv_hex);
-
-        if (cpp_result.success) {
-            return StdStringToNSString(cpp_result.iv_hex + ":" +
-                                       cpp_result.ciphertext_hex);
-        } else {
-            return [NSString stringWithFormat:@"Error: Encryption failed - %s",
-                                              cpp_result.error_message.c_str()];
-        }
+    NSData *key = BytesFromHexString(keyHex);
+    NSData *iv = [initialIvHex length] > 0 ? BytesFromHexString(initialIvHex)
+                                           : [NSData data];
+    if (key == nil || iv == nil) {
+        return @"Error: Encryption failed - Invalid character in hex string.";
+    }
+    NSData *input = [plaintext dataUsingEncoding:NSUTF8StringEncoding];
 
-    } catch (const std::exception &e) {
+    int status = RGR_OK;
+    NSData *output = RunWithOutput(
+        ^int(uint8_t *out, size_t capacity, size_t *length) {
+          return rgr_gost_encrypt(
+              (const uint8_t *)key.bytes, key.length,
+              (const uint8_t *)iv.bytes, iv.length,
+              (const uint8_t *)input.bytes, input.length, out, capacity,
+              length);
+        },
+        &status);
+    if (output == nil) {
         return [NSString
-            stringWithFormat:
-                @"Error: C++ Exception during text encryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during text encryption.";
+            stringWithFormat:@"Error: Encryption failed - %@", LastError()];
     }
+
+    const uint8_t *bytes = (const uint8_t *)output.bytes;
+    return [NSString
+        stringWithFormat:@"%@:%@",
+                         HexStringFromBytes(bytes, RGR_GOST_IV_BYTES),
+                         HexStringFromBytes(bytes + RGR_GOST_IV_BYTES,
+                                            output.length -
+                                                RGR_GOST_IV_BYTES)];
 }
 
 - (NSString *)decryptTextGOST:(NSString *)combinedIvCiphertextHex
@@ -110,10 +154,10 @@ static NSString *StdStringToNSString(const std::string &stdString) {
     if ([combinedIvCiphertextHex length] == 0) {
         return @"Error: CombinedIVCiphertextHex cannot be empty.";
     }
-    if ([keyHex length] != GOST_KEY_SIZE_BYTES * 2) {
+    if ([keyHex length] != RGR_GOST_KEY_BYTES * 2) {
         return [NSString
             stringWithFormat:@"Error: KeyHex must be %u characters long.",
-                             GOST_KEY_SIZE_BYTES * 2];
+                             RGR_GOST_KEY_BYTES * 2];
     }
 
     NSArray<NSString *> *parts =
@@ -122,38 +166,39 @@ static NSString *StdStringToNSString(const std::string &stdString) {
         return @"Error: combinedIvCiphertextHex format is invalid. Expected "
                @"'ivHex:ciphertextHex'.";
     }
-    NSString *ivHexStr = parts[0];
-    NSString *ciphertextHexStr = parts[1];
-
-    if ([ivHexStr length] != GOST_IV_SIZE_BYTES * 2) {
+    if ([parts[0] length] != RGR_GOST_IV_BYTES * 2) {
         return [NSString
             stringWithFormat:
                 @"Error: IV part of combined string must be %u hex characters.",
-                GOST_IV_SIZE_BYTES * 2];
+                RGR_GOST_IV_BYTES * 2];
     }
 
-    try {
-        std::string std_iv_hex = NSStringToStdString(ivHexStr);
-        std::string std_ciphertext_hex = NSStringToStdString(ciphertextHexStr);
-        std::string std_key_hex = NSStringToStdString(keyHex);
-
-        GostDecryptedTextResult cpp_result =
-            decryptTextGOST(std_iv_hex, std_ciphertext_hex, std_key_hex);
-
-        if (cpp_result.success) {
-            return StdStringToNSString(cpp_result.plaintext);
-        } else {
-            return [NSString stringWithFormat:@"Error: Decryption failed - %s",
-                                              cpp_result.error_message.c_str()];
-        }
+    // IV || ciphertext is exactly the two hex parts back to back.
+    NSData *key = BytesFromHexString(keyHex);
+    NSData *input =
+        BytesFromHexString([parts[0] stringByAppendingString:parts[1]]);
+    if (key == nil || input == nil) {
+        return @"Error: Decryption failed - Invalid character in hex string.";
+    }
 
-    } catch (const std::exception &e) {
+    int status = RGR_OK;
+    NSData *output = RunWithOutput(
+        ^int(uint8_t *out, size_t capacity, size_t *length) {
+          return rgr_gost_decrypt((const uint8_t *)key.bytes, key.length,
+                                  (const uint8_t *)input.bytes, input.length,
+                                  out, capacity, length);
+        },
+        &status);
+    if (output == nil) {
         return [NSString
-            stringWithFormat:
-                @"Error: C++ Exception during text decryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during text decryption.";
+            stringWithFormat:@"Error: Decryption failed - %@", LastError()];
     }
+    NSString *plaintext = [[NSString alloc] initWithData:output
+                                                encoding:NSUTF8StringEncoding];
+    if (plaintext == nil) {
+        return @"Error: Decryption failed - Decrypted data is not valid UTF-8.";
+    }
+    return plaintext;
 }
 
 - (NSString *)encryptFileGOST:(NSString *)inputFilePath
@@ -170,47 +215,40 @@ static NSString *StdStringToNSString(const std::string &stdString) {
         return @"Error: InputFilePath, OutputFilePath, and KeyHex parameters "
                @"cannot be empty strings for file encryption.";
     }
-    if ([keyHex length] != GOST_KEY_SIZE_BYTES * 2) {
+    if ([keyHex length] != RGR_GOST_KEY_BYTES * 2) {
         return [NSString
             stringWithFormat:@"Error: KeyHex must be %u characters long.",
-                             GOST_KEY_SIZE_BYTES * 2];
+                             RGR_GOST_KEY_BYTES * 2];
     }
     if (initialIvHex != nil && [initialIvHex length] > 0 &&
-        [initialIvHex length] != GOST_IV_SIZE_BYTES * 2) {
+        [initialIvHex length] != RGR_GOST_IV_BYTES * 2) {
         return [NSString
             stringWithFormat:
                 @"Error: If provided, InitialIvHex must be %u characters long.",
-                GOST_IV_SIZE_BYTES * 2];
+                RGR_GOST_IV_BYTES * 2];
     }
 
-    try {
-        std::string std_input_path = NSStringToStdString(inputFilePath);
-        std::string std_output_path = NSStringToStdString(outputFilePath);
-        std::string std_key_hex = NSStringToStdString(keyHex);
-        std::string std_initial_iv_hex =
-            (initialIvHex != nil) ? NSStringToStdString(initialIvHex) : "";
-
-        GostFileOperationResult cpp_fres = encryptFileGOST(
-            std_input_path, std_output_path, std_key_hex, std_initial_iv_hex);
-
-        if (cpp_fres.success) {
-            return [NSString
-                stringWithFormat:@"Success: File '%@' encrypted. IV Used: %s",
-                                 [outputFilePath lastPathComponent],
-                                 cpp_fres.used_iv_hex.c_str()];
-        } else {
-            return [NSString
-                stringWithFormat:@"Error: File encryption failed - %s",
-                                 cpp_fres.message.c_str()];
-        }
+    NSData *key = BytesFromHexString(keyHex);
+    NSData *iv = [initialIvHex length] > 0 ? BytesFromHexString(initialIvHex)
+                                           : [NSData data];
+    if (key == nil || iv == nil) {
+        return @"Error: File encryption failed - Invalid character in hex "
+               @"string.";
+    }
 
-    } catch (const std::exception &e) {
-        return [NSString
-            stringWithFormat:
-                @"Error: C++ Exception during file encryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during file encryption.";
+    uint8_t used_iv[RGR_GOST_IV_BYTES];
+    int status = rgr_gost_encrypt_file(
+        FileSystemPath(inputFilePath), FileSystemPath(outputFilePath),
+        (const uint8_t *)key.bytes, key.length, (const uint8_t *)iv.bytes,
+        iv.length, 0, used_iv);
+    if (status != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: File encryption failed - %@",
+                                          LastError()];
     }
+    return [NSString
+        stringWithFormat:@"Success: File '%@' encrypted. IV Used: %@",
+                         [outputFilePath lastPathComponent],
+                         HexStringFromBytes(used_iv, RGR_GOST_IV_BYTES)];
 }
 
 - (NSString *)decryptFileGOST:(NSString *)inputFilePath
@@ -225,38 +263,31 @@ static NSString *StdStringToNSString(const std::string &stdString) {
         return @"Error: InputFilePath, OutputFilePath, and KeyHex parameters "
                @"cannot be empty strings for file decryption.";
     }
-    if ([keyHex length] != GOST_KEY_SIZE_BYTES * 2) {
+    if ([keyHex length] != RGR_GOST_KEY_BYTES * 2) {
         return [NSString
             stringWithFormat:@"Error: KeyHex must be %u characters long.",
-                             GOST_KEY_SIZE_BYTES * 2];
+                             RGR_GOST_KEY_BYTES * 2];
     }
 
-    try {
-        std::string std_input_path = NSStringToStdString(inputFilePath);
-        std::string std_output_path = NSStringToStdString(outputFilePath);
-        std::string std_key_hex = NSStringToStdString(keyHex);
-
-        GostFileOperationResult cpp_fres =
-            decryptFileGOST(std_input_path, std_output_path, std_key_hex);
+    NSData *key = BytesFromHexString(keyHex);
+    if (key == nil) {
+        return @"Error: File decryption failed - Invalid character in hex "
+               @"string.";
+    }
 
-        if (cpp_fres.success) {
-            return
-                [NSString stringWithFormat:@"Success: File '%@' decrypted. IV "
-                                           @"Used (read from file): %s",
-                                           [outputFilePath lastPathComponent],
-                                           cpp_fres.used_iv_hex.c_str()];
-        } else {
-            return [NSString
-                stringWithFormat:@"Error: File decryption failed - %s",
-                                 cpp_fres.message.c_str()];
-        }
-    } catch (const std::exception &e) {
-        return [NSString
-            stringWithFormat:
-                @"Error: C++ Exception during file decryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during file decryption.";
+    uint8_t used_iv[RGR_GOST_IV_BYTES];
+    int status = rgr_gost_decrypt_file(
+        FileSystemPath(inputFilePath), FileSystemPath(outputFilePath),
+        (const uint8_t *)key.bytes, key.length, used_iv);
+    if (status != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: File decryption failed - %@",
+                                          LastError()];
     }
+    return [NSString stringWithFormat:@"Success: File '%@' decrypted. IV "
+                                      @"Used (read from file): %@",
+                                      [outputFilePath lastPathComponent],
+                                      HexStringFromBytes(used_iv,
+                                                         RGR_GOST_IV_BYTES)];
 }
 
 @end
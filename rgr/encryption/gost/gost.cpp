@@ -6,11 +6,14 @@
 //
 
 #include "gost.hpp"
+#include "../common/cipher_random.hpp"
+#include "../container/cipher_container.hpp"
+#include "gost_sbox.hpp"
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <random>
 #include <sstream>
 std::vector<unsigned char> hexStringToBytes(const std::string &hex) {
     if (hex.length() % 2 != 0) {
@@ -47,12 +50,7 @@ std::string bytesToHexString(const std::vector<unsigned char> &bytes) {
 
 void generateRandomBytes(std::vector<unsigned char> &buffer, size_t length) {
     buffer.resize(length);
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(0, 255);
-    for (size_t i = 0; i < length; ++i) {
-        buffer[i] = static_cast<unsigned char>(distrib(gen));
-    }
+    cipher_random_fill(buffer.data(), length);
 }
 
 void pkcs7_pad(std::vector<unsigned char> &data, size_t block_size) {
@@ -81,6 +79,240 @@ bool pkcs7_unpad(std::vector<unsigned char> &data) {
     data.resize(data.size() - padding_len);
     return true;
 }
+namespace {
+
+// The placeholder XORs byte i with key[i % 32] and iv[i % 8]; since the IV
+// length divides the key length both collapse into one 32-byte pattern.
+void gost_placeholder_pattern(const unsigned char *key, const unsigned char *iv,
+                              unsigned char *pattern) {
+    for (size_t i = 0; i < GOST_KEY_SIZE_BYTES; ++i) {
+        pattern[i] = key[i] ^ iv[i % GOST_IV_SIZE_BYTES];
+    }
+}
+
+// phase is the stream position of in[0], so a stream can be processed in
+// pieces or out of order.
+void gost_placeholder_xor(const unsigned char *in, unsigned char *out,
+                          size_t length, const unsigned char *pattern,
+                          uint64_t phase = 0) {
+    size_t offset = static_cast<size_t>(phase % GOST_KEY_SIZE_BYTES);
+    for (size_t i = 0; i < length; ++i) {
+        out[i] = in[i] ^ pattern[(offset + i) % GOST_KEY_SIZE_BYTES];
+    }
+}
+
+bool gost_unpad_length(const unsigned char *data, size_t length,
+                       size_t &unpadded_length) {
+    if (length == 0)
+        return false;
+    unsigned char padding_len = data[length - 1];
+    if (padding_len == 0 || padding_len > length ||
+        padding_len > GOST_BLOCK_SIZE_BYTES) {
+        return false;
+    }
+    for (size_t i = 0; i < padding_len; ++i) {
+        if (data[length - 1 - i] != padding_len) {
+            return false;
+        }
+    }
+    unpadded_length = length - padding_len;
+    return true;
+}
+
+} // namespace
+
+size_t gost_padded_length(size_t length) {
+    return length - length % GOST_BLOCK_SIZE_BYTES + GOST_BLOCK_SIZE_BYTES;
+}
+
+size_t gost_encrypt_to(const unsigned char *key, const unsigned char *iv,
+                       const unsigned char *in, size_t length,
+                       unsigned char *out) {
+    size_t padded = gost_padded_length(length);
+    {
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost,
+                           CipherInstrStage::Padding, length);
+        std::memcpy(out, in, length);
+        unsigned char padding_len = static_cast<unsigned char>(padded - length);
+        std::memset(out + length, padding_len, padding_len);
+    }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost, CipherInstrStage::Kernel,
+                       padded);
+    unsigned char pattern[GOST_KEY_SIZE_BYTES];
+    gost_placeholder_pattern(key, iv, pattern);
+    gost_placeholder_xor(out, out, padded, pattern);
+    return padded;
+}
+
+size_t gost_decrypt_to(const unsigned char *key, const unsigned char *iv,
+                       const unsigned char *in, size_t length,
+                       unsigned char *out) {
+    if (length == 0) {
+        return 0;
+    }
+    if (length % GOST_BLOCK_SIZE_BYTES != 0) {
+        throw std::invalid_argument(
+            "Ciphertext size is not a multiple of the GOST block size.");
+    }
+    {
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost,
+                           CipherInstrStage::Kernel, length);
+        unsigned char pattern[GOST_KEY_SIZE_BYTES];
+        gost_placeholder_pattern(key, iv, pattern);
+        gost_placeholder_xor(in, out, length, pattern);
+    }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost, CipherInstrStage::Padding,
+                       length);
+    size_t plaintext_length = 0;
+    if (!gost_unpad_length(out, length, plaintext_length)) {
+        throw std::runtime_error("Decryption failed (e.g., invalid padding).");
+    }
+    return plaintext_length;
+}
+
+namespace {
+
+// Calls body with a GostBlockCipher<Set> for set; the switch sits outside
+// every block loop.
+template <typename Body>
+void with_gost_block_cipher(GostSBoxSet set, const unsigned char *key,
+                            Body body) {
+    switch (set) {
+    case GostSBoxSet::CryptoProA:
+        body(GostBlockCipher<GostSBoxCryptoProA>(key));
+        return;
+    case GostSBoxSet::Tc26Z:
+        body(GostBlockCipher<GostSBoxTc26Z>(key));
+        return;
+    }
+    throw std::invalid_argument("Unknown GOST S-box set.");
+}
+
+} // namespace
+
+const char *gost_sbox_set_name(GostSBoxSet set) {
+    switch (set) {
+    case GostSBoxSet::CryptoProA:
+        return GostSBoxCryptoProA::name;
+    case GostSBoxSet::Tc26Z:
+        return GostSBoxTc26Z::name;
+    }
+    return "unknown";
+}
+
+void gost_ecb_encrypt_blocks(GostSBoxSet set, const unsigned char *key,
+                             const unsigned char *in, unsigned char *out,
+                             size_t blocks) {
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost, CipherInstrStage::Kernel,
+                       blocks * GOST_BLOCK_SIZE_BYTES);
+    with_gost_block_cipher(set, key, [&](const auto &cipher) {
+        cipher.encrypt_blocks(in, out, blocks);
+    });
+}
+
+void gost_ecb_decrypt_blocks(GostSBoxSet set, const unsigned char *key,
+                             const unsigned char *in, unsigned char *out,
+                             size_t blocks) {
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost, CipherInstrStage::Kernel,
+                       blocks * GOST_BLOCK_SIZE_BYTES);
+    with_gost_block_cipher(set, key, [&](const auto &cipher) {
+        cipher.decrypt_blocks(in, out, blocks);
+    });
+}
+
+namespace {
+
+// One lane of a multi-buffer group. The placeholder pattern is kept as four
+// 64-bit words, one per block position modulo the 32-byte key; a real CBC
+// round function would also carry the lane's chaining value here.
+struct GostLane {
+    const unsigned char *in;
+    unsigned char *out;
+    size_t full_blocks;
+    size_t blocks;
+    uint64_t pattern[GOST_KEY_SIZE_BYTES / GOST_BLOCK_SIZE_BYTES];
+    unsigned char tail[GOST_BLOCK_SIZE_BYTES];
+};
+
+void gost_lane_init(const unsigned char *key, const GostMultiBufferJob &job,
+                    GostLane &lane) {
+    unsigned char pattern[GOST_KEY_SIZE_BYTES];
+    gost_placeholder_pattern(key, job.iv, pattern);
+    std::memcpy(lane.pattern, pattern, GOST_KEY_SIZE_BYTES);
+    lane.in = job.in;
+    lane.out = job.out;
+    lane.full_blocks = job.length / GOST_BLOCK_SIZE_BYTES;
+    lane.blocks = lane.full_blocks + 1;
+    // The PKCS#7-padded last block, so the kernel never reads past in.
+    size_t rest = job.length % GOST_BLOCK_SIZE_BYTES;
+    if (rest > 0) {
+        std::memcpy(lane.tail,
+                    job.in + lane.full_blocks * GOST_BLOCK_SIZE_BYTES, rest);
+    }
+    std::memset(lane.tail + rest,
+                static_cast<unsigned char>(GOST_BLOCK_SIZE_BYTES - rest),
+                GOST_BLOCK_SIZE_BYTES - rest);
+}
+
+// Advances lanes[0, count), sorted by descending block count, in lockstep:
+// block b of every lane still running is processed before block b + 1 of
+// any, so the per-block dependency chains of up to GOST_MULTI_BUFFER_LANES
+// messages overlap instead of running back to back.
+void gost_encrypt_lanes(GostLane *lanes, size_t count) {
+    size_t active = count;
+    for (size_t b = 0; active > 0; ++b) {
+        while (active > 0 && lanes[active - 1].blocks <= b) {
+            --active;
+        }
+        size_t word = b % (GOST_KEY_SIZE_BYTES / GOST_BLOCK_SIZE_BYTES);
+        for (size_t l = 0; l < active; ++l) {
+            GostLane &lane = lanes[l];
+            const unsigned char *src =
+                b < lane.full_blocks ? lane.in + b * GOST_BLOCK_SIZE_BYTES
+                                     : lane.tail;
+            uint64_t block;
+            std::memcpy(&block, src, GOST_BLOCK_SIZE_BYTES);
+            block ^= lane.pattern[word];
+            std::memcpy(lane.out + b * GOST_BLOCK_SIZE_BYTES, &block,
+                        GOST_BLOCK_SIZE_BYTES);
+        }
+    }
+}
+
+} // namespace
+
+void gost_encrypt_multi(const unsigned char *key,
+                        const std::vector<GostMultiBufferJob> &jobs) {
+    // Length-grouping scheduler: with the jobs sorted longest first, each
+    // group of lanes holds messages of nearly the same length and few lane
+    // slots idle while the longest message of the group finishes.
+    std::vector<uint32_t> order(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return jobs[a].length / GOST_BLOCK_SIZE_BYTES >
+               jobs[b].length / GOST_BLOCK_SIZE_BYTES;
+    });
+
+    size_t total = 0;
+    for (const GostMultiBufferJob &job : jobs) {
+        total += gost_padded_length(job.length);
+    }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost, CipherInstrStage::Kernel,
+                       total);
+    GostLane lanes[GOST_MULTI_BUFFER_LANES];
+    for (size_t first = 0; first < order.size();
+         first += GOST_MULTI_BUFFER_LANES) {
+        size_t count = std::min<size_t>(GOST_MULTI_BUFFER_LANES,
+                                        order.size() - first);
+        for (size_t l = 0; l < count; ++l) {
+            gost_lane_init(key, jobs[order[first + l]], lanes[l]);
+        }
+        gost_encrypt_lanes(lanes, count);
+    }
+}
+
 void gost_cbc_encrypt_placeholder(const std::vector<unsigned char> &plaintext,
                                   std::vector<unsigned char> &ciphertext,
                                   const std::vector<unsigned char> &key,
@@ -89,15 +321,23 @@ void gost_cbc_encrypt_placeholder(const std::vector<unsigned char> &plaintext,
         throw std::invalid_argument(
             "Invalid key or IV size for GOST placeholder.");
     }
-    std::vector<unsigned char> padded_plaintext = plaintext;
-    pkcs7_pad(padded_plaintext, GOST_BLOCK_SIZE_BYTES);
+    std::vector<unsigned char> padded_plaintext;
+    {
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost,
+                           CipherInstrStage::Padding, plaintext.size());
+        padded_plaintext = plaintext;
+        pkcs7_pad(padded_plaintext, GOST_BLOCK_SIZE_BYTES);
+    }
 
     ciphertext.resize(padded_plaintext.size());
+    CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Gost, 2);
     // Example (dummy) operation: XOR with a repeating pattern from key and IV
-    for (size_t i = 0; i < padded_plaintext.size(); ++i) {
-        ciphertext[i] =
-            padded_plaintext[i] ^ key[i % key.size()] ^ iv[i % iv.size()];
-    }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost, CipherInstrStage::Kernel,
+                       padded_plaintext.size());
+    unsigned char pattern[GOST_KEY_SIZE_BYTES];
+    gost_placeholder_pattern(key.data(), iv.data(), pattern);
+    gost_placeholder_xor(padded_plaintext.data(), ciphertext.data(),
+                         padded_plaintext.size(), pattern);
 }
 
 bool gost_cbc_decrypt_placeholder(const std::vector<unsigned char> &ciphertext,
@@ -112,11 +352,19 @@ bool gost_cbc_decrypt_placeholder(const std::vector<unsigned char> &ciphertext,
     }
 
     std::vector<unsigned char> decrypted_padded_data(ciphertext.size());
-    // Example (dummy) operation: XOR with a repeating pattern from key and IV
-    for (size_t i = 0; i < ciphertext.size(); ++i) {
-        decrypted_padded_data[i] =
-            ciphertext[i] ^ key[i % key.size()] ^ iv[i % iv.size()];
+    CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Gost, 2);
+    {
+        // Example (dummy) operation: XOR with a repeating pattern from key and
+        // IV
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost,
+                           CipherInstrStage::Kernel, ciphertext.size());
+        unsigned char pattern[GOST_KEY_SIZE_BYTES];
+        gost_placeholder_pattern(key.data(), iv.data(), pattern);
+        gost_placeholder_xor(ciphertext.data(), decrypted_padded_data.data(),
+                             ciphertext.size(), pattern);
     }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost, CipherInstrStage::Padding,
+                       decrypted_padded_data.size());
     if (!pkcs7_unpad(decrypted_padded_data)) {
         // std::cerr << "Warning: PKCS#7 unpadding failed in decrypt
         // placeholder." << std::endl;
@@ -178,8 +426,10 @@ gost_decrypt_data(const std::vector<unsigned char> &ciphertext,
 // --- Text Encryption/Decryption Implementation ---
 GostEncryptedTextResult encryptTextGOST(const std::string &plaintext_str,
                                         const std::string &key_hex,
-                                        const std::string &initial_iv_hex) {
+                                        const std::string &initial_iv_hex,
+                                        CipherTextEncoding encoding) {
     GostEncryptedTextResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Gost);
     try {
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
         if (key.size() != GOST_KEY_SIZE_BYTES) {
@@ -202,13 +452,19 @@ GostEncryptedTextResult encryptTextGOST(const std::string &plaintext_str,
             generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
         }
 
-        std::vector<unsigned char> plaintext_bytes(plaintext_str.begin(),
-                                                   plaintext_str.end());
-        std::vector<unsigned char> ciphertext_bytes =
-            gost_encrypt_data(plaintext_bytes, key, iv);
-
-        result.iv_hex = bytesToHexString(iv);
-        result.ciphertext_hex = bytesToHexString(ciphertext_bytes);
+        std::vector<unsigned char> ciphertext_bytes(
+            gost_padded_length(plaintext_str.size()));
+        CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Gost, 1);
+        gost_encrypt_to(key.data(), iv.data(),
+                        reinterpret_cast<const unsigned char *>(
+                            plaintext_str.data()),
+                        plaintext_str.size(), ciphertext_bytes.data());
+
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost,
+                           CipherInstrStage::HexEncode,
+                           iv.size() + ciphertext_bytes.size());
+        result.iv_hex = cipher_text_encode(iv, encoding);
+        result.ciphertext_hex = cipher_text_encode(ciphertext_bytes, encoding);
         result.success = true;
     } catch (const std::exception &e) {
         result.error_message =
@@ -219,8 +475,10 @@ GostEncryptedTextResult encryptTextGOST(const std::string &plaintext_str,
 
 GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
                                         const std::string &ciphertext_hex,
-                                        const std::string &key_hex) {
+                                        const std::string &key_hex,
+                                        CipherTextEncoding encoding) {
     GostDecryptedTextResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Gost);
     try {
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
         if (key.size() != GOST_KEY_SIZE_BYTES) {
@@ -230,21 +488,27 @@ GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
             return result;
         }
 
-        std::vector<unsigned char> iv = hexStringToBytes(iv_hex);
+        std::vector<unsigned char> iv = cipher_text_decode(iv_hex, encoding);
         if (iv.size() != GOST_IV_SIZE_BYTES) {
             result.error_message = "Invalid IV length. Must be " +
-                                   std::to_string(GOST_IV_SIZE_BYTES * 2) +
-                                   " hex characters.";
+                                   std::to_string(GOST_IV_SIZE_BYTES) +
+                                   " bytes.";
             return result;
         }
 
-        std::vector<unsigned char> ciphertext_bytes =
-            hexStringToBytes(ciphertext_hex);
-        std::vector<unsigned char> plaintext_bytes =
-            gost_decrypt_data(ciphertext_bytes, key, iv);
-
-        result.plaintext =
-            std::string(plaintext_bytes.begin(), plaintext_bytes.end());
+        std::vector<unsigned char> ciphertext_bytes;
+        {
+            CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Gost,
+                               CipherInstrStage::HexDecode,
+                               ciphertext_hex.size() / 2);
+            ciphertext_bytes = cipher_text_decode(ciphertext_hex, encoding);
+        }
+        result.plaintext.resize(ciphertext_bytes.size());
+        size_t plaintext_length = gost_decrypt_to(
+            key.data(), iv.data(), ciphertext_bytes.data(),
+            ciphertext_bytes.size(),
+            reinterpret_cast<unsigned char *>(result.plaintext.data()));
+        result.plaintext.resize(plaintext_length);
         result.success = true;
     } catch (const std::exception &e) {
         result.error_message =
@@ -253,85 +517,210 @@ GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
     return result;
 }
 
+CipherBytesResult encryptBytesGOST(const unsigned char *plaintext,
+                                   size_t length,
+                                   const std::vector<unsigned char> &key,
+                                   const std::vector<unsigned char> &iv) {
+    CipherBytesResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Gost);
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        result.error_message = "Invalid key length. Must be " +
+                               std::to_string(GOST_KEY_SIZE_BYTES) + " bytes.";
+        return result;
+    }
+    if (!iv.empty() && iv.size() != GOST_IV_SIZE_BYTES) {
+        result.error_message = "Invalid IV length. Must be " +
+                               std::to_string(GOST_IV_SIZE_BYTES) +
+                               " bytes if provided.";
+        return result;
+    }
+    try {
+        result.data.resize(GOST_IV_SIZE_BYTES + gost_padded_length(length));
+        CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Gost, 1);
+        if (iv.empty()) {
+            std::vector<unsigned char> random_iv;
+            generateRandomBytes(random_iv, GOST_IV_SIZE_BYTES);
+            std::memcpy(result.data.data(), random_iv.data(),
+                        GOST_IV_SIZE_BYTES);
+        } else {
+            std::memcpy(result.data.data(), iv.data(), GOST_IV_SIZE_BYTES);
+        }
+        gost_encrypt_to(key.data(), result.data.data(), plaintext, length,
+                        result.data.data() + GOST_IV_SIZE_BYTES);
+        result.success = true;
+    } catch (const std::exception &e) {
+        result.data.clear();
+        result.error_message =
+            std::string("C++ Exception in encryptBytesGOST: ") + e.what();
+    }
+    return result;
+}
+
+CipherBytesResult decryptBytesGOST(const unsigned char *data, size_t length,
+                                   const std::vector<unsigned char> &key) {
+    CipherBytesResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Gost);
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        result.error_message = "Invalid key length. Must be " +
+                               std::to_string(GOST_KEY_SIZE_BYTES) + " bytes.";
+        return result;
+    }
+    if (length < GOST_IV_SIZE_BYTES) {
+        result.error_message = "Input is shorter than the GOST IV.";
+        return result;
+    }
+    try {
+        size_t ciphertext_length = length - GOST_IV_SIZE_BYTES;
+        result.data.resize(ciphertext_length);
+        CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Gost, 1);
+        result.data.resize(gost_decrypt_to(key.data(), data,
+                                           data + GOST_IV_SIZE_BYTES,
+                                           ciphertext_length,
+                                           result.data.data()));
+        result.success = true;
+    } catch (const std::exception &e) {
+        result.data.clear();
+        result.error_message =
+            std::string("C++ Exception in decryptBytesGOST: ") + e.what();
+    }
+    return result;
+}
+
+// --- Cipher Engine Implementation ---
+void GostCipherEngine::init(const std::string &key, CipherDirection direction) {
+    direction_ = direction;
+    position_ = 0;
+    std::string key_hex = key;
+    std::string iv_hex;
+    size_t separator = key.find(':');
+    if (separator != std::string::npos) {
+        key_hex = key.substr(0, separator);
+        iv_hex = key.substr(separator + 1);
+    }
+    key_ = hexStringToBytes(key_hex);
+    if (key_.size() != GOST_KEY_SIZE_BYTES) {
+        throw std::invalid_argument("Invalid key length. Must be " +
+                                    std::to_string(GOST_KEY_SIZE_BYTES * 2) +
+                                    " hex characters.");
+    }
+    iv_.clear();
+    if (!iv_hex.empty()) {
+        set_iv(hexStringToBytes(iv_hex));
+    }
+}
+
+void GostCipherEngine::set_iv(const std::vector<unsigned char> &iv) {
+    if (iv.size() != GOST_IV_SIZE_BYTES) {
+        throw std::invalid_argument("Invalid IV length. Must be " +
+                                    std::to_string(GOST_IV_SIZE_BYTES * 2) +
+                                    " hex characters.");
+    }
+    iv_ = iv;
+    gost_placeholder_pattern(key_.data(), iv_.data(), pattern_);
+}
+
+void GostCipherEngine::write_header(unsigned char *out) {
+    if (iv_.empty()) {
+        std::vector<unsigned char> iv;
+        generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
+        set_iv(iv);
+    }
+    std::memcpy(out, iv_.data(), GOST_IV_SIZE_BYTES);
+}
+
+void GostCipherEngine::read_header(const unsigned char *in) {
+    set_iv(std::vector<unsigned char>(in, in + GOST_IV_SIZE_BYTES));
+}
+
+size_t GostCipherEngine::process(const unsigned char *in, size_t length,
+                                 unsigned char *out) {
+    gost_placeholder_xor(in, out, length, pattern_, position_);
+    position_ += length;
+    return length;
+}
+
+size_t GostCipherEngine::finalize(const unsigned char *in, size_t length,
+                                  unsigned char *out) {
+    if (direction_ == CipherDirection::Encrypt) {
+        unsigned char block[GOST_BLOCK_SIZE_BYTES];
+        unsigned char padding_len =
+            static_cast<unsigned char>(GOST_BLOCK_SIZE_BYTES - length);
+        std::memcpy(block, in, length);
+        std::memset(block + length, padding_len, padding_len);
+        return process(block, GOST_BLOCK_SIZE_BYTES, out);
+    }
+    if (length == 0) {
+        return 0;
+    }
+    if (length % GOST_BLOCK_SIZE_BYTES != 0) {
+        throw std::invalid_argument(
+            "Ciphertext size is not a multiple of the GOST block size.");
+    }
+    process(in, length, out);
+    size_t plaintext_length = 0;
+    if (!gost_unpad_length(out, length, plaintext_length)) {
+        throw std::runtime_error("Decryption failed (e.g., invalid padding).");
+    }
+    return plaintext_length;
+}
+
 // --- File Encryption/Decryption Implementation ---
 GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
                                         const std::string &key_hex,
-                                        const std::string &initial_iv_hex) {
+                                        const std::string &initial_iv_hex,
+                                        CipherProgressToken *progress,
+                                        bool compress) {
     GostFileOperationResult fres;
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    if (!inputFile) {
-        fres.message = "Error opening input file: " + inputFilePath;
-        return fres;
-    }
-
-    std::ofstream outputFile(outputFilePath,
-                             std::ios::binary | std::ios::trunc);
-    if (!outputFile) {
-        fres.message = "Error opening output file: " + outputFilePath;
-        return fres;
-    }
-
     try {
+        GostCipherEngine engine;
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
         if (key.size() != GOST_KEY_SIZE_BYTES) {
             fres.message = "Invalid key length for file encryption.";
             return fres;
         }
+        engine.init(key_hex, CipherDirection::Encrypt);
 
-        std::vector<unsigned char> iv;
         if (!initial_iv_hex.empty()) {
-            iv = hexStringToBytes(initial_iv_hex);
+            std::vector<unsigned char> iv = hexStringToBytes(initial_iv_hex);
             if (iv.size() != GOST_IV_SIZE_BYTES) {
                 fres.message = "Invalid IV length for file encryption.";
                 return fres;
             }
-        } else {
-            generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
-        }
-        fres.used_iv_hex = bytesToHexString(iv);
-
-        // Write IV to the beginning of the output file
-        outputFile.write(reinterpret_cast<const char *>(iv.data()), iv.size());
-        if (!outputFile) {
-            fres.message = "Error writing IV to output file.";
-            return fres;
-        }
-
-        // Read entire file content
-        inputFile.seekg(0, std::ios::end);
-        std::streamsize fileSize = inputFile.tellg();
-        inputFile.seekg(0, std::ios::beg);
-        std::vector<unsigned char> plaintext_bytes(
-            static_cast<size_t>(fileSize));
-        if (fileSize > 0) {
-            inputFile.read(reinterpret_cast<char *>(plaintext_bytes.data()),
-                           fileSize);
+            engine.set_iv(iv);
         }
 
-        if (!inputFile &&
-            !inputFile.eof()) { // Check for read errors other than EOF
-            fres.message = "Error reading input file content.";
-            return fres;
-        }
-
-        if (plaintext_bytes.empty() && fileSize > 0) {
-            // This case can happen if allocation failed or read failed silently
-            // but usually inputFile flags would indicate error. For robustness:
-            if (fileSize > 0) {
-                fres.message = "Input file has size > 0 but no data was read.";
+        if (compress) {
+            if (!initial_iv_hex.empty()) {
+                fres.message = "A fixed IV cannot be used with compression.";
                 return fres;
             }
-            // If fileSize is 0, plaintext_bytes will be empty, which is fine.
+            CipherContainerOptions options;
+            options.threads = 0;
+            options.compression = CipherContainerCompression::Lz4;
+            options.progress = progress;
+            CipherContainerResult cres = write_cipher_container(
+                engine, inputFilePath, outputFilePath, options);
+            if (!cres.success) {
+                fres.cancelled = cres.cancelled;
+                fres.message = cres.message;
+                return fres;
+            }
+            fres.success = true;
+            fres.message = "File compressed and encrypted successfully.";
+            return fres;
         }
 
-        std::vector<unsigned char> ciphertext_bytes =
-            gost_encrypt_data(plaintext_bytes, key, iv);
-        outputFile.write(
-            reinterpret_cast<const char *>(ciphertext_bytes.data()),
-            ciphertext_bytes.size());
-        if (!outputFile) {
-            fres.message = "Error writing ciphertext to output file.";
+        CipherDriverOptions options;
+        options.threads = 0;
+        options.io_backend = CipherIoBackend::Auto;
+        options.progress = progress;
+        CipherDriverResult dres =
+            run_cipher_file(engine, inputFilePath, outputFilePath, options);
+        fres.used_iv_hex = bytesToHexString(engine.iv());
+        if (!dres.success) {
+            fres.cancelled = dres.cancelled;
+            fres.message = dres.message;
             return fres;
         }
 
@@ -342,90 +731,49 @@ GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
         fres.message =
             std::string("C++ Exception during file encryption: ") + e.what();
     }
-
-    inputFile.close();
-    outputFile.close();
     return fres;
 }
 
 GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
-                                        const std::string &key_hex) {
+                                        const std::string &key_hex,
+                                        CipherProgressToken *progress) {
     GostFileOperationResult fres;
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    if (!inputFile) {
-        fres.message = "Error opening input file: " + inputFilePath;
-        return fres;
-    }
-
-    std::ofstream outputFile(outputFilePath,
-                             std::ios::binary | std::ios::trunc);
-    if (!outputFile) {
-        fres.message = "Error opening output file: " + outputFilePath;
-        return fres;
-    }
-
     try {
+        GostCipherEngine engine;
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
         if (key.size() != GOST_KEY_SIZE_BYTES) {
             fres.message = "Invalid key length for file decryption.";
             return fres;
         }
-
-        // Read IV from the beginning of the input file
-        std::vector<unsigned char> iv(GOST_IV_SIZE_BYTES);
-        inputFile.read(reinterpret_cast<char *>(iv.data()), iv.size());
-        if (static_cast<size_t>(inputFile.gcount()) != GOST_IV_SIZE_BYTES) {
-            fres.message = "Error reading IV from input file (file too short "
-                           "or read error).";
-            return fres;
-        }
-        fres.used_iv_hex = bytesToHexString(iv);
-
-        inputFile.seekg(0, std::ios::end);
-        std::streamsize totalFileSize = inputFile.tellg();
-        inputFile.seekg(GOST_IV_SIZE_BYTES, std::ios::beg);
-
-        std::streamsize ciphertextFileSize = totalFileSize - GOST_IV_SIZE_BYTES;
-        if (ciphertextFileSize <
-            0) { // Should not happen if IV read was successful
-            fres.message = "Input file is smaller than IV size.";
-            return fres;
-        }
-
-        std::vector<unsigned char> ciphertext_bytes(
-            static_cast<size_t>(ciphertextFileSize));
-        if (ciphertextFileSize > 0) {
-            inputFile.read(reinterpret_cast<char *>(ciphertext_bytes.data()),
-                           ciphertextFileSize);
-        }
-
-        if (!inputFile && !inputFile.eof()) {
-            fres.message = "Error reading ciphertext from input file.";
-            return fres;
-        }
-        if (ciphertext_bytes.empty() && ciphertextFileSize > 0) {
-            if (ciphertextFileSize > 0) {
-                fres.message =
-                    "Ciphertext in file has size > 0 but no data was read.";
+        engine.init(key_hex, CipherDirection::Decrypt);
+
+        if (is_cipher_container(inputFilePath)) {
+            CipherContainerOptions options;
+            options.threads = 0;
+            options.progress = progress;
+            CipherContainerResult cres = read_cipher_container(
+                engine, inputFilePath, outputFilePath, options);
+            if (!cres.success) {
+                fres.cancelled = cres.cancelled;
+                fres.message = cres.message;
                 return fres;
             }
+            fres.success = true;
+            fres.message = "File decrypted successfully.";
+            return fres;
         }
 
-        std::vector<unsigned char> plaintext_bytes =
-            gost_decrypt_data(ciphertext_bytes, key, iv);
-        if (!plaintext_bytes.empty() ||
-            (ciphertext_bytes.empty() && ciphertextFileSize == 0)) {
-            outputFile.write(
-                reinterpret_cast<const char *>(plaintext_bytes.data()),
-                plaintext_bytes.size());
-            if (!outputFile) {
-                fres.message = "Error writing plaintext to output file.";
-                return fres;
-            }
-        } else if (!ciphertext_bytes.empty()) {
-            fres.message = "Decryption resulted in empty plaintext from "
-                           "non-empty ciphertext (check for padding errors).";
+        CipherDriverOptions options;
+        options.threads = 0;
+        options.io_backend = CipherIoBackend::Auto;
+        options.progress = progress;
+        CipherDriverResult dres =
+            run_cipher_file(engine, inputFilePath, outputFilePath, options);
+        fres.used_iv_hex = bytesToHexString(engine.iv());
+        if (!dres.success) {
+            fres.cancelled = dres.cancelled;
+            fres.message = dres.message;
             return fres;
         }
 
@@ -436,8 +784,130 @@ GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
         fres.message =
             std::string("C++ Exception during file decryption: ") + e.what();
     }
-
-    inputFile.close();
-    outputFile.close();
     return fres;
 }
+
+// --- Batch Text Encryption/Decryption Implementation ---
+CipherBatchResult encryptBatchGOST(const unsigned char *input,
+                                   size_t input_size,
+                                   const std::vector<CipherBatchRecord> &records,
+                                   const std::string &key_hex) {
+    CipherBatchResult result;
+    std::vector<unsigned char> key;
+    try {
+        key = hexStringToBytes(key_hex);
+    } catch (const std::exception &e) {
+        result.error_message =
+            std::string("C++ Exception in encryptBatchGOST: ") + e.what();
+        return result;
+    }
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        result.error_message = "Invalid key length. Must be " +
+                               std::to_string(GOST_KEY_SIZE_BYTES * 2) +
+                               " hex characters.";
+        return result;
+    }
+
+    size_t arena_size = 0;
+    for (const CipherBatchRecord &record : records) {
+        arena_size += GOST_IV_SIZE_BYTES + record.length + GOST_BLOCK_SIZE_BYTES;
+    }
+    cipher_batch_begin(result, records.size(), arena_size);
+
+    // One draw from the system CSPRNG per batch instead of one per message.
+    std::vector<unsigned char> ivs;
+    generateRandomBytes(ivs, records.size() * GOST_IV_SIZE_BYTES);
+
+    // Lay out IV || ciphertext slots first; the ciphertexts are then filled
+    // in by the multi-buffer kernel. Arena offsets, not pointers, until the
+    // arena stops growing.
+    std::vector<GostMultiBufferJob> jobs;
+    std::vector<size_t> job_starts;
+    jobs.reserve(records.size());
+    job_starts.reserve(records.size());
+    for (size_t r = 0; r < records.size(); ++r) {
+        const CipherBatchRecord &record = records[r];
+        if (!cipher_batch_record_in_range(record, input_size)) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::OutOfRange);
+            continue;
+        }
+        size_t start = result.arena.size();
+        result.arena.resize(start + GOST_IV_SIZE_BYTES +
+                            gost_padded_length(record.length));
+        std::memcpy(result.arena.data() + start,
+                    ivs.data() + r * GOST_IV_SIZE_BYTES, GOST_IV_SIZE_BYTES);
+
+        GostMultiBufferJob job;
+        job.in = input + record.offset;
+        job.length = record.length;
+        jobs.push_back(job);
+        job_starts.push_back(start);
+        cipher_batch_finish_record(result, r, CipherBatchStatus::Ok);
+    }
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        jobs[j].iv = result.arena.data() + job_starts[j];
+        jobs[j].out = result.arena.data() + job_starts[j] + GOST_IV_SIZE_BYTES;
+    }
+    gost_encrypt_multi(key.data(), jobs);
+    result.success = true;
+    return result;
+}
+
+CipherBatchResult decryptBatchGOST(const unsigned char *input,
+                                   size_t input_size,
+                                   const std::vector<CipherBatchRecord> &records,
+                                   const std::string &key_hex) {
+    CipherBatchResult result;
+    std::vector<unsigned char> key;
+    try {
+        key = hexStringToBytes(key_hex);
+    } catch (const std::exception &e) {
+        result.error_message =
+            std::string("C++ Exception in decryptBatchGOST: ") + e.what();
+        return result;
+    }
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        result.error_message = "Invalid key length. Must be " +
+                               std::to_string(GOST_KEY_SIZE_BYTES * 2) +
+                               " hex characters.";
+        return result;
+    }
+
+    size_t arena_size = 0;
+    for (const CipherBatchRecord &record : records) {
+        arena_size += record.length;
+    }
+    cipher_batch_begin(result, records.size(), arena_size);
+    unsigned char pattern[GOST_KEY_SIZE_BYTES];
+
+    for (size_t r = 0; r < records.size(); ++r) {
+        const CipherBatchRecord &record = records[r];
+        if (!cipher_batch_record_in_range(record, input_size)) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::OutOfRange);
+            continue;
+        }
+        if (record.length < GOST_IV_SIZE_BYTES + GOST_BLOCK_SIZE_BYTES ||
+            (record.length - GOST_IV_SIZE_BYTES) % GOST_BLOCK_SIZE_BYTES != 0) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::InvalidInput);
+            continue;
+        }
+        const unsigned char *iv = input + record.offset;
+        size_t ciphertext_len = record.length - GOST_IV_SIZE_BYTES;
+        size_t start = result.arena.size();
+        result.arena.resize(start + ciphertext_len);
+        unsigned char *out = result.arena.data() + start;
+
+        gost_placeholder_pattern(key.data(), iv, pattern);
+        gost_placeholder_xor(iv + GOST_IV_SIZE_BYTES, out, ciphertext_len, pattern);
+
+        size_t plaintext_len = 0;
+        if (!gost_unpad_length(out, ciphertext_len, plaintext_len)) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::CipherError);
+            continue;
+        }
+        result.arena.resize(start + plaintext_len);
+        cipher_batch_finish_record(result, r, CipherBatchStatus::Ok);
+    }
+    result.success = true;
+    return result;
+}
@@ -11,6 +11,12 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
+
+#include "../common/cipher_base64.hpp"
+#include "../common/cipher_batch.hpp"
+#include "../common/cipher_bytes.hpp"
+#include "../engine/cipher_engine.hpp"
+
 const unsigned int GOST_KEY_SIZE_BITS = 256;
 const unsigned int GOST_KEY_SIZE_BYTES = GOST_KEY_SIZE_BITS / 8;
 const unsigned int GOST_BLOCK_SIZE_BYTES = 8; 
@@ -34,6 +40,47 @@ std::vector<unsigned char>
 gost_decrypt_data(const std::vector<unsigned char> &ciphertext,
                   const std::vector<unsigned char> &key,
                   const std::vector<unsigned char> &iv);
+// Caller-buffer primitives under the text and bytes APIs. gost_encrypt_to
+// pads length bytes and encrypts them into out, which must hold
+// gost_padded_length(length) bytes; key and iv are raw. gost_decrypt_to
+// needs length bytes of out, returns the unpadded length (an empty
+// ciphertext decrypts to nothing) and throws on a bad size or padding.
+size_t gost_padded_length(size_t length);
+size_t gost_encrypt_to(const unsigned char *key, const unsigned char *iv,
+                       const unsigned char *in, size_t length,
+                       unsigned char *out);
+size_t gost_decrypt_to(const unsigned char *key, const unsigned char *iv,
+                       const unsigned char *in, size_t length,
+                       unsigned char *out);
+// GOST 28147-89 block function (gost_sbox.hpp) over whole 8-byte blocks in
+// ECB order with a raw 32-byte key. The S-box set is resolved once per call
+// and each set runs its own compiled kernel; modes built on the block
+// function go through these entry points.
+enum class GostSBoxSet { CryptoProA, Tc26Z };
+const char *gost_sbox_set_name(GostSBoxSet set);
+void gost_ecb_encrypt_blocks(GostSBoxSet set, const unsigned char *key,
+                             const unsigned char *in, unsigned char *out,
+                             size_t blocks);
+void gost_ecb_decrypt_blocks(GostSBoxSet set, const unsigned char *key,
+                             const unsigned char *in, unsigned char *out,
+                             size_t blocks);
+// Multi-buffer encryption of independent messages under one key, each with
+// its own IV; the output of every job equals gost_encrypt_to on it alone.
+// CBC is serial within a message, so instead of one message at a time the
+// scheduler sorts the jobs by padded length and advances groups of
+// GOST_MULTI_BUFFER_LANES messages block by block in one interleaved
+// kernel, retiring lanes as their messages end.
+const unsigned int GOST_MULTI_BUFFER_LANES = 8;
+struct GostMultiBufferJob {
+    const unsigned char *iv = nullptr; // GOST_IV_SIZE_BYTES
+    const unsigned char *in = nullptr;
+    size_t length = 0;
+    unsigned char *out = nullptr; // gost_padded_length(length) bytes
+};
+void gost_encrypt_multi(const unsigned char *key,
+                        const std::vector<GostMultiBufferJob> &jobs);
+// iv_hex and ciphertext_hex are in the requested transport encoding (hex by
+// default); the key and an explicit IV are always given in hex.
 struct GostEncryptedTextResult {
     std::string iv_hex;
     std::string ciphertext_hex;
@@ -41,9 +88,10 @@ struct GostEncryptedTextResult {
     std::string error_message;
 };
 
-GostEncryptedTextResult encryptTextGOST(const std::string &plaintext,
-                                        const std::string &key_hex,
-                                        const std::string &iv_hex = "");
+GostEncryptedTextResult
+encryptTextGOST(const std::string &plaintext, const std::string &key_hex,
+                const std::string &iv_hex = "",
+                CipherTextEncoding encoding = CipherTextEncoding::Hex);
 
 struct GostDecryptedTextResult {
     std::string plaintext;
@@ -51,20 +99,95 @@ struct GostDecryptedTextResult {
     std::string error_message;
 };
 
-GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
-                                        const std::string &ciphertext_hex,
-                                        const std::string &key_hex);
+GostDecryptedTextResult
+decryptTextGOST(const std::string &iv_hex, const std::string &ciphertext_hex,
+                const std::string &key_hex,
+                CipherTextEncoding encoding = CipherTextEncoding::Hex);
+
+// Binary text API. encryptBytesGOST returns IV || ciphertext (the batch
+// record layout) under a raw 32-byte key; an empty iv means a random one.
+// decryptBytesGOST takes the same layout back.
+CipherBytesResult encryptBytesGOST(const unsigned char *plaintext,
+                                   size_t length,
+                                   const std::vector<unsigned char> &key,
+                                   const std::vector<unsigned char> &iv = {});
+CipherBytesResult decryptBytesGOST(const unsigned char *data, size_t length,
+                                   const std::vector<unsigned char> &key);
 struct GostFileOperationResult {
     bool success = false;
+    bool cancelled = false;
     std::string message;
     std::string used_iv_hex;
 };
+// progress, when given, receives byte counts per chunk and can cancel the
+// operation; a cancelled operation deletes its partial output.
+// compress writes an LZ4-compressed cipher container instead of the plain
+// IV || CBC layout (every chunk gets its own IV, so initial_iv_hex must be
+// empty); decryptFileGOST recognises either format.
 GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
                                         const std::string &key_hex,
-                                        const std::string &initial_iv_hex = "");
+                                        const std::string &initial_iv_hex = "",
+                                        CipherProgressToken *progress = nullptr,
+                                        bool compress = false);
 GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
-                                        const std::string &key_hex);
+                                        const std::string &key_hex,
+                                        CipherProgressToken *progress = nullptr);
+
+// Batch text API: every record of input is encrypted under one parsed key,
+// each with its own random IV, and written to the arena as IV || ciphertext.
+CipherBatchResult encryptBatchGOST(const unsigned char *input,
+                                   size_t input_size,
+                                   const std::vector<CipherBatchRecord> &records,
+                                   const std::string &key_hex);
+// Inverse of encryptBatchGOST: each record is IV || ciphertext.
+CipherBatchResult decryptBatchGOST(const unsigned char *input,
+                                   size_t input_size,
+                                   const std::vector<CipherBatchRecord> &records,
+                                   const std::string &key_hex);
+
+// CipherEngine over the GOST placeholder. The key is 64 hex characters,
+// optionally followed by ":" and a 16-hex-character IV to use instead of a
+// random one when encrypting. The IV is the stream header.
+class GostCipherEngine : public CipherEngine {
+  public:
+    std::string name() const override { return "gost"; }
+    CipherInstrAlgorithm instrumentation_algorithm() const override {
+        return CipherInstrAlgorithm::Gost;
+    }
+    void init(const std::string &key, CipherDirection direction) override;
+    void set_iv(const std::vector<unsigned char> &iv);
+    const std::vector<unsigned char> &iv() const { return iv_; }
+
+    size_t block_size() const override { return GOST_BLOCK_SIZE_BYTES; }
+    size_t max_output_size(size_t length) const override {
+        return length + GOST_BLOCK_SIZE_BYTES;
+    }
+    size_t tail_size() const override {
+        return direction_ == CipherDirection::Decrypt ? GOST_BLOCK_SIZE_BYTES
+                                                      : 0;
+    }
+    size_t header_size() const override { return GOST_IV_SIZE_BYTES; }
+    void write_header(unsigned char *out) override;
+    void read_header(const unsigned char *in) override;
+
+    size_t process(const unsigned char *in, size_t length,
+                   unsigned char *out) override;
+    size_t finalize(const unsigned char *in, size_t length,
+                    unsigned char *out) override;
+
+    bool supports_seek() const override { return true; }
+    void seek(uint64_t payload_offset) override { position_ = payload_offset; }
+    std::unique_ptr<CipherEngine> clone() const override {
+        return std::make_unique<GostCipherEngine>(*this);
+    }
+
+  private:
+    std::vector<unsigned char> key_;
+    std::vector<unsigned char> iv_;
+    unsigned char pattern_[GOST_KEY_SIZE_BYTES] = {};
+    uint64_t position_ = 0;
+};
 
 #endif // GOST_CIPHER_HPP
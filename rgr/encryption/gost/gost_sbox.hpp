@@ -0,0 +1,208 @@
+//
+//  gost_sbox.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef GOST_SBOX_HPP
+#define GOST_SBOX_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// GOST 28147-89 block function with compile-time S-box tables.
+//
+// An S-box set is a type with a static constexpr `rows[8][16]`, where row i
+// substitutes nibble i of the 32-bit round input (row 0 the lowest nibble).
+// GostRoundTables<Set> expands it at compile time into four 256-entry
+// tables that substitute one input byte each and already include the
+// 11-bit rotation, so a round is four lookups and three XORs; the tables
+// are constant-initialised data, with no startup work and no
+// initialisation-order questions. Each set instantiates its own
+// GostBlockCipher, so the round loop has no runtime S-box indirection.
+//
+// Byte order follows GOST 28147-89 and RFC 5830: key words and block halves
+// are little-endian.
+
+// id-Gost28147-89-CryptoPro-A-ParamSet (RFC 4357).
+struct GostSBoxCryptoProA {
+    static constexpr const char *name = "id-Gost28147-89-CryptoPro-A-ParamSet";
+    static constexpr uint8_t rows[8][16] = {
+        {0x9, 0x6, 0x3, 0x2, 0x8, 0xB, 0x1, 0x7, 0xA, 0x4, 0xE, 0xF, 0xC, 0x0, 0xD, 0x5},
+        {0x3, 0x7, 0xE, 0x9, 0x8, 0xA, 0xF, 0x0, 0x5, 0x2, 0x6, 0xC, 0xB, 0x4, 0xD, 0x1},
+        {0xE, 0x4, 0x6, 0x2, 0xB, 0x3, 0xD, 0x8, 0xC, 0xF, 0x5, 0xA, 0x0, 0x7, 0x1, 0x9},
+        {0xE, 0x7, 0xA, 0xC, 0xD, 0x1, 0x3, 0x9, 0x0, 0x2, 0xB, 0x4, 0xF, 0x8, 0x5, 0x6},
+        {0xB, 0x5, 0x1, 0x9, 0x8, 0xD, 0xF, 0x0, 0xE, 0x4, 0x2, 0x3, 0xC, 0x7, 0xA, 0x6},
+        {0x3, 0xA, 0xD, 0xC, 0x1, 0x2, 0x0, 0xB, 0x7, 0x5, 0x9, 0x4, 0x8, 0xF, 0xE, 0x6},
+        {0x1, 0xD, 0x2, 0x9, 0x7, 0xA, 0x6, 0x0, 0x8, 0xC, 0x4, 0x5, 0xF, 0x3, 0xB, 0xE},
+        {0xB, 0xA, 0xF, 0x5, 0x0, 0xC, 0xE, 0x8, 0x6, 0x2, 0x3, 0x9, 0x1, 0x7, 0xD, 0x4},
+    };
+};
+
+// id-tc26-gost-28147-param-Z (RFC 7836); also the S-box of Magma,
+// GOST R 34.12-2015.
+struct GostSBoxTc26Z {
+    static constexpr const char *name = "id-tc26-gost-28147-param-Z";
+    static constexpr uint8_t rows[8][16] = {
+        {0xC, 0x4, 0x6, 0x2, 0xA, 0x5, 0xB, 0x9, 0xE, 0x8, 0xD, 0x7, 0x0, 0x3, 0xF, 0x1},
+        {0x6, 0x8, 0x2, 0x3, 0x9, 0xA, 0x5, 0xC, 0x1, 0xE, 0x4, 0x7, 0xB, 0xD, 0x0, 0xF},
+        {0xB, 0x3, 0x5, 0x8, 0x2, 0xF, 0xA, 0xD, 0xE, 0x1, 0x7, 0x4, 0xC, 0x9, 0x6, 0x0},
+        {0xC, 0x8, 0x2, 0x1, 0xD, 0x4, 0xF, 0x6, 0x7, 0x0, 0xA, 0x5, 0x3, 0xE, 0x9, 0xB},
+        {0x7, 0xF, 0x5, 0xA, 0x8, 0x1, 0x6, 0xD, 0x0, 0x9, 0x3, 0xE, 0xB, 0x4, 0x2, 0xC},
+        {0x5, 0xD, 0xF, 0x6, 0x9, 0x2, 0xC, 0xA, 0xB, 0x7, 0x8, 0x1, 0x4, 0x3, 0xE, 0x0},
+        {0x8, 0xE, 0x2, 0x5, 0x6, 0x9, 0x1, 0xC, 0xF, 0x4, 0xB, 0x0, 0xD, 0xA, 0x3, 0x7},
+        {0x1, 0x7, 0xE, 0xD, 0x0, 0x5, 0x8, 0x3, 0x4, 0xF, 0xA, 0x6, 0x9, 0xC, 0xB, 0x2},
+    };
+};
+
+using GostRoundTable = std::array<std::array<uint32_t, 256>, 4>;
+
+constexpr uint32_t gost_rotl11(uint32_t x) { return (x << 11) | (x >> 21); }
+
+// Table j maps byte j of the round input to its substituted nibbles, moved
+// to their place in the word and rotated left by 11.
+constexpr GostRoundTable gost_expand_sbox(const uint8_t (&rows)[8][16]) {
+    GostRoundTable table{};
+    for (size_t j = 0; j < 4; ++j) {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t substituted =
+                static_cast<uint32_t>(rows[2 * j][b & 0xF]) |
+                static_cast<uint32_t>(rows[2 * j + 1][b >> 4]) << 4;
+            table[j][b] = gost_rotl11(substituted << (8 * j));
+        }
+    }
+    return table;
+}
+
+template <typename Set> struct GostRoundTables {
+    static constexpr GostRoundTable value = gost_expand_sbox(Set::rows);
+};
+
+// Reference round function straight from the 8x16 definition; checks the
+// expanded tables at compile time.
+template <typename Set> constexpr uint32_t gost_round_reference(uint32_t x) {
+    uint32_t substituted = 0;
+    for (unsigned int i = 0; i < 8; ++i) {
+        substituted |= static_cast<uint32_t>(Set::rows[i][(x >> (4 * i)) & 0xF])
+                       << (4 * i);
+    }
+    return gost_rotl11(substituted);
+}
+
+template <typename Set> constexpr uint32_t gost_round(uint32_t x) {
+    const GostRoundTable &t = GostRoundTables<Set>::value;
+    return t[0][x & 0xFF] ^ t[1][(x >> 8) & 0xFF] ^ t[2][(x >> 16) & 0xFF] ^
+           t[3][x >> 24];
+}
+
+template <typename Set> constexpr bool gost_round_tables_match() {
+    for (uint32_t x : {0x00000000u, 0xFFFFFFFFu, 0x01234567u, 0x89ABCDEFu,
+                       0xFDB97531u, 0x87654321u, 0x2A196F34u}) {
+        if (gost_round<Set>(x) != gost_round_reference<Set>(x)) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(gost_round_tables_match<GostSBoxCryptoProA>(),
+              "CryptoPro-A round tables");
+static_assert(gost_round_tables_match<GostSBoxTc26Z>(), "tc26 Z round tables");
+// g[87654321](fedcba98) from GOST R 34.12-2015, A.2.2.
+static_assert(gost_round<GostSBoxTc26Z>(0xFEDCBA98u + 0x87654321u) ==
+                  0xFDCBC20Cu,
+              "tc26 Z known answer");
+
+// Electronic-codebook block function under one expanded key; modes are
+// built on top of encrypt_block/decrypt_block.
+template <typename Set> class GostBlockCipher {
+  public:
+    static constexpr size_t block_size = 8;
+    static constexpr size_t key_size = 32;
+
+    GostBlockCipher() = default;
+    explicit GostBlockCipher(const unsigned char *key) { set_key(key); }
+
+    void set_key(const unsigned char *key) {
+        for (size_t i = 0; i < 8; ++i) {
+            k_[i] = load(key + 4 * i);
+        }
+    }
+
+    // Rounds 1-24 take k0..k7 three times, rounds 25-32 take k7..k0.
+    void encrypt_block(const unsigned char *in, unsigned char *out) const {
+        uint32_t n1 = load(in);
+        uint32_t n2 = load(in + 4);
+        for (int pass = 0; pass < 3; ++pass) {
+            rounds_forward(n1, n2);
+        }
+        rounds_backward(n1, n2);
+        store(out, n2);
+        store(out + 4, n1);
+    }
+
+    void decrypt_block(const unsigned char *in, unsigned char *out) const {
+        uint32_t n1 = load(in);
+        uint32_t n2 = load(in + 4);
+        rounds_forward(n1, n2);
+        for (int pass = 0; pass < 3; ++pass) {
+            rounds_backward(n1, n2);
+        }
+        store(out, n2);
+        store(out + 4, n1);
+    }
+
+    void encrypt_blocks(const unsigned char *in, unsigned char *out,
+                        size_t blocks) const {
+        for (size_t b = 0; b < blocks; ++b) {
+            encrypt_block(in + b * block_size, out + b * block_size);
+        }
+    }
+
+    void decrypt_blocks(const unsigned char *in, unsigned char *out,
+                        size_t blocks) const {
+        for (size_t b = 0; b < blocks; ++b) {
+            decrypt_block(in + b * block_size, out + b * block_size);
+        }
+    }
+
+  private:
+    static uint32_t load(const unsigned char *p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 |
+               static_cast<uint32_t>(p[3]) << 24;
+    }
+    static void store(unsigned char *p, uint32_t v) {
+        p[0] = static_cast<unsigned char>(v);
+        p[1] = static_cast<unsigned char>(v >> 8);
+        p[2] = static_cast<unsigned char>(v >> 16);
+        p[3] = static_cast<unsigned char>(v >> 24);
+    }
+
+    // Eight rounds, two per step so the halves never need swapping.
+    void rounds_forward(uint32_t &n1, uint32_t &n2) const {
+        n2 ^= gost_round<Set>(n1 + k_[0]);
+        n1 ^= gost_round<Set>(n2 + k_[1]);
+        n2 ^= gost_round<Set>(n1 + k_[2]);
+        n1 ^= gost_round<Set>(n2 + k_[3]);
+        n2 ^= gost_round<Set>(n1 + k_[4]);
+        n1 ^= gost_round<Set>(n2 + k_[5]);
+        n2 ^= gost_round<Set>(n1 + k_[6]);
+        n1 ^= gost_round<Set>(n2 + k_[7]);
+    }
+    void rounds_backward(uint32_t &n1, uint32_t &n2) const {
+        n2 ^= gost_round<Set>(n1 + k_[7]);
+        n1 ^= gost_round<Set>(n2 + k_[6]);
+        n2 ^= gost_round<Set>(n1 + k_[5]);
+        n1 ^= gost_round<Set>(n2 + k_[4]);
+        n2 ^= gost_round<Set>(n1 + k_[3]);
+        n1 ^= gost_round<Set>(n2 + k_[2]);
+        n2 ^= gost_round<Set>(n1 + k_[1]);
+        n1 ^= gost_round<Set>(n2 + k_[0]);
+    }
+
+    uint32_t k_[8] = {};
+};
+
+#endif // GOST_SBOX_HPP
@@ -0,0 +1,430 @@
+//
+//  cipher_key_store.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "cipher_key_store.hpp"
+
+#include "../common/cipher_random.hpp"
+#include "../gost/gost.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const unsigned char KEY_STORE_MAGIC[4] = {'R', 'G', 'R', 'K'};
+const size_t RECORD_HEADER_BYTES = 8;
+
+void put_le(std::vector<unsigned char> &out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+void set_le(unsigned char *out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+uint64_t get_le(const unsigned char *in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void put_field(std::vector<unsigned char> &out, const unsigned char *data,
+               size_t length) {
+    put_le(out, length, 4);
+    out.insert(out.end(), data, data + length);
+}
+
+void put_big_int(std::vector<unsigned char> &out, const BigInt &value) {
+    std::vector<unsigned char> bytes;
+    if (value != 0) {
+        boost::multiprecision::export_bits(value, std::back_inserter(bytes), 8);
+    }
+    put_field(out, bytes.data(), bytes.size());
+}
+
+// Walks the u32-length-prefixed fields of a record.
+class FieldReader {
+  public:
+    FieldReader(const unsigned char *data, size_t length)
+        : data_(data), length_(length) {}
+
+    std::pair<const unsigned char *, size_t> next() {
+        if (length_ - offset_ < 4) {
+            throw std::runtime_error("Truncated key store record.");
+        }
+        size_t size = static_cast<size_t>(get_le(data_ + offset_, 4));
+        offset_ += 4;
+        if (length_ - offset_ < size) {
+            throw std::runtime_error("Truncated key store record.");
+        }
+        const unsigned char *field = data_ + offset_;
+        offset_ += size;
+        return {field, size};
+    }
+
+    BigInt next_big_int() {
+        auto [field, size] = next();
+        BigInt value = 0;
+        if (size > 0) {
+            boost::multiprecision::import_bits(value, field, field + size);
+        }
+        return value;
+    }
+
+  private:
+    const unsigned char *data_;
+    size_t length_;
+    size_t offset_ = 0;
+};
+
+uint64_t id_hash(const unsigned char *hash_key, std::string_view id) {
+    return cipher_siphash24(hash_key,
+                            reinterpret_cast<const unsigned char *>(id.data()),
+                            id.size());
+}
+
+// Creates path + ".tmp-<random>" with O_EXCL and mode 0600 and returns its
+// descriptor, or -1 with errno set.
+int create_private_file(const std::string &path, std::string &temporary) {
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        unsigned char token[8];
+        cipher_random_fill(token, sizeof(token));
+        temporary = path + ".tmp-";
+        for (unsigned char byte : token) {
+            const char digits[] = "0123456789abcdef";
+            temporary += digits[byte >> 4];
+            temporary += digits[byte & 15];
+        }
+        int fd = ::open(temporary.c_str(),
+                        O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd >= 0 || errno != EEXIST) {
+            return fd;
+        }
+    }
+    return -1;
+}
+
+bool write_all(int fd, const unsigned char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+// --- Writer ---
+
+void CipherKeyStoreWriter::add_rsa(const std::string &id, const KeyPair &keys) {
+    Record record{id, CipherKeyKind::Rsa,
+                  static_cast<unsigned int>(keys.privKey.primes.size()),
+                  {}};
+    put_big_int(record.fields, keys.pubKey.n);
+    put_big_int(record.fields, keys.pubKey.e);
+    put_big_int(record.fields, keys.privKey.d);
+    for (const RsaPrimeFactor &factor : keys.privKey.primes) {
+        put_big_int(record.fields, factor.prime);
+        put_big_int(record.fields, factor.exponent);
+        put_big_int(record.fields, factor.coefficient);
+    }
+    records_.push_back(std::move(record));
+}
+
+void CipherKeyStoreWriter::add_gost(const std::string &id,
+                                    const unsigned char *key) {
+    Record record{id, CipherKeyKind::Gost, 0, {}};
+    put_field(record.fields, key, GOST_KEY_SIZE_BYTES);
+    records_.push_back(std::move(record));
+}
+
+CipherKeyStoreResult CipherKeyStoreWriter::write(const std::string &path) const {
+    CipherKeyStoreResult result;
+    std::unordered_set<std::string_view> seen;
+    for (const Record &record : records_) {
+        if (record.id.size() > 0xFFFF) {
+            result.message = "Key id is longer than 65535 bytes.";
+            return result;
+        }
+        if (!seen.insert(record.id).second) {
+            result.message = "Duplicate key id: " + record.id;
+            return result;
+        }
+    }
+
+    unsigned char hash_key[CIPHER_SIPHASH_KEY_BYTES];
+    cipher_random_fill(hash_key, sizeof(hash_key));
+    uint64_t slots = 2;
+    while (slots < 2 * static_cast<uint64_t>(records_.size())) {
+        slots <<= 1;
+    }
+
+    std::vector<unsigned char> file(CIPHER_KEY_STORE_HEADER_BYTES, 0);
+    std::vector<unsigned char> index(slots * CIPHER_KEY_STORE_SLOT_BYTES, 0);
+    for (const Record &record : records_) {
+        uint64_t offset = file.size();
+        size_t size = RECORD_HEADER_BYTES + record.id.size() +
+                      record.fields.size();
+        size = (size + 7) / 8 * 8;
+        put_le(file, size, 4);
+        file.push_back(static_cast<unsigned char>(record.kind));
+        file.push_back(static_cast<unsigned char>(record.prime_count));
+        put_le(file, record.id.size(), 2);
+        file.insert(file.end(), record.id.begin(), record.id.end());
+        file.insert(file.end(), record.fields.begin(), record.fields.end());
+        file.resize(offset + size, 0);
+
+        uint64_t hash = id_hash(hash_key, record.id);
+        uint64_t slot = hash & (slots - 1);
+        while (get_le(index.data() + slot * CIPHER_KEY_STORE_SLOT_BYTES + 8,
+                      8) != 0) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        set_le(index.data() + slot * CIPHER_KEY_STORE_SLOT_BYTES, hash, 8);
+        set_le(index.data() + slot * CIPHER_KEY_STORE_SLOT_BYTES + 8, offset,
+               8);
+    }
+    uint64_t index_offset = file.size();
+    file.insert(file.end(), index.begin(), index.end());
+
+    unsigned char *header = file.data();
+    std::memcpy(header, KEY_STORE_MAGIC, 4);
+    set_le(header + 4, CIPHER_KEY_STORE_VERSION, 4);
+    set_le(header + 8, records_.size(), 8);
+    set_le(header + 16, index_offset, 8);
+    set_le(header + 24, slots, 8);
+    std::memcpy(header + 32, hash_key, CIPHER_SIPHASH_KEY_BYTES);
+    set_le(header + 48, file.size(), 8);
+
+    // Written aside and renamed, so a service mapping the old file keeps a
+    // consistent view. The store holds private keys: the file is created
+    // 0600 under a fresh name, never through an existing one.
+    std::string temporary;
+    int fd = create_private_file(path, temporary);
+    if (fd < 0) {
+        result.message = "Cannot open key store for writing: " + temporary +
+                         ": " + std::strerror(errno);
+        return result;
+    }
+    bool written = write_all(fd, file.data(), file.size());
+    if (::close(fd) != 0) {
+        written = false;
+    }
+    if (!written) {
+        result.message = "Failed to write key store: " + temporary;
+        std::remove(temporary.c_str());
+        return result;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::remove(temporary.c_str());
+        result.message = "Failed to replace key store: " + ec.message();
+        return result;
+    }
+    result.success = true;
+    result.message = "Key store written.";
+    return result;
+}
+
+// --- Reader ---
+
+CipherKeyStore::~CipherKeyStore() { close(); }
+
+CipherKeyStore::CipherKeyStore(CipherKeyStore &&other) noexcept {
+    *this = std::move(other);
+}
+
+CipherKeyStore &CipherKeyStore::operator=(CipherKeyStore &&other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        length_ = std::exchange(other.length_, 0);
+        record_count_ = std::exchange(other.record_count_, 0);
+        index_offset_ = std::exchange(other.index_offset_, 0);
+        index_slots_ = std::exchange(other.index_slots_, 0);
+        std::memcpy(hash_key_, other.hash_key_, sizeof(hash_key_));
+    }
+    return *this;
+}
+
+CipherKeyStoreResult CipherKeyStore::open(const std::string &path) {
+    close();
+    CipherKeyStoreResult result;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        result.message = "Cannot open key store: " + path;
+        return result;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<uint64_t>(st.st_size) < CIPHER_KEY_STORE_HEADER_BYTES) {
+        ::close(fd);
+        result.message = "Not a key store: " + path;
+        return result;
+    }
+    size_t length = static_cast<size_t>(st.st_size);
+    void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        result.message = "Cannot map key store: " + path;
+        return result;
+    }
+    const unsigned char *data = static_cast<const unsigned char *>(mapping);
+
+    uint64_t slots = get_le(data + 24, 8);
+    uint64_t index_offset = get_le(data + 16, 8);
+    bool valid =
+        std::memcmp(data, KEY_STORE_MAGIC, 4) == 0 &&
+        get_le(data + 4, 4) == CIPHER_KEY_STORE_VERSION &&
+        get_le(data + 48, 8) == length && slots != 0 &&
+        (slots & (slots - 1)) == 0 && get_le(data + 8, 8) < slots &&
+        index_offset >= CIPHER_KEY_STORE_HEADER_BYTES &&
+        index_offset <= length &&
+        (length - index_offset) / CIPHER_KEY_STORE_SLOT_BYTES >= slots;
+    if (!valid) {
+        ::munmap(mapping, length);
+        result.message = "Not a key store or unsupported version: " + path;
+        return result;
+    }
+    data_ = data;
+    length_ = length;
+    record_count_ = get_le(data + 8, 8);
+    index_offset_ = index_offset;
+    index_slots_ = slots;
+    std::memcpy(hash_key_, data + 32, sizeof(hash_key_));
+    result.success = true;
+    result.message = "Key store opened.";
+    return result;
+}
+
+void CipherKeyStore::close() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<unsigned char *>(data_), length_);
+        data_ = nullptr;
+        length_ = 0;
+        record_count_ = 0;
+    }
+}
+
+CipherKeyView CipherKeyStore::record_at(uint64_t offset) const {
+    if (offset < CIPHER_KEY_STORE_HEADER_BYTES ||
+        offset > index_offset_ - RECORD_HEADER_BYTES) {
+        throw std::runtime_error("Key store record is out of bounds.");
+    }
+    const unsigned char *record = data_ + offset;
+    uint64_t size = get_le(record, 4);
+    size_t id_length = static_cast<size_t>(get_le(record + 6, 2));
+    if (size < RECORD_HEADER_BYTES + id_length ||
+        size > index_offset_ - offset) {
+        throw std::runtime_error("Key store record is out of bounds.");
+    }
+    CipherKeyView key;
+    key.kind = static_cast<CipherKeyKind>(record[4]);
+    key.prime_count = record[5];
+    key.id = std::string_view(
+        reinterpret_cast<const char *>(record + RECORD_HEADER_BYTES),
+        id_length);
+    key.fields = record + RECORD_HEADER_BYTES + id_length;
+    key.fields_length =
+        static_cast<size_t>(size) - RECORD_HEADER_BYTES - id_length;
+    return key;
+}
+
+bool CipherKeyStore::find(std::string_view id, CipherKeyView &key) const {
+    if (data_ == nullptr) {
+        return false;
+    }
+    uint64_t hash = id_hash(hash_key_, id);
+    uint64_t mask = index_slots_ - 1;
+    const unsigned char *index = data_ + index_offset_;
+    for (uint64_t probe = 0, slot = hash & mask; probe < index_slots_;
+         ++probe, slot = (slot + 1) & mask) {
+        const unsigned char *entry = index + slot * CIPHER_KEY_STORE_SLOT_BYTES;
+        uint64_t offset = get_le(entry + 8, 8);
+        if (offset == 0) {
+            return false;
+        }
+        if (get_le(entry, 8) != hash) {
+            continue;
+        }
+        CipherKeyView candidate = record_at(offset);
+        if (candidate.id == id) {
+            key = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> CipherKeyStore::ids() const {
+    std::vector<std::string> ids;
+    ids.reserve(static_cast<size_t>(record_count_));
+    uint64_t offset = CIPHER_KEY_STORE_HEADER_BYTES;
+    for (uint64_t i = 0; i < record_count_; ++i) {
+        CipherKeyView key = record_at(offset);
+        ids.emplace_back(key.id);
+        offset += get_le(data_ + offset, 4);
+    }
+    return ids;
+}
+
+// --- Decoders ---
+
+KeyPair cipher_key_rsa(const CipherKeyView &key) {
+    if (key.kind != CipherKeyKind::Rsa) {
+        throw std::runtime_error("Key store entry is not an RSA key.");
+    }
+    FieldReader fields(key.fields, key.fields_length);
+    KeyPair keys;
+    keys.pubKey.n = fields.next_big_int();
+    keys.pubKey.e = fields.next_big_int();
+    keys.privKey.n = keys.pubKey.n;
+    keys.privKey.d = fields.next_big_int();
+    keys.privKey.primes.resize(key.prime_count);
+    for (RsaPrimeFactor &factor : keys.privKey.primes) {
+        factor.prime = fields.next_big_int();
+        factor.exponent = fields.next_big_int();
+        factor.coefficient = fields.next_big_int();
+    }
+    return keys;
+}
+
+const unsigned char *cipher_key_gost(const CipherKeyView &key) {
+    if (key.kind != CipherKeyKind::Gost) {
+        throw std::runtime_error("Key store entry is not a GOST key.");
+    }
+    FieldReader fields(key.fields, key.fields_length);
+    auto [data, size] = fields.next();
+    if (size != GOST_KEY_SIZE_BYTES) {
+        throw std::runtime_error("Key store GOST key has the wrong length.");
+    }
+    return data;
+}
@@ -0,0 +1,116 @@
+//
+//  cipher_key_store.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef CIPHER_KEY_STORE_HPP
+#define CIPHER_KEY_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common/cipher_siphash.hpp"
+#include "../rsa/rsa.hpp"
+
+// Binary key file holding many keys with their precomputed material, read
+// through one read-only mapping (little-endian throughout):
+//
+//   header   "RGRK", u32 version, u64 record count, u64 index offset,
+//            u64 index slots (a power of two), 16-byte SipHash key,
+//            u64 file size, u64 zero
+//   records  8-byte aligned: u32 record size, u8 kind, u8 prime count,
+//            u16 id length, id, then fields of u32 length + bytes.
+//            RSA: n, e, d (big-endian; empty when unknown) and per prime
+//            its value, CRT exponent and coefficient. GOST: the 32-byte
+//            key, which is also the placeholder cipher's key schedule
+//   index    open-addressed table of u64 SipHash(id), u64 record offset
+//            (0 marks an empty slot), probed linearly
+//
+// Opening a store maps the file and checks the header; finding a key is one
+// SipHash of its id and a short probe, so a store of thousands of keys opens
+// in constant time and no key is parsed before it is used.
+const uint32_t CIPHER_KEY_STORE_VERSION = 1;
+const size_t CIPHER_KEY_STORE_HEADER_BYTES = 64;
+const size_t CIPHER_KEY_STORE_SLOT_BYTES = 16;
+
+enum class CipherKeyKind : uint8_t { Rsa = 1, Gost = 2 };
+
+// A key inside an open store; id and fields point into the mapping and stay
+// valid until the store is closed.
+struct CipherKeyView {
+    CipherKeyKind kind = CipherKeyKind::Rsa;
+    unsigned int prime_count = 0;
+    std::string_view id;
+    const unsigned char *fields = nullptr;
+    size_t fields_length = 0;
+};
+
+struct CipherKeyStoreResult {
+    bool success = false;
+    std::string message;
+};
+
+class CipherKeyStoreWriter {
+  public:
+    // keys.privKey.d may be 0 for a public-only key; its primes, when
+    // present, are stored for CRT decryption.
+    void add_rsa(const std::string &id, const KeyPair &keys);
+    // key is GOST_KEY_SIZE_BYTES raw bytes.
+    void add_gost(const std::string &id, const unsigned char *key);
+    size_t size() const { return records_.size(); }
+    // Fails on duplicate ids. The file is written under a unique temporary
+    // name with mode 0600 and renamed over path.
+    CipherKeyStoreResult write(const std::string &path) const;
+
+  private:
+    struct Record {
+        std::string id;
+        CipherKeyKind kind;
+        unsigned int prime_count;
+        std::vector<unsigned char> fields;
+    };
+    std::vector<Record> records_;
+};
+
+class CipherKeyStore {
+  public:
+    CipherKeyStore() = default;
+    ~CipherKeyStore();
+    CipherKeyStore(CipherKeyStore &&other) noexcept;
+    CipherKeyStore &operator=(CipherKeyStore &&other) noexcept;
+    CipherKeyStore(const CipherKeyStore &) = delete;
+    CipherKeyStore &operator=(const CipherKeyStore &) = delete;
+
+    CipherKeyStoreResult open(const std::string &path);
+    void close();
+    bool is_open() const { return data_ != nullptr; }
+    size_t size() const { return record_count_; }
+
+    // False when id is not in the store; throws std::runtime_error for a
+    // record that does not fit the file.
+    bool find(std::string_view id, CipherKeyView &key) const;
+    std::vector<std::string> ids() const;
+
+  private:
+    const unsigned char *data_ = nullptr;
+    size_t length_ = 0;
+    uint64_t record_count_ = 0;
+    uint64_t index_offset_ = 0;
+    uint64_t index_slots_ = 0;
+    unsigned char hash_key_[CIPHER_SIPHASH_KEY_BYTES] = {};
+
+    CipherKeyView record_at(uint64_t offset) const;
+};
+
+// Decoders for a found key; both throw std::runtime_error when the record
+// is of another kind or malformed. cipher_key_gost returns the key inside
+// the mapping, ready for gost_encrypt_to and friends.
+KeyPair cipher_key_rsa(const CipherKeyView &key);
+const unsigned char *cipher_key_gost(const CipherKeyView &key);
+
+#endif // CIPHER_KEY_STORE_HPP
@@ -6,22 +6,33 @@
 //
 
 #import "PermutationCipherObjectiveCWrapper.h"
-#include "permutation_cipher.hpp"
+#include "../capi/rgr_crypto.h"
 
-#import <string>
-#import <vector>
-#import <sstream>
-#import <iomanip>
+// Thin shim over the C ABI in rgr_crypto.h.
 
-static std::string NSStringToStdString_Perm(NSString *nsString) {
-    if (nsString == nil) {
-        return "";
+typedef int (^RgrOutputCall_Perm)(uint8_t *out, size_t capacity, size_t *length);
+
+// Runs call once as a size query and once into a buffer of that size;
+// returns nil on failure.
+static NSData *RunWithOutput_Perm(RgrOutputCall_Perm call) {
+    size_t length = 0;
+    int status = call(NULL, 0, &length);
+    if (status == RGR_OK) {
+        return [NSData data];
+    }
+    if (status != RGR_ERR_BUFFER_TOO_SMALL) {
+        return nil;
     }
-    return std::string([nsString UTF8String]);
+    NSMutableData *output = [NSMutableData dataWithLength:length];
+    if (call((uint8_t *)output.mutableBytes, length, &length) != RGR_OK) {
+        return nil;
+    }
+    output.length = length;
+    return output;
 }
 
-static NSString *StdStringToNSString_Perm(const std::string& stdString) {
-    return [NSString stringWithUTF8String:stdString.c_str()];
+static NSString *LastError_Perm(void) {
+    return [NSString stringWithUTF8String:rgr_last_error()];
 }
 
 @implementation PermutationCipherObjectiveCWrapper
@@ -34,22 +45,20 @@ static NSString *StdStringToNSString_Perm(const std::string& stdString) {
         return @"Error: Permutation KeyString cannot be empty.";
     }
 
-    try {
-        std::string std_plaintext = NSStringToStdString_Perm(plaintext);
-        std::string std_key_string = NSStringToStdString_Perm(keyString);
-
-        PermutationTextResultCpp cpp_result = encryptTextPermutationCpp(std_plaintext, std_key_string);
-
-        if (cpp_result.success) {
-            return StdStringToNSString_Perm(cpp_result.data_hex);
-        } else {
-            return [NSString stringWithFormat:@"Error: Permutation Encrypt Text - %s", cpp_result.error_message.c_str()];
-        }
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Exception during permutation text encryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during permutation text encryption.";
+    const char *key = [keyString UTF8String];
+    size_t key_length = strlen(key);
+    NSData *input = [plaintext dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *output = RunWithOutput_Perm(^int(uint8_t *out, size_t capacity, size_t *length) {
+        return rgr_permutation_encrypt(key, key_length, (const uint8_t *)input.bytes, input.length, out, capacity, length);
+    });
+    if (output == nil) {
+        return [NSString stringWithFormat:@"Error: Permutation Encrypt Text - %@", LastError_Perm()];
     }
+
+    NSMutableData *text = [NSMutableData dataWithLength:output.length * 2];
+    size_t text_length = 0;
+    rgr_text_encode(RGR_TEXT_HEX, (const uint8_t *)output.bytes, output.length, (char *)text.mutableBytes, text.length, &text_length);
+    return [[NSString alloc] initWithBytes:text.bytes length:text_length encoding:NSASCIIStringEncoding];
 }
 
 - (NSString *)decryptTextPermutation:(NSString *)hexCiphertext keyString:(NSString *)keyString {
@@ -63,22 +72,28 @@ static NSString *StdStringToNSString_Perm(const std::string& stdString) {
         return @"";
     }
 
-    try {
-        std::string std_hex_ciphertext = NSStringToStdString_Perm(hexCiphertext);
-        std::string std_key_string = NSStringToStdString_Perm(keyString);
-
-        PermutationTextResultCpp cpp_result = decryptTextPermutationCpp(std_hex_ciphertext, std_key_string);
-
-        if (cpp_result.success) {
-            return StdStringToNSString_Perm(cpp_result.data_hex); 
-        } else {
-            return [NSString stringWithFormat:@"Error: Permutation Decrypt Text - %s", cpp_result.error_message.c_str()];
-        }
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Exception during permutation text decryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during permutation text decryption.";
+    const char *hex = [hexCiphertext UTF8String];
+    size_t hex_length = strlen(hex);
+    NSMutableData *ciphertext = [NSMutableData dataWithLength:hex_length / 2];
+    size_t ciphertext_length = 0;
+    if (rgr_text_decode(RGR_TEXT_HEX, hex, hex_length, (uint8_t *)ciphertext.mutableBytes, ciphertext.length, &ciphertext_length) != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: Permutation Decrypt Text - %@", LastError_Perm()];
+    }
+    ciphertext.length = ciphertext_length;
+
+    const char *key = [keyString UTF8String];
+    size_t key_length = strlen(key);
+    NSData *output = RunWithOutput_Perm(^int(uint8_t *out, size_t capacity, size_t *length) {
+        return rgr_permutation_decrypt(key, key_length, (const uint8_t *)ciphertext.bytes, ciphertext.length, out, capacity, length);
+    });
+    if (output == nil) {
+        return [NSString stringWithFormat:@"Error: Permutation Decrypt Text - %@", LastError_Perm()];
     }
+    NSString *plaintext = [[NSString alloc] initWithData:output encoding:NSUTF8StringEncoding];
+    if (plaintext == nil) {
+        return @"Error: Permutation Decrypt Text - Decrypted data is not valid UTF-8.";
+    }
+    return plaintext;
 }
 
 - (NSString *)encryptFilePermutation:(NSString *)inputFilePath
@@ -91,23 +106,12 @@ static NSString *StdStringToNSString_Perm(const std::string& stdString) {
         return @"Error: File paths and KeyString cannot be empty for permutation file encryption.";
     }
 
-    try {
-        std::string std_input_path = NSStringToStdString_Perm(inputFilePath);
-        std::string std_output_path = NSStringToStdString_Perm(outputFilePath);
-        std::string std_key_string = NSStringToStdString_Perm(keyString);
-
-        PermutationFileResultCpp cpp_fres = encryptFilePermutationCpp(std_input_path, std_output_path, std_key_string);
-
-        if (cpp_fres.success) {
-            return StdStringToNSString_Perm(cpp_fres.message);
-        } else {
-            return [NSString stringWithFormat:@"Error: Permutation Encrypt File - %s", cpp_fres.message.c_str()];
-        }
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Exception during permutation file encryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during permutation file encryption.";
+    const char *key = [keyString UTF8String];
+    int status = rgr_permutation_encrypt_file([inputFilePath fileSystemRepresentation], [outputFilePath fileSystemRepresentation], key, strlen(key), 0);
+    if (status != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: Permutation Encrypt File - %@", LastError_Perm()];
     }
+    return @"File successfully encrypted with permutation cipher.";
 }
 
 - (NSString *)decryptFilePermutation:(NSString *)inputFilePath
@@ -120,23 +124,12 @@ static NSString *StdStringToNSString_Perm(const std::string& stdString) {
         return @"Error: File paths and KeyString cannot be empty for permutation file decryption.";
     }
 
-    try {
-        std::string std_input_path = NSStringToStdString_Perm(inputFilePath);
-        std::string std_output_path = NSStringToStdString_Perm(outputFilePath);
-        std::string std_key_string = NSStringToStdString_Perm(keyString);
-
-        PermutationFileResultCpp cpp_fres = decryptFilePermutationCpp(std_input_path, std_output_path, std_key_string);
-
-        if (cpp_fres.success) {
-            return StdStringToNSString_Perm(cpp_fres.message);
-        } else {
-            return [NSString stringWithFormat:@"Error: Permutation Decrypt File - %s", cpp_fres.message.c_str()];
-        }
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Exception during permutation file decryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during permutation file decryption.";
+    const char *key = [keyString UTF8String];
+    int status = rgr_permutation_decrypt_file([inputFilePath fileSystemRepresentation], [outputFilePath fileSystemRepresentation], key, strlen(key));
+    if (status != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: Permutation Decrypt File - %@", LastError_Perm()];
     }
+    return @"File successfully decrypted with permutation cipher.";
 }
 
 @end
@@ -5,6 +5,7 @@
 //  Created by Stanislav Klepikov on 30.05.2025.
 //
 #include "permutation_cipher.hpp"
+#include "../container/cipher_container.hpp"
 #include <vector>
 #include <string>
 #include <numeric>
@@ -13,6 +14,17 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PERM_HAVE_SSSE3_TARGET 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PERM_HAVE_NEON 1
+#endif
 std::vector<unsigned char> hexStringToBytes_perm_cpp(const std::string& hex) {
     if (hex.length() % 2 != 0) {
         throw std::invalid_argument("Hex string must have an even number of characters for permutation cipher.");
@@ -125,58 +137,249 @@ std::vector<unsigned char> apply_permutation_cpp(const std::vector<unsigned char
     return result;
 }
 
-std::vector<unsigned char> permutation_encrypt_data_cpp(const std::vector<unsigned char>& plaintext, const std::string& key_str) {
+std::shared_ptr<const CompiledPermutationKey> compile_permutation_key_cpp(const std::string& key_str) {
     std::vector<size_t> p_map;
-    if (!parse_permutation_key_cpp(key_str, p_map) || p_map.empty()) {
-        throw std::invalid_argument("Invalid permutation key string for encryption.");
+    if (!parse_permutation_key_cpp(key_str, p_map) || p_map.empty() || p_map.size() > PERMUTATION_MAX_BLOCK_SIZE) {
+        return nullptr;
+    }
+    auto compiled = std::make_shared<CompiledPermutationKey>();
+    compiled->key_str = key_str;
+    compiled->block_size = p_map.size();
+    compiled->inverse_map = invert_permutation_cpp(p_map);
+    compiled->forward_map = std::move(p_map);
+
+    size_t n = compiled->block_size;
+    compiled->blocks_per_mask = PERMUTATION_SHUFFLE_WIDTH / n;
+    for (size_t lane = 0; lane < PERMUTATION_SHUFFLE_WIDTH; ++lane) {
+        compiled->forward_mask[lane] = static_cast<unsigned char>(lane);
+        compiled->inverse_mask[lane] = static_cast<unsigned char>(lane);
+    }
+    for (size_t b = 0; b < compiled->blocks_per_mask; ++b) {
+        for (size_t i = 0; i < n; ++i) {
+            compiled->forward_mask[b * n + i] = static_cast<unsigned char>(b * n + compiled->forward_map[i]);
+            compiled->inverse_mask[b * n + i] = static_cast<unsigned char>(b * n + compiled->inverse_map[i]);
+        }
     }
-    size_t block_size = p_map.size();
-    std::vector<unsigned char> padded_plaintext = plaintext;
-    pkcs7_pad_perm(padded_plaintext, block_size);
+    return compiled;
+}
 
-    std::vector<unsigned char> ciphertext;
-    ciphertext.reserve(padded_plaintext.size());
+namespace {
 
-    for (size_t i = 0; i < padded_plaintext.size(); i += block_size) {
-        std::vector<unsigned char> current_block(padded_plaintext.begin() + i, padded_plaintext.begin() + i + block_size);
-        std::vector<unsigned char> permuted_block = apply_permutation_cpp(current_block, p_map);
-        ciphertext.insert(ciphertext.end(), permuted_block.begin(), permuted_block.end());
+struct PermutationKeyCache {
+    using Entry = std::pair<std::string, std::shared_ptr<const CompiledPermutationKey>>;
+    std::mutex mutex;
+    size_t capacity = PERMUTATION_KEY_CACHE_DEFAULT_CAPACITY;
+    std::list<Entry> lru; // most recently used at the front
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    void evict_to(size_t limit) {
+        while (lru.size() > limit) {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
     }
-    return ciphertext;
+};
+
+PermutationKeyCache& permutation_key_cache() {
+    static PermutationKeyCache cache;
+    return cache;
 }
 
-std::vector<unsigned char> permutation_decrypt_data_cpp(const std::vector<unsigned char>& ciphertext, const std::string& key_str) {
-    std::vector<size_t> p_map_encrypt;
-    if (!parse_permutation_key_cpp(key_str, p_map_encrypt) || p_map_encrypt.empty()) {
-        throw std::invalid_argument("Invalid permutation key string for decryption.");
+} // namespace
+
+std::shared_ptr<const CompiledPermutationKey> get_compiled_permutation_key_cpp(const std::string& key_str) {
+    PermutationKeyCache& cache = permutation_key_cache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.index.find(key_str);
+        if (it != cache.index.end()) {
+            cache.lru.splice(cache.lru.begin(), cache.lru, it->second);
+            return it->second->second;
+        }
     }
-    size_t block_size = p_map_encrypt.size();
-    if (ciphertext.size() % block_size != 0) {
-        throw std::invalid_argument("Ciphertext size is not a multiple of the block size defined by the key.");
+
+    // Compile outside the lock; a concurrent miss on the same key just
+    // produces an identical object and the first insert wins.
+    std::shared_ptr<const CompiledPermutationKey> compiled = compile_permutation_key_cpp(key_str);
+    if (!compiled) return nullptr;
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.capacity == 0) return compiled;
+    auto it = cache.index.find(key_str);
+    if (it != cache.index.end()) {
+        cache.lru.splice(cache.lru.begin(), cache.lru, it->second);
+        return it->second->second;
+    }
+    cache.lru.emplace_front(key_str, compiled);
+    cache.index[key_str] = cache.lru.begin();
+    cache.evict_to(cache.capacity);
+    return compiled;
+}
+
+void set_permutation_key_cache_capacity_cpp(size_t capacity) {
+    PermutationKeyCache& cache = permutation_key_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.capacity = capacity;
+    cache.evict_to(capacity);
+}
+
+void clear_permutation_key_cache_cpp() {
+    PermutationKeyCache& cache = permutation_key_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.lru.clear();
+    cache.index.clear();
+}
+
+namespace {
+
+// Scalar fallback: one block at a time through a small stack buffer so that
+// in-place operation works.
+void permute_blocks_scalar(const unsigned char* in, unsigned char* out, size_t length,
+                           const std::vector<size_t>& map) {
+    size_t n = map.size();
+    unsigned char block[PERMUTATION_MAX_BLOCK_SIZE];
+    for (size_t i = 0; i < length; i += n) {
+        std::memcpy(block, in + i, n);
+        for (size_t j = 0; j < n; ++j) {
+            out[i + j] = block[map[j]];
+        }
     }
+}
 
-    std::vector<size_t> p_map_decrypt = invert_permutation_cpp(p_map_encrypt);
-    std::vector<unsigned char> padded_plaintext;
-    padded_plaintext.reserve(ciphertext.size());
+#if defined(PERM_HAVE_SSSE3_TARGET)
+__attribute__((target("ssse3")))
+size_t permute_blocks_ssse3(const unsigned char* in, unsigned char* out, size_t length,
+                            size_t step, const unsigned char* mask_bytes) {
+    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask_bytes));
+    size_t i = 0;
+    for (; i + PERMUTATION_SHUFFLE_WIDTH <= length; i += step) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(v, mask));
+    }
+    return i;
+}
 
-    for (size_t i = 0; i < ciphertext.size(); i += block_size) {
-        std::vector<unsigned char> current_block(ciphertext.begin() + i, ciphertext.begin() + i + block_size);
-        std::vector<unsigned char> unpermuted_block = apply_permutation_cpp(current_block, p_map_decrypt);
-        padded_plaintext.insert(padded_plaintext.end(), unpermuted_block.begin(), unpermuted_block.end());
+bool cpu_has_ssse3() {
+    static const bool has = __builtin_cpu_supports("ssse3");
+    return has;
+}
+#elif defined(PERM_HAVE_NEON)
+size_t permute_blocks_neon(const unsigned char* in, unsigned char* out, size_t length,
+                           size_t step, const unsigned char* mask_bytes) {
+    const uint8x16_t mask = vld1q_u8(mask_bytes);
+    size_t i = 0;
+    for (; i + PERMUTATION_SHUFFLE_WIDTH <= length; i += step) {
+        vst1q_u8(out + i, vqtbl1q_u8(vld1q_u8(in + i), mask));
     }
+    return i;
+}
+#endif
 
-    if (!pkcs7_unpad_perm(padded_plaintext, block_size)) {
+} // namespace
+
+void permute_blocks_cpp(const unsigned char* in, unsigned char* out, size_t length,
+                        const CompiledPermutationKey& key, bool inverse) {
+    if (key.block_size == 0 || length % key.block_size != 0) {
+        throw std::invalid_argument("Data length must be a multiple of the permutation block size.");
+    }
+    const std::vector<size_t>& map = inverse ? key.inverse_map : key.forward_map;
+    size_t done = 0;
+    // Each step writes a full 16-byte register but only advances over whole
+    // blocks; the identity lanes past them rewrite bytes the next step (or the
+    // scalar tail) overwrites anyway.
+    size_t step = key.blocks_per_mask * key.block_size;
+    const unsigned char* mask = inverse ? key.inverse_mask.data() : key.forward_mask.data();
+#if defined(PERM_HAVE_SSSE3_TARGET)
+    if (cpu_has_ssse3()) {
+        done = permute_blocks_ssse3(in, out, length, step, mask);
+    }
+#elif defined(PERM_HAVE_NEON)
+    done = permute_blocks_neon(in, out, length, step, mask);
+#else
+    (void)step;
+    (void)mask;
+#endif
+    permute_blocks_scalar(in + done, out + done, length - done, map);
+}
+
+size_t permutation_encrypt_to(const CompiledPermutationKey& key, const unsigned char* in, size_t length, unsigned char* out) {
+    size_t padded = (length / key.block_size + 1) * key.block_size;
+    {
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Permutation, CipherInstrStage::Padding, length);
+        if (length > 0) {
+            std::memcpy(out, in, length);
+        }
+        std::memset(out + length, static_cast<int>(padded - length), padded - length);
+    }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Permutation, CipherInstrStage::Kernel, padded);
+    permute_blocks_cpp(out, out, padded, key, false);
+    return padded;
+}
+
+size_t permutation_decrypt_to(const CompiledPermutationKey& key, const unsigned char* in, size_t length, unsigned char* out) {
+    if (length % key.block_size != 0) {
+        throw std::invalid_argument("Ciphertext size is not a multiple of the block size defined by the key.");
+    }
+    {
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Permutation, CipherInstrStage::Kernel, length);
+        permute_blocks_cpp(in, out, length, key, true);
+    }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Permutation, CipherInstrStage::Padding, length);
+    unsigned char padding_len = length > 0 ? out[length - 1] : 0;
+    bool valid = padding_len != 0 && padding_len <= length && padding_len <= key.block_size;
+    for (size_t i = 0; valid && i < padding_len; ++i) {
+        valid = out[length - 1 - i] == padding_len;
+    }
+    if (!valid) {
         throw std::runtime_error("Permutation decryption failed due to invalid padding.");
     }
-    return padded_plaintext;
+    return length - padding_len;
+}
+
+namespace {
+
+std::vector<unsigned char> permutation_encrypt_bytes(const unsigned char* data, size_t length, const std::string& key_str) {
+    std::shared_ptr<const CompiledPermutationKey> key = get_compiled_permutation_key_cpp(key_str);
+    if (!key) {
+        throw std::invalid_argument("Invalid permutation key string for encryption.");
+    }
+    std::vector<unsigned char> ciphertext((length / key->block_size + 1) * key->block_size);
+    CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Permutation, 1);
+    permutation_encrypt_to(*key, data, length, ciphertext.data());
+    return ciphertext;
+}
+
+std::vector<unsigned char> permutation_decrypt_bytes(const unsigned char* data, size_t length, const std::string& key_str) {
+    std::shared_ptr<const CompiledPermutationKey> key = get_compiled_permutation_key_cpp(key_str);
+    if (!key) {
+        throw std::invalid_argument("Invalid permutation key string for decryption.");
+    }
+    if (length % key->block_size != 0) {
+        throw std::invalid_argument("Ciphertext size is not a multiple of the block size defined by the key.");
+    }
+    std::vector<unsigned char> plaintext(length);
+    CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Permutation, 1);
+    plaintext.resize(permutation_decrypt_to(*key, data, length, plaintext.data()));
+    return plaintext;
+}
+
+} // namespace
+
+std::vector<unsigned char> permutation_encrypt_data_cpp(const std::vector<unsigned char>& plaintext, const std::string& key_str) {
+    return permutation_encrypt_bytes(plaintext.data(), plaintext.size(), key_str);
+}
+
+std::vector<unsigned char> permutation_decrypt_data_cpp(const std::vector<unsigned char>& ciphertext, const std::string& key_str) {
+    return permutation_decrypt_bytes(ciphertext.data(), ciphertext.size(), key_str);
 }
 
-PermutationTextResultCpp encryptTextPermutationCpp(const std::string& plaintext, const std::string& key_str) {
+PermutationTextResultCpp encryptTextPermutationCpp(const std::string& plaintext, const std::string& key_str, CipherTextEncoding encoding) {
     PermutationTextResultCpp result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Permutation);
     try {
-        std::vector<unsigned char> plaintext_bytes(plaintext.begin(), plaintext.end());
-        std::vector<unsigned char> ciphertext_bytes = permutation_encrypt_data_cpp(plaintext_bytes, key_str);
-        result.data_hex = bytesToHexString_perm_cpp(ciphertext_bytes);
+        std::vector<unsigned char> ciphertext_bytes = permutation_encrypt_bytes(reinterpret_cast<const unsigned char*>(plaintext.data()), plaintext.size(), key_str);
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Permutation, CipherInstrStage::HexEncode, ciphertext_bytes.size());
+        result.data_hex = cipher_text_encode(ciphertext_bytes, encoding);
         result.success = true;
     } catch (const std::exception& e) {
         result.error_message = std::string("C++ Permutation Encrypt Text: ") + e.what();
@@ -184,11 +387,16 @@ PermutationTextResultCpp encryptTextPermutationCpp(const std::string& plaintext,
     return result;
 }
 
-PermutationTextResultCpp decryptTextPermutationCpp(const std::string& ciphertext_hex, const std::string& key_str) {
+PermutationTextResultCpp decryptTextPermutationCpp(const std::string& ciphertext_hex, const std::string& key_str, CipherTextEncoding encoding) {
     PermutationTextResultCpp result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Permutation);
     try {
-        std::vector<unsigned char> ciphertext_bytes = hexStringToBytes_perm_cpp(ciphertext_hex);
-        std::vector<unsigned char> plaintext_bytes = permutation_decrypt_data_cpp(ciphertext_bytes, key_str);
+        std::vector<unsigned char> ciphertext_bytes;
+        {
+            CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Permutation, CipherInstrStage::HexDecode, ciphertext_hex.size() / 2);
+            ciphertext_bytes = cipher_text_decode(ciphertext_hex, encoding);
+        }
+        std::vector<unsigned char> plaintext_bytes = permutation_decrypt_bytes(ciphertext_bytes.data(), ciphertext_bytes.size(), key_str);
         result.data_hex = std::string(plaintext_bytes.begin(), plaintext_bytes.end()); // Decrypted text is string, not hex
         result.success = true;
     } catch (const std::exception& e) {
@@ -197,93 +405,217 @@ PermutationTextResultCpp decryptTextPermutationCpp(const std::string& ciphertext
     return result;
 }
 
-PermutationFileResultCpp encryptFilePermutationCpp(const std::string& inputFilePath, const std::string& outputFilePath, const std::string& key_str) {
-    PermutationFileResultCpp fres;
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    if (!inputFile) {
-        fres.message = "Error opening input file: " + inputFilePath;
-        return fres;
-    }
-    std::ofstream outputFile(outputFilePath, std::ios::binary | std::ios::trunc);
-    if (!outputFile) {
-        fres.message = "Error opening output file: " + outputFilePath;
-        return fres;
+CipherBytesResult encryptBytesPermutationCpp(const unsigned char* data, size_t length, const std::string& key_str) {
+    CipherBytesResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Permutation);
+    try {
+        result.data = permutation_encrypt_bytes(data, length, key_str);
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.error_message = std::string("C++ Permutation Encrypt Bytes: ") + e.what();
     }
+    return result;
+}
 
+CipherBytesResult decryptBytesPermutationCpp(const unsigned char* data, size_t length, const std::string& key_str) {
+    CipherBytesResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Permutation);
     try {
-        inputFile.seekg(0, std::ios::end);
-        std::streamsize fileSize = inputFile.tellg();
-        inputFile.seekg(0, std::ios::beg);
-        std::vector<unsigned char> plaintext_bytes(static_cast<size_t>(fileSize));
-        if (fileSize > 0) {
-            inputFile.read(reinterpret_cast<char*>(plaintext_bytes.data()), fileSize);
+        result.data = permutation_decrypt_bytes(data, length, key_str);
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.error_message = std::string("C++ Permutation Decrypt Bytes: ") + e.what();
+    }
+    return result;
+}
+
+CipherBatchResult encryptBatchPermutationCpp(const unsigned char* input, size_t input_size,
+                                             const std::vector<CipherBatchRecord>& records,
+                                             const std::string& key_str) {
+    CipherBatchResult result;
+    std::shared_ptr<const CompiledPermutationKey> key = get_compiled_permutation_key_cpp(key_str);
+    if (!key) {
+        result.error_message = "C++ Permutation Encrypt Batch: Invalid permutation key string for encryption.";
+        return result;
+    }
+    size_t block_size = key->block_size;
+    size_t arena_size = 0;
+    for (const CipherBatchRecord& record : records) {
+        arena_size += record.length + block_size;
+    }
+    cipher_batch_begin(result, records.size(), arena_size);
+
+    for (size_t r = 0; r < records.size(); ++r) {
+        const CipherBatchRecord& record = records[r];
+        if (!cipher_batch_record_in_range(record, input_size)) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::OutOfRange);
+            continue;
         }
-        if (!inputFile && !inputFile.eof() && fileSize > 0) {
-            fres.message = "Error reading input file content.";
-            return fres;
+        size_t padded = (record.length / block_size + 1) * block_size;
+        size_t start = result.arena.size();
+        result.arena.resize(start + padded);
+        unsigned char* out = result.arena.data() + start;
+        std::memcpy(out, input + record.offset, record.length);
+        std::memset(out + record.length, static_cast<int>(padded - record.length), padded - record.length);
+        permute_blocks_cpp(out, out, padded, *key, false);
+        cipher_batch_finish_record(result, r, CipherBatchStatus::Ok);
+    }
+    result.success = true;
+    return result;
+}
+
+CipherBatchResult decryptBatchPermutationCpp(const unsigned char* input, size_t input_size,
+                                             const std::vector<CipherBatchRecord>& records,
+                                             const std::string& key_str) {
+    CipherBatchResult result;
+    std::shared_ptr<const CompiledPermutationKey> key = get_compiled_permutation_key_cpp(key_str);
+    if (!key) {
+        result.error_message = "C++ Permutation Decrypt Batch: Invalid permutation key string for decryption.";
+        return result;
+    }
+    size_t block_size = key->block_size;
+    size_t arena_size = 0;
+    for (const CipherBatchRecord& record : records) {
+        arena_size += record.length;
+    }
+    cipher_batch_begin(result, records.size(), arena_size);
+
+    for (size_t r = 0; r < records.size(); ++r) {
+        const CipherBatchRecord& record = records[r];
+        if (!cipher_batch_record_in_range(record, input_size)) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::OutOfRange);
+            continue;
         }
+        if (record.length == 0 || record.length % block_size != 0) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::InvalidInput);
+            continue;
+        }
+        size_t start = result.arena.size();
+        result.arena.resize(start + record.length);
+        unsigned char* out = result.arena.data() + start;
+        permute_blocks_cpp(input + record.offset, out, record.length, *key, true);
+
+        unsigned char padding_len = out[record.length - 1];
+        bool padding_ok = padding_len != 0 && padding_len <= block_size;
+        for (size_t i = 0; padding_ok && i < padding_len; ++i) {
+            padding_ok = out[record.length - 1 - i] == padding_len;
+        }
+        if (!padding_ok) {
+            cipher_batch_finish_record(result, r, CipherBatchStatus::CipherError);
+            continue;
+        }
+        result.arena.resize(start + record.length - padding_len);
+        cipher_batch_finish_record(result, r, CipherBatchStatus::Ok);
+    }
+    result.success = true;
+    return result;
+}
+
+void PermutationCipherEngine::init(const std::string& key, CipherDirection direction) {
+    direction_ = direction;
+    key_ = get_compiled_permutation_key_cpp(key);
+    if (!key_) {
+        throw std::invalid_argument(direction == CipherDirection::Encrypt
+                                        ? "Invalid permutation key string for encryption."
+                                        : "Invalid permutation key string for decryption.");
+    }
+}
+
+size_t PermutationCipherEngine::process(const unsigned char* in, size_t length, unsigned char* out) {
+    permute_blocks_cpp(in, out, length, *key_, direction_ == CipherDirection::Decrypt);
+    return length;
+}
+
+size_t PermutationCipherEngine::finalize(const unsigned char* in, size_t length, unsigned char* out) {
+    size_t block_size = key_->block_size;
+    if (direction_ == CipherDirection::Encrypt) {
+        std::vector<unsigned char> last_block(in, in + length);
+        pkcs7_pad_perm(last_block, block_size);
+        return process(last_block.data(), last_block.size(), out);
+    }
+    if (length % block_size != 0) {
+        throw std::invalid_argument("Ciphertext size is not a multiple of the block size defined by the key.");
+    }
+    std::vector<unsigned char> last_block(length);
+    process(in, length, last_block.data());
+    if (!pkcs7_unpad_perm(last_block, block_size)) {
+        throw std::runtime_error("Permutation decryption failed due to invalid padding.");
+    }
+    std::memcpy(out, last_block.data(), last_block.size());
+    return last_block.size();
+}
 
-        std::vector<unsigned char> ciphertext_bytes = permutation_encrypt_data_cpp(plaintext_bytes, key_str);
-        if (!ciphertext_bytes.empty() || (plaintext_bytes.empty() && fileSize == 0) ) {
-             outputFile.write(reinterpret_cast<const char*>(ciphertext_bytes.data()), ciphertext_bytes.size());
+PermutationFileResultCpp encryptFilePermutationCpp(const std::string& inputFilePath, const std::string& outputFilePath, const std::string& key_str, CipherProgressToken* progress, bool compress) {
+    PermutationFileResultCpp fres;
+    try {
+        PermutationCipherEngine engine;
+        engine.init(key_str, CipherDirection::Encrypt);
+        if (compress) {
+            CipherContainerOptions options;
+            options.threads = 0;
+            options.compression = CipherContainerCompression::Lz4;
+            options.progress = progress;
+            CipherContainerResult cres = write_cipher_container(engine, inputFilePath, outputFilePath, options);
+            if (!cres.success) {
+                fres.cancelled = cres.cancelled;
+                fres.message = cres.message;
+                return fres;
+            }
+            fres.success = true;
+            fres.message = "File successfully compressed and encrypted with permutation cipher.";
+            return fres;
         }
-       
-        if (!outputFile) {
-            fres.message = "Error writing ciphertext to output file.";
+        CipherDriverOptions options;
+        options.threads = 0;
+        options.io_backend = CipherIoBackend::Auto;
+        options.progress = progress;
+        CipherDriverResult dres = run_cipher_file(engine, inputFilePath, outputFilePath, options);
+        if (!dres.success) {
+            fres.cancelled = dres.cancelled;
+            fres.message = dres.message;
             return fres;
         }
-        
         fres.success = true;
         fres.message = "File successfully encrypted with permutation cipher.";
     } catch (const std::exception& e) {
         fres.message = std::string("C++ Permutation Encrypt File: ") + e.what();
     }
-    inputFile.close();
-    outputFile.close();
     return fres;
 }
 
-PermutationFileResultCpp decryptFilePermutationCpp(const std::string& inputFilePath, const std::string& outputFilePath, const std::string& key_str) {
+PermutationFileResultCpp decryptFilePermutationCpp(const std::string& inputFilePath, const std::string& outputFilePath, const std::string& key_str, CipherProgressToken* progress) {
     PermutationFileResultCpp fres;
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    if (!inputFile) {
-        fres.message = "Error opening input file: " + inputFilePath;
-        return fres;
-    }
-    std::ofstream outputFile(outputFilePath, std::ios::binary | std::ios::trunc);
-    if (!outputFile) {
-        fres.message = "Error opening output file: " + outputFilePath;
-        return fres;
-    }
-
     try {
-        inputFile.seekg(0, std::ios::end);
-        std::streamsize fileSize = inputFile.tellg();
-        inputFile.seekg(0, std::ios::beg);
-        std::vector<unsigned char> ciphertext_bytes(static_cast<size_t>(fileSize));
-         if (fileSize > 0) {
-            inputFile.read(reinterpret_cast<char*>(ciphertext_bytes.data()), fileSize);
-        }
-        if (!inputFile && !inputFile.eof() && fileSize > 0) {
-            fres.message = "Error reading input file content.";
+        PermutationCipherEngine engine;
+        engine.init(key_str, CipherDirection::Decrypt);
+        if (is_cipher_container(inputFilePath)) {
+            CipherContainerOptions options;
+            options.threads = 0;
+            options.progress = progress;
+            CipherContainerResult cres = read_cipher_container(engine, inputFilePath, outputFilePath, options);
+            if (!cres.success) {
+                fres.cancelled = cres.cancelled;
+                fres.message = cres.message;
+                return fres;
+            }
+            fres.success = true;
+            fres.message = "File successfully decrypted with permutation cipher.";
             return fres;
         }
-
-        std::vector<unsigned char> plaintext_bytes = permutation_decrypt_data_cpp(ciphertext_bytes, key_str);
-         if (!plaintext_bytes.empty() || (ciphertext_bytes.empty() && fileSize == 0) ) {
-            outputFile.write(reinterpret_cast<const char*>(plaintext_bytes.data()), plaintext_bytes.size());
-        }
-        if (!outputFile) {
-            fres.message = "Error writing plaintext to output file.";
+        CipherDriverOptions options;
+        options.threads = 0;
+        options.io_backend = CipherIoBackend::Auto;
+        options.progress = progress;
+        CipherDriverResult dres = run_cipher_file(engine, inputFilePath, outputFilePath, options);
+        if (!dres.success) {
+            fres.cancelled = dres.cancelled;
+            fres.message = dres.message;
             return fres;
         }
-
         fres.success = true;
         fres.message = "File successfully decrypted with permutation cipher.";
     } catch (const std::exception& e) {
         fres.message = std::string("C++ Permutation Decrypt File: ") + e.what();
     }
-    inputFile.close();
-    outputFile.close();
     return fres;
 }
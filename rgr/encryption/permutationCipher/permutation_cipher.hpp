@@ -8,16 +8,66 @@
 #ifndef PERMUTATION_CIPHER_HPP
 #define PERMUTATION_CIPHER_HPP
 
+#include <array>
+#include <cstddef>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "../common/cipher_base64.hpp"
+#include "../common/cipher_batch.hpp"
+#include "../common/cipher_bytes.hpp"
+#include "../engine/cipher_engine.hpp"
+
+// Keys are strings of distinct decimal digits, so a block never exceeds ten
+// bytes and several whole blocks fit into one 16-byte shuffle register.
+const size_t PERMUTATION_MAX_BLOCK_SIZE = 10;
+const size_t PERMUTATION_SHUFFLE_WIDTH = 16;
+const size_t PERMUTATION_KEY_CACHE_DEFAULT_CAPACITY = 64;
+
+struct CompiledPermutationKey {
+    std::string key_str;
+    size_t block_size = 0;
+    std::vector<size_t> forward_map;
+    std::vector<size_t> inverse_map;
+    // Shuffle masks permuting blocks_per_mask consecutive blocks at once;
+    // lanes past the last whole block map onto themselves.
+    size_t blocks_per_mask = 0;
+    std::array<unsigned char, PERMUTATION_SHUFFLE_WIDTH> forward_mask{};
+    std::array<unsigned char, PERMUTATION_SHUFFLE_WIDTH> inverse_mask{};
+};
+
 bool parse_permutation_key_cpp(const std::string &key_str,
                                std::vector<size_t> &p_map);
 std::vector<size_t> invert_permutation_cpp(const std::vector<size_t> &p_map);
 std::vector<unsigned char>
 apply_permutation_cpp(const std::vector<unsigned char> &block,
                       const std::vector<size_t> &p_map);
+std::shared_ptr<const CompiledPermutationKey>
+compile_permutation_key_cpp(const std::string &key_str);
+// Returns the cached compiled key (compiling it on a miss), or nullptr if the
+// key string is invalid. Safe to call from several threads.
+std::shared_ptr<const CompiledPermutationKey>
+get_compiled_permutation_key_cpp(const std::string &key_str);
+void set_permutation_key_cache_capacity_cpp(size_t capacity);
+void clear_permutation_key_cache_cpp();
+// Permutes length bytes (a multiple of the block size) from in to out; in and
+// out may be the same buffer.
+void permute_blocks_cpp(const unsigned char *in, unsigned char *out,
+                        size_t length, const CompiledPermutationKey &key,
+                        bool inverse);
+// Caller-buffer primitives under the text and bytes APIs.
+// permutation_encrypt_to pads and permutes length bytes into out, which must
+// hold the next multiple of key.block_size above length, and returns that
+// size. permutation_decrypt_to needs length bytes of out, returns the
+// unpadded length and throws on a bad size or padding.
+size_t permutation_encrypt_to(const CompiledPermutationKey &key,
+                              const unsigned char *in, size_t length,
+                              unsigned char *out);
+size_t permutation_decrypt_to(const CompiledPermutationKey &key,
+                              const unsigned char *in, size_t length,
+                              unsigned char *out);
 void pkcs7_pad_perm(std::vector<unsigned char> &data, size_t block_size);
 bool pkcs7_unpad_perm(std::vector<unsigned char> &data,
                       size_t block_size_hint); 
@@ -27,29 +77,89 @@ permutation_encrypt_data_cpp(const std::vector<unsigned char> &plaintext,
 std::vector<unsigned char>
 permutation_decrypt_data_cpp(const std::vector<unsigned char> &ciphertext,
                              const std::string &key_str);
+// data_hex holds the ciphertext in the requested transport encoding after
+// encryption and the plain text after decryption.
 struct PermutationTextResultCpp {
     std::string data_hex;
     bool success = false;
     std::string error_message;
 };
-PermutationTextResultCpp encryptTextPermutationCpp(const std::string &plaintext,
-                                                   const std::string &key_str);
+PermutationTextResultCpp
+encryptTextPermutationCpp(const std::string &plaintext,
+                          const std::string &key_str,
+                          CipherTextEncoding encoding = CipherTextEncoding::Hex);
 PermutationTextResultCpp
 decryptTextPermutationCpp(const std::string &ciphertext_hex,
-                          const std::string &key_str);
+                          const std::string &key_str,
+                          CipherTextEncoding encoding = CipherTextEncoding::Hex);
+// Binary text API: raw plaintext in, raw permuted blocks out (and back),
+// without the hex step of the text functions.
+CipherBytesResult encryptBytesPermutationCpp(const unsigned char *data,
+                                             size_t length,
+                                             const std::string &key_str);
+CipherBytesResult decryptBytesPermutationCpp(const unsigned char *data,
+                                             size_t length,
+                                             const std::string &key_str);
 struct PermutationFileResultCpp {
     bool success = false;
+    bool cancelled = false;
     std::string message;
 };
+// progress is optional; see CipherProgressToken. compress writes an
+// LZ4-compressed cipher container, which decryptFilePermutationCpp detects.
 PermutationFileResultCpp
 encryptFilePermutationCpp(const std::string &inputFilePath,
                           const std::string &outputFilePath,
-                          const std::string &key_str);
+                          const std::string &key_str,
+                          CipherProgressToken *progress = nullptr,
+                          bool compress = false);
 PermutationFileResultCpp
 decryptFilePermutationCpp(const std::string &inputFilePath,
                           const std::string &outputFilePath,
-                          const std::string &key_str);
+                          const std::string &key_str,
+                          CipherProgressToken *progress = nullptr);
+// Batch text API: the key is compiled once and each record of input is
+// padded and permuted into the arena.
+CipherBatchResult
+encryptBatchPermutationCpp(const unsigned char *input, size_t input_size,
+                           const std::vector<CipherBatchRecord> &records,
+                           const std::string &key_str);
+CipherBatchResult
+decryptBatchPermutationCpp(const unsigned char *input, size_t input_size,
+                           const std::vector<CipherBatchRecord> &records,
+                           const std::string &key_str);
 std::vector<unsigned char> hexStringToBytes_perm_cpp(const std::string &hex);
 std::string bytesToHexString_perm_cpp(const std::vector<unsigned char> &bytes);
 
+// CipherEngine over the permutation cipher; the key is the digit string.
+class PermutationCipherEngine : public CipherEngine {
+  public:
+    std::string name() const override { return "permutation"; }
+    CipherInstrAlgorithm instrumentation_algorithm() const override {
+        return CipherInstrAlgorithm::Permutation;
+    }
+    void init(const std::string &key, CipherDirection direction) override;
+
+    size_t block_size() const override { return key_->block_size; }
+    size_t max_output_size(size_t length) const override {
+        return length + key_->block_size;
+    }
+    size_t tail_size() const override {
+        return direction_ == CipherDirection::Decrypt ? key_->block_size : 0;
+    }
+
+    size_t process(const unsigned char *in, size_t length,
+                   unsigned char *out) override;
+    size_t finalize(const unsigned char *in, size_t length,
+                    unsigned char *out) override;
+
+    bool supports_seek() const override { return true; }
+    std::unique_ptr<CipherEngine> clone() const override {
+        return std::make_unique<PermutationCipherEngine>(*this);
+    }
+
+  private:
+    std::shared_ptr<const CompiledPermutationKey> key_;
+};
+
 #endif // PERMUTATION_CIPHER_HPP
@@ -4,3 +4,4 @@
 #import "RSAObjectiveCWrapper.h"
 #import "GOSTObjectiveCWrapper.h"
 #import "PermutationCipherObjectiveCWrapper.h"
+#import "capi/rgr_crypto.h"
@@ -12,6 +12,17 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSString *)generateRSAKeysWithBits:(unsigned int)bits;
 
+// A new key of primeCount (2 to 4) primes with its CRT values, all in hex:
+// @"n", @"e", @"d" and @"primes", an array of dictionaries with @"prime",
+// @"exponent" and @"coefficient" in generation order. nil on failure.
+- (nullable NSDictionary<NSString *, id> *)generateRSAKeyComponentsWithBits:(unsigned int)bits
+                                                                  primeCount:(unsigned int)primeCount;
+
+// Keeps depth key pairs of each size ready in the background so that
+// generateRSAKeysWithBits: returns immediately for those sizes.
+- (void)prepareRSAKeyPoolWithBitSizes:(NSArray<NSNumber *> *)bitSizes
+                                depth:(NSUInteger)depth;
+
 - (NSString *)encryptRSAWithPlaintext:(NSString *)plaintext
                                  nHex:(NSString *)nHex
                                  eHex:(NSString *)eHex;
@@ -1,72 +1,134 @@
 #import "RSAObjectiveCWrapper.h"
 
 
-#include "rsa.hpp"
-#import <string>
-#import <vector>
-#import <sstream>
-#import <iomanip>
-#import <random>
-#import <chrono>
+#include "../capi/rgr_crypto.h"
 
+// Thin shim over the C ABI in rgr_crypto.h. Key components and ciphertext
+// blocks are shown to the user as hex BigInts (no leading zeros, ciphertext
+// blocks separated by spaces); the core takes them as big-endian bytes.
 
-static std::string NSStringToStdString(NSString *nsString) {
-    if (nsString == nil) {
-        return "";
+typedef int (^RgrOutputCall)(uint8_t *out, size_t capacity, size_t *length);
+
+// Runs call once as a size query and once into a buffer of that size;
+// returns nil on failure.
+static NSData *RunWithOutput(RgrOutputCall call) {
+    size_t length = 0;
+    int status = call(NULL, 0, &length);
+    if (status == RGR_OK) {
+        return [NSData data];
+    }
+    if (status != RGR_ERR_BUFFER_TOO_SMALL) {
+        return nil;
     }
-    return std::string([nsString UTF8String]);
+    NSMutableData *output = [NSMutableData dataWithLength:length];
+    if (call((uint8_t *)output.mutableBytes, length, &length) != RGR_OK) {
+        return nil;
+    }
+    output.length = length;
+    return output;
 }
 
-static NSString *StdStringToNSString(const std::string& stdString) {
-    return [NSString stringWithUTF8String:stdString.c_str()];
+static NSString *LastError(void) {
+    return [NSString stringWithUTF8String:rgr_last_error()];
 }
 
-static BigInt HexNSStringToBigInt(NSString *hexNSString) {
-    if (hexNSString == nil || [hexNSString length] == 0) {
-        throw std::runtime_error("Hex string for BigInt is empty or nil");
-    }
-    std::string hexStdString = NSStringToStdString(hexNSString);
-    BigInt val;
-    std::stringstream ss;
-    ss << std::hex << hexStdString;
-    ss >> val;
-    if (ss.fail() && !ss.eof()) { // Проверка на ошибку парсинга
-        throw std::runtime_error("Failed to parse hex string to BigInt: " + hexStdString);
-    }
-    return val;
+// Hex of a big-endian integer without leading zeros ("0" for zero), as
+// BigInt prints it.
+static NSString *BigIntHexFromBytes(const uint8_t *bytes, size_t length) {
+    while (length > 0 && bytes[0] == 0) {
+        ++bytes;
+        --length;
+    }
+    if (length == 0) {
+        return @"0";
+    }
+    NSMutableData *text = [NSMutableData dataWithLength:length * 2];
+    size_t text_length = 0;
+    rgr_text_encode(RGR_TEXT_HEX, bytes, length, (char *)text.mutableBytes, text.length, &text_length);
+    const char *digits = (const char *)text.bytes;
+    size_t skip = digits[0] == '0' ? 1 : 0;
+    return [[NSString alloc] initWithBytes:digits + skip length:text_length - skip encoding:NSASCIIStringEncoding];
 }
 
-// Вспомогательная функция для конвертации BigInt в 16-ричный NSString
-static NSString *BigIntToHexNSString(const BigInt& val) {
-    std::ostringstream oss;
-    oss << std::hex << val;
-    return StdStringToNSString(oss.str());
+// Big-endian bytes of a hex BigInt; nil when hexString is empty or not hex.
+static NSData *BytesFromBigIntHex(NSString *hexString) {
+    if (hexString == nil || [hexString length] == 0) {
+        return nil;
+    }
+    if ([hexString length] % 2 != 0) {
+        hexString = [@"0" stringByAppendingString:hexString];
+    }
+    const char *text = [hexString UTF8String];
+    size_t text_length = strlen(text);
+    NSMutableData *bytes = [NSMutableData dataWithLength:text_length / 2];
+    size_t length = 0;
+    if (rgr_text_decode(RGR_TEXT_HEX, text, text_length, (uint8_t *)bytes.mutableBytes, bytes.length, &length) != RGR_OK) {
+        return nil;
+    }
+    bytes.length = length;
+    return bytes;
+}
+
+// Byte length of n, which is also the RSA ciphertext block size.
+static size_t ModulusByteLength(NSData *n) {
+    const uint8_t *bytes = (const uint8_t *)n.bytes;
+    size_t length = n.length;
+    while (length > 0 && bytes[0] == 0) {
+        ++bytes;
+        --length;
+    }
+    return length;
 }
 
 
 @implementation RSAObjectiveCWrapper
 
+- (NSString *)generateRSAKeysWithBits:(unsigned int)bits {
+    size_t capacity = (bits + 7) / 8;
+    NSMutableData *n = [NSMutableData dataWithLength:capacity];
+    NSMutableData *e = [NSMutableData dataWithLength:capacity];
+    NSMutableData *d = [NSMutableData dataWithLength:capacity];
+    size_t key_length = 0;
+    int status = rgr_rsa_generate_key(bits, (uint8_t *)n.mutableBytes, (uint8_t *)e.mutableBytes, (uint8_t *)d.mutableBytes, capacity, &key_length);
+    if (status != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: Key generation failed - %@", LastError()];
+    }
 
-static boost::random::mt19937& get_rng() {
-    static boost::random::mt19937 rng(static_cast<unsigned long>(
-        std::chrono::system_clock::now().time_since_epoch().count()
-    ));
-    return rng;
+    return [NSString stringWithFormat:@"%@;%@;%@",
+            BigIntHexFromBytes((const uint8_t *)n.bytes, key_length),
+            BigIntHexFromBytes((const uint8_t *)e.bytes, key_length),
+            BigIntHexFromBytes((const uint8_t *)d.bytes, key_length)];
 }
 
-- (NSString *)generateRSAKeysWithBits:(unsigned int)bits {
-    try {
-        KeyPair keys = generateKeys(bits, get_rng()); // Вызов C++ функции
-
-        NSString *n_hex = BigIntToHexNSString(keys.pubKey.n);
-        NSString *e_hex = BigIntToHexNSString(keys.pubKey.e);
-        NSString *d_hex = BigIntToHexNSString(keys.privKey.d);
+- (NSDictionary<NSString *, id> *)generateRSAKeyComponentsWithBits:(unsigned int)bits primeCount:(unsigned int)primeCount {
+    size_t width = (bits + 7) / 8;
+    size_t fields = 3 + 3 * (size_t)primeCount;
+    NSMutableData *key = [NSMutableData dataWithLength:width * fields];
+    size_t key_length = 0;
+    if (rgr_rsa_generate_key_crt(bits, primeCount, (uint8_t *)key.mutableBytes, key.length, &key_length) != RGR_OK) {
+        return nil;
+    }
+    const uint8_t *bytes = (const uint8_t *)key.bytes;
+    NSMutableArray<NSDictionary<NSString *, NSString *> *> *primes = [NSMutableArray arrayWithCapacity:primeCount];
+    for (size_t i = 0; i < primeCount; ++i) {
+        const uint8_t *field = bytes + (3 + 3 * i) * key_length;
+        [primes addObject:@{
+            @"prime" : BigIntHexFromBytes(field, key_length),
+            @"exponent" : BigIntHexFromBytes(field + key_length, key_length),
+            @"coefficient" : BigIntHexFromBytes(field + 2 * key_length, key_length),
+        }];
+    }
+    return @{
+        @"n" : BigIntHexFromBytes(bytes, key_length),
+        @"e" : BigIntHexFromBytes(bytes + key_length, key_length),
+        @"d" : BigIntHexFromBytes(bytes + 2 * key_length, key_length),
+        @"primes" : primes,
+    };
+}
 
-        return [NSString stringWithFormat:@"%@;%@;%@", n_hex, e_hex, d_hex];
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Exception during key generation - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during key generation.";
+- (void)prepareRSAKeyPoolWithBitSizes:(NSArray<NSNumber *> *)bitSizes depth:(NSUInteger)depth {
+    for (NSNumber *bits in bitSizes) {
+        rgr_rsa_key_pool_reserve([bits unsignedIntValue], depth);
     }
 }
 
@@ -77,35 +139,32 @@ static boost::random::mt19937& get_rng() {
     if ([plaintext length] == 0) {
         return @"Error: Plaintext cannot be empty.";
     }
-    try {
-        std::string std_plaintext = NSStringToStdString(plaintext);
-        PublicKey pubKey;
-        pubKey.n = HexNSStringToBigInt(nHex);
-        pubKey.e = HexNSStringToBigInt(eHex);
-
-        size_t key_n_byte_length = getApproximateByteLength(pubKey.n);
-        if (key_n_byte_length == 0) { // Дополнительная проверка
-             return @"Error: Key modulus N results in zero byte length.";
-        }
-
-        // Вызов C++ функции шифрования текста
-        std::vector<BigInt> encrypted_blocks = encryptText(std_plaintext, pubKey, key_n_byte_length);
+    NSData *n = BytesFromBigIntHex(nHex);
+    NSData *e = BytesFromBigIntHex(eHex);
+    if (n == nil || e == nil) {
+        return @"Error: Key components must be non-empty hex strings.";
+    }
+    size_t block_length = ModulusByteLength(n);
+    if (block_length == 0) {
+        return @"Error: Key modulus N results in zero byte length.";
+    }
 
-        // Конвертируем вектор BigInt в одну строку (hex-значения, разделенные пробелом)
-        std::ostringstream oss;
-        for (size_t i = 0; i < encrypted_blocks.size(); ++i) {
-            oss << std::hex << encrypted_blocks[i];
-            if (i < encrypted_blocks.size() - 1) {
-                oss << " "; // Разделитель
-            }
-        }
-        return StdStringToNSString(oss.str());
+    NSData *input = [plaintext dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *output = RunWithOutput(^int(uint8_t *out, size_t capacity, size_t *length) {
+        return rgr_rsa_encrypt((const uint8_t *)n.bytes, n.length, (const uint8_t *)e.bytes, e.length,
+                               (const uint8_t *)input.bytes, input.length, out, capacity, length);
+    });
+    if (output == nil) {
+        return [NSString stringWithFormat:@"Error: Encryption failed - %@", LastError()];
+    }
 
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Exception during encryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during encryption.";
+    // One hex BigInt per ciphertext block, separated by spaces.
+    NSMutableArray<NSString *> *blocks = [NSMutableArray array];
+    const uint8_t *bytes = (const uint8_t *)output.bytes;
+    for (size_t offset = 0; offset < output.length; offset += block_length) {
+        [blocks addObject:BigIntHexFromBytes(bytes + offset, block_length)];
     }
+    return [blocks componentsJoinedByString:@" "];
 }
 
 - (NSString *)decryptRSAWithCiphertext:(NSString *)hexCiphertext nHex:(NSString *)nHex dHex:(NSString *)dHex {
@@ -115,63 +174,60 @@ static boost::random::mt19937& get_rng() {
      if ([hexCiphertext length] == 0) {
         return @"Error: Ciphertext cannot be empty.";
     }
+    NSData *n = BytesFromBigIntHex(nHex);
+    NSData *d = BytesFromBigIntHex(dHex);
+    if (n == nil || d == nil) {
+        return @"Error: Key components must be non-empty hex strings.";
+    }
+    size_t block_length = ModulusByteLength(n);
+    if (block_length == 0) {
+        return @"Error: Key modulus N results in zero byte length.";
+    }
 
-    try {
-        PrivateKey privKey;
-        privKey.n = HexNSStringToBigInt(nHex);
-        privKey.d = HexNSStringToBigInt(dHex);
-
-        size_t key_n_byte_length = getApproximateByteLength(privKey.n);
-         if (key_n_byte_length == 0) {
-             return @"Error: Key modulus N results in zero byte length.";
+    // Every space-separated hex BigInt becomes one fixed-width block.
+    NSMutableData *ciphertext = [NSMutableData data];
+    for (NSString *segment in [hexCiphertext componentsSeparatedByString:@" "]) {
+        if ([segment length] == 0) {
+            continue;
         }
-
-        // Парсим входную строку hexCiphertext (hex-значения BigInt, разделенные пробелом) в std::vector<BigInt>
-        std::vector<BigInt> encrypted_blocks_vec;
-        std::string std_hex_ciphertext = NSStringToStdString(hexCiphertext);
-        std::stringstream ss_parser(std_hex_ciphertext);
-        std::string segment;
-
-        while(std::getline(ss_parser, segment, ' ')) { // Разделяем по пробелу
-            if (segment.empty()) continue;
-            BigInt val;
-            std::stringstream ss_segment;
-            ss_segment << std::hex << segment;
-            ss_segment >> val;
-             if (ss_segment.fail() && !ss_segment.eof()) {
-                throw std::runtime_error("Failed to parse ciphertext segment: " + segment);
-            }
-            encrypted_blocks_vec.push_back(val);
+        NSData *value = BytesFromBigIntHex(segment);
+        if (value == nil) {
+            return [NSString stringWithFormat:@"Error: Failed to parse ciphertext segment: %@", segment];
         }
-        
-        if (encrypted_blocks_vec.empty() && ![hexCiphertext isEqualToString:@"0"] && [hexCiphertext length] > 0) {
-        
-             bool hasSpace = false;
-             for (NSUInteger i = 0; i < [hexCiphertext length]; ++i) {
-                 if ([hexCiphertext characterAtIndex:i] == ' ') {
-                     hasSpace = true;
-                     break;
-                 }
-             }
-             if (!hasSpace) { // Если пробелов нет, пробуем как один блок
-                 encrypted_blocks_vec.clear();
-                 encrypted_blocks_vec.push_back(HexNSStringToBigInt(hexCiphertext));
-             } else if (encrypted_blocks_vec.empty()) { // Если пробелы были, но ничего не распарсили
-                 throw std::runtime_error("Ciphertext format error: contains spaces but no valid hex blocks parsed.");
-             }
+        size_t significant = ModulusByteLength(value);
+        if (significant > block_length) {
+            return [NSString stringWithFormat:@"Error: Ciphertext segment is larger than the modulus: %@", segment];
         }
+        NSUInteger start = ciphertext.length;
+        ciphertext.length = start + block_length;
+        memcpy((uint8_t *)ciphertext.mutableBytes + start + block_length - significant,
+               (const uint8_t *)value.bytes + value.length - significant, significant);
+    }
+    if (ciphertext.length == 0) {
+        return @"Error: Ciphertext format error: no valid hex blocks parsed.";
+    }
 
-
-        // Вызов C++ функции расшифрования текста
-        std::string decrypted_std_string = decryptText(encrypted_blocks_vec, privKey, key_n_byte_length);
-        
-        return StdStringToNSString(decrypted_std_string);
-
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Exception during decryption - %s", e.what()];
-    } catch (...) {
-        return @"Error: Unknown C++ exception during decryption.";
+    NSData *output = RunWithOutput(^int(uint8_t *out, size_t capacity, size_t *length) {
+        return rgr_rsa_decrypt((const uint8_t *)n.bytes, n.length, (const uint8_t *)d.bytes, d.length,
+                               (const uint8_t *)ciphertext.bytes, ciphertext.length, out, capacity, length);
+    });
+    if (output == nil) {
+        // Text encrypted before the framed block layout fails the framing
+        // checks; decrypt it the old way.
+        NSString *error = LastError();
+        output = RunWithOutput(^int(uint8_t *out, size_t capacity, size_t *length) {
+            return rgr_rsa_decrypt_legacy_text((const uint8_t *)n.bytes, n.length, (const uint8_t *)d.bytes, d.length,
+                                               (const uint8_t *)ciphertext.bytes, ciphertext.length, out, capacity, length);
+        });
+        if (output == nil) {
+            return [NSString stringWithFormat:@"Error: Decryption failed - %@", error];
+        }
     }
+    NSString *plaintext = [[NSString alloc] initWithData:output encoding:NSUTF8StringEncoding];
+    if (plaintext == nil) {
+        return @"Error: Decrypted data is not valid UTF-8.";
+    }
+    return plaintext;
 }
 
 
@@ -185,34 +241,18 @@ static boost::random::mt19937& get_rng() {
     if ([inputFilePath length] == 0 || [outputFilePath length] == 0 || [nHex length] == 0 || [eHex length] == 0) {
         return @"Error: Входные параметры для шифрования файла не могут быть пустыми строками.";
     }
+    NSData *n = BytesFromBigIntHex(nHex);
+    NSData *e = BytesFromBigIntHex(eHex);
+    if (n == nil || e == nil) {
+        return @"Error: Компоненты ключа RSA должны быть 16-ричными строками.";
+    }
 
-    try {
-        std::string std_input_path = NSStringToStdString(inputFilePath);
-        std::string std_output_path = NSStringToStdString(outputFilePath);
-
-        PublicKey pubKey;
-        pubKey.n = HexNSStringToBigInt(nHex); // Убедитесь, что BigInt и HexNSStringToBigInt определены и работают
-        pubKey.e = HexNSStringToBigInt(eHex);
-
-        size_t key_n_byte_length = getApproximateByteLength(pubKey.n); // Убедитесь, что эта C++ функция существует
-        if (key_n_byte_length == 0) {
-             return @"Error: Модуль ключа RSA N приводит к нулевой длине в байтах (шифрование файла).";
-        }
-
-    
-        bool success = encryptFile(std_input_path, std_output_path, pubKey, key_n_byte_length);
-
-        if (success) {
-            return [NSString stringWithFormat:@"Файл успешно зашифрован в: %@", [outputFilePath lastPathComponent]];
-        } else {
-            return @"Error: Ошибка C++ при шифровании файла. Проверьте консоль на предмет C++ ошибок.";
-        }
-
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Исключение во время шифрования файла - %s", e.what()];
-    } catch (...) {
-        return @"Error: Неизвестное C++ исключение во время шифрования файла.";
+    int status = rgr_rsa_encrypt_file([inputFilePath fileSystemRepresentation], [outputFilePath fileSystemRepresentation],
+                                      (const uint8_t *)n.bytes, n.length, (const uint8_t *)e.bytes, e.length, 0);
+    if (status != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: Ошибка при шифровании файла - %@", LastError()];
     }
+    return [NSString stringWithFormat:@"Файл успешно зашифрован в: %@", [outputFilePath lastPathComponent]];
 }
 
 - (NSString *)decryptFileRSA:(NSString *)inputFilePath
@@ -225,32 +265,17 @@ static boost::random::mt19937& get_rng() {
     if ([inputFilePath length] == 0 || [outputFilePath length] == 0 || [nHex length] == 0 || [dHex length] == 0) {
         return @"Error: Входные параметры для расшифрования файла не могут быть пустыми строками.";
     }
-    
-    try {
-        std::string std_input_path = NSStringToStdString(inputFilePath);
-        std::string std_output_path = NSStringToStdString(outputFilePath);
-
-        PrivateKey privKey;
-        privKey.n = HexNSStringToBigInt(nHex);
-        privKey.d = HexNSStringToBigInt(dHex);
-        
-        size_t key_n_byte_length = getApproximateByteLength(privKey.n);
-         if (key_n_byte_length == 0) {
-             return @"Error: Модуль ключа RSA N приводит к нулевой длине в байтах (расшифрование файла).";
-        }
-
-        bool success = decryptFile(std_input_path, std_output_path, privKey, key_n_byte_length);
-
-        if (success) {
-            return [NSString stringWithFormat:@"Файл успешно расшифрован в: %@", [outputFilePath lastPathComponent]];
-        } else {
-            return @"Error: Ошибка C++ при расшифровании файла. Проверьте консоль на предмет C++ ошибок.";
-        }
+    NSData *n = BytesFromBigIntHex(nHex);
+    NSData *d = BytesFromBigIntHex(dHex);
+    if (n == nil || d == nil) {
+        return @"Error: Компоненты ключа RSA должны быть 16-ричными строками.";
+    }
 
-    } catch (const std::exception& e) {
-        return [NSString stringWithFormat:@"Error: C++ Исключение во время расшифрования файла - %s", e.what()];
-    } catch (...) {
-        return @"Error: Неизвестное C++ исключение во время расшифрования файла.";
+    int status = rgr_rsa_decrypt_file([inputFilePath fileSystemRepresentation], [outputFilePath fileSystemRepresentation],
+                                      (const uint8_t *)n.bytes, n.length, (const uint8_t *)d.bytes, d.length);
+    if (status != RGR_OK) {
+        return [NSString stringWithFormat:@"Error: Ошибка при расшифровании файла - %@", LastError()];
     }
+    return [NSString stringWithFormat:@"Файл успешно расшифрован в: %@", [outputFilePath lastPathComponent]];
 }
 @end
@@ -1,4 +1,8 @@
 #include "rsa.hpp"
+#include "../common/cipher_random.hpp"
+#include "../common/cipher_thread_pool.hpp"
+#include "../container/cipher_container.hpp"
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -7,53 +11,89 @@
 #include <vector>
 #include <string>
 #include <sstream>
-
-BigInt generateProbablePrime(unsigned int bits, boost::random::mt19937& rng) {
-    if (bits < 64) {
-        std::cerr << "Warning: Prime bit length " << bits << " is very short for security demonstrations." << std::endl;
-        if (bits < 3) throw std::invalid_argument("Prime bit length must be at least 3.");
-    }
-
-    BigInt lower_bound = BigInt(1) << (bits - 1);
-    BigInt upper_bound = (BigInt(1) << bits) - 1;
-
-    if (lower_bound < 2) lower_bound = 2;
-    if (upper_bound < lower_bound) upper_bound = lower_bound + 1;
-
+#include <cstring>
+#include <cstdio>
+
+// Draws a probable prime from [lower_bound, upper_bound]. Gives up (false)
+// after a number of candidates that a range holding primes practically
+// never needs, so that the tiny ranges of demonstration-size keys cannot
+// loop forever.
+bool generateProbablePrime(const BigInt& lower_bound, const BigInt& upper_bound, boost::random::mt19937& rng, BigInt& prime) {
+    if (upper_bound < 3 || upper_bound < lower_bound) return false;
     boost::random::uniform_int_distribution<BigInt> dist(lower_bound, upper_bound);
-    BigInt num_candidate;
     unsigned int miller_rabin_iterations = 25;
+    size_t attempts = 64 * static_cast<size_t>(boost::multiprecision::msb(upper_bound) + 1) + 1024;
 
-    while (true) {
-        num_candidate = dist(rng);
+    for (size_t attempt = 0; attempt < attempts; ++attempt) {
+        BigInt num_candidate = dist(rng);
         num_candidate |= BigInt(1);
 
         if (num_candidate > upper_bound || num_candidate < lower_bound) continue;
         if (num_candidate < 3) continue;
 
         if (boost::multiprecision::miller_rabin_test(num_candidate, miller_rabin_iterations, rng)) {
-            return num_candidate;
+            prime = num_candidate;
+            return true;
         }
     }
+    return false;
+}
+
+void seedKeyGenerator(boost::random::mt19937& rng) {
+    std::vector<uint32_t> state(boost::random::mt19937::state_size);
+    cipher_random_fill(reinterpret_cast<unsigned char*>(state.data()),
+                       state.size() * sizeof(uint32_t));
+    auto first = state.begin();
+    rng.seed(first, state.end());
 }
 
-KeyPair generateKeys(unsigned int bits, boost::random::mt19937& rng) {
+KeyPair generateKeys(unsigned int bits, boost::random::mt19937& rng, unsigned int prime_count) {
+    if (prime_count < 2 || prime_count > 4) {
+        throw std::invalid_argument("RSA keys use 2, 3 or 4 primes.");
+    }
     if (bits < 128) {
         std::cerr << "Warning: Key bit length " << bits << " is too short for any security. Demonstration only." << std::endl;
-        if (bits < 6) throw std::invalid_argument("Total key bit length must be at least 6 for two 3-bit primes.");
+        if (bits < 3 * prime_count) throw std::invalid_argument("Total key bit length must be at least 3 bits per prime.");
     }
-    unsigned int prime_bits = bits / 2;
-    if (prime_bits < 3) prime_bits = 3;
-
-    BigInt p = generateProbablePrime(prime_bits, rng);
-    BigInt q = generateProbablePrime(prime_bits, rng);
-
-    while (p == q) {
-        q = generateProbablePrime(prime_bits, rng);
+    // The prime sizes add up to bits. The last prime is drawn from the range
+    // that puts n at exactly bits bits (it ends up within a bit of its
+    // share), so no prime count yields a short modulus.
+    std::vector<BigInt> primes;
+    BigInt product = 1;
+    unsigned int remaining_bits = bits;
+    while (primes.size() < prime_count) {
+        unsigned int left = prime_count - static_cast<unsigned int>(primes.size());
+        BigInt lower;
+        BigInt upper;
+        unsigned int prime_bits = remaining_bits / left;
+        if (left > 1) {
+            lower = BigInt(1) << (prime_bits - 1);
+            upper = (BigInt(1) << prime_bits) - 1;
+        } else {
+            lower = ((BigInt(1) << (bits - 1)) + product - 1) / product;
+            upper = ((BigInt(1) << bits) - 1) / product;
+        }
+        BigInt r;
+        if (!generateProbablePrime(lower, upper, rng, r)) {
+            // Only tiny keys get here; start over with other primes.
+            primes.clear();
+            product = 1;
+            remaining_bits = bits;
+            continue;
+        }
+        if (std::find(primes.begin(), primes.end(), r) == primes.end()) {
+            primes.push_back(r);
+            product *= r;
+            remaining_bits -= prime_bits;
+        }
     }
 
-    BigInt n = p * q;
-    BigInt phi_n = (p - 1) * (q - 1);
+    BigInt n = 1;
+    BigInt phi_n = 1;
+    for (const BigInt& r : primes) {
+        n *= r;
+        phi_n *= r - 1;
+    }
 
     BigInt e = 65537;
     if (e >= phi_n || boost::multiprecision::gcd(e, phi_n) != 1) {
@@ -71,7 +111,54 @@ KeyPair generateKeys(unsigned int bits, boost::random::mt19937& rng) {
         throw std::runtime_error("Modular inverse for e and phi_n could not be found.");
     }
 
-    return {{n, e}, {n, d}};
+    PrivateKey private_key{n, d, {}};
+    BigInt earlier = 1;
+    for (const BigInt& r : primes) {
+        RsaPrimeFactor factor;
+        factor.prime = r;
+        factor.exponent = d % (r - 1);
+        factor.coefficient = earlier == 1 ? BigInt(0) : BigInt(boost::integer::mod_inverse(BigInt(earlier % r), r));
+        private_key.primes.push_back(factor);
+        earlier *= r;
+    }
+    return {{n, e}, private_key};
+}
+
+bool checkPrimeFactors(const PrivateKey& key) {
+    if (key.primes.size() < 2) {
+        return false;
+    }
+    BigInt earlier = 1;
+    for (const RsaPrimeFactor& factor : key.primes) {
+        if (factor.prime < 3 || factor.exponent != key.d % (factor.prime - 1)) {
+            return false;
+        }
+        BigInt expected = earlier == 1 ? BigInt(0) : BigInt(boost::integer::mod_inverse(BigInt(earlier % factor.prime), factor.prime));
+        if (factor.coefficient != expected || (earlier != 1 && expected == 0)) {
+            return false;
+        }
+        earlier *= factor.prime;
+    }
+    return earlier == key.n;
+}
+
+BigInt applyPrivateKey(const BigInt& c, const PrivateKey& key) {
+    if (key.primes.empty()) {
+        return boost::multiprecision::powm(c, key.d, key.n);
+    }
+    // Garner's recombination: m stays the CRT value modulo the product of
+    // the primes seen so far.
+    const RsaPrimeFactor& first = key.primes[0];
+    BigInt m = boost::multiprecision::powm(c % first.prime, first.exponent, first.prime);
+    BigInt product = first.prime;
+    for (size_t i = 1; i < key.primes.size(); ++i) {
+        const RsaPrimeFactor& factor = key.primes[i];
+        BigInt m_i = boost::multiprecision::powm(c % factor.prime, factor.exponent, factor.prime);
+        BigInt h = (m_i + factor.prime - m % factor.prime) * factor.coefficient % factor.prime;
+        m += product * h;
+        product *= factor.prime;
+    }
+    return m;
 }
 
 BigInt bytesToBigInt(const std::vector<unsigned char>& bytes) {
@@ -97,10 +184,7 @@ std::vector<unsigned char> bigIntToBytes(const BigInt& val, size_t fixed_output_
         if (bytes.size() < fixed_output_byte_length) {
             bytes.insert(bytes.begin(), fixed_output_byte_length - bytes.size(), 0);
         } else if (bytes.size() > fixed_output_byte_length) {
-            std::cerr << "Warning: BigIntToBytes conversion resulted in " << bytes.size()
-                      << " bytes, but expected " << fixed_output_byte_length
-                      << ". Truncating (this might indicate an issue)." << std::endl;
-            bytes.erase(bytes.begin(), bytes.begin() + (bytes.size() - fixed_output_byte_length));
+            throw std::length_error("BigIntToBytes: value needs " + std::to_string(bytes.size()) + " bytes, but only " + std::to_string(fixed_output_byte_length) + " fit.");
         }
     } else if (val == 0) {
          bytes.push_back(0);
@@ -118,6 +202,13 @@ size_t getApproximateByteLength(const BigInt& n) {
     return (static_cast<size_t>(msb(n)) + 8) / 8;
 }
 
+size_t getBlockPayloadLength(size_t key_n_byte_length) {
+    if (key_n_byte_length < 3) {
+        throw std::invalid_argument("Key modulus n is too small (<3 bytes).");
+    }
+    return key_n_byte_length - 1 - (key_n_byte_length <= 257 ? 1 : 2);
+}
+
 BigInt encryptBlock(const std::vector<unsigned char>& block, const PublicKey& key) {
     BigInt m = bytesToBigInt(block);
     if (m >= key.n) {
@@ -130,98 +221,360 @@ std::vector<unsigned char> decryptBlock(const BigInt& encrypted_block, const Pri
     if (encrypted_block >= key.n) {
         throw std::runtime_error("Ciphertext block integer C is too large for the key modulus n.");
     }
-    BigInt m = boost::multiprecision::powm(encrypted_block, key.d, key.n);
+    BigInt m = applyPrivateKey(encrypted_block, key);
     return bigIntToBytes(m, expected_byte_length);
 }
 
-std::vector<BigInt> encryptText(const std::string& text, const PublicKey& key, size_t key_n_byte_length) {
-    std::vector<BigInt> encrypted_blocks;
-    std::vector<unsigned char> byte_text(text.begin(), text.end());
+namespace {
 
-    size_t block_size_data = key_n_byte_length > 1 ? key_n_byte_length - 1 : 1;
-    if (key_n_byte_length <= 1) throw std::runtime_error("Key modulus n is too small (<=1 byte).");
+// Shorter runs of blocks stay on the calling thread.
+const size_t RSA_PARALLEL_MIN_BLOCKS = 4;
 
-    for (size_t i = 0; i < byte_text.size(); i += block_size_data) {
-        size_t current_block_actual_size = std::min(block_size_data, byte_text.size() - i);
-        std::vector<unsigned char> block(byte_text.begin() + i, byte_text.begin() + i + current_block_actual_size);
-        encrypted_blocks.push_back(encryptBlock(block, key));
+// Framed block layout: the k - 1 message bytes of every block are a
+// big-endian length field (one byte while k <= 257, two above), that many
+// plaintext bytes and zero padding. Every block but the last carries a full
+// getBlockPayloadLength(k) bytes, so block b always decrypts to offset
+// b * payload and the final length is read, not searched for.
+BigInt rsaFramedMessage(const unsigned char* in, size_t length, size_t key_n_byte_length) {
+    size_t payload = getBlockPayloadLength(key_n_byte_length);
+    if (length > payload) {
+        throw std::invalid_argument("RSA block plaintext is longer than the block payload.");
     }
-    return encrypted_blocks;
+    BigInt m = length;
+    if (length > 0) {
+        BigInt data;
+        boost::multiprecision::import_bits(data, in, in + length);
+        m <<= 8 * length;
+        m |= data;
+    }
+    // m < 256^(k - 1) <= n, so every framed message is a valid RSA input.
+    m <<= 8 * (payload - length);
+    return m;
 }
 
-std::string decryptText(const std::vector<BigInt>& encrypted_data, const PrivateKey& key, size_t key_n_byte_length) {
-    std::vector<unsigned char> all_decrypted_bytes;
-    size_t block_size_data = key_n_byte_length > 1 ? key_n_byte_length - 1 : 1;
+// Writes the plaintext of a decrypted framed message to out and returns its
+// length. A wrong key or a damaged block shows up as a bad length field or
+// non-zero padding.
+size_t rsaUnframeMessage(const BigInt& m, size_t key_n_byte_length, unsigned char* out) {
+    size_t payload = getBlockPayloadLength(key_n_byte_length);
+    size_t field = key_n_byte_length - 1 - payload;
+    if (m != 0 && msb(m) >= 8 * (key_n_byte_length - 1)) {
+        throw std::runtime_error("Corrupt RSA block: decrypted value does not fit the block.");
+    }
+    std::vector<unsigned char> message = bigIntToBytes(m, key_n_byte_length - 1);
+    size_t length = message[0];
+    if (field == 2) {
+        length = (length << 8) | message[1];
+    }
+    if (length > payload) {
+        throw std::runtime_error("Corrupt RSA block: bad length field.");
+    }
+    for (size_t i = field + length; i < message.size(); ++i) {
+        if (message[i] != 0) {
+            throw std::runtime_error("Corrupt RSA block: non-zero padding.");
+        }
+    }
+    std::memcpy(out, message.data() + field, length);
+    return length;
+}
 
-    for (const auto& encrypted_block_val : encrypted_data) {
-        std::vector<unsigned char> decrypted_padded_block_bytes = decryptBlock(encrypted_block_val, key, block_size_data);
+// Encrypts length (<= payload) bytes into exactly k big-endian bytes.
+void rsaEncryptBlockTo(const unsigned char* in, size_t length, const BigInt& e, const BigInt& n, unsigned char* out, size_t key_n_byte_length) {
+    BigInt m = rsaFramedMessage(in, length, key_n_byte_length);
+    std::vector<unsigned char> block = bigIntToBytes(boost::multiprecision::powm(m, e, n), key_n_byte_length);
+    std::memcpy(out, block.data(), key_n_byte_length);
+}
 
-        all_decrypted_bytes.insert(all_decrypted_bytes.end(),
-                                     decrypted_padded_block_bytes.begin(),
-                                     decrypted_padded_block_bytes.end());
+// Decrypts one k-byte block and returns its plaintext length.
+size_t rsaDecryptBlockTo(const unsigned char* in, const PrivateKey& key, unsigned char* out, size_t key_n_byte_length) {
+    BigInt c;
+    boost::multiprecision::import_bits(c, in, in + key_n_byte_length);
+    if (c >= key.n) {
+        throw std::runtime_error("Ciphertext block integer C is too large for the key modulus n.");
     }
+    return rsaUnframeMessage(applyPrivateKey(c, key), key_n_byte_length, out);
+}
 
-    size_t last_block_start = encrypted_data.empty() ? 0 : (encrypted_data.size() - 1) * block_size_data;
-    size_t first_zero = std::string::npos;
-
-    for(size_t i = last_block_start; i < all_decrypted_bytes.size(); ++i){
-        if(all_decrypted_bytes[i] == 0) {
-            bool all_zeros_after = true;
-            for(size_t j = i + 1; j < all_decrypted_bytes.size(); ++j) {
-                if(all_decrypted_bytes[j] != 0) {
-                    all_zeros_after = false;
-                    break;
-                }
-            }
-            if(all_zeros_after){
-                first_zero = i;
-                break;
+// Runs fn(begin, end) over slices of [0, count) blocks or records on the
+// shared thread pool. Each RSA block costs a modular exponentiation and
+// none depends on another, so even a few are worth spreading out.
+template <typename RangeFn>
+void rsaForEachRange(size_t count, RangeFn fn) {
+    if (count < RSA_PARALLEL_MIN_BLOCKS) {
+        fn(0, count);
+        return;
+    }
+    CipherThreadPool& pool = cipher_thread_pool();
+    size_t slices = std::min(count, static_cast<size_t>(pool.thread_count() + 1) * 4);
+    size_t per_slice = (count + slices - 1) / slices;
+    pool.parallel_for((count + per_slice - 1) / per_slice, [&](size_t s) {
+        fn(s * per_slice, std::min(count, (s + 1) * per_slice));
+    });
+}
+
+// Encrypts length bytes as payload-sized blocks, only the last one short,
+// into k bytes each at out and returns the bytes written.
+size_t rsaEncryptBlocksTo(const unsigned char* in, size_t length, const BigInt& e, const BigInt& n, unsigned char* out, size_t key_n_byte_length) {
+    size_t payload = getBlockPayloadLength(key_n_byte_length);
+    size_t blocks = (length + payload - 1) / payload;
+    rsaForEachRange(blocks, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            size_t offset = b * payload;
+            rsaEncryptBlockTo(in + offset, std::min(payload, length - offset), e, n, out + b * key_n_byte_length, key_n_byte_length);
+        }
+    });
+    return blocks * key_n_byte_length;
+}
+
+// Decrypts blocks k-byte blocks, block b to out + b * payload, and returns
+// the bytes written. Only the last block of a message may be short, and only
+// when last_is_final is set.
+size_t rsaDecryptBlocksTo(const unsigned char* in, size_t blocks, const PrivateKey& key, unsigned char* out, size_t key_n_byte_length, bool last_is_final) {
+    size_t payload = getBlockPayloadLength(key_n_byte_length);
+    std::atomic<size_t> written{0};
+    rsaForEachRange(blocks, [&](size_t begin, size_t end) {
+        size_t range_written = 0;
+        for (size_t b = begin; b < end; ++b) {
+            size_t length = rsaDecryptBlockTo(in + b * key_n_byte_length, key, out + b * payload, key_n_byte_length);
+            if (length != payload && (b + 1 < blocks || !last_is_final)) {
+                throw std::runtime_error("Corrupt RSA ciphertext: short block before the last one.");
             }
+            range_written += length;
         }
+        written += range_written;
+    });
+    return written;
+}
+
+// Legacy (unframed) ciphertext only: decryptFile and decryptTextLegacy trim
+// the final run of zero bytes of data written before the framed layout, but
+// never past the start of the last block.
+size_t trimTrailingZeroPadding(const unsigned char* data, size_t length, size_t last_block_start) {
+    size_t end = length;
+    while (end > last_block_start && data[end - 1] == 0) {
+        --end;
     }
-    
-    if(first_zero != std::string::npos && first_zero < all_decrypted_bytes.size()){
-        all_decrypted_bytes.resize(first_zero);
+    return end;
+}
+
+BigInt parseHexBigInt(const std::string& hex) {
+    if (hex.empty()) {
+        throw std::invalid_argument("Hex string for BigInt is empty.");
     }
-    
-    return std::string(all_decrypted_bytes.begin(), all_decrypted_bytes.end());
+    BigInt val;
+    std::istringstream iss(hex);
+    iss >> std::hex >> val;
+    if (iss.fail() || !iss.eof()) {
+        throw std::invalid_argument("Failed to parse hex string to BigInt: " + hex);
+    }
+    return val;
 }
 
+} // namespace
 
-bool encryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PublicKey& key, size_t key_n_byte_length) {
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    std::ofstream outputFile(outputFilePath);
+std::vector<BigInt> encryptText(const std::string& text, const PublicKey& key, size_t key_n_byte_length) {
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Rsa);
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, text.size());
+    std::vector<BigInt> encrypted_blocks;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    size_t payload = getBlockPayloadLength(key_n_byte_length);
+
+    for (size_t i = 0; i < text.size(); i += payload) {
+        size_t current_block_actual_size = std::min(payload, text.size() - i);
+        CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Rsa, 1);
+        BigInt m = rsaFramedMessage(bytes + i, current_block_actual_size, key_n_byte_length);
+        encrypted_blocks.push_back(boost::multiprecision::powm(m, key.e, key.n));
+    }
+    return encrypted_blocks;
+}
 
+std::string decryptText(const std::vector<BigInt>& encrypted_data, const PrivateKey& key, size_t key_n_byte_length) {
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Rsa);
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, encrypted_data.size() * key_n_byte_length);
+    size_t payload = getBlockPayloadLength(key_n_byte_length);
+    std::string text(encrypted_data.size() * payload, '\0');
+    unsigned char* out = reinterpret_cast<unsigned char*>(text.data());
+    size_t length = 0;
+
+    for (size_t b = 0; b < encrypted_data.size(); ++b) {
+        if (encrypted_data[b] >= key.n) {
+            throw std::runtime_error("Ciphertext block integer C is too large for the key modulus n.");
+        }
+        BigInt m = applyPrivateKey(encrypted_data[b], key);
+        size_t block_length = 0;
+        try {
+            block_length = rsaUnframeMessage(m, key_n_byte_length, out + length);
+        } catch (const std::runtime_error&) {
+            return decryptTextLegacy(encrypted_data, key, key_n_byte_length);
+        }
+        if (block_length != payload && b + 1 < encrypted_data.size()) {
+            return decryptTextLegacy(encrypted_data, key, key_n_byte_length);
+        }
+        length += block_length;
+    }
+    text.resize(length);
+    return text;
+}
+
+std::string decryptTextLegacy(const std::vector<BigInt>& encrypted_data, const PrivateKey& key, size_t key_n_byte_length) {
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Rsa);
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, encrypted_data.size() * key_n_byte_length);
+    if (key_n_byte_length < 2) {
+        throw std::invalid_argument("Key modulus n is too small (<2 bytes).");
+    }
+    size_t block_size_data = key_n_byte_length - 1;
+    std::string text;
+    text.reserve(encrypted_data.size() * block_size_data);
+    for (size_t b = 0; b < encrypted_data.size(); ++b) {
+        if (encrypted_data[b] >= key.n) {
+            throw std::runtime_error("Ciphertext block integer C is too large for the key modulus n.");
+        }
+        BigInt m = applyPrivateKey(encrypted_data[b], key);
+        if (m != 0 && msb(m) >= 8 * block_size_data) {
+            throw std::runtime_error("Corrupt RSA block: decrypted value does not fit the block.");
+        }
+        // The old encoder wrote the short last block without padding, so it
+        // keeps only its significant bytes.
+        bool last = b + 1 == encrypted_data.size();
+        std::vector<unsigned char> block = bigIntToBytes(m, last ? 0 : block_size_data);
+        if (last && m == 0) {
+            block.clear();
+        }
+        text.append(block.begin(), block.end());
+    }
+    size_t last_block_start = encrypted_data.empty() ? 0 : (encrypted_data.size() - 1) * block_size_data;
+    text.resize(trimTrailingZeroPadding(reinterpret_cast<const unsigned char*>(text.data()), text.size(), std::min(last_block_start, text.size())));
+    return text;
+}
+
+namespace {
+
+bool rsaFileOperationCancelled(CipherProgressToken* progress, std::ifstream& inputFile, std::ofstream& outputFile, const std::string& outputFilePath) {
+    if (progress == nullptr || !progress->cancelled()) {
+        return false;
+    }
+    inputFile.close();
+    outputFile.close();
+    std::remove(outputFilePath.c_str());
+    std::cerr << "RSA file operation cancelled; partial output removed." << std::endl;
+    return true;
+}
+
+// Container path of encryptFile/decryptFile: the chunks go through
+// RsaCipherEngine, initialised from the key as "n;exponent" in hex, or from
+// private_key with its CRT factors when decrypting.
+bool rsaContainerFile(const std::string& inputFilePath, const std::string& outputFilePath, const BigInt& n, const BigInt& exponent, CipherDirection direction, CipherProgressToken* progress, const PrivateKey* private_key = nullptr) {
+    std::ostringstream key;
+    key << std::hex << n << ';' << exponent;
+    RsaCipherEngine engine;
+    engine.init(key.str(), direction);
+    if (private_key != nullptr) {
+        engine.set_private_key(*private_key);
+    }
+    CipherContainerOptions options;
+    options.threads = 0;
+    options.progress = progress;
+    CipherContainerResult result;
+    if (direction == CipherDirection::Encrypt) {
+        options.compression = CipherContainerCompression::Lz4;
+        result = write_cipher_container(engine, inputFilePath, outputFilePath, options);
+    } else {
+        result = read_cipher_container(engine, inputFilePath, outputFilePath, options);
+    }
+    if (!result.success) {
+        std::cerr << result.message << std::endl;
+    }
+    return result.success;
+}
+
+// First line of hex files written with the framed block layout; older files
+// start directly with a ciphertext block and are decrypted the legacy way.
+const char RSA_FRAMED_FILE_MARKER[] = "rsa-framed-v1";
+
+// Strips whitespace and an optional surrounding [ ] from a hex line.
+std::string rsaHexLinePayload(const std::string& line) {
+    std::string processed_line = line;
+    processed_line.erase(0, processed_line.find_first_not_of(" \t\n\r\f\v"));
+    processed_line.erase(processed_line.find_last_not_of(" \t\n\r\f\v") + 1);
+    if (!processed_line.empty() && processed_line.front() == '[' && processed_line.back() == ']') {
+        if (processed_line.length() >= 2) {
+             processed_line = processed_line.substr(1, processed_line.length() - 2);
+        } else {
+             processed_line.clear();
+        }
+        processed_line.erase(0, processed_line.find_first_not_of(" \t\n\r\f\v"));
+        processed_line.erase(processed_line.find_last_not_of(" \t\n\r\f\v") + 1);
+    }
+    return processed_line;
+}
+
+} // namespace
+
+bool encryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PublicKey& key, size_t key_n_byte_length, CipherProgressToken* progress, bool compress) {
+    if (compress) {
+        try {
+            return rsaContainerFile(inputFilePath, outputFilePath, key.n, key.e, CipherDirection::Encrypt, progress);
+        } catch (const std::exception& e) {
+            std::cerr << "RSA container encryption failed: " << e.what() << std::endl;
+            return false;
+        }
+    }
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Rsa);
+    std::ifstream inputFile(inputFilePath, std::ios::binary);
     if (!inputFile.is_open()) {
         std::cerr << "Error opening input file: " << inputFilePath << std::endl;
         return false;
     }
+    if (key_n_byte_length < 3) {
+        std::cerr << "Key modulus n is too small for file encryption." << std::endl;
+        return false;
+    }
+    std::ofstream outputFile(outputFilePath);
     if (!outputFile.is_open()) {
         std::cerr << "Error opening output file: " << outputFilePath << std::endl;
         return false;
     }
 
-    size_t block_size_data = key_n_byte_length > 1 ? key_n_byte_length - 1 : 1;
-    if (key_n_byte_length <= 1) {
-        std::cerr << "Key modulus n is too small for file encryption." << std::endl;
-        return false;
+    size_t block_size_data = getBlockPayloadLength(key_n_byte_length);
+    outputFile << RSA_FRAMED_FILE_MARKER << std::endl;
+
+    if (progress) {
+        inputFile.seekg(0, std::ios::end);
+        progress->set_total(static_cast<uint64_t>(inputFile.tellg()));
+        inputFile.seekg(0, std::ios::beg);
     }
 
     std::vector<unsigned char> buffer(block_size_data);
     while (inputFile) {
-        inputFile.read(reinterpret_cast<char*>(buffer.data()), block_size_data);
-        size_t bytes_read = static_cast<size_t>(inputFile.gcount());
+        if (rsaFileOperationCancelled(progress, inputFile, outputFile, outputFilePath)) {
+            return false;
+        }
+        size_t bytes_read = 0;
+        {
+            CIPHER_INSTR_SCOPE_NAMED(read_stage, CipherInstrAlgorithm::Rsa, CipherInstrStage::Read);
+            inputFile.read(reinterpret_cast<char*>(buffer.data()), block_size_data);
+            bytes_read = static_cast<size_t>(inputFile.gcount());
+            CIPHER_INSTR_SET_BYTES(read_stage, bytes_read);
+        }
 
         if (bytes_read == 0) break;
 
-        std::vector<unsigned char> current_block(buffer.begin(), buffer.begin() + bytes_read);
-
-        BigInt encrypted_val = encryptBlock(current_block, key);
-        outputFile << std::hex << encrypted_val << std::endl;
+        BigInt encrypted_val;
+        {
+            CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, bytes_read);
+            encrypted_val = boost::multiprecision::powm(rsaFramedMessage(buffer.data(), bytes_read, key_n_byte_length), key.e, key.n);
+        }
+        {
+            // Hex formatting happens inside the stream insertion.
+            CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Write, key_n_byte_length);
+            outputFile << std::hex << encrypted_val << std::endl;
+        }
+        if (progress) progress->add_bytes(bytes_read);
     }
 
     inputFile.close();
     outputFile.close();
+    if (progress) progress->report();
     return true;
 }
 
@@ -237,130 +590,401 @@ bool is_string_all_whitespace(const std::string& s) {
     });
 }
 
-bool decryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PrivateKey& key, size_t key_n_byte_length) {
+bool decryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PrivateKey& key, size_t key_n_byte_length, CipherProgressToken* progress) {
+    if (is_cipher_container(inputFilePath)) {
+        try {
+            return rsaContainerFile(inputFilePath, outputFilePath, key.n, key.d, CipherDirection::Decrypt, progress, &key);
+        } catch (const std::exception& e) {
+            std::cerr << "RSA container decryption failed: " << e.what() << std::endl;
+            return false;
+        }
+    }
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Rsa);
     std::ifstream inputFile(inputFilePath);
-    std::ofstream outputFile(outputFilePath, std::ios::binary | std::ios::trunc);
-
     if (!inputFile.is_open()) {
         std::cerr << "Error opening input file: " << inputFilePath << std::endl;
         return false;
     }
-    if (!outputFile.is_open()) {
-        std::cerr << "Error opening output file: " << outputFilePath << std::endl;
-        inputFile.close();
+    if (key_n_byte_length < 3) {
+        std::cerr << "Key modulus n is too small for file decryption." << std::endl;
         return false;
     }
-
-    size_t block_size_data = key_n_byte_length > 1 ? key_n_byte_length - 1 : 1;
-    if (key_n_byte_length <= 1) {
-        std::cerr << "Key modulus n is too small for file decryption." << std::endl;
-        inputFile.close();
-        outputFile.close();
+    std::ofstream outputFile(outputFilePath, std::ios::binary | std::ios::trunc);
+    if (!outputFile.is_open()) {
+        std::cerr << "Error opening output file: " << outputFilePath << std::endl;
         return false;
     }
 
+    size_t payload = getBlockPayloadLength(key_n_byte_length);
     std::string original_hex_line;
-    bool SucceededAtLeastOnce = false;
+    bool framed = false;
     bool hadProcessableLines = false;
     int lineNumber = 0;
-    std::vector<BigInt> encrypted_blocks;
+    // Framed files stream: each block is held back only until the next line
+    // shows it was not the last one, the only block allowed to be short.
+    std::vector<unsigned char> held_block(payload);
+    size_t held_length = 0;
+    bool holding = false;
+    // Legacy files are collected and trimmed of trailing zeros at the end.
+    std::vector<BigInt> legacy_blocks;
+    // Input bytes behind each parsed legacy block, for progress reporting.
+    std::vector<size_t> legacy_block_input_bytes;
+    size_t pending_input_bytes = 0;
+
+    if (progress) {
+        inputFile.seekg(0, std::ios::end);
+        progress->set_total(static_cast<uint64_t>(inputFile.tellg()));
+        inputFile.seekg(0, std::ios::beg);
+    }
 
-    while (std::getline(inputFile, original_hex_line)) {
-        lineNumber++;
+    try {
+        while (std::getline(inputFile, original_hex_line)) {
+            lineNumber++;
+            pending_input_bytes += original_hex_line.size() + 1;
+            if (rsaFileOperationCancelled(progress, inputFile, outputFile, outputFilePath)) {
+                return false;
+            }
 
-        std::string processed_line = original_hex_line;
-        processed_line.erase(0, processed_line.find_first_not_of(" \t\n\r\f\v"));
-        processed_line.erase(processed_line.find_last_not_of(" \t\n\r\f\v") + 1);
-        if (!processed_line.empty() && processed_line.front() == '[' && processed_line.back() == ']') {
-            if (processed_line.length() >= 2) {
-                 processed_line = processed_line.substr(1, processed_line.length() - 2);
-            } else {
-                 processed_line.clear();
+            std::string processed_line = rsaHexLinePayload(original_hex_line);
+            if (processed_line.empty()) {
+                continue;
             }
-            processed_line.erase(0, processed_line.find_first_not_of(" \t\n\r\f\v"));
-            processed_line.erase(processed_line.find_last_not_of(" \t\n\r\f\v") + 1);
-        }
+            if (!hadProcessableLines && !framed && processed_line == RSA_FRAMED_FILE_MARKER) {
+                framed = true;
+                continue;
+            }
+            hadProcessableLines = true;
 
-        if (processed_line.empty()) {
-            continue;
+            std::istringstream iss(processed_line);
+            BigInt encrypted_block_val;
+            {
+                CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::HexDecode, processed_line.size() / 2);
+                iss >> std::hex >> encrypted_block_val;
+            }
+            if (iss.fail() || !iss.eof()) {
+                if (framed) {
+                    throw std::runtime_error("Line " + std::to_string(lineNumber) + ": malformed ciphertext block.");
+                }
+                std::cerr << "Line " << lineNumber << ": Error parsing hex string or trailing data. Original: [" << original_hex_line << "], Processed for parsing: [" << processed_line << "]" << std::endl;
+                continue;
+            }
+            if (!framed) {
+                legacy_blocks.push_back(encrypted_block_val);
+                legacy_block_input_bytes.push_back(pending_input_bytes);
+                pending_input_bytes = 0;
+                continue;
+            }
+
+            if (holding) {
+                if (held_length != payload) {
+                    throw std::runtime_error("Corrupt RSA ciphertext: short block before the last one.");
+                }
+                CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Write, held_length);
+                outputFile.write(reinterpret_cast<const char*>(held_block.data()), held_length);
+            }
+            {
+                CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, key_n_byte_length);
+                if (encrypted_block_val >= key.n) {
+                    throw std::runtime_error("Ciphertext block integer C is too large for the key modulus n.");
+                }
+                held_length = rsaUnframeMessage(applyPrivateKey(encrypted_block_val, key), key_n_byte_length, held_block.data());
+            }
+            holding = true;
+            if (progress) progress->add_bytes(pending_input_bytes);
+            pending_input_bytes = 0;
         }
-        hadProcessableLines = true;
+        inputFile.close();
 
-        std::istringstream iss(processed_line);
-        BigInt encrypted_block_val;
-        iss >> std::hex >> encrypted_block_val;
-        if (iss.fail() || !iss.eof()) {
-            std::cerr << "Line " << lineNumber << ": Error parsing hex string or trailing data. Original: [" << original_hex_line << "], Processed for parsing: [" << processed_line << "]" << std::endl;
-            continue;
+        if (framed) {
+            if (holding) {
+                CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Write, held_length);
+                outputFile.write(reinterpret_cast<const char*>(held_block.data()), held_length);
+            }
+        } else if (!legacy_blocks.empty()) {
+            std::vector<unsigned char> all_decrypted_bytes;
+            for (size_t i = 0; i < legacy_blocks.size(); ++i) {
+                if (rsaFileOperationCancelled(progress, inputFile, outputFile, outputFilePath)) {
+                    return false;
+                }
+                std::vector<unsigned char> decrypted_bytes;
+                {
+                    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, key_n_byte_length);
+                    decrypted_bytes = decryptBlock(legacy_blocks[i], key, key_n_byte_length - 1);
+                }
+                CIPHER_INSTR_ALLOC(CipherInstrAlgorithm::Rsa, 1);
+                all_decrypted_bytes.insert(all_decrypted_bytes.end(), decrypted_bytes.begin(), decrypted_bytes.end());
+                if (progress) progress->add_bytes(legacy_block_input_bytes[i]);
+            }
+            {
+                CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Padding, all_decrypted_bytes.size());
+                all_decrypted_bytes.resize(trimTrailingZeroPadding(all_decrypted_bytes.data(), all_decrypted_bytes.size(), all_decrypted_bytes.size() - (key_n_byte_length - 1)));
+            }
+            CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Write, all_decrypted_bytes.size());
+            outputFile.write(reinterpret_cast<const char*>(all_decrypted_bytes.data()), all_decrypted_bytes.size());
         }
-        encrypted_blocks.push_back(encrypted_block_val);
+    } catch (const std::exception& e) {
+        std::cerr << "RSA file decryption failed: " << e.what() << std::endl;
+        inputFile.close();
+        outputFile.close();
+        std::remove(outputFilePath.c_str());
+        return false;
     }
 
-    inputFile.close();
+    if (!outputFile) {
+        std::cerr << "Critical error writing decrypted data to output file." << std::endl;
+        outputFile.close();
+        return false;
+    }
+    outputFile.close();
+    if (progress) progress->report();
 
-    if (!hadProcessableLines && encrypted_blocks.empty()) {
-         outputFile.close();
-         return true;
+    if (!framed && hadProcessableLines && legacy_blocks.empty()) {
+        std::cerr << "Warning: Input file contained processable lines, but no blocks were successfully decrypted." << std::endl;
+        return false;
     }
+    return true;
+}
 
-    std::vector<unsigned char> all_decrypted_bytes;
-    for (size_t i = 0; i < encrypted_blocks.size(); ++i) {
-        const auto& encrypted_block_val = encrypted_blocks[i];
-        std::vector<unsigned char> decrypted_bytes = decryptBlock(encrypted_block_val, key, block_size_data);
 
-        if (!decrypted_bytes.empty()) {
-             all_decrypted_bytes.insert(all_decrypted_bytes.end(), decrypted_bytes.begin(), decrypted_bytes.end());
-             SucceededAtLeastOnce = true;
-        } else if (block_size_data > 0) {
-       
-        }
+CipherBatchResult encryptBatchRSA(const unsigned char* input, size_t input_size, const std::vector<CipherBatchRecord>& records, const PublicKey& key) {
+    CipherBatchResult result;
+    size_t key_n_byte_length = getApproximateByteLength(key.n);
+    if (key_n_byte_length < 3) {
+        result.error_message = "Key modulus n is too small (<3 bytes).";
+        return result;
     }
+    size_t block_size_data = getBlockPayloadLength(key_n_byte_length);
+
+    // Output sizes are known up front, so records are encrypted in parallel
+    // into their own slots and the arena is compacted afterwards.
+    std::vector<size_t> slots(records.size() + 1, 0);
+    for (size_t r = 0; r < records.size(); ++r) {
+        size_t blocks = (records[r].length + block_size_data - 1) / block_size_data;
+        slots[r + 1] = slots[r] + (cipher_batch_record_in_range(records[r], input_size) ? blocks * key_n_byte_length : 0);
+    }
+    cipher_batch_begin(result, records.size(), slots.back());
+    result.arena.resize(slots.back());
+    std::vector<size_t> written(records.size(), 0);
+
+    rsaForEachRange(records.size(), [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            const CipherBatchRecord& record = records[r];
+            if (!cipher_batch_record_in_range(record, input_size)) {
+                result.status[r] = CipherBatchStatus::OutOfRange;
+                continue;
+            }
+            try {
+                written[r] = rsaEncryptBlocksTo(input + record.offset, record.length, key.e, key.n, result.arena.data() + slots[r], key_n_byte_length);
+            } catch (const std::exception&) {
+                result.status[r] = CipherBatchStatus::CipherError;
+            }
+        }
+    });
+    cipher_batch_compact(result, slots, written);
+    result.success = true;
+    return result;
+}
 
-    if (!all_decrypted_bytes.empty() && !encrypted_blocks.empty()) {
-        size_t first_zero_in_potential_padding = std::string::npos;
-        size_t start_search_index = (all_decrypted_bytes.size() > block_size_data) ? (all_decrypted_bytes.size() - block_size_data) : 0;
+CipherBatchResult decryptBatchRSA(const unsigned char* input, size_t input_size, const std::vector<CipherBatchRecord>& records, const PrivateKey& key) {
+    CipherBatchResult result;
+    size_t key_n_byte_length = getApproximateByteLength(key.n);
+    if (key_n_byte_length < 3) {
+        result.error_message = "Key modulus n is too small (<3 bytes).";
+        return result;
+    }
+    size_t block_size_data = getBlockPayloadLength(key_n_byte_length);
 
-        for (size_t i = all_decrypted_bytes.size(); i > start_search_index; --i) {
-            if (all_decrypted_bytes[i-1] == 0) {
-                bool all_zeros_before_this = true;
-                for (size_t j = i-1; j > start_search_index; --j) {
-                     if(all_decrypted_bytes[j-1] != 0) {
-                        all_zeros_before_this = false;
-                        break;
-                     }
-                }
-                 if (all_zeros_before_this) {
-                    first_zero_in_potential_padding = i-1;
-                 } else {
-                    break;
-                 }
-
-            } else {
-                break;
+    std::vector<size_t> slots(records.size() + 1, 0);
+    for (size_t r = 0; r < records.size(); ++r) {
+        const CipherBatchRecord& record = records[r];
+        bool valid = cipher_batch_record_in_range(record, input_size) && record.length % key_n_byte_length == 0;
+        slots[r + 1] = slots[r] + (valid ? record.length / key_n_byte_length * block_size_data : 0);
+    }
+    cipher_batch_begin(result, records.size(), slots.back());
+    result.arena.resize(slots.back());
+    std::vector<size_t> written(records.size(), 0);
+
+    rsaForEachRange(records.size(), [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            const CipherBatchRecord& record = records[r];
+            if (!cipher_batch_record_in_range(record, input_size)) {
+                result.status[r] = CipherBatchStatus::OutOfRange;
+                continue;
+            }
+            if (record.length % key_n_byte_length != 0) {
+                result.status[r] = CipherBatchStatus::InvalidInput;
+                continue;
+            }
+            try {
+                written[r] = rsaDecryptBlocksTo(input + record.offset, record.length / key_n_byte_length, key, result.arena.data() + slots[r], key_n_byte_length, true);
+            } catch (const std::exception&) {
+                result.status[r] = CipherBatchStatus::CipherError;
             }
         }
-        
-        if(first_zero_in_potential_padding != std::string::npos){
-            all_decrypted_bytes.resize(first_zero_in_potential_padding);
-        }
+    });
+    cipher_batch_compact(result, slots, written);
+    result.success = true;
+    return result;
+}
+
+CipherBytesResult encryptBytesRSA(const unsigned char* data, size_t length, const PublicKey& key) {
+    CipherBytesResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Rsa);
+    size_t key_n_byte_length = getApproximateByteLength(key.n);
+    if (key_n_byte_length < 3) {
+        result.error_message = "Key modulus n is too small (<3 bytes).";
+        return result;
+    }
+    size_t block_size_data = getBlockPayloadLength(key_n_byte_length);
+    size_t blocks = (length + block_size_data - 1) / block_size_data;
+    try {
+        result.data.resize(blocks * key_n_byte_length);
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, length);
+        rsaEncryptBlocksTo(data, length, key.e, key.n, result.data.data(), key_n_byte_length);
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.data.clear();
+        result.error_message = std::string("C++ Exception in encryptBytesRSA: ") + e.what();
     }
+    return result;
+}
 
+CipherBytesResult decryptBytesRSA(const unsigned char* data, size_t length, const PrivateKey& key) {
+    CipherBytesResult result;
+    CIPHER_INSTR_CALL(CipherInstrAlgorithm::Rsa);
+    size_t key_n_byte_length = getApproximateByteLength(key.n);
+    if (key_n_byte_length < 3) {
+        result.error_message = "Key modulus n is too small (<3 bytes).";
+        return result;
+    }
+    if (length % key_n_byte_length != 0) {
+        result.error_message = "Ciphertext size is not a multiple of the RSA block size.";
+        return result;
+    }
+    size_t block_size_data = getBlockPayloadLength(key_n_byte_length);
+    size_t blocks = length / key_n_byte_length;
+    try {
+        result.data.resize(blocks * block_size_data);
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::Kernel, length);
+        result.data.resize(rsaDecryptBlocksTo(data, blocks, key, result.data.data(), key_n_byte_length, true));
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.data.clear();
+        result.error_message = std::string("C++ Exception in decryptBytesRSA: ") + e.what();
+    }
+    return result;
+}
 
-    if (!all_decrypted_bytes.empty()) {
-        outputFile.write(reinterpret_cast<const char*>(all_decrypted_bytes.data()), all_decrypted_bytes.size());
-        if (!outputFile) {
-            std::cerr << "Critical error writing decrypted data to output file." << std::endl;
-            outputFile.close();
-            return false;
+RsaTextResult encryptTextEncodedRSA(const std::string& plaintext, const PublicKey& key, CipherTextEncoding encoding) {
+    RsaTextResult result;
+    CipherBytesResult bytes = encryptBytesRSA(reinterpret_cast<const unsigned char*>(plaintext.data()), plaintext.size(), key);
+    if (!bytes.success) {
+        result.error_message = bytes.error_message;
+        return result;
+    }
+    CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::HexEncode, bytes.data.size());
+    result.text = cipher_text_encode(bytes.data, encoding);
+    result.success = true;
+    return result;
+}
+
+RsaTextResult decryptTextEncodedRSA(const std::string& ciphertext, const PrivateKey& key, CipherTextEncoding encoding) {
+    RsaTextResult result;
+    std::vector<unsigned char> ciphertext_bytes;
+    try {
+        CIPHER_INSTR_SCOPE(CipherInstrAlgorithm::Rsa, CipherInstrStage::HexDecode, ciphertext.size() / 2);
+        ciphertext_bytes = cipher_text_decode(ciphertext, encoding);
+    } catch (const std::exception& e) {
+        result.error_message = std::string("C++ Exception in decryptTextEncodedRSA: ") + e.what();
+        return result;
+    }
+    CipherBytesResult bytes = decryptBytesRSA(ciphertext_bytes.data(), ciphertext_bytes.size(), key);
+    if (!bytes.success) {
+        result.error_message = bytes.error_message;
+        return result;
+    }
+    result.text.assign(bytes.data.begin(), bytes.data.end());
+    result.success = true;
+    return result;
+}
+
+void RsaCipherEngine::init(const std::string& key, CipherDirection direction) {
+    direction_ = direction;
+    std::vector<std::string> parts;
+    std::stringstream ss(key);
+    std::string part;
+    while (std::getline(ss, part, ';')) {
+        parts.push_back(part);
+    }
+    bool with_primes = parts.size() >= 9 && parts.size() <= 15 && parts.size() % 3 == 0;
+    if (parts.size() != 2 && parts.size() != 3 && !with_primes) {
+        throw std::invalid_argument("RSA engine key must be \"n;e\", \"n;d\", \"n;e;d\" or \"n;e;d\" followed by 2-4 \"prime;exponent;coefficient\" triples, in hex.");
+    }
+    n_ = parseHexBigInt(parts[0]);
+    if (parts.size() >= 3) {
+        exponent_ = parseHexBigInt(direction == CipherDirection::Encrypt ? parts[1] : parts[2]);
+    } else {
+        exponent_ = parseHexBigInt(parts[1]);
+    }
+    key_n_byte_length_ = getApproximateByteLength(n_);
+    block_payload_ = getBlockPayloadLength(key_n_byte_length_);
+    private_key_ = PrivateKey{n_, exponent_, {}};
+    if (with_primes && direction == CipherDirection::Decrypt) {
+        for (size_t i = 3; i < parts.size(); i += 3) {
+            private_key_.primes.push_back({parseHexBigInt(parts[i]), parseHexBigInt(parts[i + 1]), parseHexBigInt(parts[i + 2])});
+        }
+        if (!checkPrimeFactors(private_key_)) {
+            throw std::invalid_argument("RSA engine key prime factors do not match n and d.");
         }
     }
+}
 
-    outputFile.close();
+void RsaCipherEngine::set_private_key(const PrivateKey& key) {
+    n_ = key.n;
+    exponent_ = key.d;
+    private_key_ = key;
+    key_n_byte_length_ = getApproximateByteLength(n_);
+    block_payload_ = getBlockPayloadLength(key_n_byte_length_);
+}
 
-    if (hadProcessableLines && !SucceededAtLeastOnce) {
-        std::cerr << "Warning: Input file contained processable lines, but no blocks were successfully decrypted." << std::endl;
-        return false;
+size_t RsaCipherEngine::block_size() const {
+    return direction_ == CipherDirection::Encrypt ? block_payload_ : key_n_byte_length_;
+}
+
+size_t RsaCipherEngine::max_output_size(size_t length) const {
+    if (direction_ == CipherDirection::Encrypt) {
+        return (length / block_payload_ + 1) * key_n_byte_length_;
+    }
+    return length / key_n_byte_length_ * block_payload_;
+}
+
+size_t RsaCipherEngine::tail_size() const {
+    return direction_ == CipherDirection::Decrypt ? key_n_byte_length_ : 0;
+}
+
+uint64_t RsaCipherEngine::output_offset(uint64_t input_offset) const {
+    if (direction_ == CipherDirection::Encrypt) {
+        return input_offset / block_payload_ * key_n_byte_length_;
     }
+    return input_offset / key_n_byte_length_ * block_payload_;
+}
 
-    return SucceededAtLeastOnce || !hadProcessableLines;
+size_t RsaCipherEngine::process(const unsigned char* in, size_t length, unsigned char* out) {
+    if (direction_ == CipherDirection::Decrypt) {
+        // The tail holds back the last block, so every block here is full.
+        return rsaDecryptBlocksTo(in, length / key_n_byte_length_, private_key_, out, key_n_byte_length_, false);
+    }
+    return rsaEncryptBlocksTo(in, length - length % block_payload_, exponent_, n_, out, key_n_byte_length_);
+}
+
+size_t RsaCipherEngine::finalize(const unsigned char* in, size_t length, unsigned char* out) {
+    if (direction_ == CipherDirection::Encrypt) {
+        if (length == 0) return 0;
+        rsaEncryptBlockTo(in, length, exponent_, n_, out, key_n_byte_length_);
+        return key_n_byte_length_;
+    }
+    if (length % key_n_byte_length_ != 0) {
+        throw std::invalid_argument("Ciphertext size is not a multiple of the RSA block size.");
+    }
+    return rsaDecryptBlocksTo(in, length / key_n_byte_length_, private_key_, out, key_n_byte_length_, true);
 }
@@ -14,27 +14,126 @@
 #include <boost/multiprecision/miller_rabin.hpp>
 #include <boost/random.hpp>
 #include <boost/integer/mod_inverse.hpp>
+#include "../common/cipher_base64.hpp"
+#include "../common/cipher_batch.hpp"
+#include "../common/cipher_bytes.hpp"
+#include "../engine/cipher_engine.hpp"
 using BigInt = boost::multiprecision::cpp_int;
 struct PublicKey {
     BigInt n;
     BigInt e;
 };
+// One prime r of n with its CRT values (RFC 8017 multi-prime form).
+struct RsaPrimeFactor {
+    BigInt prime;
+    BigInt exponent;    // d mod (r - 1)
+    BigInt coefficient; // (product of the earlier primes)^-1 mod r; 0 for the first
+};
 struct PrivateKey {
     BigInt n;
     BigInt d;
+    // Prime factors of n in generation order, filled in by generateKeys.
+    // Keys known only as (n, d) leave it empty and decrypt with one
+    // full-size exponentiation instead of CRT.
+    std::vector<RsaPrimeFactor> primes;
 };
 struct KeyPair {
     PublicKey pubKey;
     PrivateKey privKey;
 };
-KeyPair generateKeys(unsigned int bits, boost::random::mt19937& rng);
+// prime_count is 2, 3 or 4. More primes make each CRT exponentiation work
+// on a modulus of bits / prime_count bits, so 3072/4096-bit keys decrypt
+// and generate faster.
+KeyPair generateKeys(unsigned int bits, boost::random::mt19937& rng, unsigned int prime_count = 2);
+// Fills the whole state of rng from the system CSPRNG. Engines that feed
+// generateKeys must be seeded this way rather than from one 32-bit value.
+void seedKeyGenerator(boost::random::mt19937& rng);
+// True when key.primes multiply to n and every exponent and coefficient
+// matches d and the earlier primes, so CRT decryption agrees with c^d mod n.
+// Used to check factors that come from outside, e.g. an exported key.
+bool checkPrimeFactors(const PrivateKey& key);
+// c^d mod n, through CRT when key carries its prime factors.
+BigInt applyPrivateKey(const BigInt& c, const PrivateKey& key);
 BigInt encryptBlock(const std::vector<unsigned char>& block, const PublicKey& key);
 std::vector<unsigned char> decryptBlock(const BigInt& encrypted_block, const PrivateKey& key, size_t expected_byte_length);
 std::vector<BigInt> encryptText(const std::string& text, const PublicKey& key, size_t key_byte_length);
+// Falls back to decryptTextLegacy when a block fails the framing checks, so
+// text encrypted before the framed layout still decrypts.
 std::string decryptText(const std::vector<BigInt>& encrypted_data, const PrivateKey& key, size_t key_byte_length);
-bool encryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PublicKey& key, size_t key_byte_length);
-bool decryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PrivateKey& key, size_t key_byte_length);
+// Text ciphertext written before the framed layout: every block but the
+// last held k - 1 plaintext bytes and the last one its bytes unpadded, and
+// trailing zeros were trimmed. Nothing marks this layout, so a wrong key
+// yields garbage instead of an error.
+std::string decryptTextLegacy(const std::vector<BigInt>& encrypted_data, const PrivateKey& key, size_t key_byte_length);
+// progress is optional: it is fed input byte counts per block and, once
+// cancelled, stops the operation, deletes the partial output and makes the
+// call return false. compress writes an LZ4-compressed cipher container of
+// binary RSA blocks instead of hex lines; decryptFile detects it. Hex files
+// start with a marker line for the framed layout; decryptFile still reads
+// older files without it.
+bool encryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PublicKey& key, size_t key_byte_length, CipherProgressToken* progress = nullptr, bool compress = false);
+bool decryptFile(const std::string& inputFilePath, const std::string& outputFilePath, const PrivateKey& key, size_t key_byte_length, CipherProgressToken* progress = nullptr);
 std::vector<unsigned char> bigIntToBytes(const BigInt& val, size_t fixed_output_byte_length = 0);
 BigInt bytesToBigInt(const std::vector<unsigned char>& bytes);
 size_t getApproximateByteLength(const BigInt& n);
+// Plaintext bytes per block of the framed layout used by every RSA API: each
+// k-byte ciphertext block (k being the byte length of n) decrypts to a length
+// field plus up to this many bytes, and only the last block of a message may
+// be short. Throws std::invalid_argument when k < 3.
+size_t getBlockPayloadLength(size_t key_n_byte_length);
+// Batch text API: records are split into payload-sized blocks as in
+// encryptText and every ciphertext block is stored as k big-endian bytes.
+CipherBatchResult encryptBatchRSA(const unsigned char* input, size_t input_size, const std::vector<CipherBatchRecord>& records, const PublicKey& key);
+CipherBatchResult decryptBatchRSA(const unsigned char* input, size_t input_size, const std::vector<CipherBatchRecord>& records, const PrivateKey& key);
+// Binary text API with the same block layout as the batch API, for callers
+// that do not need encryptText's BigInt/hex representation.
+CipherBytesResult encryptBytesRSA(const unsigned char* data, size_t length, const PublicKey& key);
+CipherBytesResult decryptBytesRSA(const unsigned char* data, size_t length, const PrivateKey& key);
+// encryptBytesRSA/decryptBytesRSA with the ciphertext in a transport
+// encoding; text is the ciphertext after encryption and the plain text after
+// decryption.
+struct RsaTextResult {
+    std::string text;
+    bool success = false;
+    std::string error_message;
+};
+RsaTextResult encryptTextEncodedRSA(const std::string& plaintext, const PublicKey& key, CipherTextEncoding encoding);
+RsaTextResult decryptTextEncodedRSA(const std::string& ciphertext, const PrivateKey& key, CipherTextEncoding encoding);
+
+// CipherEngine over RSA with a binary layout: every payload-sized plaintext
+// block becomes one k-byte big-endian ciphertext block, so both directions
+// map block b to a fixed offset and chunks decrypt independently. The key is
+// "n;e" or "n;d" in hex; a full "n;e;d" triple also works, with the
+// exponent picked by direction, and may be followed by a
+// "prime;exponent;coefficient" triple per prime factor (2 to 4 of them), in
+// which case decryption goes through CRT.
+class RsaCipherEngine : public CipherEngine {
+public:
+    std::string name() const override { return "rsa"; }
+    CipherInstrAlgorithm instrumentation_algorithm() const override {
+        return CipherInstrAlgorithm::Rsa;
+    }
+    void init(const std::string& key, CipherDirection direction) override;
+    // For decryption: uses key, with its CRT factors, instead of the
+    // exponent given to init().
+    void set_private_key(const PrivateKey& key);
+
+    size_t block_size() const override;
+    size_t max_output_size(size_t length) const override;
+    size_t tail_size() const override;
+
+    size_t process(const unsigned char* in, size_t length, unsigned char* out) override;
+    size_t finalize(const unsigned char* in, size_t length, unsigned char* out) override;
+
+    bool supports_seek() const override { return true; }
+    uint64_t output_offset(uint64_t input_offset) const override;
+    std::unique_ptr<CipherEngine> clone() const override { return std::make_unique<RsaCipherEngine>(*this); }
+
+private:
+    BigInt n_;
+    BigInt exponent_;
+    PrivateKey private_key_;
+    size_t key_n_byte_length_ = 0;
+    size_t block_payload_ = 0;
+};
 #endif /* rsa_hpp */
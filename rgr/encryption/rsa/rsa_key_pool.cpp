@@ -0,0 +1,243 @@
+//
+//  rsa_key_pool.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "rsa_key_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__APPLE__)
+#include <pthread/qos.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+void lower_current_thread_priority() {
+#if defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined(__linux__)
+    // On Linux the nice value of a thread id applies to that thread only.
+    setpriority(PRIO_PROCESS, 0, 19);
+#endif
+}
+
+boost::random::mt19937 &key_pool_rng() {
+    thread_local boost::random::mt19937 rng = [] {
+        boost::random::mt19937 seeded;
+        seedKeyGenerator(seeded);
+        return seeded;
+    }();
+    return rng;
+}
+
+void check_key_size(unsigned int bits, unsigned int prime_count) {
+    if (prime_count < 2 || prime_count > 4) {
+        throw std::invalid_argument("RSA keys use 2, 3 or 4 primes.");
+    }
+    if (bits < 3 * prime_count) {
+        throw std::invalid_argument(
+            "Total key bit length must be at least 3 bits per prime.");
+    }
+}
+
+} // namespace
+
+RsaKeyPool::RsaKeyPool(unsigned int workers)
+    : worker_count_(std::max(1u, workers)) {}
+
+RsaKeyPool::~RsaKeyPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (std::thread &worker : workers_) {
+        worker.join();
+    }
+}
+
+void RsaKeyPool::reserve(unsigned int bits, size_t depth,
+                         unsigned int prime_count) {
+    check_key_size(bits, prime_count);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot &slot = slots_[{bits, prime_count}];
+        slot.target_depth = depth;
+        while (slot.ready.size() > depth) {
+            slot.ready.pop_back();
+        }
+        if (depth > 0) {
+            start_workers();
+        }
+    }
+    work_cv_.notify_all();
+}
+
+KeyPair RsaKeyPool::acquire(unsigned int bits, unsigned int prime_count) {
+    check_key_size(bits, prime_count);
+    KeyPair keys;
+    if (try_acquire(bits, keys, prime_count)) {
+        return keys;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++slots_[{bits, prime_count}].served_synchronously;
+    }
+    return generateKeys(bits, key_pool_rng(), prime_count);
+}
+
+bool RsaKeyPool::try_acquire(unsigned int bits, KeyPair &keys,
+                             unsigned int prime_count) {
+    check_key_size(bits, prime_count);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = slots_.find({bits, prime_count});
+        if (it == slots_.end() || it->second.ready.empty()) {
+            return false;
+        }
+        keys = std::move(it->second.ready.front());
+        it->second.ready.pop_front();
+        ++it->second.served_from_pool;
+    }
+    work_cv_.notify_one();
+    return true;
+}
+
+RsaKeyPoolStats RsaKeyPool::stats(unsigned int bits,
+                                  unsigned int prime_count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slots_.find({bits, prime_count});
+    if (it == slots_.end()) {
+        RsaKeyPoolStats empty;
+        empty.bits = bits;
+        empty.prime_count = prime_count;
+        return empty;
+    }
+    return slot_stats(it->first, it->second);
+}
+
+std::vector<RsaKeyPoolStats> RsaKeyPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<RsaKeyPoolStats> all;
+    all.reserve(slots_.size());
+    for (const auto &[size, slot] : slots_) {
+        all.push_back(slot_stats(size, slot));
+    }
+    return all;
+}
+
+void RsaKeyPool::start_workers() {
+    while (workers_.size() < worker_count_) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+std::map<RsaKeyPool::SizeKey, RsaKeyPool::Slot>::iterator
+RsaKeyPool::next_refill() {
+    auto best = slots_.end();
+    size_t best_have = 0;
+    for (auto it = slots_.begin(); it != slots_.end(); ++it) {
+        const Slot &slot = it->second;
+        size_t have = slot.ready.size() + slot.generating;
+        if (have < slot.target_depth &&
+            (best == slots_.end() || have < best_have)) {
+            best = it;
+            best_have = have;
+        }
+    }
+    return best;
+}
+
+void RsaKeyPool::worker_loop() {
+    lower_current_thread_priority();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        auto slot = slots_.end();
+        work_cv_.wait(lock, [&] {
+            return stopping_ || (slot = next_refill()) != slots_.end();
+        });
+        if (stopping_) {
+            return;
+        }
+        SizeKey size = slot->first;
+        ++slot->second.generating;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        KeyPair keys;
+        bool generated = true;
+        try {
+            keys = generateKeys(size.first, key_pool_rng(), size.second);
+        } catch (const std::exception &) {
+            generated = false;
+        }
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+        lock.lock();
+        // Slots are never erased, so the iterator is still valid.
+        --slot->second.generating;
+        if (!generated) {
+            // Do not spin on a size that keeps failing.
+            slot->second.target_depth = 0;
+            continue;
+        }
+        if (slot->second.ready.size() < slot->second.target_depth) {
+            slot->second.ready.push_back(std::move(keys));
+        }
+        ++slot->second.generated;
+        slot->second.generation_seconds += seconds;
+    }
+}
+
+RsaKeyPoolStats RsaKeyPool::slot_stats(const SizeKey &size, const Slot &slot) {
+    RsaKeyPoolStats stats;
+    stats.bits = size.first;
+    stats.prime_count = size.second;
+    stats.target_depth = slot.target_depth;
+    stats.ready = slot.ready.size();
+    stats.generating = slot.generating;
+    stats.served_from_pool = slot.served_from_pool;
+    stats.served_synchronously = slot.served_synchronously;
+    stats.generated = slot.generated;
+    if (slot.generated > 0 && slot.generation_seconds > 0.0) {
+        stats.average_generation_ms =
+            slot.generation_seconds * 1000.0 / slot.generated;
+        stats.refill_keys_per_second = slot.generated / slot.generation_seconds;
+    }
+    return stats;
+}
+
+RsaKeyPool &rsa_key_pool() {
+    static RsaKeyPool *pool = new RsaKeyPool(1);
+    return *pool;
+}
+
+std::string rsa_key_pool_stats_to_json(const std::vector<RsaKeyPoolStats> &stats) {
+    std::ostringstream json;
+    json << "{\"sizes\":[";
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const RsaKeyPoolStats &s = stats[i];
+        json << (i ? "," : "") << "{\"bits\":" << s.bits
+             << ",\"primes\":" << s.prime_count
+             << ",\"target_depth\":" << s.target_depth
+             << ",\"ready\":" << s.ready << ",\"generating\":" << s.generating
+             << ",\"served_from_pool\":" << s.served_from_pool
+             << ",\"served_synchronously\":" << s.served_synchronously
+             << ",\"generated\":" << s.generated
+             << ",\"average_generation_ms\":" << s.average_generation_ms
+             << ",\"refill_keys_per_second\":" << s.refill_keys_per_second
+             << "}";
+    }
+    json << "]}";
+    return json.str();
+}
@@ -0,0 +1,103 @@
+//
+//  rsa_key_pool.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef RSA_KEY_POOL_HPP
+#define RSA_KEY_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rsa.hpp"
+
+// Pool state of one key size. refill_keys_per_second is the rate of one
+// background worker on this size (keys generated per second spent
+// generating them); the pool refills at up to that rate times the worker
+// count.
+struct RsaKeyPoolStats {
+    unsigned int bits = 0;
+    unsigned int prime_count = 2;
+    size_t target_depth = 0;
+    size_t ready = 0;
+    size_t generating = 0;
+    uint64_t served_from_pool = 0;
+    uint64_t served_synchronously = 0;
+    uint64_t generated = 0;
+    double average_generation_ms = 0.0;
+    double refill_keys_per_second = 0.0;
+};
+
+// Keeps ready RSA key pairs per key size so that key generation, which
+// takes seconds for large keys, is served from memory. Background workers
+// run at the lowest scheduling priority, start on the first reserve() and
+// refill a size whenever acquire() takes a key from it. Every key is handed
+// out once.
+class RsaKeyPool {
+  public:
+    explicit RsaKeyPool(unsigned int workers = 1);
+    // Stops the workers, waiting for keys that are being generated.
+    ~RsaKeyPool();
+    RsaKeyPool(const RsaKeyPool &) = delete;
+    RsaKeyPool &operator=(const RsaKeyPool &) = delete;
+
+    // Keeps depth ready key pairs of bits bits and prime_count primes (see
+    // generateKeys); depth 0 stops refilling that size. Throws
+    // std::invalid_argument for sizes generateKeys rejects.
+    void reserve(unsigned int bits, size_t depth, unsigned int prime_count = 2);
+    // A pooled key pair, or a freshly generated one (synchronously) when the
+    // pool for that size is empty. Throws std::invalid_argument like
+    // reserve().
+    KeyPair acquire(unsigned int bits, unsigned int prime_count = 2);
+    // Only a pooled key pair; false when none is ready. Throws
+    // std::invalid_argument like reserve().
+    bool try_acquire(unsigned int bits, KeyPair &keys,
+                     unsigned int prime_count = 2);
+
+    RsaKeyPoolStats stats(unsigned int bits,
+                          unsigned int prime_count = 2) const;
+    std::vector<RsaKeyPoolStats> stats() const;
+
+  private:
+    using SizeKey = std::pair<unsigned int, unsigned int>;
+    struct Slot {
+        std::deque<KeyPair> ready;
+        size_t target_depth = 0;
+        size_t generating = 0;
+        uint64_t served_from_pool = 0;
+        uint64_t served_synchronously = 0;
+        uint64_t generated = 0;
+        double generation_seconds = 0.0;
+    };
+
+    void start_workers();
+    void worker_loop();
+    // The size furthest below its target, or slots_.end(); needs mutex_.
+    std::map<SizeKey, Slot>::iterator next_refill();
+    static RsaKeyPoolStats slot_stats(const SizeKey &size, const Slot &slot);
+
+    unsigned int worker_count_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::map<SizeKey, Slot> slots_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+};
+
+// Process-wide pool behind rgr_rsa_generate_key. It is never destroyed, so
+// process exit does not wait for a key in progress.
+RsaKeyPool &rsa_key_pool();
+
+std::string rsa_key_pool_stats_to_json(const std::vector<RsaKeyPoolStats> &stats);
+
+#endif // RSA_KEY_POOL_HPP
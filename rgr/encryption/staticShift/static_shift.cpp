@@ -0,0 +1,99 @@
+//
+//  static_shift.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "static_shift.hpp"
+#include <cctype>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+bool parse_static_shift_key_cpp(const std::string &key_str,
+                                unsigned char &shift) {
+    if (key_str.empty()) {
+        shift = STATIC_SHIFT_DEFAULT_AMOUNT;
+        return true;
+    }
+    unsigned int value = 0;
+    for (char c : key_str) {
+        if (!isdigit(static_cast<unsigned char>(c))) return false;
+        value = (value * 10 + static_cast<unsigned int>(c - '0')) % 256;
+    }
+    shift = static_cast<unsigned char>(value);
+    return true;
+}
+
+void static_shift_bytes_cpp(const unsigned char *in, unsigned char *out,
+                            size_t length, unsigned char shift) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i delta = _mm_set1_epi8(static_cast<char>(shift));
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm_add_epi8(v, delta));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t delta = vdupq_n_u8(shift);
+    for (; i + 16 <= length; i += 16) {
+        vst1q_u8(out + i, vaddq_u8(vld1q_u8(in + i), delta));
+    }
+#endif
+    for (; i < length; ++i) {
+        out[i] = static_cast<unsigned char>(in[i] + shift);
+    }
+}
+
+std::vector<unsigned char>
+static_shift_encrypt_data_cpp(const std::vector<unsigned char> &plaintext,
+                              const std::string &key_str) {
+    unsigned char shift = 0;
+    if (!parse_static_shift_key_cpp(key_str, shift)) {
+        throw std::invalid_argument("Invalid static shift key: expected a "
+                                    "decimal shift amount.");
+    }
+    std::vector<unsigned char> ciphertext(plaintext.size());
+    static_shift_bytes_cpp(plaintext.data(), ciphertext.data(),
+                           plaintext.size(), shift);
+    return ciphertext;
+}
+
+std::vector<unsigned char>
+static_shift_decrypt_data_cpp(const std::vector<unsigned char> &ciphertext,
+                              const std::string &key_str) {
+    unsigned char shift = 0;
+    if (!parse_static_shift_key_cpp(key_str, shift)) {
+        throw std::invalid_argument("Invalid static shift key: expected a "
+                                    "decimal shift amount.");
+    }
+    std::vector<unsigned char> plaintext(ciphertext.size());
+    static_shift_bytes_cpp(ciphertext.data(), plaintext.data(),
+                           ciphertext.size(),
+                           static_cast<unsigned char>(256 - shift));
+    return plaintext;
+}
+
+void StaticShiftCipherEngine::init(const std::string &key,
+                                   CipherDirection direction) {
+    direction_ = direction;
+    unsigned char shift = 0;
+    if (!parse_static_shift_key_cpp(key, shift)) {
+        throw std::invalid_argument("Invalid static shift key: expected a "
+                                    "decimal shift amount.");
+    }
+    shift_ = direction == CipherDirection::Encrypt
+                 ? shift
+                 : static_cast<unsigned char>(256 - shift);
+}
+
+size_t StaticShiftCipherEngine::process(const unsigned char *in, size_t length,
+                                        unsigned char *out) {
+    static_shift_bytes_cpp(in, out, length, shift_);
+    return length;
+}
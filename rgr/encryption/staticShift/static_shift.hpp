@@ -0,0 +1,56 @@
+//
+//  static_shift.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef STATIC_SHIFT_HPP
+#define STATIC_SHIFT_HPP
+
+#include <string>
+#include <vector>
+
+#include "../engine/cipher_engine.hpp"
+
+// The app's demo cipher adds 1 to every byte; a key selects another shift.
+const unsigned char STATIC_SHIFT_DEFAULT_AMOUNT = 1;
+
+// Parses a decimal shift amount (taken modulo 256); an empty key selects
+// STATIC_SHIFT_DEFAULT_AMOUNT.
+bool parse_static_shift_key_cpp(const std::string &key_str,
+                                unsigned char &shift);
+// out[i] = in[i] + shift (mod 256); in and out may be the same buffer.
+void static_shift_bytes_cpp(const unsigned char *in, unsigned char *out,
+                            size_t length, unsigned char shift);
+std::vector<unsigned char>
+static_shift_encrypt_data_cpp(const std::vector<unsigned char> &plaintext,
+                              const std::string &key_str);
+std::vector<unsigned char>
+static_shift_decrypt_data_cpp(const std::vector<unsigned char> &ciphertext,
+                              const std::string &key_str);
+
+class StaticShiftCipherEngine : public CipherEngine {
+  public:
+    std::string name() const override { return "static_shift"; }
+    CipherInstrAlgorithm instrumentation_algorithm() const override {
+        return CipherInstrAlgorithm::StaticShift;
+    }
+    void init(const std::string &key, CipherDirection direction) override;
+    size_t block_size() const override { return 1; }
+    size_t process(const unsigned char *in, size_t length,
+                   unsigned char *out) override;
+    size_t finalize(const unsigned char *in, size_t length,
+                    unsigned char *out) override {
+        return process(in, length, out);
+    }
+    bool supports_seek() const override { return true; }
+    std::unique_ptr<CipherEngine> clone() const override {
+        return std::make_unique<StaticShiftCipherEngine>(*this);
+    }
+
+  private:
+    unsigned char shift_ = STATIC_SHIFT_DEFAULT_AMOUNT;
+};
+
+#endif // STATIC_SHIFT_HPP
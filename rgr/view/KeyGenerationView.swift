@@ -90,7 +90,10 @@ struct KeyGenerationView: View {
         }
         .padding()
         .frame(minWidth: 500, idealWidth: 600, minHeight: 550, idealHeight: 700)
-        .onAppear(perform: updateFeedbackForAlgorithmChange)
+        .onAppear {
+            updateFeedbackForAlgorithmChange()
+            rsaWrapper.prepareRSAKeyPool(withBitSizes: rsaBitSizes.map { NSNumber(value: $0) }, depth: 2)
+        }
     }
 
     // MARK: - Algorithm Specific Controls
@@ -0,0 +1,233 @@
+//
+//  cipher_async_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  The coroutine API must produce what the blocking functions produce, on
+//  both I/O backends.
+//
+
+#include "rgr_test.hpp"
+
+#include "async/cipher_async.hpp"
+#include "async/cipher_executor.hpp"
+
+#include <atomic>
+#include <sstream>
+
+namespace {
+
+const char *const GOST_KEY =
+    "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20";
+const char *const GOST_IV = "0011223344556677";
+
+std::string read_text(const std::string &path) {
+    std::vector<unsigned char> bytes = rgr_test_read_file(path);
+    return std::string(bytes.begin(), bytes.end());
+}
+
+struct EngineKeys {
+    std::string name;
+    std::string encrypt_key;
+    std::string decrypt_key;
+};
+
+std::string hex(const BigInt &value) {
+    std::ostringstream text;
+    text << std::hex << value;
+    return text.str();
+}
+
+std::vector<EngineKeys> engine_keys(const KeyPair &rsa) {
+    std::string rsa_key = hex(rsa.pubKey.n) + ";" + hex(rsa.pubKey.e) + ";" +
+                          hex(rsa.privKey.d);
+    return {
+        {"gost", std::string(GOST_KEY) + ":" + GOST_IV, GOST_KEY},
+        {"permutation", "2031", "2031"},
+        {"static_shift", "5", "5"},
+        {"rsa", rsa_key, rsa_key},
+    };
+}
+
+// run_cipher_file_async against run_cipher_stream, with chunks small
+// enough that every size below crosses several of them.
+void test_driver_matches_stream(CipherExecutor &executor,
+                                const RgrTestDir &dir, const KeyPair &rsa) {
+    CipherEngineRegistry &registry = CipherEngineRegistry::instance();
+    for (const EngineKeys &keys : engine_keys(rsa)) {
+        for (size_t length : {0, 1, 7, 8, 9, 255, 4096, 100000}) {
+            std::string data = std::string(
+                reinterpret_cast<const char *>(rgr_test_bytes(length).data()),
+                length);
+            rgr_test_write_file(dir.file("plain"), rgr_test_bytes(length));
+
+            auto engine = registry.create(keys.name, keys.encrypt_key,
+                                          CipherDirection::Encrypt);
+            std::istringstream input(data);
+            std::ostringstream output;
+            CipherDriverOptions options;
+            options.chunk_size = 256;
+            RGR_CHECK(run_cipher_stream(*engine, input, output, options).success);
+
+            auto async_engine = registry.create(keys.name, keys.encrypt_key,
+                                                CipherDirection::Encrypt);
+            CipherDriverResult encrypted = cipher_sync_wait(
+                executor,
+                run_cipher_file_async(executor, *async_engine, dir.file("plain"),
+                                      dir.file("enc"), 256));
+            RGR_CHECK(encrypted.success && encrypted.bytes_in == length);
+            RGR_CHECK(read_text(dir.file("enc")) == output.str());
+
+            auto decrypt_engine = registry.create(keys.name, keys.decrypt_key,
+                                                  CipherDirection::Decrypt);
+            CipherDriverResult decrypted = cipher_sync_wait(
+                executor,
+                run_cipher_file_async(executor, *decrypt_engine,
+                                      dir.file("enc"), dir.file("dec"), 256));
+            RGR_CHECK(decrypted.success);
+            RGR_CHECK(read_text(dir.file("dec")) == data);
+        }
+    }
+}
+
+// A failed or cancelled run leaves no output file.
+void test_driver_failures(CipherExecutor &executor, const RgrTestDir &dir) {
+    CipherEngineRegistry &registry = CipherEngineRegistry::instance();
+    rgr_test_write_file(dir.file("plain"), rgr_test_bytes(10000));
+    auto engine = registry.create("gost", std::string(GOST_KEY) + ":" + GOST_IV,
+                                  CipherDirection::Encrypt);
+    RGR_CHECK(cipher_sync_wait(executor,
+                               run_cipher_file_async(executor, *engine,
+                                                     dir.file("plain"),
+                                                     dir.file("enc")))
+                  .success);
+
+    // Every key byte differs, so the padding check fails.
+    std::string wrong_key(64, 'a');
+    auto wrong = registry.create("gost", wrong_key, CipherDirection::Decrypt);
+    CipherDriverResult result = cipher_sync_wait(
+        executor, run_cipher_file_async(executor, *wrong, dir.file("enc"),
+                                        dir.file("bad")));
+    RGR_CHECK(!result.success);
+    RGR_CHECK(!std::filesystem::exists(dir.file("bad")));
+
+    CipherProgressToken token;
+    token.cancel();
+    auto cancelled = registry.create(
+        "gost", std::string(GOST_KEY) + ":" + GOST_IV, CipherDirection::Encrypt);
+    result = cipher_sync_wait(
+        executor, run_cipher_file_async(executor, *cancelled,
+                                        dir.file("plain"), dir.file("cancelled"),
+                                        256, &token));
+    RGR_CHECK(!result.success && result.cancelled);
+    RGR_CHECK(!std::filesystem::exists(dir.file("cancelled")));
+
+    result = cipher_sync_wait(
+        executor, run_cipher_file_async(executor, *engine, dir.file("missing"),
+                                        dir.file("out")));
+    RGR_CHECK(!result.success);
+}
+
+CipherTask<int> file_roundtrip(CipherExecutor &executor, std::string base,
+                               std::atomic<int> *failures) {
+    GostFileOperationResult encrypted = co_await encryptFileGOSTAsync(
+        executor, base, base + ".enc", GOST_KEY, GOST_IV);
+    GostFileOperationResult decrypted = co_await decryptFileGOSTAsync(
+        executor, base + ".enc", base + ".dec", GOST_KEY);
+    PermutationFileResultCpp permuted = co_await encryptFilePermutationAsync(
+        executor, base, base + ".penc", "2031");
+    PermutationFileResultCpp restored = co_await decryptFilePermutationAsync(
+        executor, base + ".penc", base + ".pdec", "2031");
+    if (!encrypted.success || !decrypted.success || !permuted.success ||
+        !restored.success || decrypted.used_iv_hex != encrypted.used_iv_hex) {
+        ++*failures;
+    }
+    co_return 0;
+}
+
+// Many files in flight at once on two workers; outputs equal the blocking
+// functions' byte for byte.
+void test_many_files(CipherExecutor &executor, const RgrTestDir &dir) {
+    const int files = 64;
+    for (int i = 0; i < files; ++i) {
+        rgr_test_write_file(dir.file("f" + std::to_string(i)),
+                            rgr_test_bytes(static_cast<size_t>(i) * 3001,
+                                           static_cast<uint32_t>(i)));
+    }
+    std::atomic<int> failures{0};
+    for (int i = 0; i < files; ++i) {
+        executor.spawn(
+            file_roundtrip(executor, dir.file("f" + std::to_string(i)), &failures));
+    }
+    executor.wait_idle();
+    RGR_CHECK(failures == 0);
+    for (int i = 0; i < files; i += 7) {
+        std::string base = dir.file("f" + std::to_string(i));
+        RGR_CHECK(encryptFileGOST(base, base + ".senc", GOST_KEY, GOST_IV).success);
+        RGR_CHECK(encryptFilePermutationCpp(base, base + ".spenc", "2031").success);
+        RGR_CHECK(read_text(base + ".senc") == read_text(base + ".enc"));
+        RGR_CHECK(read_text(base + ".spenc") == read_text(base + ".penc"));
+        RGR_CHECK(read_text(base + ".dec") == read_text(base));
+        RGR_CHECK(read_text(base + ".pdec") == read_text(base));
+    }
+}
+
+void test_text_and_rsa(CipherExecutor &executor, const RgrTestDir &dir,
+                       const KeyPair &rsa) {
+    GostEncryptedTextResult text = cipher_sync_wait(
+        executor, encryptTextGOSTAsync(executor, "hello", GOST_KEY, GOST_IV));
+    RGR_CHECK(text.success);
+    RGR_CHECK(text.ciphertext_hex ==
+              encryptTextGOST("hello", GOST_KEY, GOST_IV).ciphertext_hex);
+    RGR_CHECK(cipher_sync_wait(executor,
+                               decryptTextGOSTAsync(executor, text.iv_hex,
+                                                    text.ciphertext_hex,
+                                                    GOST_KEY))
+                  .plaintext == "hello");
+
+    PermutationTextResultCpp permuted = cipher_sync_wait(
+        executor, encryptTextPermutationAsync(executor, "hello world", "2031"));
+    RGR_CHECK(permuted.success);
+    RGR_CHECK(cipher_sync_wait(executor,
+                               decryptTextPermutationAsync(
+                                   executor, permuted.data_hex, "2031"))
+                  .data_hex == "hello world");
+
+    size_t k = getApproximateByteLength(rsa.pubKey.n);
+    std::vector<BigInt> blocks = cipher_sync_wait(
+        executor, encryptTextRSAAsync(executor, "rsa text", rsa.pubKey, k));
+    RGR_CHECK(cipher_sync_wait(executor, decryptTextRSAAsync(executor, blocks,
+                                                             rsa.privKey, k)) ==
+              "rsa text");
+    rgr_test_write_file(dir.file("rsa"), rgr_test_bytes(5000));
+    RGR_CHECK(cipher_sync_wait(executor,
+                               encryptFileRSAAsync(executor, dir.file("rsa"),
+                                                   dir.file("rsa.enc"),
+                                                   rsa.pubKey, k)));
+    RGR_CHECK(cipher_sync_wait(executor,
+                               decryptFileRSAAsync(executor, dir.file("rsa.enc"),
+                                                   dir.file("rsa.dec"),
+                                                   rsa.privKey, k)));
+    RGR_CHECK(read_text(dir.file("rsa.dec")) == read_text(dir.file("rsa")));
+}
+
+} // namespace
+
+int main() {
+    RgrTestDir dir("cipher_async_test");
+    boost::random::mt19937 rng(31);
+    KeyPair rsa = generateKeys(512, rng);
+    for (bool io_uring : {true, false}) {
+        CipherExecutorOptions options;
+        options.threads = 2;
+        options.use_io_uring = io_uring;
+        CipherExecutor executor(options);
+        RGR_CHECK(io_uring || !executor.uses_io_uring());
+        test_driver_matches_stream(executor, dir, rsa);
+        test_driver_failures(executor, dir);
+        test_many_files(executor, dir);
+        test_text_and_rsa(executor, dir, rsa);
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+//
+//  cipher_base64_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  The SSSE3/NEON paths of cipher_base64 must agree with a plain RFC 4648
+//  codec byte for byte: every length from 0 to 64 bytes crosses the vector
+//  block boundaries, and every character of every encoding is replaced by
+//  the byte values at the edges of the character ranges the vector code
+//  classifies, to check that decoding rejects exactly what the scalar rules
+//  reject.
+//
+
+#include "rgr_test.hpp"
+
+#include "common/cipher_base64.hpp"
+
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+const char *const STANDARD_CHARS =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char *const URL_CHARS =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Both ends of 'A'-'Z', 'a'-'z' and '0'-'9', the four extra characters of
+// both alphabets with their neighbours, '=', NUL and bytes above 0x7f.
+const unsigned char EDGE_BYTES[] = {
+    0x00, 0x01, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x39, 0x3a, 0x3d,
+    0x40, 0x41, 0x5a, 0x5b, 0x5e, 0x5f, 0x60, 0x61, 0x7a, 0x7b, 0x7e, 0x7f,
+    0x80, 0xab, 0xc1, 0xef, 0xff,
+};
+
+const char *chars_of(CipherBase64Alphabet alphabet) {
+    return alphabet == CipherBase64Alphabet::Url ? URL_CHARS : STANDARD_CHARS;
+}
+
+std::string reference_encode(const std::vector<unsigned char> &data,
+                             CipherBase64Alphabet alphabet, bool pad) {
+    const char *chars = chars_of(alphabet);
+    std::string out;
+    uint32_t bits = 0;
+    int count = 0;
+    for (unsigned char byte : data) {
+        bits = bits << 8 | byte;
+        count += 8;
+        while (count >= 6) {
+            count -= 6;
+            out += chars[(bits >> count) & 0x3F];
+        }
+    }
+    if (count > 0) {
+        out += chars[(bits << (6 - count)) & 0x3F];
+    }
+    while (pad && out.size() % 4 != 0) {
+        out += '=';
+    }
+    return out;
+}
+
+// cipher_base64_decode's rules: up to two '=' may end a multiple of four
+// characters, the rest must come from the alphabet, and a lone trailing
+// character is an error. Unused low bits of the last character are
+// ignored.
+std::optional<std::vector<unsigned char>>
+reference_decode(std::string text, CipherBase64Alphabet alphabet) {
+    if (text.size() % 4 == 0 && !text.empty() && text.back() == '=') {
+        text.resize(text.size() - (text[text.size() - 2] == '=' ? 2 : 1));
+    }
+    if (text.size() % 4 == 1) {
+        return std::nullopt;
+    }
+    const char *chars = chars_of(alphabet);
+    std::vector<unsigned char> out;
+    uint32_t bits = 0;
+    int count = 0;
+    for (char c : text) {
+        const char *found = c == '\0' ? nullptr : std::strchr(chars, c);
+        if (found == nullptr) {
+            return std::nullopt;
+        }
+        bits = bits << 6 | static_cast<uint32_t>(found - chars);
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            out.push_back(static_cast<unsigned char>(bits >> count));
+        }
+    }
+    return out;
+}
+
+std::optional<std::vector<unsigned char>>
+library_decode(const std::string &text, CipherBase64Alphabet alphabet) {
+    try {
+        return cipher_base64_decode(text, alphabet);
+    } catch (const std::invalid_argument &) {
+        return std::nullopt;
+    }
+}
+
+void test_rfc4648_vectors() {
+    const char *const vectors[][2] = {
+        {"", ""},         {"f", "Zg=="},         {"fo", "Zm8="},
+        {"foo", "Zm9v"},  {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="},
+        {"foobar", "Zm9vYmFy"},
+    };
+    for (const auto &vector : vectors) {
+        std::string plain = vector[0];
+        std::vector<unsigned char> bytes(plain.begin(), plain.end());
+        RGR_CHECK(cipher_base64_encode(bytes.data(), bytes.size()) ==
+                  vector[1]);
+        RGR_CHECK(cipher_base64_decode(vector[1]) == bytes);
+    }
+}
+
+void test_matches_reference() {
+    for (CipherBase64Alphabet alphabet :
+         {CipherBase64Alphabet::Standard, CipherBase64Alphabet::Url}) {
+        for (size_t length = 0; length <= 64; ++length) {
+            std::vector<unsigned char> data =
+                rgr_test_bytes(length, static_cast<uint32_t>(length) + 7);
+            for (bool pad : {true, false}) {
+                std::string encoded = cipher_base64_encode(
+                    data.data(), data.size(), alphabet, pad);
+                RGR_CHECK(encoded == reference_encode(data, alphabet, pad));
+                RGR_CHECK(encoded.size() ==
+                          cipher_base64_encoded_length(length, pad));
+                RGR_CHECK(cipher_base64_decode(encoded, alphabet) == data);
+            }
+            std::string encoded = reference_encode(data, alphabet, true);
+            for (size_t position = 0; position < encoded.size(); ++position) {
+                for (unsigned char value : EDGE_BYTES) {
+                    std::string text = encoded;
+                    text[position] = static_cast<char>(value);
+                    RGR_CHECK(library_decode(text, alphabet) ==
+                              reference_decode(text, alphabet));
+                }
+            }
+        }
+    }
+}
+
+void test_text_encodings() {
+    std::vector<unsigned char> data = {0x00, 0xfb, 0xff, 0x10};
+    RGR_CHECK(cipher_text_encode(data, CipherTextEncoding::Hex) == "00fbff10");
+    RGR_CHECK(cipher_text_encode(data, CipherTextEncoding::Base64) ==
+              "APv/EA==");
+    RGR_CHECK(cipher_text_encode(data, CipherTextEncoding::Base64Url) ==
+              "APv_EA");
+    for (CipherTextEncoding encoding :
+         {CipherTextEncoding::Hex, CipherTextEncoding::Base64,
+          CipherTextEncoding::Base64Url}) {
+        RGR_CHECK(cipher_text_decode(cipher_text_encode(data, encoding),
+                                     encoding) == data);
+    }
+    RGR_CHECK_THROWS(cipher_text_decode("APv/EA==\n",
+                                        CipherTextEncoding::Base64),
+                     std::invalid_argument);
+}
+
+} // namespace
+
+int main() {
+    test_rfc4648_vectors();
+    test_matches_reference();
+    test_text_encodings();
+    return 0;
+}
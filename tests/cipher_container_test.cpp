@@ -0,0 +1,344 @@
+//
+//  cipher_container_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  Seekable containers: whole-file roundtrips with and without the MAC and
+//  LZ4 flags, random access through CipherContainerReader, and rejection
+//  of tampered, truncated or mismatched containers without partial output.
+//
+
+#include "rgr_test.hpp"
+
+#include "common/cipher_siphash.hpp"
+#include "container/cipher_container.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const char *const GOST_KEY =
+    "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20";
+const uint32_t CHUNK = 4096;
+
+std::unique_ptr<CipherEngine> engine(const std::string &name,
+                                     CipherDirection direction) {
+    std::string key = name == "gost" ? GOST_KEY : "5";
+    return CipherEngineRegistry::instance().create(name, key, direction);
+}
+
+std::vector<unsigned char> mac_key(uint32_t seed = 7) {
+    return rgr_test_bytes(CIPHER_SIPHASH_KEY_BYTES, seed);
+}
+
+// Runs of repeated bytes between random stretches, so LZ4 shrinks some
+// chunks and stores others as they are.
+std::vector<unsigned char> mixed_bytes(size_t length) {
+    std::vector<unsigned char> data = rgr_test_bytes(length, 3);
+    for (size_t i = 0; i < length; ++i) {
+        if ((i / CHUNK) % 2 == 0) {
+            data[i] = static_cast<unsigned char>(i / 512);
+        }
+    }
+    return data;
+}
+
+void flip_byte(const std::string &path, uint64_t offset) {
+    std::vector<unsigned char> bytes = rgr_test_read_file(path);
+    RGR_CHECK(offset < bytes.size());
+    bytes[static_cast<size_t>(offset)] ^= 0x20;
+    rgr_test_write_file(path, bytes);
+}
+
+CipherContainerOptions container_options(bool mac, bool lz4,
+                                         unsigned int threads) {
+    CipherContainerOptions options;
+    options.chunk_size = CHUNK;
+    options.threads = threads;
+    options.compression =
+        lz4 ? CipherContainerCompression::Lz4 : CipherContainerCompression::None;
+    if (mac) {
+        options.mac_key = mac_key();
+    }
+    return options;
+}
+
+// Writes data as a container at dir.file("box").
+void write_box(const RgrTestDir &dir, const std::vector<unsigned char> &data,
+               const CipherContainerOptions &options,
+               const std::string &name = "gost") {
+    rgr_test_write_file(dir.file("plain"), data);
+    auto encryptor = engine(name, CipherDirection::Encrypt);
+    CipherContainerResult result = write_cipher_container(
+        *encryptor, dir.file("plain"), dir.file("box"), options);
+    RGR_CHECK(result.success);
+    RGR_CHECK(result.plaintext_bytes == data.size());
+    RGR_CHECK(result.chunks == (data.size() + CHUNK - 1) / CHUNK);
+    RGR_CHECK(result.container_bytes ==
+              std::filesystem::file_size(dir.file("box")));
+}
+
+void test_roundtrips(const RgrTestDir &dir) {
+    for (const char *name : {"gost", "static_shift"}) {
+        for (size_t size : {size_t(0), size_t(1), size_t(CHUNK - 1),
+                            size_t(CHUNK), size_t(CHUNK + 1),
+                            size_t(9 * CHUNK + 17)}) {
+            std::vector<unsigned char> data = mixed_bytes(size);
+            for (int flags = 0; flags < 4; ++flags) {
+                for (unsigned int threads : {1u, 3u}) {
+                    CipherContainerOptions options =
+                        container_options(flags & 1, flags & 2, threads);
+                    write_box(dir, data, options, name);
+                    RGR_CHECK(is_cipher_container(dir.file("box")));
+
+                    auto decryptor = engine(name, CipherDirection::Decrypt);
+                    CipherContainerResult result = read_cipher_container(
+                        *decryptor, dir.file("box"), dir.file("out"), options);
+                    RGR_CHECK(result.success);
+                    RGR_CHECK(result.plaintext_bytes == size);
+                    RGR_CHECK(rgr_test_read_file(dir.file("out")) == data);
+                }
+            }
+        }
+    }
+    RGR_CHECK(!is_cipher_container(dir.file("plain")));
+    RGR_CHECK(!is_cipher_container(dir.file("missing")));
+}
+
+void test_reader_random_access(const RgrTestDir &dir) {
+    const size_t size = 7 * CHUNK + 123;
+    std::vector<unsigned char> data = mixed_bytes(size);
+    for (int flags = 0; flags < 4; ++flags) {
+        CipherContainerOptions options = container_options(flags & 1, flags & 2, 2);
+        write_box(dir, data, options);
+        auto decryptor = engine("gost", CipherDirection::Decrypt);
+        CipherContainerReader reader(dir.file("box"), *decryptor,
+                                     options.mac_key);
+        RGR_CHECK(reader.size() == size);
+        RGR_CHECK(reader.chunk_size() == CHUNK);
+        RGR_CHECK(reader.chunk_count() == 8);
+        RGR_CHECK(reader.authenticated() == ((flags & 1) != 0));
+        RGR_CHECK(reader.compressed() == ((flags & 2) != 0));
+        RGR_CHECK(reader.index_entry(0).record_offset ==
+                  CIPHER_CONTAINER_HEADER_BYTES);
+        RGR_CHECK(reader.index_entry(7).plaintext_length == 123);
+        RGR_CHECK_THROWS(reader.index_entry(8), std::out_of_range);
+
+        uint32_t state = 12345;
+        for (int i = 0; i < 200; ++i) {
+            state = state * 1103515245u + 12345u;
+            uint64_t offset = (state >> 8) % (size + 10);
+            state = state * 1103515245u + 12345u;
+            size_t length = (state >> 8) % (3 * CHUNK);
+            std::vector<unsigned char> got = reader.read_at(offset, length);
+            size_t expected = offset >= size
+                                  ? 0
+                                  : std::min<size_t>(length, size - offset);
+            RGR_CHECK(got.size() == expected);
+            RGR_CHECK(std::equal(got.begin(), got.end(),
+                                 data.begin() + static_cast<std::ptrdiff_t>(
+                                                    std::min<uint64_t>(offset,
+                                                                       size))));
+        }
+        RGR_CHECK(reader.read_at(0, size + 100) == data);
+        RGR_CHECK(reader.read_at(size, 10).empty());
+        RGR_CHECK(reader.read_at(5, 0).empty());
+        std::vector<unsigned char> last = reader.read_chunk(7);
+        RGR_CHECK(std::equal(last.begin(), last.end(),
+                             data.begin() + 7 * CHUNK) &&
+                  last.size() == 123);
+    }
+
+    // Without a fixed IV every chunk gets its own, so equal chunks encrypt
+    // differently.
+    write_box(dir, std::vector<unsigned char>(2 * CHUNK, 0x5a),
+              container_options(false, false, 1));
+    auto decryptor = engine("gost", CipherDirection::Decrypt);
+    CipherContainerReader reader(dir.file("box"), *decryptor);
+    RGR_CHECK(reader.read_record(0) != reader.read_record(1));
+    RGR_CHECK(reader.read_chunk(0) == reader.read_chunk(1));
+}
+
+void test_mac(const RgrTestDir &dir) {
+    std::vector<unsigned char> data = mixed_bytes(4 * CHUNK + 9);
+    CipherContainerOptions options = container_options(true, true, 1);
+    write_box(dir, data, options);
+    std::vector<unsigned char> sealed = rgr_test_read_file(dir.file("box"));
+    auto decryptor = engine("gost", CipherDirection::Decrypt);
+
+    RGR_CHECK_THROWS(CipherContainerReader(dir.file("box"), *decryptor),
+                     std::runtime_error);
+    RGR_CHECK_THROWS(
+        CipherContainerReader(dir.file("box"), *decryptor, mac_key(8)),
+        std::runtime_error);
+    RGR_CHECK_THROWS(
+        CipherContainerReader(dir.file("box"), *decryptor,
+                              std::vector<unsigned char>(5, 1)),
+        std::invalid_argument);
+
+    // A tampered record fails on its own; the other chunks stay readable.
+    uint64_t record = 0;
+    {
+        CipherContainerReader reader(dir.file("box"), *decryptor, mac_key());
+        record = reader.index_entry(2).record_offset;
+    }
+    flip_byte(dir.file("box"), record + 11);
+    {
+        CipherContainerReader reader(dir.file("box"), *decryptor, mac_key());
+        RGR_CHECK_THROWS(reader.read_chunk(2), std::runtime_error);
+        RGR_CHECK_THROWS(reader.read_at(2 * CHUNK - 1, 2), std::runtime_error);
+        RGR_CHECK(reader.read_at(0, 2 * CHUNK) ==
+                  std::vector<unsigned char>(data.begin(),
+                                             data.begin() + 2 * CHUNK));
+        RGR_CHECK(reader.read_chunk(3).size() == CHUNK);
+    }
+    // The whole-file reader stops there and keeps none of chunks 0 and 1.
+    rgr_test_write_file(dir.file("out"), {1, 2, 3});
+    CipherContainerResult result =
+        read_cipher_container(*decryptor, dir.file("box"), dir.file("out"),
+                              options);
+    RGR_CHECK(!result.success && !result.cancelled);
+    RGR_CHECK(!std::filesystem::exists(dir.file("out")));
+
+    // Header fields are covered by the index tag: clearing the LZ4 flag,
+    // changing the chunk size or the engine name is detected.
+    const size_t header_offsets[] = {6, 9, 14};
+    for (size_t offset : header_offsets) {
+        rgr_test_write_file(dir.file("box"), sealed);
+        flip_byte(dir.file("box"), offset);
+        RGR_CHECK_THROWS(
+            CipherContainerReader(dir.file("box"), *decryptor, mac_key()),
+            std::runtime_error);
+    }
+
+    // Stripping the MAC flag does not downgrade a reader that has a key.
+    std::vector<unsigned char> stripped = sealed;
+    stripped[6] &= static_cast<unsigned char>(~CIPHER_CONTAINER_FLAG_MAC);
+    rgr_test_write_file(dir.file("box"), stripped);
+    RGR_CHECK_THROWS(
+        CipherContainerReader(dir.file("box"), *decryptor, mac_key()),
+        std::runtime_error);
+    result = read_cipher_container(*decryptor, dir.file("box"),
+                                   dir.file("out"), options);
+    RGR_CHECK(!result.success);
+    RGR_CHECK(!std::filesystem::exists(dir.file("out")));
+
+    // Nor does a container that never had tags.
+    write_box(dir, data, container_options(false, false, 1));
+    RGR_CHECK_THROWS(
+        CipherContainerReader(dir.file("box"), *decryptor, mac_key()),
+        std::runtime_error);
+}
+
+void test_corrupt_containers(const RgrTestDir &dir) {
+    std::vector<unsigned char> data = mixed_bytes(3 * CHUNK + 1);
+    write_box(dir, data, container_options(false, false, 1));
+    std::vector<unsigned char> box = rgr_test_read_file(dir.file("box"));
+    auto decryptor = engine("gost", CipherDirection::Decrypt);
+    auto expect_rejected = [&](const std::vector<unsigned char> &bytes) {
+        rgr_test_write_file(dir.file("bad"), bytes);
+        RGR_CHECK_THROWS(CipherContainerReader(dir.file("bad"), *decryptor),
+                         std::runtime_error);
+    };
+
+    expect_rejected({});
+    expect_rejected(std::vector<unsigned char>(box.begin(), box.end() - 1));
+    expect_rejected(std::vector<unsigned char>(box.begin(), box.begin() + 60));
+    std::vector<unsigned char> bad = box;
+    bad[0] = 'X';
+    expect_rejected(bad);
+    bad = box;
+    bad[4] = 9; // version
+    expect_rejected(bad);
+    bad = box;
+    bad[6] |= 0x80; // unknown flag
+    expect_rejected(bad);
+    bad = box;
+    bad[8] = bad[9] = bad[10] = bad[11] = 0; // chunk size
+    expect_rejected(bad);
+
+    // Index entries: a record offset past the index, a plaintext length
+    // beyond the chunk size, and an inconsistent plaintext total.
+    size_t index = box.size() - CIPHER_CONTAINER_TRAILER_BYTES -
+                   3 * CIPHER_CONTAINER_INDEX_ENTRY_BYTES -
+                   CIPHER_CONTAINER_INDEX_ENTRY_BYTES;
+    bad = box;
+    bad[index + CIPHER_CONTAINER_INDEX_ENTRY_BYTES + 7] = 0x40;
+    expect_rejected(bad);
+    bad = box;
+    bad[index + 13] = 0x7f;
+    expect_rejected(bad);
+    bad = box;
+    bad[box.size() - CIPHER_CONTAINER_TRAILER_BYTES + 16] ^= 1;
+    expect_rejected(bad);
+    bad = box;
+    bad[box.size() - CIPHER_CONTAINER_TRAILER_BYTES + 8] ^= 1; // chunk count
+    expect_rejected(bad);
+
+    // The wrong engine or direction.
+    auto shift = engine("static_shift", CipherDirection::Decrypt);
+    RGR_CHECK_THROWS(CipherContainerReader(dir.file("box"), *shift),
+                     std::runtime_error);
+    auto encryptor = engine("gost", CipherDirection::Encrypt);
+    RGR_CHECK_THROWS(CipherContainerReader(dir.file("box"), *encryptor),
+                     std::invalid_argument);
+    RGR_CHECK_THROWS(CipherContainerReader(dir.file("missing"), *decryptor),
+                     std::runtime_error);
+
+    // Without a MAC a damaged record is caught by the GOST padding check or
+    // the length checks, and the whole-file reader leaves no output.
+    bad = box;
+    bad[box.size() - CIPHER_CONTAINER_TRAILER_BYTES -
+        3 * CIPHER_CONTAINER_INDEX_ENTRY_BYTES - 1] ^= 0xff;
+    rgr_test_write_file(dir.file("bad"), bad);
+    CipherContainerResult result =
+        read_cipher_container(*decryptor, dir.file("bad"), dir.file("out"),
+                              container_options(false, false, 1));
+    RGR_CHECK(!result.success);
+    RGR_CHECK(!std::filesystem::exists(dir.file("out")));
+}
+
+void test_writer_failures(const RgrTestDir &dir) {
+    rgr_test_write_file(dir.file("plain"), mixed_bytes(20 * CHUNK));
+    auto encryptor = engine("gost", CipherDirection::Encrypt);
+    auto decryptor = engine("gost", CipherDirection::Decrypt);
+
+    CipherProgressToken token;
+    token.cancel();
+    CipherContainerOptions options = container_options(true, false, 1);
+    options.progress = &token;
+    CipherContainerResult result = write_cipher_container(
+        *encryptor, dir.file("plain"), dir.file("cancelled"), options);
+    RGR_CHECK(!result.success && result.cancelled);
+    RGR_CHECK(!std::filesystem::exists(dir.file("cancelled")));
+
+    result = write_cipher_container(*decryptor, dir.file("plain"),
+                                    dir.file("wrong"));
+    RGR_CHECK(!result.success && !std::filesystem::exists(dir.file("wrong")));
+    options = container_options(false, false, 1);
+    options.chunk_size = 0;
+    result = write_cipher_container(*encryptor, dir.file("plain"),
+                                    dir.file("wrong"), options);
+    RGR_CHECK(!result.success && !std::filesystem::exists(dir.file("wrong")));
+    options = container_options(false, false, 1);
+    options.mac_key.assign(3, 1);
+    result = write_cipher_container(*encryptor, dir.file("plain"),
+                                    dir.file("wrong"), options);
+    RGR_CHECK(!result.success && !std::filesystem::exists(dir.file("wrong")));
+    result = write_cipher_container(*encryptor, dir.file("missing"),
+                                    dir.file("wrong"));
+    RGR_CHECK(!result.success && !std::filesystem::exists(dir.file("wrong")));
+}
+
+} // namespace
+
+int main() {
+    RgrTestDir dir("cipher_container_test");
+    test_roundtrips(dir);
+    test_reader_random_access(dir);
+    test_mac(dir);
+    test_corrupt_containers(dir);
+    test_writer_failures(dir);
+    return 0;
+}
@@ -0,0 +1,262 @@
+//
+//  cipher_file_batch_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  run_cipher_file_batch: outputs of whole and split files against
+//  run_cipher_stream, per-file failure and cancellation accounting, and no
+//  temporary files left behind.
+//
+
+#include "rgr_test.hpp"
+
+#include "common/cipher_thread_pool.hpp"
+#include "engine/cipher_file_batch.hpp"
+
+#include <sstream>
+
+namespace {
+
+const char *const GOST_KEY =
+    "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20";
+const char *const GOST_IV = "0011223344556677";
+
+// Small enough that the largest input below is split into several ranges.
+const uint64_t SPLIT_MIN = 64 << 10;
+const uint64_t RANGE = 16 << 10;
+
+struct EngineKeys {
+    std::string name;
+    std::string encrypt_key;
+    std::string decrypt_key;
+};
+
+std::unique_ptr<CipherEngine> engine(const std::string &name,
+                                     const std::string &key,
+                                     CipherDirection direction) {
+    return CipherEngineRegistry::instance().create(name, key, direction);
+}
+
+std::vector<unsigned char> stream_output(CipherEngine &engine,
+                                         const std::vector<unsigned char> &in) {
+    std::istringstream input(std::string(in.begin(), in.end()));
+    std::ostringstream output;
+    RGR_CHECK(run_cipher_stream(engine, input, output).success);
+    std::string text = output.str();
+    return std::vector<unsigned char>(text.begin(), text.end());
+}
+
+CipherFileBatchOptions batch_options() {
+    CipherFileBatchOptions options;
+    options.threads = 4;
+    options.chunk_size = 4096;
+    options.split_min_bytes = SPLIT_MIN;
+    options.range_bytes = RANGE;
+    return options;
+}
+
+// Paths under root whose name contains the batch's temporary marker.
+size_t temporary_files(const std::string &root) {
+    size_t count = 0;
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(root)) {
+        if (entry.path().filename().string().find(".rgr-tmp-") !=
+            std::string::npos) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// One split file, several whole ones of different sizes (one in a
+// directory the batch has to create) and a missing input.
+struct Manifest {
+    std::vector<CipherFileJob> jobs;
+    std::vector<std::vector<unsigned char>> inputs;
+    size_t missing = 0;
+};
+
+Manifest mixed_manifest(const RgrTestDir &dir) {
+    Manifest manifest;
+    std::filesystem::create_directories(dir.file("in"));
+    const size_t sizes[] = {5000, 0, 3 * RANGE * 2 + 13, 1, 4096, 777};
+    for (size_t i = 0; i < std::size(sizes); ++i) {
+        std::string name = "file" + std::to_string(i);
+        manifest.inputs.push_back(rgr_test_bytes(sizes[i], i + 1));
+        rgr_test_write_file(dir.file("in/" + name), manifest.inputs.back());
+        std::string output = i == 3 ? dir.file("out/nested/" + name)
+                                    : dir.file("out/" + name);
+        manifest.jobs.push_back({dir.file("in/" + name), output});
+    }
+    manifest.missing = manifest.jobs.size();
+    manifest.jobs.push_back({dir.file("in/missing"), dir.file("out/missing")});
+    manifest.inputs.push_back({});
+    return manifest;
+}
+
+void test_mixed_manifest(const RgrTestDir &dir) {
+    const EngineKeys engines[] = {
+        {"gost", std::string(GOST_KEY) + ":" + GOST_IV, GOST_KEY},
+        {"permutation", "2031", "2031"},
+        {"static_shift", "5", "5"},
+    };
+    Manifest manifest = mixed_manifest(dir);
+    for (const EngineKeys &keys : engines) {
+        std::filesystem::remove_all(dir.file("out"));
+        CipherProgressToken progress;
+        CipherFileBatchOptions options = batch_options();
+        options.progress = &progress;
+        auto prototype =
+            engine(keys.name, keys.encrypt_key, CipherDirection::Encrypt);
+        CipherFileBatchResult batch =
+            run_cipher_file_batch(*prototype, manifest.jobs, options);
+
+        RGR_CHECK(!batch.success && !batch.cancelled);
+        RGR_CHECK(batch.files.size() == manifest.jobs.size());
+        RGR_CHECK(batch.files_succeeded == manifest.jobs.size() - 1);
+        RGR_CHECK(batch.files_failed == 1);
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        for (size_t i = 0; i < manifest.jobs.size(); ++i) {
+            const CipherFileJobResult &file = batch.files[i];
+            const std::string &output = manifest.jobs[i].output_path;
+            if (i == manifest.missing) {
+                RGR_CHECK(!file.success && !file.cancelled);
+                RGR_CHECK(!file.message.empty());
+                RGR_CHECK(file.bytes_out == 0);
+                RGR_CHECK(!std::filesystem::exists(output));
+                continue;
+            }
+            auto reference =
+                engine(keys.name, keys.encrypt_key, CipherDirection::Encrypt);
+            std::vector<unsigned char> expected =
+                stream_output(*reference, manifest.inputs[i]);
+            RGR_CHECK(file.success);
+            RGR_CHECK(file.bytes_in == manifest.inputs[i].size());
+            RGR_CHECK(file.bytes_out == expected.size());
+            RGR_CHECK(rgr_test_read_file(output) == expected);
+            bytes_in += file.bytes_in;
+            bytes_out += file.bytes_out;
+        }
+        RGR_CHECK(batch.bytes_in == bytes_in && batch.bytes_out == bytes_out);
+        RGR_CHECK(progress.snapshot().bytes_total == bytes_in);
+        RGR_CHECK(progress.snapshot().bytes_processed == bytes_in);
+        RGR_CHECK(temporary_files(dir.file("out")) == 0);
+
+        // Back again, with the missing input dropped.
+        std::vector<CipherFileJob> decrypt_jobs;
+        for (size_t i = 0; i < manifest.missing; ++i) {
+            decrypt_jobs.push_back({manifest.jobs[i].output_path,
+                                    manifest.jobs[i].output_path + ".dec"});
+        }
+        auto decryptor =
+            engine(keys.name, keys.decrypt_key, CipherDirection::Decrypt);
+        batch = run_cipher_file_batch(*decryptor, decrypt_jobs, batch_options());
+        RGR_CHECK(batch.success && batch.files_failed == 0);
+        for (size_t i = 0; i < decrypt_jobs.size(); ++i) {
+            RGR_CHECK(rgr_test_read_file(decrypt_jobs[i].output_path) ==
+                      manifest.inputs[i]);
+        }
+        RGR_CHECK(temporary_files(dir.file("out")) == 0);
+    }
+}
+
+// A wrong key fails the padding check of every file, split ones included;
+// none of them may leave an output or a temporary file.
+void test_failed_files_leave_nothing(const RgrTestDir &dir) {
+    Manifest manifest = mixed_manifest(dir);
+    manifest.jobs.pop_back();
+    std::filesystem::remove_all(dir.file("out"));
+    auto encryptor = engine("gost", GOST_KEY, CipherDirection::Encrypt);
+    RGR_CHECK(
+        run_cipher_file_batch(*encryptor, manifest.jobs, batch_options())
+            .success);
+
+    std::vector<CipherFileJob> jobs;
+    for (const CipherFileJob &job : manifest.jobs) {
+        jobs.push_back({job.output_path, job.output_path + ".dec"});
+    }
+    auto wrong =
+        engine("gost", std::string(64, 'a'), CipherDirection::Decrypt);
+    CipherFileBatchResult batch =
+        run_cipher_file_batch(*wrong, jobs, batch_options());
+    RGR_CHECK(!batch.success && !batch.cancelled);
+    RGR_CHECK(batch.files_succeeded == 0);
+    RGR_CHECK(batch.files_failed == jobs.size());
+    RGR_CHECK(batch.bytes_out == 0);
+    for (const CipherFileJob &job : jobs) {
+        RGR_CHECK(!std::filesystem::exists(job.output_path));
+    }
+    RGR_CHECK(temporary_files(dir.file("out")) == 0);
+}
+
+void test_cancellation(const RgrTestDir &dir) {
+    Manifest manifest = mixed_manifest(dir);
+    auto prototype = engine("gost", GOST_KEY, CipherDirection::Encrypt);
+
+    // Cancelled before the start: every file is reported cancelled.
+    std::filesystem::remove_all(dir.file("out"));
+    CipherProgressToken cancelled;
+    cancelled.cancel();
+    CipherFileBatchOptions options = batch_options();
+    options.progress = &cancelled;
+    CipherFileBatchResult batch =
+        run_cipher_file_batch(*prototype, manifest.jobs, options);
+    RGR_CHECK(batch.cancelled && !batch.success);
+    RGR_CHECK(batch.files_succeeded == 0);
+    RGR_CHECK(batch.files_failed == manifest.jobs.size());
+    for (size_t i = 0; i < manifest.jobs.size(); ++i) {
+        RGR_CHECK(batch.files[i].cancelled);
+        RGR_CHECK(!std::filesystem::exists(manifest.jobs[i].output_path));
+    }
+
+    // Cancelled from the first progress report, which only the split file
+    // (file2) reaches: what finished is complete, the rest is gone.
+    std::filesystem::remove_all(dir.file("out"));
+    CipherProgressToken *token = nullptr;
+    CipherProgressToken midway(
+        [&token](const CipherProgress &) { token->cancel(); }, RANGE);
+    token = &midway;
+    options.progress = &midway;
+    batch = run_cipher_file_batch(*prototype, manifest.jobs, options);
+    RGR_CHECK(batch.cancelled && !batch.success);
+    RGR_CHECK(batch.files_succeeded + batch.files_failed ==
+              manifest.jobs.size());
+    RGR_CHECK(!batch.files[2].success && batch.files[2].cancelled);
+    for (size_t i = 0; i < manifest.jobs.size(); ++i) {
+        const CipherFileJobResult &file = batch.files[i];
+        RGR_CHECK(file.success ==
+                  std::filesystem::exists(manifest.jobs[i].output_path));
+        RGR_CHECK(!(file.success && file.cancelled));
+    }
+    RGR_CHECK(temporary_files(dir.file("out")) == 0);
+}
+
+void test_jobs_from_directory(const RgrTestDir &dir) {
+    std::filesystem::create_directories(dir.file("tree/a/b"));
+    rgr_test_write_file(dir.file("tree/top"), rgr_test_bytes(3));
+    rgr_test_write_file(dir.file("tree/a/b/deep"), rgr_test_bytes(4));
+    std::vector<CipherFileJob> jobs = cipher_file_jobs_from_directory(
+        dir.file("tree"), dir.file("mirror"), ".enc");
+    RGR_CHECK(jobs.size() == 2);
+    RGR_CHECK(jobs[0].input_path == dir.file("tree/a/b/deep"));
+    RGR_CHECK(jobs[0].output_path == dir.file("mirror/a/b/deep.enc"));
+    RGR_CHECK(jobs[1].output_path == dir.file("mirror/top.enc"));
+    RGR_CHECK_THROWS(
+        cipher_file_jobs_from_directory(dir.file("absent"), dir.file("x")),
+        std::filesystem::filesystem_error);
+}
+
+} // namespace
+
+int main() {
+    // The batch runs on the shared pool; give it workers even on one CPU.
+    RGR_CHECK(cipher_thread_pool_configure({4, CipherThreadAffinity::None}));
+    RgrTestDir dir("cipher_file_batch_test");
+    test_mixed_manifest(dir);
+    test_failed_files_leave_nothing(dir);
+    test_cancellation(dir);
+    test_jobs_from_directory(dir);
+    return 0;
+}
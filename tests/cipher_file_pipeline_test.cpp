@@ -0,0 +1,154 @@
+//
+//  cipher_file_pipeline_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  The overlapped file pipeline must produce what run_cipher_stream
+//  produces on every backend, including a short final chunk, and fall back
+//  to threads wherever io_uring cannot serve it.
+//
+
+#include "rgr_test.hpp"
+
+#include "engine/cipher_file_pipeline.hpp"
+
+#include <sstream>
+
+#include <sys/resource.h>
+
+namespace {
+
+const size_t CHUNK = 4096;
+
+struct EngineKeys {
+    const char *name;
+    const char *encrypt_key;
+    const char *decrypt_key;
+};
+
+const EngineKeys ENGINES[] = {
+    {"gost",
+     "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20:"
+     "0011223344556677",
+     "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20"},
+    {"permutation", "2031", "2031"},
+    {"static_shift", "5", "5"},
+};
+
+const CipherIoBackend BACKENDS[] = {CipherIoBackend::Threaded,
+                                    CipherIoBackend::IoUring,
+                                    CipherIoBackend::Auto};
+
+std::unique_ptr<CipherEngine> engine(const char *name, const char *key,
+                                     CipherDirection direction) {
+    return CipherEngineRegistry::instance().create(name, key, direction);
+}
+
+std::vector<unsigned char> stream_output(CipherEngine &engine,
+                                         const std::vector<unsigned char> &in) {
+    std::istringstream input(std::string(in.begin(), in.end()));
+    std::ostringstream output;
+    CipherDriverOptions options;
+    options.chunk_size = CHUNK;
+    RGR_CHECK(run_cipher_stream(engine, input, output, options).success);
+    std::string text = output.str();
+    return std::vector<unsigned char>(text.begin(), text.end());
+}
+
+void check_backends(const RgrTestDir &dir) {
+    for (const EngineKeys &keys : ENGINES) {
+        for (size_t size : {size_t(0), size_t(1), CHUNK - 1, CHUNK, CHUNK + 1,
+                            10 * CHUNK + 123}) {
+            std::vector<unsigned char> data = rgr_test_bytes(size, 5);
+            rgr_test_write_file(dir.file("plain"), data);
+            auto reference = engine(keys.name, keys.encrypt_key,
+                                    CipherDirection::Encrypt);
+            std::vector<unsigned char> expected =
+                stream_output(*reference, data);
+
+            for (CipherIoBackend backend : BACKENDS) {
+                for (unsigned int depth : {1u, 4u}) {
+                    CipherDriverOptions options;
+                    options.chunk_size = CHUNK;
+                    options.io_backend = backend;
+                    options.queue_depth = depth;
+
+                    auto encryptor = engine(keys.name, keys.encrypt_key,
+                                            CipherDirection::Encrypt);
+                    CipherDriverResult result = run_cipher_file_pipeline(
+                        *encryptor, dir.file("plain"), dir.file("enc"),
+                        options);
+                    RGR_CHECK(result.success);
+                    RGR_CHECK(result.bytes_in == size);
+                    RGR_CHECK(result.bytes_out == expected.size());
+                    RGR_CHECK(rgr_test_read_file(dir.file("enc")) == expected);
+
+                    auto decryptor = engine(keys.name, keys.decrypt_key,
+                                            CipherDirection::Decrypt);
+                    result = run_cipher_file_pipeline(
+                        *decryptor, dir.file("enc"), dir.file("dec"), options);
+                    RGR_CHECK(result.success);
+                    RGR_CHECK(rgr_test_read_file(dir.file("dec")) == data);
+                }
+            }
+        }
+    }
+}
+
+// run_cipher_file routes single-threaded regular files to the pipeline and
+// removes the output of a failed run whatever the backend.
+void test_file_driver(const RgrTestDir &dir) {
+    std::vector<unsigned char> data = rgr_test_bytes(5 * CHUNK + 7, 9);
+    rgr_test_write_file(dir.file("plain"), data);
+    for (CipherIoBackend backend : BACKENDS) {
+        CipherDriverOptions options;
+        options.chunk_size = CHUNK;
+        options.io_backend = backend;
+        const EngineKeys &gost = ENGINES[0];
+        auto encryptor =
+            engine(gost.name, gost.encrypt_key, CipherDirection::Encrypt);
+        RGR_CHECK(run_cipher_file(*encryptor, dir.file("plain"),
+                                  dir.file("enc"), options)
+                      .success);
+        auto decryptor =
+            engine(gost.name, gost.decrypt_key, CipherDirection::Decrypt);
+        RGR_CHECK(run_cipher_file(*decryptor, dir.file("enc"), dir.file("dec"),
+                                  options)
+                      .success);
+        RGR_CHECK(rgr_test_read_file(dir.file("dec")) == data);
+
+        // Every key byte differs, so the padding check fails.
+        auto wrong = engine("gost", std::string(64, 'a').c_str(),
+                            CipherDirection::Decrypt);
+        RGR_CHECK(!run_cipher_file(*wrong, dir.file("enc"), dir.file("bad"),
+                                   options)
+                       .success);
+        RGR_CHECK(!std::filesystem::exists(dir.file("bad")));
+
+        CipherDriverResult missing = run_cipher_file_pipeline(
+            *encryptor, dir.file("missing"), dir.file("out"), options);
+        RGR_CHECK(!missing.success);
+    }
+}
+
+} // namespace
+
+int main() {
+    RgrTestDir dir("cipher_file_pipeline_test");
+    // A ring that takes plain READ/WRITE is also one that can be set up.
+    RGR_CHECK(!cipher_io_uring_read_write_available() ||
+              cipher_io_uring_available());
+    check_backends(dir);
+    test_file_driver(dir);
+
+    // Without locked memory for fixed buffers the ring falls back to plain
+    // READ/WRITE, or the pipeline to threads where those are missing; the
+    // output must not change. (Privileged runs may register regardless.)
+    rlimit limit;
+    RGR_CHECK(getrlimit(RLIMIT_MEMLOCK, &limit) == 0);
+    limit.rlim_cur = 0;
+    RGR_CHECK(setrlimit(RLIMIT_MEMLOCK, &limit) == 0);
+    check_backends(dir);
+    return 0;
+}
@@ -0,0 +1,173 @@
+//
+//  cipher_incremental_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "rgr_test.hpp"
+
+#include "container/cipher_incremental.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const std::string KEY(64, 'a');
+const std::string OTHER_KEY(64, 'b');
+
+// Small chunks keep the test fast while still giving ~250 of them.
+CipherIncrementalOptions small_chunks() {
+    CipherIncrementalOptions options;
+    options.min_chunk = 1 << 10;
+    options.average_chunk = 4 << 10;
+    options.max_chunk = 16 << 10;
+    return options;
+}
+
+struct Archive {
+    const RgrTestDir &dir;
+
+    CipherIncrementalResult update(const std::vector<unsigned char> &data,
+                                   const CipherIncrementalOptions &options =
+                                       small_chunks(),
+                                   const std::string &key = KEY) {
+        rgr_test_write_file(dir.file("in"), data);
+        return encryptFileIncrementalGOST(dir.file("in"), dir.file("arc"), key,
+                                          options);
+    }
+
+    bool restores(const std::vector<unsigned char> &data) {
+        CipherIncrementalResult result =
+            decryptFileIncrementalGOST(dir.file("arc"), dir.file("out"), KEY);
+        return result.success && rgr_test_read_file(dir.file("out")) == data;
+    }
+
+    size_t size() const {
+        return static_cast<size_t>(std::filesystem::file_size(dir.file("arc")));
+    }
+};
+
+void test_cdc_cut_bounds() {
+    std::vector<unsigned char> data = rgr_test_bytes(1 << 20);
+    std::vector<size_t> cuts;
+    for (size_t position = 0; position < data.size();) {
+        size_t length = cipher_cdc_cut(data.data() + position,
+                                       data.size() - position, 1 << 10,
+                                       4 << 10, 16 << 10);
+        RGR_CHECK(length > 0 && length <= 16 << 10);
+        position += length;
+        RGR_CHECK(length >= 1 << 10 || position == data.size());
+        cuts.push_back(position);
+    }
+    RGR_CHECK(cuts.size() > 100 && cuts.size() < 1000);
+
+    // An edit near the start moves only the boundaries next to it.
+    std::vector<unsigned char> edited = data;
+    edited.insert(edited.begin() + 100, 37, 0x11);
+    size_t shared = 0;
+    for (size_t position = 0; position < edited.size();) {
+        position += cipher_cdc_cut(edited.data() + position,
+                                   edited.size() - position, 1 << 10, 4 << 10,
+                                   16 << 10);
+        if (position > 100 + 37 &&
+            std::binary_search(cuts.begin(), cuts.end(), position - 37)) {
+            ++shared;
+        }
+    }
+    RGR_CHECK(shared + 3 >= cuts.size());
+}
+
+void test_updates(const RgrTestDir &dir) {
+    Archive archive{dir};
+    std::vector<unsigned char> data = rgr_test_bytes(1 << 20);
+
+    CipherIncrementalResult result = archive.update(data);
+    RGR_CHECK(result.success && result.encrypted_chunks == result.chunks);
+    RGR_CHECK(is_cipher_incremental_archive(dir.file("arc")));
+    RGR_CHECK(!is_cipher_incremental_archive(dir.file("in")));
+    RGR_CHECK(archive.restores(data));
+    uint64_t chunks = result.chunks;
+
+    // Unchanged input: nothing is re-encrypted, only a manifest is added.
+    result = archive.update(data);
+    RGR_CHECK(result.success && result.encrypted_chunks == 0);
+    RGR_CHECK(result.reused_chunks == chunks);
+    RGR_CHECK(result.bytes_written <=
+              chunks * CIPHER_INCREMENTAL_MANIFEST_ENTRY_BYTES +
+                  CIPHER_INCREMENTAL_TRAILER_BYTES);
+
+    // A change in place, an insertion and a deletion each touch only the
+    // chunks around them.
+    for (size_t i = 0; i < 1000; ++i) {
+        data[500000 + i] ^= 0x5a;
+    }
+    result = archive.update(data);
+    RGR_CHECK(result.success && result.encrypted_chunks <= 3);
+    RGR_CHECK(archive.restores(data));
+
+    data.insert(data.begin() + 100000, 777, 0x11);
+    result = archive.update(data);
+    RGR_CHECK(result.success && result.encrypted_chunks <= 3);
+    RGR_CHECK(archive.restores(data));
+
+    data.erase(data.begin() + 700000, data.begin() + 720000);
+    result = archive.update(data);
+    RGR_CHECK(result.success && result.encrypted_chunks <= 3);
+    RGR_CHECK(archive.restores(data));
+
+    // Replacing everything leaves mostly dead records, so the archive is
+    // compacted to about the size of the new content.
+    std::vector<unsigned char> replaced = rgr_test_bytes(300000, 99);
+    result = archive.update(replaced);
+    RGR_CHECK(result.success && result.compacted);
+    RGR_CHECK(archive.size() < 400000);
+    RGR_CHECK(archive.restores(replaced));
+
+    result = archive.update({});
+    RGR_CHECK(result.success && result.chunks == 0);
+    RGR_CHECK(archive.restores({}));
+}
+
+void test_failures_keep_archive(const RgrTestDir &dir) {
+    Archive archive{dir};
+    std::vector<unsigned char> data = rgr_test_bytes(200000, 3);
+    RGR_CHECK(archive.update(data).success);
+    std::vector<unsigned char> before = rgr_test_read_file(dir.file("arc"));
+
+    RGR_CHECK(!decryptFileIncrementalGOST(dir.file("arc"), dir.file("out"),
+                                          OTHER_KEY)
+                   .success);
+    RGR_CHECK(!archive.update(rgr_test_bytes(200000, 4), small_chunks(),
+                              OTHER_KEY)
+                   .success);
+    RGR_CHECK(rgr_test_read_file(dir.file("arc")) == before);
+
+    CipherProgressToken token;
+    token.cancel();
+    CipherIncrementalOptions options = small_chunks();
+    options.progress = &token;
+    CipherIncrementalResult result =
+        archive.update(rgr_test_bytes(200000, 5), options);
+    RGR_CHECK(!result.success && result.cancelled);
+    RGR_CHECK(rgr_test_read_file(dir.file("arc")) == before);
+    RGR_CHECK(archive.restores(data));
+
+    // A flipped ciphertext byte fails the chunk's fingerprint check.
+    std::vector<unsigned char> damaged = before;
+    damaged[CIPHER_INCREMENTAL_HEADER_BYTES + 100] ^= 1;
+    rgr_test_write_file(dir.file("arc"), damaged);
+    RGR_CHECK(!decryptFileIncrementalGOST(dir.file("arc"), dir.file("out"),
+                                          KEY)
+                   .success);
+}
+
+} // namespace
+
+int main() {
+    RgrTestDir dir("cipher_incremental_test");
+    test_cdc_cut_bounds();
+    test_updates(dir);
+    test_failures_keep_archive(dir);
+    return 0;
+}
@@ -0,0 +1,209 @@
+//
+//  cipher_key_store_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "rgr_test.hpp"
+
+#include "gost/gost.hpp"
+#include "keystore/cipher_key_store.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+namespace {
+
+const int GOST_KEYS = 3000;
+
+void gost_key_for(int i, unsigned char *key) {
+    for (unsigned int j = 0; j < GOST_KEY_SIZE_BYTES; ++j) {
+        key[j] = static_cast<unsigned char>(i * 7 + j);
+    }
+}
+
+void test_write_and_find(const RgrTestDir &dir) {
+    boost::random::mt19937 rng(5);
+    KeyPair full = generateKeys(512, rng, 3);
+    KeyPair public_only = full;
+    public_only.privKey.d = 0;
+    public_only.privKey.primes.clear();
+
+    CipherKeyStoreWriter writer;
+    writer.add_rsa("rsa-main", full);
+    writer.add_rsa("rsa-public", public_only);
+    unsigned char key[GOST_KEY_SIZE_BYTES];
+    for (int i = 0; i < GOST_KEYS; ++i) {
+        gost_key_for(i, key);
+        writer.add_gost("gost-" + std::to_string(i), key);
+    }
+    RGR_CHECK(writer.size() == GOST_KEYS + 2);
+    RGR_CHECK(writer.write(dir.file("keys.bin")).success);
+
+    CipherKeyStore store;
+    RGR_CHECK(store.open(dir.file("keys.bin")).success);
+    RGR_CHECK(store.is_open() && store.size() == GOST_KEYS + 2);
+
+    CipherKeyView view;
+    for (int i = 0; i < GOST_KEYS; ++i) {
+        RGR_CHECK(store.find("gost-" + std::to_string(i), view));
+        RGR_CHECK(view.kind == CipherKeyKind::Gost);
+        gost_key_for(i, key);
+        RGR_CHECK(std::equal(key, key + GOST_KEY_SIZE_BYTES,
+                             cipher_key_gost(view)));
+    }
+    RGR_CHECK(!store.find("gost-" + std::to_string(GOST_KEYS), view));
+    RGR_CHECK(!store.find("", view));
+
+    // Every precomputed value survives, and CRT works straight from it.
+    RGR_CHECK(store.find("rsa-main", view));
+    RGR_CHECK(view.kind == CipherKeyKind::Rsa && view.prime_count == 3);
+    KeyPair loaded = cipher_key_rsa(view);
+    RGR_CHECK(loaded.pubKey.n == full.pubKey.n && loaded.pubKey.e == full.pubKey.e);
+    RGR_CHECK(loaded.privKey.d == full.privKey.d);
+    RGR_CHECK(loaded.privKey.primes.size() == 3);
+    for (size_t i = 0; i < 3; ++i) {
+        RGR_CHECK(loaded.privKey.primes[i].prime == full.privKey.primes[i].prime);
+        RGR_CHECK(loaded.privKey.primes[i].exponent ==
+                  full.privKey.primes[i].exponent);
+        RGR_CHECK(loaded.privKey.primes[i].coefficient ==
+                  full.privKey.primes[i].coefficient);
+    }
+    BigInt m = 123456789;
+    BigInt c = boost::multiprecision::powm(m, loaded.pubKey.e, loaded.pubKey.n);
+    RGR_CHECK(applyPrivateKey(c, loaded.privKey) == m);
+
+    RGR_CHECK(store.find("rsa-public", view));
+    loaded = cipher_key_rsa(view);
+    RGR_CHECK(loaded.pubKey.n == full.pubKey.n && loaded.privKey.d == 0);
+    RGR_CHECK(loaded.privKey.primes.empty());
+
+    // Decoders refuse the other kind.
+    RGR_CHECK(store.find("gost-1", view));
+    RGR_CHECK_THROWS(cipher_key_rsa(view), std::runtime_error);
+    RGR_CHECK(store.find("rsa-main", view));
+    RGR_CHECK_THROWS(cipher_key_gost(view), std::runtime_error);
+
+    std::vector<std::string> ids = store.ids();
+    RGR_CHECK(ids.size() == GOST_KEYS + 2);
+    RGR_CHECK(std::find(ids.begin(), ids.end(), "rsa-public") != ids.end());
+
+    CipherKeyStore moved = std::move(store);
+    RGR_CHECK(moved.is_open() && !store.is_open());
+    RGR_CHECK(moved.find("gost-42", view));
+    moved.close();
+    RGR_CHECK(!moved.is_open());
+}
+
+void test_empty_store(const RgrTestDir &dir) {
+    CipherKeyStoreWriter writer;
+    RGR_CHECK(writer.write(dir.file("empty.bin")).success);
+    CipherKeyStore store;
+    RGR_CHECK(store.open(dir.file("empty.bin")).success);
+    CipherKeyView view;
+    RGR_CHECK(store.size() == 0 && !store.find("x", view));
+    RGR_CHECK(store.ids().empty());
+}
+
+void test_rejects_bad_files(const RgrTestDir &dir) {
+    unsigned char key[GOST_KEY_SIZE_BYTES] = {};
+    CipherKeyStoreWriter duplicate;
+    duplicate.add_gost("a", key);
+    duplicate.add_gost("a", key);
+    RGR_CHECK(!duplicate.write(dir.file("duplicate.bin")).success);
+    RGR_CHECK(!std::filesystem::exists(dir.file("duplicate.bin")));
+
+    CipherKeyStore store;
+    RGR_CHECK(!store.open(dir.file("missing.bin")).success);
+    rgr_test_write_file(dir.file("short.bin"), {'R', 'G', 'R', 'K'});
+    RGR_CHECK(!store.open(dir.file("short.bin")).success);
+
+    CipherKeyStoreWriter writer;
+    for (int i = 0; i < 10; ++i) {
+        gost_key_for(i, key);
+        writer.add_gost("gost-" + std::to_string(i), key);
+    }
+    RGR_CHECK(writer.write(dir.file("keys.bin")).success);
+    std::vector<unsigned char> good = rgr_test_read_file(dir.file("keys.bin"));
+
+    std::vector<unsigned char> bad = good;
+    bad[0] = 'X';
+    rgr_test_write_file(dir.file("bad.bin"), bad);
+    RGR_CHECK(!store.open(dir.file("bad.bin")).success);
+
+    // The header records the file size, so a truncated file fails to open.
+    bad.assign(good.begin(), good.end() - 8);
+    rgr_test_write_file(dir.file("bad.bin"), bad);
+    RGR_CHECK(!store.open(dir.file("bad.bin")).success);
+
+    // Index slots that point past the end of the file make find throw
+    // instead of reading outside the mapping.
+    bad = good;
+    uint64_t index_offset = 0;
+    uint64_t slots = 0;
+    for (int i = 7; i >= 0; --i) {
+        index_offset = index_offset << 8 | bad[16 + i];
+        slots = slots << 8 | bad[24 + i];
+    }
+    for (uint64_t slot = 0; slot < slots; ++slot) {
+        unsigned char *offset =
+            bad.data() + index_offset + slot * CIPHER_KEY_STORE_SLOT_BYTES + 8;
+        if (std::any_of(offset, offset + 8, [](unsigned char b) { return b; })) {
+            std::fill(offset, offset + 8, 0x7f);
+        }
+    }
+    rgr_test_write_file(dir.file("bad.bin"), bad);
+    RGR_CHECK(store.open(dir.file("bad.bin")).success);
+    CipherKeyView view;
+    RGR_CHECK_THROWS(store.find("gost-3", view), std::runtime_error);
+}
+
+// The store holds private keys: it is created 0600 whatever the umask, and
+// never written through a name someone else could have prepared.
+void test_private_file(const RgrTestDir &dir) {
+    unsigned char key[GOST_KEY_SIZE_BYTES] = {};
+    CipherKeyStoreWriter writer;
+    writer.add_gost("a", key);
+    std::string path = dir.file("private.bin");
+    rgr_test_write_file(path, {1, 2, 3});
+    RGR_CHECK(chmod(path.c_str(), 0644) == 0);
+    rgr_test_write_file(dir.file("victim"), {4, 5, 6});
+    std::filesystem::create_symlink(dir.file("victim"), path + ".tmp");
+
+    mode_t old_umask = umask(022);
+    RGR_CHECK(writer.write(path).success);
+    std::vector<unsigned char> first = rgr_test_read_file(path);
+    RGR_CHECK(writer.write(path).success);
+    umask(old_umask);
+
+    struct stat info;
+    RGR_CHECK(stat(path.c_str(), &info) == 0);
+    RGR_CHECK((info.st_mode & 0777) == 0600);
+    RGR_CHECK(rgr_test_read_file(dir.file("victim")) ==
+              std::vector<unsigned char>({4, 5, 6}));
+    for (const auto &entry : std::filesystem::directory_iterator(
+             std::filesystem::path(path).parent_path())) {
+        std::string name = entry.path().filename().string();
+        RGR_CHECK(name.find(".tmp-") == std::string::npos);
+    }
+    std::filesystem::remove(path + ".tmp");
+
+    // Every write draws a fresh hash key.
+    std::vector<unsigned char> second = rgr_test_read_file(path);
+    RGR_CHECK(!std::equal(first.begin() + 32, first.begin() + 48,
+                          second.begin() + 32));
+}
+
+} // namespace
+
+int main() {
+    RgrTestDir dir("cipher_key_store_test");
+    test_write_and_find(dir);
+    test_empty_store(dir);
+    test_rejects_bad_files(dir);
+    test_private_file(dir);
+    return 0;
+}
@@ -0,0 +1,101 @@
+//
+//  cipher_lz4_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "rgr_test.hpp"
+
+#include "common/cipher_lz4.hpp"
+#include "gost/gost.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char *const KEY_HEX =
+    "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20";
+
+void check_roundtrip(const std::vector<unsigned char> &data) {
+    std::vector<unsigned char> block =
+        cipher_lz4_compress(data.data(), data.size());
+    RGR_CHECK(block.size() <= cipher_lz4_compress_bound(data.size()));
+    std::vector<unsigned char> back(data.size());
+    cipher_lz4_decompress(block.data(), block.size(), back.data(),
+                          back.size());
+    RGR_CHECK(back == data);
+}
+
+void test_block_roundtrip() {
+    check_roundtrip({});
+    for (size_t length : {1, 4, 5, 12, 13, 64, 1000, 65536, 300000}) {
+        check_roundtrip(rgr_test_bytes(length, static_cast<uint32_t>(length)));
+        check_roundtrip(std::vector<unsigned char>(length, 0x41));
+        std::vector<unsigned char> pattern(length);
+        for (size_t i = 0; i < length; ++i) {
+            pattern[i] = static_cast<unsigned char>("abcdefg"[i % 7]);
+        }
+        check_roundtrip(pattern);
+    }
+}
+
+void test_compresses_repetition() {
+    std::vector<unsigned char> zeros(65536, 0);
+    RGR_CHECK(cipher_lz4_compress(zeros.data(), zeros.size()).size() < 1024);
+}
+
+// An empty block decodes into a null output of length 0.
+void test_empty_block_into_null() {
+    std::vector<unsigned char> block = cipher_lz4_compress(nullptr, 0);
+    cipher_lz4_decompress(block.data(), block.size(), nullptr, 0);
+}
+
+void test_malformed() {
+    std::vector<unsigned char> data = rgr_test_bytes(4096);
+    std::memset(data.data() + 1000, 'x', 2000);
+    std::vector<unsigned char> block =
+        cipher_lz4_compress(data.data(), data.size());
+    std::vector<unsigned char> back(data.size());
+    RGR_CHECK_THROWS(cipher_lz4_decompress(block.data(), block.size() / 2,
+                                           back.data(), back.size()),
+                     std::runtime_error);
+    RGR_CHECK_THROWS(cipher_lz4_decompress(block.data(), block.size(),
+                                           back.data(), back.size() - 1),
+                     std::runtime_error);
+    std::vector<unsigned char> longer(data.size() + 1);
+    RGR_CHECK_THROWS(cipher_lz4_decompress(block.data(), block.size(),
+                                           longer.data(), longer.size()),
+                     std::runtime_error);
+}
+
+// Compress-then-encrypt through the GOST file API, including an empty file.
+void test_compressed_file_roundtrip() {
+    RgrTestDir dir("cipher_lz4_test");
+    for (size_t length : {0, 1, 8, 100000, 3000000}) {
+        std::vector<unsigned char> data = rgr_test_bytes(length);
+        for (size_t i = 0; i < length; i += 3) {
+            data[i] = 0;
+        }
+        rgr_test_write_file(dir.file("in"), data);
+        GostFileOperationResult encrypted = encryptFileGOST(
+            dir.file("in"), dir.file("enc"), KEY_HEX, "", nullptr, true);
+        RGR_CHECK(encrypted.success);
+        GostFileOperationResult decrypted =
+            decryptFileGOST(dir.file("enc"), dir.file("out"), KEY_HEX);
+        RGR_CHECK(decrypted.success);
+        RGR_CHECK(rgr_test_read_file(dir.file("out")) == data);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_block_roundtrip();
+    test_compresses_repetition();
+    test_empty_block_into_null();
+    test_malformed();
+    test_compressed_file_roundtrip();
+    return 0;
+}
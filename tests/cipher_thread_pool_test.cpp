@@ -0,0 +1,315 @@
+//
+//  cipher_thread_pool_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  CipherThreadPool: parallel_for coverage, nesting and error propagation,
+//  submit priorities and shutdown, statistics and CipherLocalBuffer.
+//
+
+#include "rgr_test.hpp"
+
+#include "common/cipher_thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Blocks the single worker of a pool until release(), so tasks submitted
+// meanwhile pile up in its queues.
+class WorkerGate {
+  public:
+    explicit WorkerGate(CipherThreadPool &pool) {
+        pool.submit([this] {
+            started_ = true;
+            while (!released_) {
+                std::this_thread::yield();
+            }
+        });
+        while (!started_) {
+            std::this_thread::yield();
+        }
+    }
+    void release() { released_ = true; }
+
+  private:
+    std::atomic<bool> started_{false};
+    std::atomic<bool> released_{false};
+};
+
+// Stats are updated after a task returns; wait until every submitted task
+// is accounted for.
+CipherThreadPoolStats settled_stats(const CipherThreadPool &pool) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    CipherThreadPoolStats stats = pool.stats();
+    while (stats.executed != stats.submitted &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = pool.stats();
+    }
+    return stats;
+}
+
+void test_parallel_for_covers_every_index() {
+    CipherThreadPool pool({4, CipherThreadAffinity::None});
+    RGR_CHECK(pool.thread_count() == 4);
+    RGR_CHECK(pool.current_worker() == -1);
+
+    for (size_t count : {0, 1, 2, 5, 64, 1000, 10007}) {
+        for (unsigned int max_threads : {0u, 1u, 2u, 3u, 16u}) {
+            std::vector<std::atomic<int>> hits(count);
+            std::mutex mutex;
+            std::set<std::thread::id> threads;
+            pool.parallel_for(
+                count,
+                [&](size_t i) {
+                    hits[i]++;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                },
+                max_threads);
+            for (size_t i = 0; i < count; ++i) {
+                RGR_CHECK(hits[i] == 1);
+            }
+            if (max_threads != 0) {
+                RGR_CHECK(threads.size() <= max_threads);
+            }
+            if (max_threads == 1) {
+                RGR_CHECK(threads.size() <= 1);
+                RGR_CHECK(count == 0 ||
+                          threads.count(std::this_thread::get_id()) == 1);
+            }
+        }
+    }
+}
+
+void test_nested_parallel_for() {
+    // Every worker blocks in an outer index while the inner loops run; the
+    // callers take part, so this finishes even with a single worker.
+    for (unsigned int workers : {1u, 2u, 4u}) {
+        CipherThreadPool pool({workers, CipherThreadAffinity::None});
+        std::vector<std::atomic<int>> hits(16 * 32);
+        pool.parallel_for(16, [&](size_t outer) {
+            pool.parallel_for(32, [&](size_t inner) {
+                hits[outer * 32 + inner]++;
+            });
+        });
+        for (const std::atomic<int> &hit : hits) {
+            RGR_CHECK(hit == 1);
+        }
+    }
+}
+
+void test_parallel_for_rethrows() {
+    CipherThreadPool pool({3, CipherThreadAffinity::None});
+
+    // One bad index among many.
+    std::atomic<size_t> calls{0};
+    bool caught = false;
+    try {
+        pool.parallel_for(1000, [&](size_t i) {
+            calls++;
+            if (i == 10) {
+                throw std::runtime_error("index 10");
+            }
+        });
+    } catch (const std::runtime_error &e) {
+        caught = std::string(e.what()) == "index 10";
+    }
+    RGR_CHECK(caught);
+    RGR_CHECK(calls >= 11);
+
+    // Every call throws: each participant stops after its first failure, so
+    // the remaining indices are skipped.
+    calls = 0;
+    RGR_CHECK_THROWS(pool.parallel_for(1000,
+                                       [&](size_t) {
+                                           calls++;
+                                           throw std::logic_error("always");
+                                       }),
+                     std::logic_error);
+    RGR_CHECK(calls >= 1 && calls <= pool.thread_count() + 1);
+
+    // The inline path with max_threads 1 rethrows as well.
+    RGR_CHECK_THROWS(pool.parallel_for(
+                         4, [](size_t) { throw std::invalid_argument("x"); }, 1),
+                     std::invalid_argument);
+
+    // The pool stays usable.
+    std::atomic<size_t> sum{0};
+    pool.parallel_for(100, [&](size_t i) { sum += i; });
+    RGR_CHECK(sum == 4950);
+}
+
+void test_submit_priorities() {
+    std::string order;
+    std::mutex mutex;
+    auto record = [&](char c) {
+        return [&, c] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order += c;
+        };
+    };
+    {
+        CipherThreadPool pool({1, CipherThreadAffinity::None});
+        WorkerGate gate(pool);
+        for (int i = 0; i < 3; ++i) {
+            pool.submit(record('l'), CipherTaskPriority::Low);
+            pool.submit(record('n'), CipherTaskPriority::Normal);
+            pool.submit(record('h'), CipherTaskPriority::High);
+        }
+        gate.release();
+    }
+    RGR_CHECK(order == "hhhnnnlll");
+}
+
+void test_destructor_runs_queued_tasks() {
+    std::atomic<int> done{0};
+    {
+        CipherThreadPool pool({1, CipherThreadAffinity::None});
+        WorkerGate gate(pool);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&] { done++; });
+        }
+        // An escaping exception is dropped and does not stop the worker.
+        pool.submit([] { throw std::runtime_error("dropped"); });
+        pool.submit([&] { done++; });
+        gate.release();
+    }
+    RGR_CHECK(done == 101);
+}
+
+void test_current_worker() {
+    CipherThreadPool pool({3, CipherThreadAffinity::None});
+    CipherThreadPool other({1, CipherThreadAffinity::None});
+    std::atomic<int> bad{0};
+    std::atomic<int> done{0};
+    for (int i = 0; i < 30; ++i) {
+        pool.submit([&] {
+            int index = pool.current_worker();
+            if (index < 0 || index >= 3 || other.current_worker() != -1) {
+                bad++;
+            }
+            done++;
+        });
+    }
+    while (done < 30) {
+        std::this_thread::yield();
+    }
+    RGR_CHECK(bad == 0);
+    RGR_CHECK(pool.current_worker() == -1);
+}
+
+void test_stats() {
+    CipherThreadPool pool({2, CipherThreadAffinity::None});
+    std::atomic<int> done{0};
+    for (int i = 0; i < 50; ++i) {
+        pool.submit([&] { done++; });
+    }
+    while (done < 50) {
+        std::this_thread::yield();
+    }
+    CipherThreadPoolStats stats = settled_stats(pool);
+    RGR_CHECK(stats.threads == 2);
+    RGR_CHECK(stats.workers.size() == 2);
+    RGR_CHECK(stats.numa_nodes == pool.numa_nodes() && stats.numa_nodes >= 1);
+    RGR_CHECK(stats.affinity == CipherThreadAffinity::None);
+    RGR_CHECK(stats.submitted == 50);
+    RGR_CHECK(stats.executed == 50);
+    RGR_CHECK(stats.queued == 0);
+    RGR_CHECK(stats.remote_steals <= stats.steals);
+    RGR_CHECK(stats.occupancy >= 0.0 && stats.occupancy <= 1.0);
+    uint64_t executed = 0;
+    for (const CipherThreadPoolWorkerStats &w : stats.workers) {
+        RGR_CHECK(w.cpu == -1);
+        executed += w.executed;
+    }
+    RGR_CHECK(executed == stats.executed);
+
+    std::string json = cipher_thread_pool_stats_to_json(stats);
+    RGR_CHECK(json.front() == '{' && json.back() == '}');
+    for (const char *key :
+         {"\"threads\":2", "\"affinity\":\"none\"", "\"submitted\":50",
+          "\"executed\":50", "\"steals\":", "\"remote_steals\":",
+          "\"queued\":0", "\"uptime_ms\":", "\"occupancy\":", "\"workers\":[{",
+          "\"cpu\":-1", "\"busy_ms\":"}) {
+        RGR_CHECK(json.find(key) != std::string::npos);
+    }
+}
+
+void test_affinity() {
+    for (CipherThreadAffinity affinity :
+         {CipherThreadAffinity::None, CipherThreadAffinity::Node,
+          CipherThreadAffinity::Cpu}) {
+        CipherThreadPool pool({3, affinity});
+        std::vector<std::atomic<int>> hits(200);
+        pool.parallel_for(200, [&](size_t i) { hits[i]++; });
+        for (const std::atomic<int> &hit : hits) {
+            RGR_CHECK(hit == 1);
+        }
+        CipherThreadPoolStats stats = pool.stats();
+        RGR_CHECK(stats.affinity == affinity);
+        for (const CipherThreadPoolWorkerStats &w : stats.workers) {
+            RGR_CHECK((w.cpu >= 0) == (affinity == CipherThreadAffinity::Cpu));
+        }
+    }
+    RGR_CHECK(cipher_current_numa_node() >= 0);
+}
+
+void test_shared_pool() {
+    // Options apply only until the shared pool is created.
+    RGR_CHECK(cipher_thread_pool_configure({2, CipherThreadAffinity::None}));
+    CipherThreadPool &pool = cipher_thread_pool();
+    RGR_CHECK(&pool == &cipher_thread_pool());
+    RGR_CHECK(pool.thread_count() == 2);
+    RGR_CHECK(!cipher_thread_pool_configure({4, CipherThreadAffinity::Cpu}));
+    RGR_CHECK(cipher_thread_pool().thread_count() == 2);
+}
+
+void test_local_buffer() {
+    CipherLocalBuffer empty;
+    RGR_CHECK(empty.data() == nullptr && empty.size() == 0);
+
+    for (size_t size : {1, 4096, 1 << 20}) {
+        CipherLocalBuffer buffer(size);
+        RGR_CHECK(buffer.size() == size && buffer.data() != nullptr);
+        std::vector<unsigned char> bytes = rgr_test_bytes(size, size);
+        std::memcpy(buffer.data(), bytes.data(), size);
+
+        unsigned char *data = buffer.data();
+        CipherLocalBuffer moved(std::move(buffer));
+        RGR_CHECK(moved.data() == data && moved.size() == size);
+        RGR_CHECK(buffer.data() == nullptr && buffer.size() == 0);
+
+        CipherLocalBuffer assigned(16);
+        assigned = std::move(moved);
+        RGR_CHECK(assigned.data() == data && assigned.size() == size);
+        RGR_CHECK(moved.data() == nullptr && moved.size() == 0);
+        RGR_CHECK(std::memcmp(assigned.data(), bytes.data(), size) == 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_parallel_for_covers_every_index();
+    test_nested_parallel_for();
+    test_parallel_for_rethrows();
+    test_submit_priorities();
+    test_destructor_runs_queued_tasks();
+    test_current_worker();
+    test_stats();
+    test_affinity();
+    test_shared_pool();
+    test_local_buffer();
+    return 0;
+}
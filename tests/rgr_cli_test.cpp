@@ -0,0 +1,137 @@
+//
+//  rgr_cli_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  Runs the rgr_cli binary given as the first argument through the shell.
+//
+
+#include "rgr_test.hpp"
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+namespace {
+
+const int EXIT_USAGE = 2;
+
+std::string cli;
+
+// Exit status of the shell command "rgr_cli args", with stderr silenced.
+int run(const std::string &args) {
+    std::string command = "'" + cli + "' " + args + " 2>/dev/null";
+    int status = std::system(command.c_str());
+    RGR_CHECK(status != -1 && WIFEXITED(status));
+    return WEXITSTATUS(status);
+}
+
+std::string quote(const std::string &path) { return "'" + path + "'"; }
+
+mode_t file_mode(const std::string &path) {
+    struct stat info;
+    RGR_CHECK(stat(path.c_str(), &info) == 0);
+    return info.st_mode & 0777;
+}
+
+void check_roundtrip(const RgrTestDir &dir, const std::string &engine,
+                     const std::string &key_file,
+                     const std::string &extra = "") {
+    std::vector<unsigned char> data = rgr_test_bytes(200000);
+    rgr_test_write_file(dir.file("in"), data);
+    std::string key = " --key-file " + quote(dir.file(key_file)) + " ";
+    RGR_CHECK(run("encrypt " + engine + key + extra + quote(dir.file("in")) +
+                  " -o " + quote(dir.file("enc"))) == 0);
+    RGR_CHECK(run("decrypt " + engine + key + quote(dir.file("enc")) +
+                  " -o " + quote(dir.file("out"))) == 0);
+    RGR_CHECK(rgr_test_read_file(dir.file("out")) == data);
+    // stdin to stdout
+    RGR_CHECK(run("encrypt " + engine + key + "< " + quote(dir.file("in")) +
+                  " | '" + cli + "' decrypt " + engine + key + "> " +
+                  quote(dir.file("piped"))) == 0);
+    RGR_CHECK(rgr_test_read_file(dir.file("piped")) == data);
+}
+
+void test_roundtrips(const RgrTestDir &dir) {
+    RGR_CHECK(run("keygen gost -o " + quote(dir.file("gost.key"))) == 0);
+    check_roundtrip(dir, "gost", "gost.key");
+    check_roundtrip(dir, "gost", "gost.key", "--compress --threads 2 ");
+    RGR_CHECK(run("keygen permutation --length 6 -o " +
+                  quote(dir.file("perm.key"))) == 0);
+    check_roundtrip(dir, "permutation", "perm.key");
+    RGR_CHECK(file_mode(dir.file("gost.key")) == 0600);
+    RGR_CHECK(file_mode(dir.file("perm.key")) == 0600);
+}
+
+void test_rsa_keys(const RgrTestDir &dir) {
+    // Private key files end up owner-only even when they already existed
+    // world-readable.
+    rgr_test_write_file(dir.file("rsa.priv"), {'x'});
+    RGR_CHECK(chmod(dir.file("rsa.priv").c_str(), 0644) == 0);
+    RGR_CHECK(run("keygen rsa --bits 512 --primes 3 -o " +
+                  quote(dir.file("rsa.key")) + " --public " +
+                  quote(dir.file("rsa.pub")) + " --private " +
+                  quote(dir.file("rsa.priv"))) == 0);
+    RGR_CHECK(file_mode(dir.file("rsa.key")) == 0600);
+    RGR_CHECK(file_mode(dir.file("rsa.priv")) == 0600);
+    RGR_CHECK(file_mode(dir.file("rsa.pub")) == 0644);
+    std::vector<unsigned char> data = rgr_test_bytes(3000);
+    rgr_test_write_file(dir.file("in"), data);
+    RGR_CHECK(run("encrypt rsa --key-file " + quote(dir.file("rsa.pub")) +
+                  " " + quote(dir.file("in")) + " -o " +
+                  quote(dir.file("enc"))) == 0);
+    // The full key decrypts through CRT, "n;d" without it.
+    for (const char *key : {"rsa.key", "rsa.priv"}) {
+        RGR_CHECK(run("decrypt rsa --key-file " + quote(dir.file(key)) + " " +
+                      quote(dir.file("enc")) + " -o " +
+                      quote(dir.file("out"))) == 0);
+        RGR_CHECK(rgr_test_read_file(dir.file("out")) == data);
+    }
+}
+
+void test_rejected_options(const RgrTestDir &dir) {
+    const char *const bad[] = {
+        "keygen rsa --bits 64",        "keygen rsa --bits 100000",
+        "keygen rsa --primes 5",       "keygen permutation --length 11",
+        "keygen permutation --length -1",
+        "encrypt gost --key 00 --threads -1",
+        "encrypt gost --key 00 --threads 99999999999999999999",
+        "encrypt gost --key 00 --chunk-size 99999999999G",
+        "encrypt gost --key 00 --chunk-size 1X",
+        "encrypt gost --key 00 --affinity everywhere",
+        "frobnicate gost",
+    };
+    for (const char *args : bad) {
+        RGR_CHECK(run(args) == EXIT_USAGE);
+    }
+    // Writing over the input would truncate it before it is read.
+    std::vector<unsigned char> data = rgr_test_bytes(1000);
+    rgr_test_write_file(dir.file("same"), data);
+    RGR_CHECK(run("encrypt gost --key-file " + quote(dir.file("gost.key")) +
+                  " " + quote(dir.file("same")) + " -o " +
+                  quote(dir.file("same"))) == EXIT_USAGE);
+    RGR_CHECK(rgr_test_read_file(dir.file("same")) == data);
+}
+
+// A failed decryption leaves no output behind.
+void test_failure_removes_output(const RgrTestDir &dir) {
+    rgr_test_write_file(dir.file("garbage"), rgr_test_bytes(1001));
+    RGR_CHECK(run("decrypt gost --key-file " + quote(dir.file("gost.key")) +
+                  " " + quote(dir.file("garbage")) + " -o " +
+                  quote(dir.file("garbage.out"))) != 0);
+    RGR_CHECK(!std::filesystem::exists(dir.file("garbage.out")));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    RGR_CHECK(argc == 2);
+    cli = argv[1];
+    umask(022);
+    RgrTestDir dir("rgr_cli_test");
+    test_roundtrips(dir);
+    test_rsa_keys(dir);
+    test_rejected_options(dir);
+    test_failure_removes_output(dir);
+    return 0;
+}
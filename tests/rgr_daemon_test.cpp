@@ -0,0 +1,340 @@
+//
+//  rgr_daemon_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  Starts the rgr_daemon binary given as the first argument and talks to
+//  it through RgrDaemonClient and, for requests the client never sends,
+//  over a raw socket.
+//
+
+#include "rgr_test.hpp"
+
+#include "gost/gost.hpp"
+#include "rgr_daemon.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+namespace {
+
+const char *const KEY_HEX =
+    "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20";
+const uint64_t MAX_IN_FLIGHT = 4;
+
+std::string socket_path;
+pid_t daemon_pid = -1;
+
+pid_t start_daemon(const std::string &daemon) {
+    pid_t pid = fork();
+    RGR_CHECK(pid >= 0);
+    if (pid == 0) {
+        std::string in_flight = std::to_string(MAX_IN_FLIGHT);
+        execl(daemon.c_str(), daemon.c_str(), "serve", "--socket",
+              socket_path.c_str(), "--workers", "2", "--max-in-flight",
+              in_flight.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+
+int connect_raw() {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    RGR_CHECK(fd >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(),
+                 sizeof(address.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) !=
+        0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void wait_for_socket() {
+    for (int attempt = 0; attempt < 500; ++attempt) {
+        int fd = connect_raw();
+        if (fd >= 0) {
+            close(fd);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    RGR_CHECK(!"daemon did not start listening");
+}
+
+RgrDaemonResponseHeader receive_response(int fd, std::string *aux = nullptr) {
+    RgrDaemonResponseHeader response;
+    RGR_CHECK(rgr_daemon_receive(fd, &response, sizeof(response)));
+    RGR_CHECK(response.magic == RGR_DAEMON_MAGIC);
+    std::string text(response.aux_length, '\0');
+    if (!text.empty()) {
+        RGR_CHECK(rgr_daemon_receive(fd, text.data(), text.size()));
+    }
+    if (aux) {
+        *aux = text;
+    }
+    return response;
+}
+
+RgrDaemonStatus status_of(const RgrDaemonResponseHeader &response) {
+    return static_cast<RgrDaemonStatus>(response.status);
+}
+
+// Shared buffer for the raw-socket tests, sealed only when asked to.
+int shared_memory(size_t length, bool sealed) {
+    int fd = memfd_create("rgr_daemon_test", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    RGR_CHECK(fd >= 0 && ftruncate(fd, static_cast<off_t>(length)) == 0);
+    if (sealed) {
+        RGR_CHECK(fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) == 0);
+    }
+    return fd;
+}
+
+RgrDaemonStatus attach(int socket, int memory, uint64_t length) {
+    RgrDaemonRequestHeader request;
+    request.op = static_cast<uint16_t>(RgrDaemonOp::Attach);
+    request.request_id = 1;
+    request.in_length = length;
+    RGR_CHECK(rgr_daemon_send(socket, &request, sizeof(request), memory));
+    return status_of(receive_response(socket));
+}
+
+uint32_t open_key(int socket) {
+    std::string aux = std::string("gost\n") + KEY_HEX;
+    RgrDaemonRequestHeader request;
+    request.op = static_cast<uint16_t>(RgrDaemonOp::Open);
+    request.request_id = 2;
+    request.aux_length = static_cast<uint32_t>(aux.size());
+    RGR_CHECK(rgr_daemon_send(socket, &request, sizeof(request)));
+    RGR_CHECK(rgr_daemon_send(socket, aux.data(), aux.size()));
+    RgrDaemonResponseHeader response = receive_response(socket);
+    RGR_CHECK(status_of(response) == RgrDaemonStatus::Ok);
+    return response.key_handle;
+}
+
+void test_client_roundtrip() {
+    RgrDaemonClient client(socket_path, 1 << 20);
+    uint32_t key = client.open("gost", KEY_HEX);
+    std::vector<unsigned char> key_bytes = hexStringToBytes(KEY_HEX);
+    const size_t output = 512 << 10;
+    for (size_t length : {0, 1, 8, 1000, 100000}) {
+        std::vector<unsigned char> data = rgr_test_bytes(length, 3);
+        std::copy(data.begin(), data.end(), client.buffer());
+        RgrDaemonReply encrypted =
+            client.encrypt(key, 0, length, output, client.buffer_size() - output);
+        RGR_CHECK(encrypted.ok());
+        RGR_CHECK(encrypted.out_length ==
+                  GOST_IV_SIZE_BYTES + gost_padded_length(length));
+        // The layout is encryptBytesGOST's: IV, then the ciphertext.
+        CipherBytesResult reference = decryptBytesGOST(
+            client.buffer() + output, encrypted.out_length, key_bytes);
+        RGR_CHECK(reference.success && reference.data == data);
+
+        std::memset(client.buffer(), 0, length);
+        RgrDaemonReply decrypted =
+            client.decrypt(key, output, encrypted.out_length, 0, output);
+        RGR_CHECK(decrypted.ok() && decrypted.out_length == length);
+        RGR_CHECK(std::equal(data.begin(), data.end(), client.buffer()));
+    }
+
+    // The needed size comes back with BufferTooSmall.
+    RgrDaemonReply small = client.encrypt(key, 0, 100, output, 10);
+    RGR_CHECK(small.status == RgrDaemonStatus::BufferTooSmall);
+    RGR_CHECK(small.out_length == GOST_IV_SIZE_BYTES + gost_padded_length(100));
+
+    RGR_CHECK(client.encrypt(key, client.buffer_size() - 10, 100, 0, output)
+                  .status == RgrDaemonStatus::BadRequest);
+    RGR_CHECK(client.encrypt(key, 0, 100, client.buffer_size(), 1000).status ==
+              RgrDaemonStatus::BadRequest);
+    RGR_CHECK(client.encrypt(key + 1000, 0, 100, output, 1000).status ==
+              RgrDaemonStatus::UnknownKey);
+    // Ciphertext that is not whole blocks.
+    RGR_CHECK(client.decrypt(key, 0, 13, output, output).status ==
+              RgrDaemonStatus::CipherError);
+    RGR_CHECK_THROWS(client.open("gost", "00"), std::runtime_error);
+    RGR_CHECK_THROWS(client.open("no-such-engine", KEY_HEX), std::runtime_error);
+}
+
+// Keys are warm and shared: a second client opening the same key gets the
+// same handle.
+void test_shared_keys() {
+    RgrDaemonClient first(socket_path, 4096);
+    RgrDaemonClient second(socket_path, 4096);
+    RGR_CHECK(first.open("gost", KEY_HEX) == second.open("gost", KEY_HEX));
+}
+
+void test_attach_rules() {
+    int socket = connect_raw();
+    RGR_CHECK(socket >= 0);
+    RgrDaemonRequestHeader request;
+    request.op = static_cast<uint16_t>(RgrDaemonOp::Encrypt);
+    request.request_id = 9;
+    request.in_length = 8;
+    request.out_capacity = 64;
+    RGR_CHECK(rgr_daemon_send(socket, &request, sizeof(request)));
+    RGR_CHECK(status_of(receive_response(socket)) ==
+              RgrDaemonStatus::NotAttached);
+
+    // An unsealed memfd could be shrunk under the daemon's mapping.
+    int unsealed = shared_memory(4096, false);
+    RGR_CHECK(attach(socket, unsealed, 4096) != RgrDaemonStatus::Ok);
+    close(unsealed);
+    // A length beyond the file is refused as well.
+    int sealed = shared_memory(4096, true);
+    RGR_CHECK(attach(socket, sealed, 8192) != RgrDaemonStatus::Ok);
+    RGR_CHECK(attach(socket, sealed, 4096) == RgrDaemonStatus::Ok);
+    RGR_CHECK(ftruncate(sealed, 0) != 0);
+    close(sealed);
+
+    // A header with the wrong magic ends the connection.
+    RgrDaemonRequestHeader bad;
+    bad.magic = 0x12345678;
+    RGR_CHECK(rgr_daemon_send(socket, &bad, sizeof(bad)));
+    RgrDaemonResponseHeader response;
+    if (rgr_daemon_receive(socket, &response, sizeof(response))) {
+        RGR_CHECK(status_of(response) == RgrDaemonStatus::BadRequest);
+        std::string aux(response.aux_length, '\0');
+        RGR_CHECK(aux.empty() ||
+                  rgr_daemon_receive(socket, aux.data(), aux.size()));
+        RGR_CHECK(!rgr_daemon_receive(socket, &response, sizeof(response)));
+    }
+    close(socket);
+}
+
+// Pipelining past --max-in-flight gets Busy answers instead of queueing
+// without bound, and every request is still answered exactly once.
+void test_in_flight_cap() {
+    const size_t length = 256 << 10;
+    const size_t requests = 64;
+    int socket = connect_raw();
+    RGR_CHECK(socket >= 0);
+    int memory = shared_memory(4 * length, true);
+    RGR_CHECK(attach(socket, memory, 4 * length) == RgrDaemonStatus::Ok);
+    uint32_t key = open_key(socket);
+
+    std::vector<RgrDaemonRequestHeader> batch(requests);
+    for (size_t i = 0; i < requests; ++i) {
+        batch[i].op = static_cast<uint16_t>(RgrDaemonOp::Encrypt);
+        batch[i].request_id = 100 + i;
+        batch[i].key_handle = key;
+        batch[i].in_length = length;
+        batch[i].out_offset = 2 * length;
+        batch[i].out_capacity = 2 * length;
+    }
+    RGR_CHECK(rgr_daemon_send(socket, batch.data(),
+                              batch.size() * sizeof(batch[0])));
+    std::vector<bool> answered(requests, false);
+    size_t ok = 0;
+    size_t busy = 0;
+    for (size_t i = 0; i < requests; ++i) {
+        RgrDaemonResponseHeader response = receive_response(socket);
+        RGR_CHECK(response.request_id >= 100 &&
+                  response.request_id < 100 + requests);
+        RGR_CHECK(!answered[response.request_id - 100]);
+        answered[response.request_id - 100] = true;
+        ok += status_of(response) == RgrDaemonStatus::Ok;
+        busy += status_of(response) == RgrDaemonStatus::Busy;
+    }
+    RGR_CHECK(ok + busy == requests);
+    RGR_CHECK(ok >= MAX_IN_FLIGHT && busy > 0);
+    close(socket);
+    close(memory);
+
+    RgrDaemonClient client(socket_path, 4096);
+    std::string stats = client.stats_json();
+    RGR_CHECK(stats.find("\"busy\":") != std::string::npos);
+}
+
+size_t daemon_descriptors() {
+    std::string dir = "/proc/" + std::to_string(daemon_pid) + "/fd";
+    size_t count = 0;
+    for (auto it = std::filesystem::directory_iterator(dir);
+         it != std::filesystem::directory_iterator(); ++it) {
+        ++count;
+    }
+    return count;
+}
+
+// A descriptor sent along with a request other than Attach is closed by the
+// daemon, whatever the request's outcome.
+void test_stray_descriptors_closed() {
+    int socket = connect_raw();
+    RGR_CHECK(socket >= 0);
+    open_key(socket);
+    size_t before = daemon_descriptors();
+
+    int memory = shared_memory(4096, true);
+    std::string good = std::string("gost\n") + KEY_HEX;
+    for (int i = 0; i < 20; ++i) {
+        for (const std::string &aux : {good, std::string("no separator")}) {
+            RgrDaemonRequestHeader request;
+            request.op = static_cast<uint16_t>(RgrDaemonOp::Open);
+            request.request_id = 3;
+            request.aux_length = static_cast<uint32_t>(aux.size());
+            RGR_CHECK(
+                rgr_daemon_send(socket, &request, sizeof(request), memory));
+            RGR_CHECK(rgr_daemon_send(socket, aux.data(), aux.size()));
+            receive_response(socket);
+        }
+        for (uint16_t op : {static_cast<uint16_t>(RgrDaemonOp::Stats),
+                            static_cast<uint16_t>(RgrDaemonOp::Encrypt),
+                            static_cast<uint16_t>(0x7777)}) {
+            RgrDaemonRequestHeader request;
+            request.op = op;
+            request.request_id = 4;
+            RGR_CHECK(
+                rgr_daemon_send(socket, &request, sizeof(request), memory));
+            std::string aux;
+            RgrDaemonResponseHeader response = receive_response(socket, &aux);
+            if (op == static_cast<uint16_t>(RgrDaemonOp::Stats)) {
+                RGR_CHECK(status_of(response) == RgrDaemonStatus::Ok);
+                RGR_CHECK(aux.find("\"busy\":") != std::string::npos);
+            } else {
+                RGR_CHECK(status_of(response) != RgrDaemonStatus::Ok);
+            }
+        }
+    }
+    // Connections of earlier tests may still be closing, so the count can
+    // only have dropped.
+    RGR_CHECK(daemon_descriptors() <= before);
+    close(memory);
+    close(socket);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    RGR_CHECK(argc == 2);
+    RgrTestDir dir("rgr_daemon_test");
+    socket_path = dir.file("socket");
+    pid_t daemon = start_daemon(argv[1]);
+    daemon_pid = daemon;
+    wait_for_socket();
+
+    test_client_roundtrip();
+    test_shared_keys();
+    test_attach_rules();
+    test_in_flight_cap();
+    test_stray_descriptors_closed();
+
+    // SIGINT shuts the daemon down cleanly.
+    RGR_CHECK(kill(daemon, SIGINT) == 0);
+    int status = 0;
+    RGR_CHECK(waitpid(daemon, &status, 0) == daemon);
+    RGR_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    return 0;
+}
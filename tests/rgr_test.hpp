@@ -0,0 +1,105 @@
+//
+//  rgr_test.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  Minimal checks for the test executables: no framework, a failed check
+//  prints where it failed and exits with status 1.
+//
+
+#ifndef RGR_TEST_HPP
+#define RGR_TEST_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#define RGR_CHECK(condition)                                                   \
+    do {                                                                       \
+        if (!(condition)) {                                                    \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__,        \
+                         __LINE__, #condition);                                \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (0)
+
+// Passes when statement throws exception_type.
+#define RGR_CHECK_THROWS(statement, exception_type)                            \
+    do {                                                                       \
+        bool rgr_thrown = false;                                               \
+        try {                                                                  \
+            statement;                                                         \
+        } catch (const exception_type &) {                                     \
+            rgr_thrown = true;                                                 \
+        }                                                                      \
+        RGR_CHECK(rgr_thrown && #statement);                                   \
+    } while (0)
+
+// Deterministic filler, so a failure reproduces.
+inline std::vector<unsigned char> rgr_test_bytes(size_t length,
+                                                 uint32_t seed = 1) {
+    std::vector<unsigned char> bytes(length);
+    uint32_t state = seed * 2654435761u + 1;
+    for (unsigned char &byte : bytes) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        byte = static_cast<unsigned char>(state);
+    }
+    return bytes;
+}
+
+// Scratch directory under the system temp directory, removed with its
+// contents on destruction.
+class RgrTestDir {
+  public:
+    explicit RgrTestDir(const std::string &name)
+        : path_(std::filesystem::temp_directory_path() /
+                (name + "_" + std::to_string(getpid()))) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+    ~RgrTestDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+    RgrTestDir(const RgrTestDir &) = delete;
+    RgrTestDir &operator=(const RgrTestDir &) = delete;
+
+    std::string file(const std::string &name) const {
+        return (path_ / name).string();
+    }
+
+  private:
+    std::filesystem::path path_;
+};
+
+inline void rgr_test_write_file(const std::string &path,
+                                const std::vector<unsigned char> &bytes) {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    RGR_CHECK(file != nullptr);
+    RGR_CHECK(bytes.empty() ||
+              std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+    std::fclose(file);
+}
+
+inline std::vector<unsigned char> rgr_test_read_file(const std::string &path) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    RGR_CHECK(file != nullptr);
+    std::vector<unsigned char> bytes;
+    unsigned char buffer[65536];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + got);
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+#endif // RGR_TEST_HPP
@@ -0,0 +1,148 @@
+//
+//  rsa_key_pool_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  RsaKeyPool: refilling, pooled and synchronous service, statistics, and
+//  rejection of key sizes generateKeys cannot produce.
+//
+
+#include "rgr_test.hpp"
+
+#include "capi/rgr_crypto.h"
+#include "rsa/rsa_key_pool.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Small keys, so the background worker fills the pool in milliseconds.
+const unsigned int BITS = 128;
+
+bool valid_key_pair(const KeyPair &keys) {
+    BigInt message = 0x1234567;
+    BigInt encrypted =
+        boost::multiprecision::powm(message, keys.pubKey.e, keys.pubKey.n);
+    return keys.pubKey.n > message &&
+           applyPrivateKey(encrypted, keys.privKey) == message;
+}
+
+// Waits until the background worker has brought the pool to its target.
+RsaKeyPoolStats filled_stats(const RsaKeyPool &pool, unsigned int bits,
+                             unsigned int prime_count = 2) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    RsaKeyPoolStats stats = pool.stats(bits, prime_count);
+    while (stats.ready < stats.target_depth &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = pool.stats(bits, prime_count);
+    }
+    return stats;
+}
+
+void test_pooled_and_synchronous() {
+    RsaKeyPool pool;
+    KeyPair keys;
+    RGR_CHECK(!pool.try_acquire(BITS, keys));
+
+    pool.reserve(BITS, 2);
+    RsaKeyPoolStats stats = filled_stats(pool, BITS);
+    RGR_CHECK(stats.bits == BITS && stats.prime_count == 2);
+    RGR_CHECK(stats.target_depth == 2 && stats.ready == 2);
+
+    KeyPair first = pool.acquire(BITS);
+    RGR_CHECK(pool.try_acquire(BITS, keys));
+    RGR_CHECK(valid_key_pair(first) && valid_key_pair(keys));
+    RGR_CHECK(first.pubKey.n != keys.pubKey.n);
+    stats = pool.stats(BITS);
+    RGR_CHECK(stats.served_from_pool == 2);
+    RGR_CHECK(stats.served_synchronously == 0);
+
+    // Depth 0 stops the refill; an empty pool generates on the caller.
+    pool.reserve(BITS, 0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (pool.stats(BITS).generating > 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    while (pool.try_acquire(BITS, keys)) {
+    }
+    RGR_CHECK(valid_key_pair(pool.acquire(BITS)));
+    stats = pool.stats(BITS);
+    RGR_CHECK(stats.target_depth == 0 && stats.ready == 0);
+    RGR_CHECK(stats.served_synchronously == 1);
+    RGR_CHECK(stats.generated >= 2);
+    RGR_CHECK(stats.average_generation_ms > 0.0);
+}
+
+void test_prime_counts() {
+    RsaKeyPool pool(2);
+    pool.reserve(BITS, 1, 3);
+    pool.reserve(3 * BITS, 1, 4);
+    RGR_CHECK(filled_stats(pool, BITS, 3).ready == 1);
+    RGR_CHECK(filled_stats(pool, 3 * BITS, 4).ready == 1);
+    KeyPair keys = pool.acquire(BITS, 3);
+    RGR_CHECK(keys.privKey.primes.size() == 3 && valid_key_pair(keys));
+    RGR_CHECK(checkPrimeFactors(keys.privKey));
+    // Sizes are kept apart by prime count.
+    RGR_CHECK(pool.stats(BITS, 2).served_from_pool == 0);
+    RGR_CHECK(pool.stats(3 * BITS, 4).ready == 1);
+
+    std::string json = rsa_key_pool_stats_to_json(pool.stats());
+    RGR_CHECK(json.find("{\"bits\":128,\"primes\":3,\"target_depth\":1,") !=
+              std::string::npos);
+    RGR_CHECK(json.find("{\"bits\":384,\"primes\":4,") != std::string::npos);
+}
+
+// Rejected sizes throw from every entry point and do not create a slot.
+void test_invalid_sizes() {
+    RsaKeyPool pool;
+    KeyPair keys;
+    for (auto [bits, primes] : {std::pair(5u, 2u), std::pair(0u, 2u),
+                                std::pair(8u, 3u), std::pair(BITS, 1u),
+                                std::pair(BITS, 5u)}) {
+        RGR_CHECK_THROWS(pool.acquire(bits, primes), std::invalid_argument);
+        RGR_CHECK_THROWS(pool.try_acquire(bits, keys, primes),
+                         std::invalid_argument);
+        RGR_CHECK_THROWS(pool.reserve(bits, 1, primes), std::invalid_argument);
+    }
+    RGR_CHECK(pool.stats().empty());
+}
+
+void test_c_api() {
+    uint8_t n[16];
+    uint8_t e[16];
+    uint8_t d[16];
+    size_t length = 0;
+    RGR_CHECK(rgr_rsa_generate_key(BITS, n, e, d, sizeof(n), &length) ==
+              RGR_OK);
+    RGR_CHECK(length > 0 && length <= sizeof(n));
+    RGR_CHECK(rgr_rsa_generate_key(4, n, e, d, sizeof(n), &length) ==
+              RGR_ERR_INVALID_ARGUMENT);
+    RGR_CHECK(rgr_rsa_generate_key(0, n, e, d, sizeof(n), &length) ==
+              RGR_ERR_INVALID_ARGUMENT);
+
+    uint8_t key[16 * 12];
+    RGR_CHECK(rgr_rsa_generate_key_crt(8, 3, key, sizeof(key), &length) ==
+              RGR_ERR_INVALID_ARGUMENT);
+    RGR_CHECK(rgr_rsa_key_pool_reserve(4, 1) == RGR_ERR_INVALID_ARGUMENT);
+
+    rgr_rsa_key_pool_stats stats;
+    RGR_CHECK(rgr_rsa_key_pool_get_stats(4, &stats) == RGR_OK);
+    RGR_CHECK(stats.target_depth == 0 && stats.served_synchronously == 0);
+    RGR_CHECK(rgr_rsa_key_pool_get_stats(BITS, &stats) == RGR_OK);
+    RGR_CHECK(stats.served_synchronously == 1);
+}
+
+} // namespace
+
+int main() {
+    test_pooled_and_synchronous();
+    test_prime_counts();
+    test_invalid_sizes();
+    test_c_api();
+    return 0;
+}
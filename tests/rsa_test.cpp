@@ -0,0 +1,370 @@
+//
+//  rsa_test.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "rgr_test.hpp"
+
+#include "capi/rgr_crypto.h"
+#include "rsa/rsa.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Plaintext that ends in zero bytes, which the unframed layout used to
+// strip.
+std::string zero_heavy_text(size_t length) {
+    std::string text;
+    for (size_t i = 0; i < length; ++i) {
+        text.push_back(static_cast<char>(i % 3 == 0 ? 0 : i));
+    }
+    if (length > 0) {
+        text.back() = 0;
+    }
+    return text;
+}
+
+std::string read_text(const std::string &path) {
+    std::vector<unsigned char> bytes = rgr_test_read_file(path);
+    return std::string(bytes.begin(), bytes.end());
+}
+
+void test_payload_length() {
+    RGR_CHECK_THROWS(getBlockPayloadLength(2), std::invalid_argument);
+    RGR_CHECK(getBlockPayloadLength(3) == 1);
+    RGR_CHECK(getBlockPayloadLength(64) == 62);
+    RGR_CHECK(getBlockPayloadLength(257) == 255);
+    RGR_CHECK(getBlockPayloadLength(258) == 255);
+    RGR_CHECK(getBlockPayloadLength(512) == 509);
+}
+
+// Every length around the block payload, through each API that uses the
+// framed layout. Keys above 2048 bits take a two-byte length field.
+void test_framed_roundtrips(const RgrTestDir &dir) {
+    boost::random::mt19937 rng(7);
+    for (unsigned int bits : {24u, 512u, 2072u}) {
+        KeyPair keys = generateKeys(bits, rng);
+        size_t k = getApproximateByteLength(keys.pubKey.n);
+        size_t payload = getBlockPayloadLength(k);
+        for (size_t length : {size_t(0), size_t(1), payload - 1, payload,
+                              payload + 1, 3 * payload, 3 * payload + 5}) {
+            std::string text = zero_heavy_text(length);
+            const unsigned char *bytes =
+                reinterpret_cast<const unsigned char *>(text.data());
+
+            std::vector<BigInt> blocks = encryptText(text, keys.pubKey, k);
+            RGR_CHECK(decryptText(blocks, keys.privKey, k) == text);
+
+            CipherBytesResult encrypted =
+                encryptBytesRSA(bytes, text.size(), keys.pubKey);
+            RGR_CHECK(encrypted.success);
+            RGR_CHECK(encrypted.data.size() ==
+                      (length + payload - 1) / payload * k);
+            CipherBytesResult decrypted = decryptBytesRSA(
+                encrypted.data.data(), encrypted.data.size(), keys.privKey);
+            RGR_CHECK(decrypted.success);
+            RGR_CHECK(std::string(decrypted.data.begin(),
+                                  decrypted.data.end()) == text);
+
+            rgr_test_write_file(dir.file("in"),
+                                std::vector<unsigned char>(text.begin(),
+                                                           text.end()));
+            for (bool compress : {false, true}) {
+                RGR_CHECK(encryptFile(dir.file("in"), dir.file("enc"),
+                                      keys.pubKey, k, nullptr, compress));
+                RGR_CHECK(decryptFile(dir.file("enc"), dir.file("out"),
+                                      keys.privKey, k));
+                RGR_CHECK(read_text(dir.file("out")) == text);
+            }
+        }
+    }
+}
+
+// Hex files written before the framed layout: no marker line, every block
+// holds k - 1 plaintext bytes and the last one is padded with zeros.
+void test_legacy_hex_file(const RgrTestDir &dir) {
+    boost::random::mt19937 rng(11);
+    KeyPair keys = generateKeys(512, rng);
+    size_t k = getApproximateByteLength(keys.pubKey.n);
+    std::string plain(150, 'L');
+    plain += "legacy data ends here";
+    {
+        std::ofstream file(dir.file("legacy.txt"));
+        for (size_t i = 0; i < plain.size(); i += k - 1) {
+            std::vector<unsigned char> block(
+                plain.begin() + i,
+                plain.begin() + std::min(plain.size(), i + k - 1));
+            block.resize(k - 1, 0);
+            file << std::hex << encryptBlock(block, keys.pubKey) << "\n";
+        }
+    }
+    RGR_CHECK(decryptFile(dir.file("legacy.txt"), dir.file("legacy.out"),
+                          keys.privKey, k));
+    RGR_CHECK(read_text(dir.file("legacy.out")) == plain);
+}
+
+// Text encrypted before the framed layout (the app's space-separated hex
+// blocks): k - 1 bytes per block and the last block unpadded.
+void test_legacy_text() {
+    boost::random::mt19937 rng(12);
+    for (unsigned int bits : {512u, 2072u}) {
+        KeyPair keys = generateKeys(bits, rng);
+        size_t k = getApproximateByteLength(keys.pubKey.n);
+        for (size_t length : {size_t(0), size_t(1), size_t(5), k - 2, k - 1, k,
+                              3 * (k - 1) + 7}) {
+            std::string text;
+            for (size_t i = 0; i < length; ++i) {
+                text.push_back(static_cast<char>('A' + i % 26));
+            }
+            std::vector<BigInt> blocks;
+            std::vector<uint8_t> wire;
+            for (size_t i = 0; i < text.size(); i += k - 1) {
+                std::vector<unsigned char> block(
+                    text.begin() + i,
+                    text.begin() + std::min(text.size(), i + k - 1));
+                blocks.push_back(encryptBlock(block, keys.pubKey));
+                std::vector<unsigned char> bytes = bigIntToBytes(blocks.back(), k);
+                wire.insert(wire.end(), bytes.begin(), bytes.end());
+            }
+            RGR_CHECK(decryptText(blocks, keys.privKey, k) == text);
+            RGR_CHECK(decryptTextLegacy(blocks, keys.privKey, k) == text);
+            if (blocks.empty()) {
+                continue;
+            }
+
+            // The C ABI reports the framing failure; the legacy call then
+            // recovers the text, as the ObjC wrapper does.
+            std::vector<unsigned char> n = bigIntToBytes(keys.privKey.n, k);
+            std::vector<unsigned char> d = bigIntToBytes(keys.privKey.d, k);
+            std::vector<uint8_t> out(wire.size());
+            size_t out_length = 0;
+            RGR_CHECK(rgr_rsa_decrypt(n.data(), n.size(), d.data(), d.size(),
+                                      wire.data(), wire.size(), out.data(),
+                                      out.size(), &out_length) ==
+                      RGR_ERR_BAD_INPUT);
+            RGR_CHECK(rgr_rsa_decrypt_legacy_text(
+                          n.data(), n.size(), d.data(), d.size(), wire.data(),
+                          wire.size(), nullptr, 0, &out_length) ==
+                      RGR_ERR_BUFFER_TOO_SMALL);
+            RGR_CHECK(out_length == blocks.size() * (k - 1));
+            RGR_CHECK(rgr_rsa_decrypt_legacy_text(
+                          n.data(), n.size(), d.data(), d.size(), wire.data(),
+                          wire.size(), out.data(), out.size(),
+                          &out_length) == RGR_OK);
+            RGR_CHECK(std::string(out.begin(), out.begin() + out_length) ==
+                      text);
+        }
+
+        // Framed text still takes the framed path, trailing zeros included.
+        std::string framed = zero_heavy_text(2 * k + 3);
+        RGR_CHECK(decryptText(encryptText(framed, keys.pubKey, k),
+                              keys.privKey, k) == framed);
+        std::vector<BigInt> too_large = {keys.pubKey.n};
+        RGR_CHECK_THROWS(decryptTextLegacy(too_large, keys.privKey, k),
+                         std::runtime_error);
+    }
+}
+
+void test_batch() {
+    boost::random::mt19937 rng(13);
+    KeyPair keys = generateKeys(512, rng);
+    size_t payload =
+        getBlockPayloadLength(getApproximateByteLength(keys.pubKey.n));
+    std::string input = std::string("abc\0\0", 5) + std::string(2 * payload, 'q');
+    std::vector<CipherBatchRecord> records{{0, 5}, {5, 2 * payload}, {0, 0}};
+    CipherBatchResult encrypted = encryptBatchRSA(
+        reinterpret_cast<const unsigned char *>(input.data()), input.size(),
+        records, keys.pubKey);
+    RGR_CHECK(encrypted.success && encrypted.failed_count == 0);
+    std::vector<CipherBatchRecord> cipher_records;
+    for (size_t i = 0; i < records.size(); ++i) {
+        cipher_records.push_back(
+            {encrypted.offsets[i], encrypted.offsets[i + 1] - encrypted.offsets[i]});
+    }
+    CipherBatchResult decrypted =
+        decryptBatchRSA(encrypted.arena.data(), encrypted.arena.size(),
+                        cipher_records, keys.privKey);
+    RGR_CHECK(decrypted.success && decrypted.failed_count == 0);
+    for (size_t i = 0; i < records.size(); ++i) {
+        std::string record(
+            reinterpret_cast<const char *>(decrypted.arena.data()) +
+                decrypted.offsets[i],
+            decrypted.offsets[i + 1] - decrypted.offsets[i]);
+        RGR_CHECK(record == input.substr(records[i].offset, records[i].length));
+    }
+}
+
+// A block that does not decrypt to a valid length field is an error rather
+// than garbage output; a wrong key never yields the plaintext.
+void test_rejects_bad_blocks() {
+    boost::random::mt19937 rng(17);
+    KeyPair keys = generateKeys(512, rng);
+    KeyPair other = generateKeys(512, rng);
+    std::string text(300, 'x');
+    CipherBytesResult encrypted = encryptBytesRSA(
+        reinterpret_cast<const unsigned char *>(text.data()), text.size(),
+        keys.pubKey);
+    RGR_CHECK(encrypted.success);
+    PrivateKey wrong{keys.privKey.n, other.privKey.d, {}};
+    CipherBytesResult decrypted = decryptBytesRSA(
+        encrypted.data.data(), encrypted.data.size(), wrong);
+    RGR_CHECK(!decrypted.success ||
+              std::string(decrypted.data.begin(), decrypted.data.end()) != text);
+    decrypted = decryptBytesRSA(encrypted.data.data(),
+                                encrypted.data.size() - 1, keys.privKey);
+    RGR_CHECK(!decrypted.success);
+}
+
+
+std::string hex(const BigInt &value) {
+    std::ostringstream text;
+    text << std::hex << value;
+    return text.str();
+}
+
+// Multi-prime keys: n has exactly the requested size for every prime count,
+// and CRT decryption agrees with the plain c^d mod n.
+void test_crt_matches_plain() {
+    boost::random::mt19937 rng(19);
+    for (unsigned int prime_count = 2; prime_count <= 4; ++prime_count) {
+        for (unsigned int bits : {64u, 127u, 512u, 1024u, 2048u}) {
+            KeyPair keys = generateKeys(bits, rng, prime_count);
+            RGR_CHECK(boost::multiprecision::msb(keys.pubKey.n) + 1 == bits);
+            RGR_CHECK(keys.privKey.primes.size() == prime_count);
+            RGR_CHECK(checkPrimeFactors(keys.privKey));
+            PrivateKey plain{keys.privKey.n, keys.privKey.d, {}};
+            for (uint32_t seed = 1; seed <= 4; ++seed) {
+                std::vector<unsigned char> bytes =
+                    rgr_test_bytes(bits / 8, seed);
+                BigInt c = bytesToBigInt(bytes) % keys.pubKey.n;
+                RGR_CHECK(applyPrivateKey(c, keys.privKey) ==
+                          applyPrivateKey(c, plain));
+            }
+            if (bits >= 512) {
+                std::string text = zero_heavy_text(1000);
+                CipherBytesResult encrypted = encryptBytesRSA(
+                    reinterpret_cast<const unsigned char *>(text.data()),
+                    text.size(), keys.pubKey);
+                RGR_CHECK(encrypted.success);
+                CipherBytesResult with_crt = decryptBytesRSA(
+                    encrypted.data.data(), encrypted.data.size(), keys.privKey);
+                CipherBytesResult without_crt = decryptBytesRSA(
+                    encrypted.data.data(), encrypted.data.size(), plain);
+                RGR_CHECK(with_crt.success && without_crt.success);
+                RGR_CHECK(with_crt.data == without_crt.data);
+                RGR_CHECK(std::string(with_crt.data.begin(),
+                                      with_crt.data.end()) == text);
+            }
+        }
+    }
+}
+
+void test_check_prime_factors() {
+    boost::random::mt19937 rng(23);
+    KeyPair keys = generateKeys(512, rng, 3);
+    RGR_CHECK(checkPrimeFactors(keys.privKey));
+    for (size_t i = 0; i < keys.privKey.primes.size(); ++i) {
+        PrivateKey bad = keys.privKey;
+        bad.primes[i].exponent += 1;
+        RGR_CHECK(!checkPrimeFactors(bad));
+        bad = keys.privKey;
+        bad.primes[i].coefficient += 1;
+        RGR_CHECK(!checkPrimeFactors(bad));
+    }
+    PrivateKey missing = keys.privKey;
+    missing.primes.pop_back();
+    RGR_CHECK(!checkPrimeFactors(missing));
+    RGR_CHECK(!checkPrimeFactors(PrivateKey{keys.privKey.n, keys.privKey.d, {}}));
+}
+
+// The "n;e;d" engine key followed by the CRT triples decrypts like "n;d".
+void test_engine_crt_key() {
+    boost::random::mt19937 rng(29);
+    KeyPair keys = generateKeys(768, rng, 4);
+    std::string key = hex(keys.pubKey.n) + ";" + hex(keys.pubKey.e) + ";" +
+                      hex(keys.privKey.d);
+    std::string crt_key = key;
+    for (const RsaPrimeFactor &factor : keys.privKey.primes) {
+        crt_key += ";" + hex(factor.prime) + ";" + hex(factor.exponent) + ";" +
+                   hex(factor.coefficient);
+    }
+    std::string text = zero_heavy_text(2000);
+    CipherBytesResult encrypted = encryptBytesRSA(
+        reinterpret_cast<const unsigned char *>(text.data()), text.size(),
+        keys.pubKey);
+    RGR_CHECK(encrypted.success);
+    for (const std::string &engine_key : {key, crt_key}) {
+        RsaCipherEngine engine;
+        engine.init(engine_key, CipherDirection::Decrypt);
+        std::vector<unsigned char> out(
+            engine.max_output_size(encrypted.data.size()));
+        size_t written = engine.finalize(encrypted.data.data(),
+                                         encrypted.data.size(), out.data());
+        RGR_CHECK(std::string(out.begin(), out.begin() + written) == text);
+    }
+    RsaCipherEngine engine;
+    RGR_CHECK_THROWS(engine.init(crt_key + "1", CipherDirection::Decrypt),
+                     std::invalid_argument);
+    RGR_CHECK_THROWS(engine.init(crt_key + ";1", CipherDirection::Decrypt),
+                     std::invalid_argument);
+    // Encryption only needs n and e.
+    engine.init(crt_key, CipherDirection::Encrypt);
+}
+
+// C ABI export: n, e, d and the triples, each key_length bytes wide.
+void test_capi_crt_export() {
+    const char message[] = "multi-prime key through the C ABI";
+    for (unsigned int prime_count = 2; prime_count <= 4; ++prime_count) {
+        size_t width = 0;
+        RGR_CHECK(rgr_rsa_generate_key_crt(1024, prime_count, nullptr, 0,
+                                           &width) == RGR_ERR_BUFFER_TOO_SMALL);
+        std::vector<uint8_t> key(width * (3 + 3 * prime_count));
+        RGR_CHECK(rgr_rsa_generate_key_crt(1024, prime_count, key.data(),
+                                           key.size(), &width) == RGR_OK);
+        RGR_CHECK(width == 128);
+        std::vector<uint8_t> ciphertext(4 * width), plain(4 * width);
+        size_t ciphertext_length = 0, plain_length = 0;
+        RGR_CHECK(rgr_rsa_encrypt(key.data(), width, key.data() + width, width,
+                                  reinterpret_cast<const uint8_t *>(message),
+                                  sizeof(message), ciphertext.data(),
+                                  ciphertext.size(),
+                                  &ciphertext_length) == RGR_OK);
+        RGR_CHECK(rgr_rsa_decrypt_crt(key.data(), width, prime_count,
+                                      ciphertext.data(), ciphertext_length,
+                                      plain.data(), plain.size(),
+                                      &plain_length) == RGR_OK);
+        RGR_CHECK(plain_length == sizeof(message));
+        RGR_CHECK(std::memcmp(plain.data(), message, sizeof(message)) == 0);
+        key[4 * width - 1] ^= 1; // first prime
+        RGR_CHECK(rgr_rsa_decrypt_crt(key.data(), width, prime_count,
+                                      ciphertext.data(), ciphertext_length,
+                                      plain.data(), plain.size(),
+                                      &plain_length) == RGR_ERR_INVALID_KEY);
+        RGR_CHECK(rgr_rsa_generate_key_crt(1024, 5, key.data(), key.size(),
+                                           &width) == RGR_ERR_INVALID_ARGUMENT);
+    }
+}
+
+} // namespace
+
+int main() {
+    RgrTestDir dir("rsa_test");
+    test_payload_length();
+    test_framed_roundtrips(dir);
+    test_legacy_hex_file(dir);
+    test_legacy_text();
+    test_batch();
+    test_rejects_bad_blocks();
+    test_crt_matches_plain();
+    test_check_prime_factors();
+    test_engine_crt_key();
+    test_capi_crt_export();
+    return 0;
+}
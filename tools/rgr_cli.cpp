@@ -0,0 +1,695 @@
+//
+//  rgr_cli.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  Headless front end to the C++ core. Typical runs:
+//
+//      rgr_cli keygen gost > gost.key
+//      tar c dir | rgr_cli encrypt gost --key-file gost.key > dir.tar.enc
+//      rgr_cli decrypt gost --key-file gost.key dir.tar.enc -o dir.tar
+//      rgr_cli encrypt rsa --key-file rsa.pub --output-dir out a.bin b.bin
+//
+//  Run without arguments for the full option list.
+//
+
+#include "common/cipher_random.hpp"
+#include "common/cipher_thread_pool.hpp"
+#include "container/cipher_container.hpp"
+#include "container/cipher_incremental.hpp"
+#include "engine/cipher_engine.hpp"
+#include "engine/cipher_file_batch.hpp"
+#include "gost/gost.hpp"
+#include "rsa/rsa.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const int EXIT_USAGE = 2;
+// --threads above this many per core only adds contention.
+const unsigned int MAX_THREADS_PER_CORE = 4;
+const unsigned int MIN_RSA_BITS = 128;
+const unsigned int MAX_RSA_BITS = 16384;
+
+const char *const USAGE =
+    "usage: rgr_cli keygen <gost|permutation|rsa> [-o FILE] [--length N]\n"
+    "                     [--bits N] [--primes N] [--public FILE]\n"
+    "                     [--private FILE]\n"
+    "       rgr_cli <encrypt|decrypt> <engine> (--key KEY | --key-file FILE)\n"
+    "                     [options] [INPUT...]\n"
+    "\n"
+    "engines: gost, permutation, rsa, static_shift. Keys use the engine\n"
+    "format: 64 hex digits for gost, a digit permutation such as 2031 for\n"
+    "permutation, \"n;e\", \"n;d\" or \"n;e;d\" in hex for rsa; keygen prints\n"
+    "them that way. An rsa \"n;e;d\" key may be followed by a\n"
+    "\"prime;exponent;coefficient\" triple per prime of n, which makes\n"
+    "decryption use CRT; keygen rsa prints them.\n"
+    "\n"
+    "With no INPUT (or \"-\") data is read from stdin, and without -o (or\n"
+    "with \"-o -\") written to stdout, so the tool works in pipelines.\n"
+    "Several inputs, or a directory, are processed as one batch into\n"
+    "--output-dir.\n"
+    "\n"
+    "options:\n"
+    "  -o, --output FILE     output file (single input)\n"
+    "  --output-dir DIR      batch output directory\n"
+    "  --suffix S            appended to batch outputs (default .enc on\n"
+    "                        encrypt, .dec on decrypt)\n"
+    "  --iv HEX              fixed 16-hex-digit gost IV (encrypt)\n"
+    "  --compress            write an LZ4 cipher container (file to file);\n"
+    "                        decrypt detects containers by itself\n"
+    "  --incremental         gost: create or update an incremental archive\n"
+    "                        (file to file); only changed content-defined\n"
+    "                        chunks are re-encrypted. Decrypt detects\n"
+    "                        archives by itself\n"
+    "  --threads N           worker threads for files and batches, up to\n"
+    "                        4 per core (default: all cores; stdin/stdout\n"
+    "                        is one pass)\n"
+    "  --affinity MODE       worker placement: none, node (default; keep\n"
+    "                        each worker on one NUMA node) or cpu (pin)\n"
+    "  --chunk-size SIZE     I/O chunk, or container chunk with --compress;\n"
+    "                        accepts K, M and G suffixes\n"
+    "  --stats               print throughput and the per-stage counters\n"
+    "                        to stderr\n"
+    "  --length N            keygen permutation: key length, 2-10 (default 8)\n"
+    "  --bits N              keygen rsa: modulus size, 128-16384\n"
+    "                        (default 2048)\n"
+    "  --primes N            keygen rsa: primes in n, 2-4 (default 2)\n"
+    "  --public FILE         keygen rsa: also write \"n;e\" to FILE\n"
+    "  --private FILE        keygen rsa: also write \"n;d\" to FILE\n";
+
+struct CliOptions {
+    std::string command;
+    std::string engine;
+    std::string key;
+    std::string key_file;
+    std::string iv_hex;
+    std::vector<std::string> inputs;
+    std::string output;
+    std::string output_dir;
+    std::string suffix;
+    bool suffix_set = false;
+    bool compress = false;
+    bool incremental = false;
+    bool stats = false;
+    unsigned int threads = 0;
+    CipherThreadAffinity affinity = CipherThreadAffinity::Node;
+    size_t chunk_size = 0;
+    size_t length = 8;
+    unsigned int bits = 2048;
+    unsigned int primes = 2;
+    std::string public_out;
+    std::string private_out;
+};
+
+struct UsageError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+unsigned int cores() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+// A decimal number in [min, max]. stoull on its own would also take
+// leading blanks and signs and turn "-1" into a huge value.
+unsigned long long parse_number(const std::string &option,
+                                const std::string &value,
+                                unsigned long long min = 0,
+                                unsigned long long max = ULLONG_MAX) {
+    size_t pos = 0;
+    unsigned long long number = 0;
+    bool parsed = !value.empty() &&
+                  std::isdigit(static_cast<unsigned char>(value.front()));
+    if (parsed) {
+        try {
+            number = std::stoull(value, &pos);
+        } catch (const std::exception &) {
+            parsed = false;
+        }
+    }
+    if (!parsed || pos != value.size()) {
+        throw UsageError(option + " expects a number, got \"" + value + "\".");
+    }
+    if (number < min || number > max) {
+        throw UsageError(option + " must be between " + std::to_string(min) +
+                         " and " + std::to_string(max) + ".");
+    }
+    return number;
+}
+
+// "64K", "4M", "1G" or plain bytes.
+size_t parse_size(const std::string &option, const std::string &value) {
+    std::string digits = value;
+    unsigned long long scale = 1;
+    if (!digits.empty()) {
+        switch (std::toupper(static_cast<unsigned char>(digits.back()))) {
+        case 'K':
+            scale = 1ull << 10;
+            break;
+        case 'M':
+            scale = 1ull << 20;
+            break;
+        case 'G':
+            scale = 1ull << 30;
+            break;
+        }
+        if (scale != 1) {
+            digits.pop_back();
+        }
+    }
+    unsigned long long size = parse_number(option, digits);
+    if (size == 0 || size > 0xFFFFFFFFull / scale) {
+        throw UsageError(option + " must be between 1 byte and 4 GiB.");
+    }
+    return static_cast<size_t>(size * scale);
+}
+
+CliOptions parse_arguments(int argc, char **argv) {
+    if (argc < 3) {
+        throw UsageError("");
+    }
+    CliOptions options;
+    options.command = argv[1];
+    options.engine = argv[2];
+    if (options.command != "keygen" && options.command != "encrypt" &&
+        options.command != "decrypt") {
+        throw UsageError("Unknown command \"" + options.command + "\".");
+    }
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw UsageError(arg + " expects a value.");
+            }
+            return argv[++i];
+        };
+        if (arg == "-o" || arg == "--output") {
+            options.output = value();
+        } else if (arg == "--output-dir") {
+            options.output_dir = value();
+        } else if (arg == "--suffix") {
+            options.suffix = value();
+            options.suffix_set = true;
+        } else if (arg == "--key") {
+            options.key = value();
+        } else if (arg == "--key-file") {
+            options.key_file = value();
+        } else if (arg == "--iv") {
+            options.iv_hex = value();
+        } else if (arg == "--compress") {
+            options.compress = true;
+        } else if (arg == "--incremental") {
+            options.incremental = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--threads") {
+            options.threads = static_cast<unsigned int>(
+                parse_number(arg, value(), 0, MAX_THREADS_PER_CORE * cores()));
+        } else if (arg == "--affinity") {
+            std::string mode = value();
+            if (mode == "none") {
+                options.affinity = CipherThreadAffinity::None;
+            } else if (mode == "node") {
+                options.affinity = CipherThreadAffinity::Node;
+            } else if (mode == "cpu") {
+                options.affinity = CipherThreadAffinity::Cpu;
+            } else {
+                throw UsageError("--affinity expects none, node or cpu.");
+            }
+        } else if (arg == "--chunk-size") {
+            options.chunk_size = parse_size(arg, value());
+        } else if (arg == "--length") {
+            options.length = static_cast<size_t>(parse_number(arg, value(), 2, 10));
+        } else if (arg == "--bits") {
+            options.bits = static_cast<unsigned int>(
+                parse_number(arg, value(), MIN_RSA_BITS, MAX_RSA_BITS));
+        } else if (arg == "--primes") {
+            options.primes =
+                static_cast<unsigned int>(parse_number(arg, value(), 2, 4));
+        } else if (arg == "--public") {
+            options.public_out = value();
+        } else if (arg == "--private") {
+            options.private_out = value();
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            throw UsageError("Unknown option \"" + arg + "\".");
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.threads == 0) {
+        options.threads = cores();
+    }
+    if (!options.suffix_set) {
+        options.suffix = options.command == "encrypt" ? ".enc" : ".dec";
+    }
+    return options;
+}
+
+std::string trim(const std::string &text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+        ++begin;
+    }
+    while (end > begin &&
+           std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    return text.substr(begin, end - begin);
+}
+
+std::string read_key(const CliOptions &options) {
+    if (options.key_file.empty()) {
+        if (options.key.empty()) {
+            throw UsageError("--key or --key-file is required.");
+        }
+        return options.key;
+    }
+    std::ifstream file(options.key_file);
+    if (!file) {
+        throw std::runtime_error("Cannot open key file " + options.key_file);
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return trim(text.str());
+}
+
+// Writes text plus a newline to path, or to stdout for "" and "-". A secret
+// (a private or symmetric key) goes to a file readable by its owner only,
+// also when the file already existed with wider permissions.
+void write_text(const std::string &path, const std::string &text,
+                bool secret) {
+    if (path.empty() || path == "-") {
+        std::cout << text << '\n';
+        return;
+    }
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  secret ? 0600 : 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot write " + path + ": " +
+                                 std::strerror(errno));
+    }
+    struct stat info;
+    bool ok = !secret || (fstat(fd, &info) == 0 &&
+                          (!S_ISREG(info.st_mode) || fchmod(fd, 0600) == 0));
+    std::string line = text + '\n';
+    for (size_t done = 0; ok && done < line.size();) {
+        ssize_t n = write(fd, line.data() + done, line.size() - done);
+        if (n < 0 && errno != EINTR) {
+            ok = false;
+        } else if (n > 0) {
+            done += static_cast<size_t>(n);
+        }
+    }
+    if (close(fd) != 0 || !ok) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+std::string hex(const BigInt &value) {
+    std::ostringstream text;
+    text << std::hex << value;
+    return text.str();
+}
+
+// Uniform random bit generator over cipher_random_fill.
+struct SystemRandom {
+    using result_type = uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+    result_type operator()() {
+        result_type value;
+        cipher_random_fill(reinterpret_cast<unsigned char *>(&value),
+                           sizeof(value));
+        return value;
+    }
+};
+
+int run_keygen(const CliOptions &options) {
+    // Every key comes from the system CSPRNG, directly or through a fully
+    // seeded engine.
+    if (options.engine == "gost") {
+        std::vector<unsigned char> key;
+        generateRandomBytes(key, GOST_KEY_SIZE_BYTES);
+        write_text(options.output, bytesToHexString(key), true);
+    } else if (options.engine == "permutation") {
+        std::vector<int> digits(options.length);
+        std::iota(digits.begin(), digits.end(), 0);
+        std::shuffle(digits.begin(), digits.end(), SystemRandom());
+        std::string key;
+        for (int digit : digits) {
+            key += static_cast<char>('0' + digit);
+        }
+        write_text(options.output, key, true);
+    } else if (options.engine == "rsa") {
+        boost::random::mt19937 rng;
+        seedKeyGenerator(rng);
+        KeyPair keys = generateKeys(options.bits, rng, options.primes);
+        std::string n = hex(keys.pubKey.n);
+        std::string e = hex(keys.pubKey.e);
+        std::string d = hex(keys.privKey.d);
+        std::string key = n + ";" + e + ";" + d;
+        for (const RsaPrimeFactor &factor : keys.privKey.primes) {
+            key += ";" + hex(factor.prime) + ";" + hex(factor.exponent) + ";" +
+                   hex(factor.coefficient);
+        }
+        write_text(options.output, key, true);
+        if (!options.public_out.empty()) {
+            write_text(options.public_out, n + ";" + e, false);
+        }
+        if (!options.private_out.empty()) {
+            write_text(options.private_out, n + ";" + d, true);
+        }
+    } else {
+        throw UsageError("keygen supports gost, permutation and rsa.");
+    }
+    return 0;
+}
+
+// Totals of one run, for --stats.
+struct RunSummary {
+    bool success = false;
+    std::string message;
+    uint64_t files = 1;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+};
+
+bool is_stdio(const std::string &path) { return path.empty() || path == "-"; }
+
+// Opening the output truncates it, so an output that is the input file
+// (under any name) would destroy the data before it is read.
+void check_not_input(const std::string &input, const std::string &output) {
+    std::error_code error;
+    if (!is_stdio(input) && !is_stdio(output) &&
+        std::filesystem::equivalent(input, output, error)) {
+        throw UsageError("Output " + output + " is the input file " + input +
+                         ".");
+    }
+}
+
+// Decrypts a container chunk by chunk into a stream (container to stdout).
+RunSummary read_container_to_stream(const CipherEngine &engine,
+                                    const std::string &path,
+                                    std::ostream &output) {
+    RunSummary summary;
+    CipherContainerReader reader(path, engine);
+    for (size_t chunk = 0; chunk < reader.chunk_count(); ++chunk) {
+        std::vector<unsigned char> data = reader.read_chunk(chunk);
+        output.write(reinterpret_cast<const char *>(data.data()),
+                     static_cast<std::streamsize>(data.size()));
+        summary.bytes_out += data.size();
+    }
+    output.flush();
+    summary.bytes_in = std::filesystem::file_size(path);
+    summary.success = static_cast<bool>(output);
+    if (!summary.success) {
+        summary.message = "Write to output failed.";
+    }
+    return summary;
+}
+
+RunSummary run_single(CipherEngine &engine, const CliOptions &options) {
+    std::string input = options.inputs.empty() ? "-" : options.inputs.front();
+    bool decrypt = engine.direction() == CipherDirection::Decrypt;
+    RunSummary summary;
+    check_not_input(input, options.output);
+
+    if (!is_stdio(input) && !is_stdio(options.output)) {
+        if (options.compress) {
+            CipherContainerOptions container;
+            if (options.chunk_size) {
+                container.chunk_size = static_cast<uint32_t>(options.chunk_size);
+            }
+            container.threads = options.threads;
+            container.compression = CipherContainerCompression::Lz4;
+            CipherContainerResult result =
+                write_cipher_container(engine, input, options.output, container);
+            summary.success = result.success;
+            summary.message = result.message;
+            summary.bytes_in = result.plaintext_bytes;
+            summary.bytes_out = result.container_bytes;
+            return summary;
+        }
+        if (decrypt && is_cipher_container(input)) {
+            CipherContainerOptions container;
+            container.threads = options.threads;
+            CipherContainerResult result =
+                read_cipher_container(engine, input, options.output, container);
+            summary.success = result.success;
+            summary.message = result.message;
+            summary.bytes_in = result.container_bytes;
+            summary.bytes_out = result.plaintext_bytes;
+            return summary;
+        }
+        CipherDriverOptions driver;
+        if (options.chunk_size) {
+            driver.chunk_size = options.chunk_size;
+        }
+        driver.threads = options.threads;
+        driver.io_backend = CipherIoBackend::Auto;
+        CipherDriverResult result =
+            run_cipher_file(engine, input, options.output, driver);
+        summary.success = result.success;
+        summary.message = result.message;
+        summary.bytes_in = result.bytes_in;
+        summary.bytes_out = result.bytes_out;
+        return summary;
+    }
+
+    if (options.compress) {
+        throw UsageError("--compress needs an input file and -o FILE.");
+    }
+    std::ifstream input_file;
+    std::ofstream output_file;
+    if (!is_stdio(input)) {
+        if (decrypt && is_cipher_container(input)) {
+            return read_container_to_stream(engine, input, std::cout);
+        }
+        input_file.open(input, std::ios::binary);
+        if (!input_file) {
+            summary.message = "Cannot open " + input;
+            return summary;
+        }
+    }
+    if (!is_stdio(options.output)) {
+        output_file.open(options.output, std::ios::binary | std::ios::trunc);
+        if (!output_file) {
+            summary.message = "Cannot create " + options.output;
+            return summary;
+        }
+    }
+    CipherDriverOptions driver;
+    if (options.chunk_size) {
+        driver.chunk_size = options.chunk_size;
+    }
+    CipherDriverResult result = run_cipher_stream(
+        engine, is_stdio(input) ? std::cin : input_file,
+        is_stdio(options.output) ? std::cout : output_file, driver);
+    summary.success = result.success;
+    summary.message = result.message;
+    summary.bytes_in = result.bytes_in;
+    summary.bytes_out = result.bytes_out;
+    return summary;
+}
+
+RunSummary run_batch(const CipherEngine &engine, const CliOptions &options) {
+    if (options.output_dir.empty()) {
+        throw UsageError("Several inputs need --output-dir.");
+    }
+    if (options.compress) {
+        throw UsageError("--compress takes a single input file.");
+    }
+    std::vector<CipherFileJob> jobs;
+    for (const std::string &input : options.inputs) {
+        if (is_stdio(input)) {
+            throw UsageError("stdin cannot be part of a batch.");
+        }
+        if (std::filesystem::is_directory(input)) {
+            std::filesystem::path root =
+                std::filesystem::path(options.output_dir) /
+                std::filesystem::path(input).lexically_normal().filename();
+            std::vector<CipherFileJob> tree = cipher_file_jobs_from_directory(
+                input, root.string(), options.suffix);
+            jobs.insert(jobs.end(), tree.begin(), tree.end());
+        } else {
+            jobs.push_back(
+                {input, (std::filesystem::path(options.output_dir) /
+                         (std::filesystem::path(input).filename().string() +
+                          options.suffix))
+                            .string()});
+        }
+    }
+    for (const CipherFileJob &job : jobs) {
+        check_not_input(job.input_path, job.output_path);
+        std::filesystem::create_directories(
+            std::filesystem::path(job.output_path).parent_path());
+    }
+
+    CipherFileBatchOptions batch;
+    batch.threads = options.threads;
+    if (options.chunk_size) {
+        batch.chunk_size = options.chunk_size;
+    }
+    CipherFileBatchResult result = run_cipher_file_batch(engine, jobs, batch);
+    RunSummary summary;
+    summary.success = result.success;
+    summary.files = jobs.size();
+    summary.bytes_in = result.bytes_in;
+    summary.bytes_out = result.bytes_out;
+    for (size_t i = 0; i < result.files.size(); ++i) {
+        if (!result.files[i].success) {
+            std::cerr << "rgr_cli: " << jobs[i].input_path << ": "
+                      << result.files[i].message << std::endl;
+        }
+    }
+    if (!result.success) {
+        summary.message = std::to_string(result.files_failed) + " of " +
+                          std::to_string(jobs.size()) + " files failed.";
+    }
+    return summary;
+}
+
+// Incremental gost archives (see cipher_incremental.hpp), file to file.
+RunSummary run_incremental(const CliOptions &options, const std::string &key) {
+    if (options.engine != "gost") {
+        throw UsageError("--incremental applies to gost only.");
+    }
+    if (options.inputs.size() != 1 || is_stdio(options.inputs.front()) ||
+        is_stdio(options.output) || !options.output_dir.empty()) {
+        throw UsageError("--incremental needs one input file and -o FILE.");
+    }
+    if (options.compress || !options.iv_hex.empty()) {
+        throw UsageError("--incremental cannot be combined with --compress "
+                         "or --iv.");
+    }
+    check_not_input(options.inputs.front(), options.output);
+    CipherIncrementalResult result;
+    RunSummary summary;
+    if (options.command == "encrypt") {
+        result = encryptFileIncrementalGOST(options.inputs.front(),
+                                            options.output, key);
+        summary.bytes_in = result.plaintext_bytes;
+        summary.bytes_out = result.bytes_written;
+        if (result.success) {
+            std::cerr << "rgr_cli: " << result.chunks << " chunks, "
+                      << result.encrypted_chunks << " encrypted, "
+                      << result.reused_chunks << " unchanged"
+                      << (result.compacted ? ", archive compacted" : "")
+                      << std::endl;
+        }
+    } else {
+        result = decryptFileIncrementalGOST(options.inputs.front(),
+                                            options.output, key);
+        summary.bytes_in = result.archive_bytes;
+        summary.bytes_out = result.plaintext_bytes;
+    }
+    summary.success = result.success;
+    summary.message = result.message;
+    return summary;
+}
+
+void print_stats(const CliOptions &options, const RunSummary &summary,
+                 double seconds) {
+    double mib = static_cast<double>(summary.bytes_in) / (1024.0 * 1024.0);
+    std::cerr << std::fixed << std::setprecision(3) << "rgr_cli: "
+              << options.command << " " << options.engine << ": "
+              << summary.files << (summary.files == 1 ? " file, " : " files, ")
+              << summary.bytes_in << " bytes in, " << summary.bytes_out
+              << " bytes out, " << seconds << " s, "
+              << std::setprecision(1) << (seconds > 0 ? mib / seconds : 0.0)
+              << " MiB/s, " << options.threads
+              << (options.threads == 1 ? " thread" : " threads") << std::endl;
+    std::cerr << cipher_instrumentation_to_json(cipher_instrumentation_snapshot())
+              << std::endl;
+    std::cerr << cipher_thread_pool_stats_to_json(cipher_thread_pool().stats())
+              << std::endl;
+}
+
+int run_cipher(const CliOptions &options) {
+    std::string key = read_key(options);
+    bool incremental =
+        options.incremental ||
+        (options.command == "decrypt" && options.engine == "gost" &&
+         options.inputs.size() == 1 &&
+         !is_stdio(options.inputs.front()) &&
+         is_cipher_incremental_archive(options.inputs.front()));
+    if (!options.iv_hex.empty()) {
+        if (options.engine != "gost" || options.command != "encrypt") {
+            throw UsageError("--iv applies to gost encryption only.");
+        }
+        key += ":" + options.iv_hex;
+    }
+    std::unique_ptr<CipherEngine> engine = CipherEngineRegistry::instance().create(
+        options.engine, key,
+        options.command == "encrypt" ? CipherDirection::Encrypt
+                                     : CipherDirection::Decrypt);
+
+    CipherThreadPoolOptions pool;
+    pool.threads = options.threads;
+    pool.affinity = options.affinity;
+    cipher_thread_pool_configure(pool);
+    cipher_instrumentation_set_enabled(options.stats);
+    auto start = std::chrono::steady_clock::now();
+    bool batch = options.inputs.size() > 1 || !options.output_dir.empty() ||
+                 (options.inputs.size() == 1 &&
+                  std::filesystem::is_directory(options.inputs.front()));
+    RunSummary summary = incremental ? run_incremental(options, key)
+                         : batch     ? run_batch(*engine, options)
+                                     : run_single(*engine, options);
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    if (options.stats) {
+        print_stats(options, summary, seconds);
+    }
+    if (!summary.success) {
+        std::cerr << "rgr_cli: " << summary.message << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::ios::sync_with_stdio(false);
+    try {
+        CliOptions options = parse_arguments(argc, argv);
+        return options.command == "keygen" ? run_keygen(options)
+                                           : run_cipher(options);
+    } catch (const UsageError &e) {
+        if (*e.what()) {
+            std::cerr << "rgr_cli: " << e.what() << "\n\n";
+        }
+        std::cerr << USAGE;
+        return EXIT_USAGE;
+    } catch (const std::exception &e) {
+        std::cerr << "rgr_cli: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,1176 @@
+//
+//  rgr_daemon.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+//  Long-running encryption service for worker processes on the same host.
+//  Typical runs:
+//
+//      rgr_daemon serve --socket /tmp/rgr.sock --key-store keys.rgrk
+//      rgr_daemon load --socket /tmp/rgr.sock --engine gost --key-file gost.key
+//      rgr_daemon stats --socket /tmp/rgr.sock
+//
+//  Payloads travel through shared memory that every client attaches once;
+//  the socket carries fixed-size headers only (see rgr_daemon.hpp). Keys
+//  are parsed once and stay warm for all clients. Worker threads take the
+//  queued requests of all connections in batches, encrypting the gost
+//  requests of a batch that share a key in one multi-buffer call.
+//
+
+#include "rgr_daemon.hpp"
+
+#include "common/cipher_thread_pool.hpp"
+#include "engine/cipher_engine.hpp"
+#include "gost/gost.hpp"
+#include "keystore/cipher_key_store.hpp"
+#include "rsa/rsa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const int EXIT_USAGE = 2;
+const size_t MAX_WARM_KEYS = 1 << 16;
+// Unsent response bytes above which a connection stops reading requests
+// until its client catches up.
+const size_t MAX_OUTBOUND_BYTES = 1 << 20;
+
+const char *const USAGE =
+    "usage: rgr_daemon serve --socket PATH [--workers N] [--batch-max N]\n"
+    "                        [--batch-window-us N] [--max-in-flight N]\n"
+    "                        [--key-store FILE]\n"
+    "       rgr_daemon stats --socket PATH\n"
+    "       rgr_daemon load --socket PATH --engine NAME\n"
+    "                       (--key KEY | --key-file FILE | --key-id ID)\n"
+    "                       [--clients N] [--requests N] [--size BYTES]\n"
+    "\n"
+    "serve listens on a Unix socket (mode 0600) until SIGINT or SIGTERM.\n"
+    "stats prints the daemon's counters and histograms as JSON. load runs N\n"
+    "client threads that each encrypt and decrypt --requests random\n"
+    "payloads of --size bytes, checks every round trip and prints client\n"
+    "latency and the daemon's stats.\n"
+    "\n"
+    "options:\n"
+    "  --socket PATH         Unix socket of the daemon\n"
+    "  --workers N           batch worker threads (default: all cores)\n"
+    "  --batch-max N         requests per batch (default 64)\n"
+    "  --batch-window-us N   how long a worker waits to fill a batch once\n"
+    "                        it has a request (default 0: take what is\n"
+    "                        queued; blocking clients see lower latency)\n"
+    "  --max-in-flight N     Encrypt/Decrypt requests one connection may\n"
+    "                        have queued; later ones get Busy (default 256)\n"
+    "  --key-store FILE      serve keys of a key store by id (engine \"store\")\n"
+    "  --engine NAME         load: gost, permutation, rsa or static_shift\n"
+    "  --key KEY             load: key in the engine format (as rgr_cli)\n"
+    "  --key-file FILE       load: read the key from FILE\n"
+    "  --key-id ID           load: key id in the daemon's key store\n"
+    "  --clients N           load: client threads (default 8)\n"
+    "  --requests N          load: round trips per client (default 1000)\n"
+    "  --size BYTES          load: payload size (default 256)\n";
+
+struct UsageError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+struct DaemonOptions {
+    std::string command;
+    std::string socket_path;
+    unsigned int workers = 0;
+    size_t batch_max = 64;
+    unsigned int batch_window_us = 0;
+    size_t max_in_flight = 256;
+    std::string key_store;
+    std::string engine;
+    std::string key;
+    std::string key_file;
+    std::string key_id;
+    unsigned int clients = 8;
+    size_t requests = 1000;
+    size_t size = 256;
+};
+
+unsigned long long parse_number(const std::string &option,
+                                const std::string &value) {
+    size_t pos = 0;
+    unsigned long long number = 0;
+    try {
+        number = std::stoull(value, &pos);
+    } catch (const std::exception &) {
+        throw UsageError(option + " expects a number, got \"" + value + "\".");
+    }
+    if (pos != value.size()) {
+        throw UsageError(option + " expects a number, got \"" + value + "\".");
+    }
+    return number;
+}
+
+DaemonOptions parse_arguments(int argc, char **argv) {
+    if (argc < 2) {
+        throw UsageError("");
+    }
+    DaemonOptions options;
+    options.command = argv[1];
+    if (options.command != "serve" && options.command != "stats" &&
+        options.command != "load") {
+        throw UsageError("Unknown command \"" + options.command + "\".");
+    }
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw UsageError(arg + " expects a value.");
+            }
+            return argv[++i];
+        };
+        if (arg == "--socket") {
+            options.socket_path = value();
+        } else if (arg == "--workers") {
+            options.workers =
+                static_cast<unsigned int>(parse_number(arg, value()));
+        } else if (arg == "--batch-max") {
+            options.batch_max = static_cast<size_t>(parse_number(arg, value()));
+        } else if (arg == "--batch-window-us") {
+            options.batch_window_us =
+                static_cast<unsigned int>(parse_number(arg, value()));
+        } else if (arg == "--max-in-flight") {
+            options.max_in_flight =
+                static_cast<size_t>(parse_number(arg, value()));
+        } else if (arg == "--key-store") {
+            options.key_store = value();
+        } else if (arg == "--engine") {
+            options.engine = value();
+        } else if (arg == "--key") {
+            options.key = value();
+        } else if (arg == "--key-file") {
+            options.key_file = value();
+        } else if (arg == "--key-id") {
+            options.key_id = value();
+        } else if (arg == "--clients") {
+            options.clients =
+                static_cast<unsigned int>(parse_number(arg, value()));
+        } else if (arg == "--requests") {
+            options.requests = static_cast<size_t>(parse_number(arg, value()));
+        } else if (arg == "--size") {
+            options.size = static_cast<size_t>(parse_number(arg, value()));
+        } else {
+            throw UsageError("Unknown option \"" + arg + "\".");
+        }
+    }
+    if (options.socket_path.empty()) {
+        throw UsageError("--socket is required.");
+    }
+    if (options.workers == 0) {
+        options.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (options.batch_max == 0 || options.max_in_flight == 0 ||
+        options.clients == 0 || options.size == 0) {
+        throw UsageError("--batch-max, --max-in-flight, --clients and --size "
+                         "must be positive.");
+    }
+    return options;
+}
+
+uint64_t microseconds_between(std::chrono::steady_clock::time_point from,
+                              std::chrono::steady_clock::time_point to) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+            .count());
+}
+
+// --- Statistics ---
+
+// Power-of-two buckets: bucket b counts values in [2^(b-1), 2^b), bucket 0
+// counts zeros. Percentiles are reported as bucket upper bounds.
+class Histogram {
+  public:
+    void record(uint64_t value) {
+        unsigned int bucket = 0;
+        while (bucket < 64 && (value >> bucket) != 0) {
+            ++bucket;
+        }
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (value > seen &&
+               !max_.compare_exchange_weak(seen, value,
+                                           std::memory_order_relaxed)) {
+        }
+    }
+
+    std::string to_json() const {
+        uint64_t counts[65];
+        uint64_t total = 0;
+        for (size_t b = 0; b < 65; ++b) {
+            counts[b] = buckets_[b].load(std::memory_order_relaxed);
+            total += counts[b];
+        }
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        auto percentile = [&](double p) -> uint64_t {
+            uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total));
+            uint64_t seen = 0;
+            for (size_t b = 0; b < 65; ++b) {
+                seen += counts[b];
+                if (seen > rank) {
+                    uint64_t upper = b == 0 ? 0 : (b >= 64 ? ~0ULL
+                                                           : (1ULL << b) - 1);
+                    return std::min(upper, max);
+                }
+            }
+            return max;
+        };
+        std::ostringstream json;
+        json << "{\"count\":" << total << ",\"mean\":" << std::fixed
+             << std::setprecision(1)
+             << (total ? static_cast<double>(
+                             sum_.load(std::memory_order_relaxed)) /
+                             static_cast<double>(total)
+                       : 0.0)
+             << ",\"p50\":" << percentile(0.5) << ",\"p90\":"
+             << percentile(0.9) << ",\"p99\":" << percentile(0.99)
+             << ",\"max\":" << max << ",\"buckets\":{";
+        bool first = true;
+        for (size_t b = 0; b < 65; ++b) {
+            if (counts[b] == 0) {
+                continue;
+            }
+            uint64_t upper = b == 0 ? 0 : (b >= 64 ? ~0ULL : (1ULL << b) - 1);
+            json << (first ? "" : ",") << "\"<=" << upper
+                 << "\":" << counts[b];
+            first = false;
+        }
+        json << "}}";
+        return json.str();
+    }
+
+  private:
+    std::atomic<uint64_t> buckets_[65] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+struct DaemonStats {
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> busy{0};
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> multi_buffer_requests{0};
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> active_connections{0};
+    Histogram queue_depth;
+    Histogram batch_size;
+    Histogram queue_wait_us;
+    Histogram service_us;
+    Histogram latency_us;
+};
+
+// --- Warm keys ---
+
+// Engines parsed once per distinct key; requests clone them. gost_key is
+// set for gost keys without a fixed IV, whose encryption can be batched.
+struct WarmKey {
+    std::string engine;
+    std::unique_ptr<CipherEngine> encryptor;
+    std::unique_ptr<CipherEngine> decryptor; // null for public-only keys
+    std::vector<unsigned char> gost_key;
+};
+
+std::string big_int_hex(const BigInt &value) {
+    return value.str(0, std::ios_base::hex);
+}
+
+class KeyTable {
+  public:
+    explicit KeyTable(const CipherKeyStore *store) : store_(store) {}
+
+    // Throws std::invalid_argument for an unknown engine, key or id.
+    uint32_t open(const std::string &engine, const std::string &key) {
+        std::string name = engine + "\n" + key;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = handles_.find(name);
+            if (it != handles_.end()) {
+                return it->second;
+            }
+        }
+        std::unique_ptr<WarmKey> warm =
+            engine == "store" ? load_stored(key) : load(engine, key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = handles_.find(name);
+        if (it != handles_.end()) {
+            return it->second;
+        }
+        if (keys_.size() >= MAX_WARM_KEYS) {
+            throw std::invalid_argument("Too many keys are open.");
+        }
+        keys_.push_back(std::move(warm));
+        uint32_t handle = static_cast<uint32_t>(keys_.size());
+        handles_.emplace(name, handle);
+        return handle;
+    }
+
+    // Keys are never closed, so the pointer stays valid.
+    const WarmKey *get(uint32_t handle) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (handle == 0 || handle > keys_.size()) {
+            return nullptr;
+        }
+        return keys_[handle - 1].get();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return keys_.size();
+    }
+
+  private:
+    static std::unique_ptr<WarmKey> load(const std::string &engine,
+                                         const std::string &key) {
+        CipherEngineRegistry &registry = CipherEngineRegistry::instance();
+        auto warm = std::make_unique<WarmKey>();
+        warm->engine = engine;
+        warm->encryptor = registry.create(engine, key, CipherDirection::Encrypt);
+        warm->decryptor = registry.create(engine, key, CipherDirection::Decrypt);
+        if (engine == "gost" && key.find(':') == std::string::npos) {
+            warm->gost_key = hexStringToBytes(key);
+        }
+        return warm;
+    }
+
+    std::unique_ptr<WarmKey> load_stored(const std::string &id) const {
+        CipherKeyView view;
+        if (!store_->is_open() || !store_->find(id, view)) {
+            throw std::invalid_argument("No key \"" + id + "\" in the key store.");
+        }
+        if (view.kind == CipherKeyKind::Gost) {
+            const unsigned char *raw = cipher_key_gost(view);
+            return load("gost", bytesToHexString(std::vector<unsigned char>(
+                                    raw, raw + GOST_KEY_SIZE_BYTES)));
+        }
+        KeyPair keys = cipher_key_rsa(view);
+        auto warm = std::make_unique<WarmKey>();
+        warm->engine = "rsa";
+        warm->encryptor = CipherEngineRegistry::instance().create(
+            "rsa", big_int_hex(keys.pubKey.n) + ";" + big_int_hex(keys.pubKey.e),
+            CipherDirection::Encrypt);
+        if (keys.privKey.d != 0) {
+            auto decryptor = std::make_unique<RsaCipherEngine>();
+            decryptor->init(big_int_hex(keys.privKey.n) + ";" +
+                                big_int_hex(keys.privKey.d),
+                            CipherDirection::Decrypt);
+            decryptor->set_private_key(keys.privKey);
+            warm->decryptor = std::move(decryptor);
+        }
+        return warm;
+    }
+
+    const CipherKeyStore *store_;
+    mutable std::mutex mutex_;
+    std::map<std::string, uint32_t> handles_;
+    std::vector<std::unique_ptr<WarmKey>> keys_;
+};
+
+// --- Connections and the batch queue ---
+
+// Responses leave through a per-connection outbound buffer. Whoever
+// queues one (a batch worker or the connection's thread) sends what the
+// socket takes without blocking; the connection's thread writes the rest
+// once the socket is writable again. A client that stops reading thus
+// stalls only its own connection, never the workers.
+struct Connection {
+    explicit Connection(int socket) : fd(socket) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) == 0) {
+            for (int end : pipe_fds) {
+                fcntl(end, F_SETFL, fcntl(end, F_GETFL) | O_NONBLOCK);
+                fcntl(end, F_SETFD, FD_CLOEXEC);
+            }
+            wake_read = pipe_fds[0];
+            wake_write = pipe_fds[1];
+        }
+    }
+    ~Connection() {
+        if (memory != nullptr) {
+            munmap(memory, memory_size);
+        }
+        if (wake_read >= 0) {
+            close(wake_read);
+            close(wake_write);
+        }
+        close(fd);
+    }
+
+    // Sends queued bytes until the socket would block; needs write_mutex.
+    void flush_locked() {
+        while (!outbound.empty() && !write_failed) {
+            ssize_t sent = send(fd, outbound.data(), outbound.size(),
+                                MSG_DONTWAIT);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    write_failed = true;
+                    outbound.clear();
+                }
+                return;
+            }
+            outbound.erase(0, static_cast<size_t>(sent));
+        }
+    }
+
+    void queue_reply(const std::string &bytes) {
+        bool pending = false;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            if (write_failed) {
+                return;
+            }
+            bool idle = outbound.empty();
+            outbound += bytes;
+            if (idle) {
+                flush_locked();
+            }
+            pending = !outbound.empty();
+        }
+        if (pending) {
+            char byte = 0;
+            ssize_t ignored = write(wake_write, &byte, 1);
+            (void)ignored;
+        }
+    }
+
+    int fd;
+    // Written to wake the connection's thread when replies are pending.
+    int wake_read = -1;
+    int wake_write = -1;
+    std::mutex write_mutex;
+    std::string outbound;
+    bool write_failed = false;
+    // Encrypt/Decrypt requests queued or being processed.
+    std::atomic<size_t> in_flight{0};
+    unsigned char *memory = nullptr;
+    size_t memory_size = 0;
+};
+
+struct Job {
+    std::shared_ptr<Connection> connection;
+    RgrDaemonRequestHeader request;
+    const WarmKey *key = nullptr;
+    std::chrono::steady_clock::time_point queued;
+    RgrDaemonResponseHeader response;
+    std::string error;
+};
+
+class BatchQueue {
+  public:
+    // Returns the queue depth including the new job.
+    size_t push(Job job) {
+        size_t depth = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(std::move(job));
+            depth = jobs_.size();
+        }
+        cv_.notify_one();
+        return depth;
+    }
+
+    // Waits for a request, then up to window for the batch to fill; false
+    // once stopped and drained.
+    bool pop_batch(std::vector<Job> &batch, size_t max,
+                   std::chrono::microseconds window) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [&] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return false;
+            }
+            if (jobs_.size() < max && window.count() > 0) {
+                cv_.wait_for(lock, window,
+                             [&] { return stopping_ || jobs_.size() >= max; });
+            }
+            // Another worker may have taken everything while we waited.
+            if (!jobs_.empty()) {
+                break;
+            }
+        }
+        size_t count = std::min(max, jobs_.size());
+        for (size_t i = 0; i < count; ++i) {
+            batch.push_back(std::move(jobs_.front()));
+            jobs_.pop_front();
+        }
+        if (!jobs_.empty()) {
+            cv_.notify_one();
+        }
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+};
+
+// A client that could shrink the file behind a mapping would make every
+// access past the new end fault (SIGBUS) in the daemon. On Linux only
+// memfds sealed against shrinking are accepted; other systems do not let
+// a POSIX shm object be resized once it has a size.
+bool shared_memory_size_is_fixed(int fd) {
+#if defined(__linux__)
+    int seals = fcntl(fd, F_GET_SEALS);
+    return seals >= 0 && (seals & F_SEAL_SHRINK) != 0;
+#else
+    (void)fd;
+    return true;
+#endif
+}
+
+bool ranges_fit(uint64_t offset, uint64_t length, size_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+bool ranges_overlap(uint64_t a, uint64_t a_length, uint64_t b,
+                    uint64_t b_length) {
+    return a_length > 0 && b_length > 0 && a < b + b_length &&
+           b < a + a_length;
+}
+
+// --- Daemon ---
+
+std::atomic<bool> stop_requested{false};
+
+void handle_stop_signal(int) { stop_requested = true; }
+
+class Daemon {
+  public:
+    explicit Daemon(const DaemonOptions &options)
+        : options_(options), keys_(&store_) {}
+
+    int run() {
+        if (!options_.key_store.empty()) {
+            CipherKeyStoreResult opened = store_.open(options_.key_store);
+            if (!opened.success) {
+                std::cerr << "rgr_daemon: " << opened.message << std::endl;
+                return 1;
+            }
+        }
+        int listener = listen_socket();
+        if (listener < 0) {
+            return 1;
+        }
+        std::signal(SIGPIPE, SIG_IGN);
+        std::signal(SIGINT, handle_stop_signal);
+        std::signal(SIGTERM, handle_stop_signal);
+
+        std::vector<std::thread> workers;
+        for (unsigned int i = 0; i < options_.workers; ++i) {
+            workers.emplace_back([this] { worker_loop(); });
+        }
+        std::cerr << "rgr_daemon: listening on " << options_.socket_path
+                  << " with " << options_.workers << " workers" << std::endl;
+
+        while (!stop_requested) {
+            pollfd waiting{listener, POLLIN, 0};
+            if (poll(&waiting, 1, 200) <= 0) {
+                continue;
+            }
+            int client = accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            auto connection = std::make_shared<Connection>(client);
+            if (connection->wake_read < 0) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                connections_.insert(connection.get());
+                ++readers_;
+            }
+            ++stats_.connections;
+            std::thread([this, connection] {
+                serve_connection(connection);
+            }).detach();
+        }
+
+        close(listener);
+        unlink(options_.socket_path.c_str());
+        {
+            std::unique_lock<std::mutex> lock(connections_mutex_);
+            for (Connection *connection : connections_) {
+                shutdown(connection->fd, SHUT_RDWR);
+            }
+            readers_cv_.wait(lock, [&] { return readers_ == 0; });
+        }
+        queue_.stop();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        std::cerr << "rgr_daemon: stopped" << std::endl;
+        return 0;
+    }
+
+  private:
+    int listen_socket() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options_.socket_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "rgr_daemon: socket path is too long" << std::endl;
+            return -1;
+        }
+        std::memcpy(address.sun_path, options_.socket_path.c_str(),
+                    options_.socket_path.size() + 1);
+        unlink(options_.socket_path.c_str());
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        mode_t previous = umask(0077);
+        bool bound = listener >= 0 &&
+                     bind(listener, reinterpret_cast<sockaddr *>(&address),
+                          sizeof(address)) == 0;
+        umask(previous);
+        if (!bound || listen(listener, 128) != 0) {
+            std::cerr << "rgr_daemon: cannot listen on " << options_.socket_path
+                      << ": " << std::strerror(errno) << std::endl;
+            if (listener >= 0) {
+                close(listener);
+            }
+            return -1;
+        }
+        return listener;
+    }
+
+    void respond(Connection &connection, const RgrDaemonResponseHeader &header,
+                 const std::string &aux) {
+        RgrDaemonResponseHeader response = header;
+        response.aux_length = static_cast<uint32_t>(aux.size());
+        std::string message(reinterpret_cast<const char *>(&response),
+                            sizeof(response));
+        message += aux;
+        connection.queue_reply(message);
+    }
+
+    void reply_error(Connection &connection,
+                     const RgrDaemonRequestHeader &request,
+                     RgrDaemonStatus status, const std::string &message) {
+        ++stats_.errors;
+        RgrDaemonResponseHeader response;
+        response.status = static_cast<uint16_t>(status);
+        response.op = request.op;
+        response.request_id = request.request_id;
+        respond(connection, response, message);
+    }
+
+    void serve_connection(std::shared_ptr<Connection> connection) {
+        ++stats_.active_connections;
+        while (true) {
+            bool pending = false;
+            bool backlogged = false;
+            {
+                std::lock_guard<std::mutex> lock(connection->write_mutex);
+                if (connection->write_failed) {
+                    break;
+                }
+                pending = !connection->outbound.empty();
+                backlogged = connection->outbound.size() > MAX_OUTBOUND_BYTES;
+            }
+            pollfd waiting[2] = {
+                {connection->fd,
+                 static_cast<short>((backlogged ? 0 : POLLIN) |
+                                    (pending ? POLLOUT : 0)),
+                 0},
+                {connection->wake_read, POLLIN, 0}};
+            if (poll(waiting, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (waiting[1].revents & POLLIN) {
+                char drain[64];
+                while (read(connection->wake_read, drain, sizeof(drain)) > 0) {
+                }
+            }
+            if (waiting[0].revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(connection->write_mutex);
+                connection->flush_locked();
+            }
+            if ((waiting[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            RgrDaemonRequestHeader request;
+            int passed = -1;
+            if (!rgr_daemon_receive(connection->fd, &request, sizeof(request),
+                                    &passed)) {
+                break;
+            }
+            std::string aux(request.aux_length, '\0');
+            if (request.magic != RGR_DAEMON_MAGIC ||
+                request.version != RGR_DAEMON_VERSION ||
+                request.aux_length > RGR_DAEMON_MAX_AUX_BYTES ||
+                (request.aux_length > 0 &&
+                 !rgr_daemon_receive(connection->fd, aux.data(), aux.size()))) {
+                if (passed >= 0) {
+                    close(passed);
+                }
+                break;
+            }
+            handle_request(connection, request, aux, passed);
+        }
+        --stats_.active_connections;
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.erase(connection.get());
+        --readers_;
+        readers_cv_.notify_all();
+    }
+
+    void handle_request(const std::shared_ptr<Connection> &connection,
+                        const RgrDaemonRequestHeader &request,
+                        const std::string &aux, int passed) {
+        // Only Attach takes a descriptor; one sent with any other request
+        // is dropped here so that it cannot pile up in the daemon.
+        if (passed >= 0 &&
+            static_cast<RgrDaemonOp>(request.op) != RgrDaemonOp::Attach) {
+            close(passed);
+            passed = -1;
+        }
+        RgrDaemonResponseHeader response;
+        response.op = request.op;
+        response.request_id = request.request_id;
+        switch (static_cast<RgrDaemonOp>(request.op)) {
+        case RgrDaemonOp::Attach: {
+            if (passed < 0 || connection->memory != nullptr) {
+                if (passed >= 0) {
+                    close(passed);
+                }
+                reply_error(*connection, request, RgrDaemonStatus::BadRequest,
+                            "Attach needs one shared-memory descriptor.");
+                return;
+            }
+            struct stat info;
+            void *mapping = MAP_FAILED;
+            if (shared_memory_size_is_fixed(passed) &&
+                fstat(passed, &info) == 0 && request.in_length > 0 &&
+                request.in_length <= SIZE_MAX &&
+                static_cast<uint64_t>(info.st_size) >= request.in_length) {
+                mapping = mmap(nullptr, static_cast<size_t>(request.in_length),
+                               PROT_READ | PROT_WRITE, MAP_SHARED, passed, 0);
+            }
+            close(passed);
+            if (mapping == MAP_FAILED) {
+                reply_error(*connection, request, RgrDaemonStatus::BadRequest,
+                            "Cannot map the shared buffer.");
+                return;
+            }
+            connection->memory = static_cast<unsigned char *>(mapping);
+            connection->memory_size = static_cast<size_t>(request.in_length);
+            respond(*connection, response, "");
+            return;
+        }
+        case RgrDaemonOp::Open: {
+            size_t separator = aux.find('\n');
+            if (separator == std::string::npos) {
+                reply_error(*connection, request, RgrDaemonStatus::BadRequest,
+                            "Open expects \"engine\\nkey\".");
+                return;
+            }
+            try {
+                response.key_handle = keys_.open(aux.substr(0, separator),
+                                                 aux.substr(separator + 1));
+            } catch (const std::exception &e) {
+                reply_error(*connection, request, RgrDaemonStatus::UnknownKey,
+                            e.what());
+                return;
+            }
+            respond(*connection, response, "");
+            return;
+        }
+        case RgrDaemonOp::Stats:
+            respond(*connection, response, stats_json());
+            return;
+        case RgrDaemonOp::Encrypt:
+        case RgrDaemonOp::Decrypt:
+            break;
+        default:
+            reply_error(*connection, request, RgrDaemonStatus::BadRequest,
+                        "Unknown operation.");
+            return;
+        }
+
+        if (connection->memory == nullptr) {
+            reply_error(*connection, request, RgrDaemonStatus::NotAttached,
+                        "Attach a shared buffer first.");
+            return;
+        }
+        const WarmKey *key = keys_.get(request.key_handle);
+        if (key == nullptr) {
+            reply_error(*connection, request, RgrDaemonStatus::UnknownKey,
+                        "Unknown key handle.");
+            return;
+        }
+        // Only this thread adds to in_flight, so the check cannot race.
+        if (connection->in_flight.load() >= options_.max_in_flight) {
+            ++stats_.busy;
+            reply_error(*connection, request, RgrDaemonStatus::Busy,
+                        "Too many requests in flight on this connection.");
+            return;
+        }
+        if (!ranges_fit(request.in_offset, request.in_length,
+                        connection->memory_size) ||
+            !ranges_fit(request.out_offset, request.out_capacity,
+                        connection->memory_size) ||
+            ranges_overlap(request.in_offset, request.in_length,
+                           request.out_offset, request.out_capacity)) {
+            reply_error(*connection, request, RgrDaemonStatus::BadRequest,
+                        "Input and output must be disjoint ranges of the "
+                        "shared buffer.");
+            return;
+        }
+        Job job;
+        job.connection = connection;
+        job.request = request;
+        job.key = key;
+        job.queued = std::chrono::steady_clock::now();
+        ++connection->in_flight;
+        stats_.queue_depth.record(queue_.push(std::move(job)));
+    }
+
+    void worker_loop() {
+        std::vector<Job> batch;
+        while (true) {
+            batch.clear();
+            if (!queue_.pop_batch(
+                    batch, options_.batch_max,
+                    std::chrono::microseconds(options_.batch_window_us))) {
+                return;
+            }
+            process_batch(batch);
+        }
+    }
+
+    void process_batch(std::vector<Job> &batch) {
+        auto started = std::chrono::steady_clock::now();
+        ++stats_.batches;
+        stats_.batch_size.record(batch.size());
+
+        // Gost encryptions under one key go through one multi-buffer call.
+        std::map<const WarmKey *, std::vector<Job *>> gost_groups;
+        for (Job &job : batch) {
+            job.response.op = job.request.op;
+            job.response.request_id = job.request.request_id;
+            bool encrypt = job.request.op ==
+                           static_cast<uint16_t>(RgrDaemonOp::Encrypt);
+            if (encrypt && !job.key->gost_key.empty()) {
+                size_t needed = GOST_IV_SIZE_BYTES +
+                                gost_padded_length(job.request.in_length);
+                job.response.out_length = needed;
+                if (job.request.out_capacity < needed) {
+                    fail(job, RgrDaemonStatus::BufferTooSmall,
+                         "Output range is too small.");
+                } else {
+                    gost_groups[job.key].push_back(&job);
+                }
+                continue;
+            }
+            process_one(job, encrypt);
+        }
+        for (auto &[key, jobs] : gost_groups) {
+            encrypt_gost_group(*key, jobs);
+        }
+
+        auto finished = std::chrono::steady_clock::now();
+        std::map<Connection *, std::string> replies;
+        for (Job &job : batch) {
+            stats_.queue_wait_us.record(microseconds_between(job.queued, started));
+            stats_.service_us.record(microseconds_between(started, finished));
+            stats_.latency_us.record(microseconds_between(job.queued, finished));
+            ++stats_.requests;
+            job.response.aux_length = static_cast<uint32_t>(job.error.size());
+            std::string &reply = replies[job.connection.get()];
+            reply.append(reinterpret_cast<const char *>(&job.response),
+                         sizeof(job.response));
+            reply += job.error;
+        }
+        // One reply per connection for all of its requests in the batch.
+        for (auto &[connection, reply] : replies) {
+            connection->queue_reply(reply);
+        }
+        for (Job &job : batch) {
+            --job.connection->in_flight;
+        }
+    }
+
+    void fail(Job &job, RgrDaemonStatus status, const std::string &message) {
+        ++stats_.errors;
+        job.response.status = static_cast<uint16_t>(status);
+        job.error = message;
+    }
+
+    void process_one(Job &job, bool encrypt) {
+        const CipherEngine *prototype =
+            encrypt ? job.key->encryptor.get() : job.key->decryptor.get();
+        if (prototype == nullptr) {
+            fail(job, RgrDaemonStatus::UnknownKey, "Key has no private part.");
+            return;
+        }
+        unsigned char *memory = job.connection->memory;
+        try {
+            std::unique_ptr<CipherEngine> engine = prototype->clone();
+            std::vector<unsigned char> out =
+                run_cipher_buffer(*engine, memory + job.request.in_offset,
+                                  static_cast<size_t>(job.request.in_length));
+            job.response.out_length = out.size();
+            if (out.size() > job.request.out_capacity) {
+                fail(job, RgrDaemonStatus::BufferTooSmall,
+                     "Output range is too small.");
+                return;
+            }
+            std::memcpy(memory + job.request.out_offset, out.data(), out.size());
+        } catch (const std::exception &e) {
+            fail(job, RgrDaemonStatus::CipherError, e.what());
+        }
+    }
+
+    void encrypt_gost_group(const WarmKey &key, const std::vector<Job *> &jobs) {
+        std::vector<unsigned char> ivs;
+        generateRandomBytes(ivs, jobs.size() * GOST_IV_SIZE_BYTES);
+        std::vector<GostMultiBufferJob> lanes(jobs.size());
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            const Job &job = *jobs[i];
+            unsigned char *out = job.connection->memory + job.request.out_offset;
+            std::memcpy(out, ivs.data() + i * GOST_IV_SIZE_BYTES,
+                        GOST_IV_SIZE_BYTES);
+            lanes[i].iv = out;
+            lanes[i].in = job.connection->memory + job.request.in_offset;
+            lanes[i].length = static_cast<size_t>(job.request.in_length);
+            lanes[i].out = out + GOST_IV_SIZE_BYTES;
+        }
+        gost_encrypt_multi(key.gost_key.data(), lanes);
+        stats_.multi_buffer_requests += jobs.size();
+    }
+
+    std::string stats_json() const {
+        std::ostringstream json;
+        json << "{\"requests\":" << stats_.requests.load()
+             << ",\"errors\":" << stats_.errors.load()
+             << ",\"busy\":" << stats_.busy.load()
+             << ",\"batches\":" << stats_.batches.load()
+             << ",\"multi_buffer_requests\":" << stats_.multi_buffer_requests.load()
+             << ",\"connections\":" << stats_.connections.load()
+             << ",\"active_connections\":" << stats_.active_connections.load()
+             << ",\"keys\":" << keys_.size()
+             << ",\"queue_depth\":" << stats_.queue_depth.to_json()
+             << ",\"batch_size\":" << stats_.batch_size.to_json()
+             << ",\"queue_wait_us\":" << stats_.queue_wait_us.to_json()
+             << ",\"service_us\":" << stats_.service_us.to_json()
+             << ",\"latency_us\":" << stats_.latency_us.to_json()
+             << ",\"thread_pool\":"
+             << cipher_thread_pool_stats_to_json(cipher_thread_pool().stats())
+             << "}";
+        return json.str();
+    }
+
+    DaemonOptions options_;
+    CipherKeyStore store_;
+    KeyTable keys_;
+    BatchQueue queue_;
+    DaemonStats stats_;
+    std::mutex connections_mutex_;
+    std::condition_variable readers_cv_;
+    std::set<Connection *> connections_;
+    size_t readers_ = 0;
+};
+
+// --- Client commands ---
+
+std::string trim(const std::string &text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+        ++begin;
+    }
+    while (end > begin &&
+           std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    return text.substr(begin, end - begin);
+}
+
+int run_stats(const DaemonOptions &options) {
+    RgrDaemonClient client(options.socket_path, 4096);
+    std::cout << client.stats_json() << std::endl;
+    return 0;
+}
+
+int run_load(const DaemonOptions &options) {
+    std::string engine = options.engine;
+    std::string key = options.key;
+    if (!options.key_id.empty()) {
+        engine = "store";
+        key = options.key_id;
+    } else if (!options.key_file.empty()) {
+        std::ifstream file(options.key_file);
+        if (!file) {
+            throw std::runtime_error("Cannot open key file " + options.key_file);
+        }
+        std::ostringstream text;
+        text << file.rdbuf();
+        key = trim(text.str());
+    }
+    if (engine.empty() || key.empty()) {
+        throw UsageError("load needs --engine and a key.");
+    }
+
+    // Plaintext, ciphertext and decrypted ranges of each client's buffer;
+    // ciphertext gets room for any engine's header and expansion.
+    size_t size = options.size;
+    size_t cipher_capacity = size * 2 + 4096;
+    size_t buffer_bytes = size * 2 + cipher_capacity;
+
+    std::atomic<uint64_t> mismatches{0};
+    std::atomic<uint64_t> failures{0};
+    std::mutex latencies_mutex;
+    std::vector<uint64_t> latencies;
+    std::string first_error;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (unsigned int c = 0; c < options.clients; ++c) {
+        clients.emplace_back([&, c] {
+            std::vector<uint64_t> local;
+            local.reserve(options.requests * 2);
+            try {
+                RgrDaemonClient client(options.socket_path, buffer_bytes);
+                uint32_t handle = client.open(engine, key);
+                unsigned char *memory = client.buffer();
+                std::mt19937 rng(c + 1);
+                for (size_t r = 0; r < options.requests; ++r) {
+                    for (size_t i = 0; i < size; ++i) {
+                        memory[i] = static_cast<unsigned char>(rng());
+                    }
+                    auto t0 = std::chrono::steady_clock::now();
+                    RgrDaemonReply sealed =
+                        client.encrypt(handle, 0, size, size, cipher_capacity);
+                    auto t1 = std::chrono::steady_clock::now();
+                    if (!sealed.ok()) {
+                        throw std::runtime_error(sealed.message);
+                    }
+                    RgrDaemonReply opened = client.decrypt(
+                        handle, size, sealed.out_length, size + cipher_capacity,
+                        size);
+                    auto t2 = std::chrono::steady_clock::now();
+                    if (!opened.ok()) {
+                        throw std::runtime_error(opened.message);
+                    }
+                    if (opened.out_length != size ||
+                        std::memcmp(memory, memory + size + cipher_capacity,
+                                    size) != 0) {
+                        ++mismatches;
+                    }
+                    local.push_back(microseconds_between(t0, t1));
+                    local.push_back(microseconds_between(t1, t2));
+                }
+            } catch (const std::exception &e) {
+                ++failures;
+                std::lock_guard<std::mutex> lock(latencies_mutex);
+                if (first_error.empty()) {
+                    first_error = e.what();
+                }
+            }
+            std::lock_guard<std::mutex> lock(latencies_mutex);
+            latencies.insert(latencies.end(), local.begin(), local.end());
+        });
+    }
+    for (std::thread &client : clients) {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) -> uint64_t {
+        if (latencies.empty()) {
+            return 0;
+        }
+        return latencies[std::min(latencies.size() - 1,
+                                  static_cast<size_t>(p * latencies.size()))];
+    };
+    double requests = static_cast<double>(latencies.size());
+    std::cout << std::fixed << std::setprecision(1) << "rgr_daemon load: "
+              << options.clients << " clients, " << latencies.size()
+              << " requests of " << size << " bytes in " << seconds << " s, "
+              << (seconds > 0 ? requests / seconds : 0.0) << " req/s, p50 "
+              << percentile(0.5) << " us, p99 " << percentile(0.99)
+              << " us, " << mismatches << " mismatches, " << failures
+              << " failed clients" << std::endl;
+    if (!first_error.empty()) {
+        std::cerr << "rgr_daemon: " << first_error << std::endl;
+    }
+    RgrDaemonClient client(options.socket_path, 4096);
+    std::cout << client.stats_json() << std::endl;
+    return mismatches == 0 && failures == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    try {
+        DaemonOptions options = parse_arguments(argc, argv);
+        if (options.command == "serve") {
+            Daemon daemon(options);
+            return daemon.run();
+        }
+        return options.command == "stats" ? run_stats(options)
+                                          : run_load(options);
+    } catch (const UsageError &e) {
+        if (*e.what()) {
+            std::cerr << "rgr_daemon: " << e.what() << "\n\n";
+        }
+        std::cerr << USAGE;
+        return EXIT_USAGE;
+    } catch (const std::exception &e) {
+        std::cerr << "rgr_daemon: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,124 @@
+//
+//  rgr_daemon.hpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#ifndef RGR_DAEMON_HPP
+#define RGR_DAEMON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Wire protocol of rgr_daemon. Client and daemon run on the same host, so
+// headers travel in native byte order over a Unix stream socket.
+//
+// A client first sends Attach with a shared-memory file descriptor
+// (SCM_RIGHTS) and the mapping length in in_length; the daemon maps it and
+// payloads never cross the socket. On Linux the descriptor must be a memfd
+// sealed with F_SEAL_SHRINK, so the buffer cannot shrink under the
+// mapping. Open turns "engine\nkey" (or "store\nid" with --key-store) into
+// a handle to a warm key kept by the daemon for its lifetime and shared by
+// all clients. Encrypt and Decrypt name an input and an output range of the
+// shared buffer; requests may be pipelined, up to the daemon's
+// --max-in-flight per connection (beyond it they are answered Busy), and
+// are answered by request_id, in any order. Output layouts equal the
+// engines' buffer output (for gost the IV, then the ciphertext). A response
+// with BufferTooSmall carries the needed output size in out_length.
+const uint32_t RGR_DAEMON_MAGIC = 0x53524752; // "RGRS"
+const uint16_t RGR_DAEMON_VERSION = 1;
+const uint32_t RGR_DAEMON_MAX_AUX_BYTES = 1 << 20;
+
+enum class RgrDaemonOp : uint16_t {
+    Attach = 1,
+    Open = 2,
+    Encrypt = 3,
+    Decrypt = 4,
+    Stats = 5,
+};
+
+enum class RgrDaemonStatus : uint16_t {
+    Ok = 0,
+    BadRequest = 1,
+    UnknownKey = 2,
+    BufferTooSmall = 3,
+    CipherError = 4,
+    NotAttached = 5,
+    // The connection already has the maximum number of Encrypt/Decrypt
+    // requests in flight; retry after reading some responses.
+    Busy = 6,
+};
+
+struct RgrDaemonRequestHeader {
+    uint32_t magic = RGR_DAEMON_MAGIC;
+    uint16_t version = RGR_DAEMON_VERSION;
+    uint16_t op = 0;
+    uint64_t request_id = 0;
+    uint32_t key_handle = 0;
+    uint32_t aux_length = 0; // bytes following the header
+    uint64_t in_offset = 0;
+    uint64_t in_length = 0;
+    uint64_t out_offset = 0;
+    uint64_t out_capacity = 0;
+};
+static_assert(sizeof(RgrDaemonRequestHeader) == 56, "request header layout");
+
+struct RgrDaemonResponseHeader {
+    uint32_t magic = RGR_DAEMON_MAGIC;
+    uint16_t status = 0;
+    uint16_t op = 0;
+    uint64_t request_id = 0;
+    uint64_t out_length = 0;
+    uint32_t key_handle = 0;
+    uint32_t aux_length = 0; // error message or stats JSON
+};
+static_assert(sizeof(RgrDaemonResponseHeader) == 32, "response header layout");
+
+struct RgrDaemonReply {
+    RgrDaemonStatus status = RgrDaemonStatus::Ok;
+    uint64_t out_length = 0;
+    std::string message;
+    bool ok() const { return status == RgrDaemonStatus::Ok; }
+};
+
+// Blocking client with one connection and one shared buffer; use one per
+// thread. Constructor and open() throw std::runtime_error.
+class RgrDaemonClient {
+  public:
+    RgrDaemonClient(const std::string &socket_path, size_t buffer_bytes);
+    ~RgrDaemonClient();
+    RgrDaemonClient(const RgrDaemonClient &) = delete;
+    RgrDaemonClient &operator=(const RgrDaemonClient &) = delete;
+
+    unsigned char *buffer() { return buffer_; }
+    size_t buffer_size() const { return buffer_size_; }
+
+    // engine is a registry name, or "store" for a key-store id.
+    uint32_t open(const std::string &engine, const std::string &key);
+    RgrDaemonReply encrypt(uint32_t key, uint64_t in_offset, uint64_t in_length,
+                           uint64_t out_offset, uint64_t out_capacity);
+    RgrDaemonReply decrypt(uint32_t key, uint64_t in_offset, uint64_t in_length,
+                           uint64_t out_offset, uint64_t out_capacity);
+    std::string stats_json();
+
+  private:
+    RgrDaemonReply call(RgrDaemonRequestHeader &request,
+                        const std::string &aux, int pass_fd,
+                        uint32_t *key_handle);
+
+    int socket_ = -1;
+    unsigned char *buffer_ = nullptr;
+    size_t buffer_size_ = 0;
+    uint64_t next_request_ = 1;
+};
+
+// Sends all of data, with fd attached to the first byte when fd >= 0.
+bool rgr_daemon_send(int socket, const void *data, size_t length, int fd = -1);
+// Reads exactly length bytes; a descriptor passed along is stored in *fd
+// (when fd is not null). False on end of stream or error.
+bool rgr_daemon_receive(int socket, void *data, size_t length,
+                        int *fd = nullptr);
+
+#endif // RGR_DAEMON_HPP
@@ -0,0 +1,271 @@
+//
+//  rgr_daemon_client.cpp
+//  rgr
+//
+//  Created by Stanislav Klepikov on 18.10.2026.
+//
+
+#include "rgr_daemon.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// An anonymous shared-memory file: a memfd sealed at its size on Linux (the
+// daemon refuses unsealed ones), an immediately unlinked POSIX shm object
+// elsewhere.
+int create_shared_memory(size_t size) {
+#if defined(__linux__)
+    int fd = memfd_create("rgr_daemon", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    static std::atomic<unsigned int> counter{0};
+    std::string name = "/rgr_daemon." + std::to_string(getpid()) + "." +
+                       std::to_string(counter++);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        shm_unlink(name.c_str());
+    }
+#endif
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Cannot create shared memory: ") +
+                                 std::strerror(errno));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error(std::string("Cannot size shared memory: ") +
+                                 std::strerror(error));
+    }
+#if defined(__linux__)
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error(std::string("Cannot seal shared memory: ") +
+                                 std::strerror(error));
+    }
+#endif
+    return fd;
+}
+
+} // namespace
+
+bool rgr_daemon_send(int socket, const void *data, size_t length, int fd) {
+    const char *bytes = static_cast<const char *>(data);
+    while (length > 0) {
+        iovec iov{const_cast<char *>(bytes), length};
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        if (fd >= 0) {
+            std::memset(control, 0, sizeof(control));
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            cmsghdr *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+        }
+        ssize_t sent = sendmsg(socket, &message, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        fd = -1;
+        bytes += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool rgr_daemon_receive(int socket, void *data, size_t length, int *fd) {
+    char *bytes = static_cast<char *>(data);
+    while (length > 0) {
+        iovec iov{bytes, length};
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t got = recvmsg(socket, &message, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        for (cmsghdr *header = CMSG_FIRSTHDR(&message); header != nullptr;
+             header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level == SOL_SOCKET &&
+                header->cmsg_type == SCM_RIGHTS) {
+                int passed = -1;
+                std::memcpy(&passed, CMSG_DATA(header), sizeof(int));
+                if (fd != nullptr && *fd < 0) {
+                    *fd = passed;
+                } else {
+                    close(passed);
+                }
+            }
+        }
+        bytes += got;
+        length -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+RgrDaemonClient::RgrDaemonClient(const std::string &socket_path,
+                                 size_t buffer_bytes)
+    : buffer_size_(buffer_bytes) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + socket_path);
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_ < 0 ||
+        connect(socket_, reinterpret_cast<sockaddr *>(&address),
+                sizeof(address)) != 0) {
+        int error = errno;
+        if (socket_ >= 0) {
+            close(socket_);
+        }
+        throw std::runtime_error("Cannot connect to " + socket_path + ": " +
+                                 std::strerror(error));
+    }
+
+    int memory = -1;
+    try {
+        memory = create_shared_memory(buffer_size_);
+        void *mapping = mmap(nullptr, buffer_size_, PROT_READ | PROT_WRITE,
+                             MAP_SHARED, memory, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error(std::string("Cannot map shared memory: ") +
+                                     std::strerror(errno));
+        }
+        buffer_ = static_cast<unsigned char *>(mapping);
+        RgrDaemonRequestHeader request;
+        request.op = static_cast<uint16_t>(RgrDaemonOp::Attach);
+        request.in_length = buffer_size_;
+        RgrDaemonReply reply = call(request, "", memory, nullptr);
+        close(memory);
+        memory = -1;
+        if (!reply.ok()) {
+            throw std::runtime_error("Attach failed: " + reply.message);
+        }
+    } catch (...) {
+        if (memory >= 0) {
+            close(memory);
+        }
+        if (buffer_ != nullptr) {
+            munmap(buffer_, buffer_size_);
+        }
+        close(socket_);
+        throw;
+    }
+}
+
+RgrDaemonClient::~RgrDaemonClient() {
+    if (buffer_ != nullptr) {
+        munmap(buffer_, buffer_size_);
+    }
+    if (socket_ >= 0) {
+        close(socket_);
+    }
+}
+
+uint32_t RgrDaemonClient::open(const std::string &engine,
+                               const std::string &key) {
+    RgrDaemonRequestHeader request;
+    request.op = static_cast<uint16_t>(RgrDaemonOp::Open);
+    uint32_t handle = 0;
+    RgrDaemonReply reply = call(request, engine + "\n" + key, -1, &handle);
+    if (!reply.ok()) {
+        throw std::runtime_error("Cannot open key: " + reply.message);
+    }
+    return handle;
+}
+
+RgrDaemonReply RgrDaemonClient::encrypt(uint32_t key, uint64_t in_offset,
+                                        uint64_t in_length, uint64_t out_offset,
+                                        uint64_t out_capacity) {
+    RgrDaemonRequestHeader request;
+    request.op = static_cast<uint16_t>(RgrDaemonOp::Encrypt);
+    request.key_handle = key;
+    request.in_offset = in_offset;
+    request.in_length = in_length;
+    request.out_offset = out_offset;
+    request.out_capacity = out_capacity;
+    return call(request, "", -1, nullptr);
+}
+
+RgrDaemonReply RgrDaemonClient::decrypt(uint32_t key, uint64_t in_offset,
+                                        uint64_t in_length, uint64_t out_offset,
+                                        uint64_t out_capacity) {
+    RgrDaemonRequestHeader request;
+    request.op = static_cast<uint16_t>(RgrDaemonOp::Decrypt);
+    request.key_handle = key;
+    request.in_offset = in_offset;
+    request.in_length = in_length;
+    request.out_offset = out_offset;
+    request.out_capacity = out_capacity;
+    return call(request, "", -1, nullptr);
+}
+
+std::string RgrDaemonClient::stats_json() {
+    RgrDaemonRequestHeader request;
+    request.op = static_cast<uint16_t>(RgrDaemonOp::Stats);
+    RgrDaemonReply reply = call(request, "", -1, nullptr);
+    if (!reply.ok()) {
+        throw std::runtime_error("Stats request failed: " + reply.message);
+    }
+    return reply.message;
+}
+
+RgrDaemonReply RgrDaemonClient::call(RgrDaemonRequestHeader &request,
+                                     const std::string &aux, int pass_fd,
+                                     uint32_t *key_handle) {
+    request.request_id = next_request_++;
+    request.aux_length = static_cast<uint32_t>(aux.size());
+    std::vector<char> message(sizeof(request) + aux.size());
+    std::memcpy(message.data(), &request, sizeof(request));
+    std::memcpy(message.data() + sizeof(request), aux.data(), aux.size());
+    if (!rgr_daemon_send(socket_, message.data(), message.size(), pass_fd)) {
+        throw std::runtime_error("Lost connection to rgr_daemon.");
+    }
+
+    RgrDaemonResponseHeader response;
+    if (!rgr_daemon_receive(socket_, &response, sizeof(response)) ||
+        response.magic != RGR_DAEMON_MAGIC ||
+        response.request_id != request.request_id ||
+        response.aux_length > RGR_DAEMON_MAX_AUX_BYTES) {
+        throw std::runtime_error("Lost connection to rgr_daemon.");
+    }
+    RgrDaemonReply reply;
+    reply.status = static_cast<RgrDaemonStatus>(response.status);
+    reply.out_length = response.out_length;
+    reply.message.resize(response.aux_length);
+    if (response.aux_length > 0 &&
+        !rgr_daemon_receive(socket_, reply.message.data(),
+                            response.aux_length)) {
+        throw std::runtime_error("Lost connection to rgr_daemon.");
+    }
+    if (key_handle != nullptr) {
+        *key_handle = response.key_handle;
+    }
+    return reply;
+}